@@ -0,0 +1,77 @@
+#include <discpp/utils.h>
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+namespace {
+    // The encoder that appended one character at a time, which Base64Encode replaced.
+    std::string LegacyBase64Encode(const std::string& text) {
+        static const std::string base64_chars =
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+            "abcdefghijklmnopqrstuvwxyz"
+            "0123456789+/";
+
+        const unsigned char* buf = reinterpret_cast<const unsigned char*>(text.c_str());
+        size_t buf_len = text.size();
+        std::string ret;
+        int i = 0;
+        unsigned char char_array_3[3];
+        unsigned char char_array_4[4];
+
+        while (buf_len--) {
+            char_array_3[i++] = *(buf++);
+            if (i == 3) {
+                char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
+                char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
+                char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
+                char_array_4[3] = char_array_3[2] & 0x3f;
+
+                for (i = 0; i < 4; i++) ret += base64_chars[char_array_4[i]];
+                i = 0;
+            }
+        }
+
+        if (i) {
+            for (int j = i; j < 3; j++) char_array_3[j] = '\0';
+
+            char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
+            char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
+            char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
+
+            for (int j = 0; j < i + 1; j++) ret += base64_chars[char_array_4[j]];
+            while (i++ < 3) ret += '=';
+        }
+
+        return ret;
+    }
+
+    // About the size of an emoji upload.
+    std::string MakeImage() {
+        std::string image(256 * 1024, '\0');
+        for (std::size_t i = 0; i < image.size(); i++) {
+            image[i] = static_cast<char>(i * 2654435761u >> 13);
+        }
+
+        return image;
+    }
+}
+
+static void BM_Base64Legacy(benchmark::State& state) {
+    std::string image = MakeImage();
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(LegacyBase64Encode(image));
+    }
+    state.SetBytesProcessed(state.iterations() * image.size());
+}
+BENCHMARK(BM_Base64Legacy);
+
+static void BM_Base64Encode(benchmark::State& state) {
+    std::string image = MakeImage();
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(discpp::Base64Encode(image));
+    }
+    state.SetBytesProcessed(state.iterations() * image.size());
+}
+BENCHMARK(BM_Base64Encode);
@@ -0,0 +1,150 @@
+#include <discpp/client.h>
+#include <discpp/client_config.h>
+#include <discpp/guild.h>
+#include <discpp/member.h>
+#include <discpp/presence.h>
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#define DISCPP_BENCH_COUNT_BYTES
+
+// Count live heap bytes, including allocator rounding, so the results reflect real RSS growth.
+static std::atomic<std::size_t> live_heap_bytes(0);
+
+void* operator new(std::size_t size) {
+    void* ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr) throw std::bad_alloc();
+
+    live_heap_bytes += malloc_usable_size(ptr);
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+    if (ptr == nullptr) return;
+
+    live_heap_bytes -= malloc_usable_size(ptr);
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    operator delete(ptr);
+}
+#endif
+
+namespace {
+    // Mirrors the member layout before role ids were stored inline and users were shared.
+    struct LegacyMember {
+        discpp::User user;
+        discpp::Snowflake guild_id;
+        std::string nick;
+        time_t joined_at;
+        time_t premium_since;
+        std::unique_ptr<discpp::Presence> presence = nullptr;
+        std::vector<discpp::Snowflake> roles;
+        unsigned char flags = 0b0;
+    };
+
+    constexpr int member_count = 10000;
+
+    discpp::Client& BenchClient() {
+        static discpp::ClientConfig config({ "!" });
+        static discpp::Client client("", &config);
+
+        return client;
+    }
+
+    std::unique_ptr<rapidjson::Document> MakeGuildJson() {
+        auto json = std::make_unique<rapidjson::Document>();
+        json->Parse(R"({"id": "81384788765712384", "name": "Benchmark", "region": "us-east", "afk_timeout": 300,
+            "verification_level": 0, "default_message_notifications": 0, "explicit_content_filter": 0, "mfa_level": 0,
+            "system_channel_flags": 0, "premium_tier": 0, "preferred_locale": "en-US", "roles": [
+            {"id": "81384788765712384", "name": "@everyone", "color": 0, "position": 0, "permissions": 104324161},
+            {"id": "81384788765712385", "name": "Member", "color": 0, "position": 1, "permissions": 104324161},
+            {"id": "81384788765712386", "name": "Helper", "color": 0, "position": 2, "permissions": 104324161}]})");
+
+        return json;
+    }
+
+    std::unique_ptr<rapidjson::Document> MakeMemberJson(int i) {
+        std::string id = std::to_string(150312037426135041ULL + (static_cast<uint64_t>(i) << 22));
+        std::string nick = (i % 4 == 0) ? "\"Nickname " + std::to_string(i) + "\"" : "null";
+
+        auto json = std::make_unique<rapidjson::Document>();
+        json->Parse(("{\"user\": {\"id\": \"" + id + "\", \"username\": \"benchmark user " + std::to_string(i) +
+            "\", \"discriminator\": \"0001\", \"avatar\": \"a_8342729096ea3675442027381ff50dfe\"}, \"nick\": " + nick +
+            ", \"roles\": [\"81384788765712385\", \"81384788765712386\"], \"joined_at\": \"2020-06-23T12:34:56.789000+00:00\"," +
+            " \"premium_since\": null, \"deaf\": false, \"mute\": false}").c_str());
+
+        return json;
+    }
+}
+
+static void BM_MemberLayoutLegacy(benchmark::State& state) {
+    BenchClient();
+
+    std::vector<std::unique_ptr<rapidjson::Document>> jsons;
+    for (int i = 0; i < member_count; i++) jsons.push_back(MakeMemberJson(i));
+
+    for (auto _ : state) {
+#ifdef DISCPP_BENCH_COUNT_BYTES
+        std::size_t before = live_heap_bytes;
+#endif
+        std::vector<std::shared_ptr<LegacyMember>> members;
+        members.reserve(member_count);
+        for (auto& json : jsons) {
+            auto member = std::make_shared<LegacyMember>();
+            member->user = discpp::ConstructDiscppObjectFromJson(*json, "user", discpp::User());
+            member->nick = discpp::GetDataSafely<std::string>(*json, "nick");
+            for (auto& role : (*json)["roles"].GetArray()) {
+                member->roles.emplace_back(discpp::Snowflake(role.GetString()));
+            }
+            member->joined_at = discpp::TimeFromDiscord((*json)["joined_at"].GetString());
+            member->premium_since = 0;
+
+            members.push_back(member);
+        }
+
+#ifdef DISCPP_BENCH_COUNT_BYTES
+        // Exclude the vector of handles, it isn't part of the per member cost.
+        std::size_t used = live_heap_bytes - before - members.capacity() * sizeof(std::shared_ptr<LegacyMember>);
+        state.counters["bytes_per_member"] = static_cast<double>(used) / member_count;
+#endif
+    }
+}
+BENCHMARK(BM_MemberLayoutLegacy)->Iterations(1)->Unit(benchmark::kMillisecond);
+
+static void BM_MemberLayoutCompact(benchmark::State& state) {
+    discpp::Client& client = BenchClient();
+
+    std::unique_ptr<rapidjson::Document> guild_json = MakeGuildJson();
+    std::vector<std::unique_ptr<rapidjson::Document>> jsons;
+    for (int i = 0; i < member_count; i++) jsons.push_back(MakeMemberJson(i));
+
+    for (auto _ : state) {
+        client.cache.users.Clear();
+
+#ifdef DISCPP_BENCH_COUNT_BYTES
+        std::size_t before = live_heap_bytes;
+#endif
+        discpp::Guild guild(*guild_json);
+        std::vector<std::shared_ptr<discpp::Member>> members;
+        members.reserve(member_count);
+        for (auto& json : jsons) {
+            members.push_back(guild.ParseMember(*json));
+        }
+
+#ifdef DISCPP_BENCH_COUNT_BYTES
+        std::size_t used = live_heap_bytes - before - members.capacity() * sizeof(std::shared_ptr<discpp::Member>);
+        state.counters["bytes_per_member"] = static_cast<double>(used) / member_count;
+#endif
+    }
+}
+BENCHMARK(BM_MemberLayoutCompact)->Iterations(1)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,110 @@
+#include <discpp/flat_hash_map.h>
+#include <discpp/snowflake.h>
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    // What std::hash<discpp::Snowflake> used to be.
+    struct IdentityHash {
+        std::size_t operator()(const discpp::Snowflake& k) const {
+            return std::hash<uint64_t>()(k);
+        }
+    };
+
+    // Ids shaped like real snowflakes: increasing timestamps, a few workers and a sequence counter.
+    std::vector<discpp::Snowflake> MakeSnowflakes(std::size_t count) {
+        std::mt19937_64 rng(42);
+        std::vector<discpp::Snowflake> ids;
+        ids.reserve(count);
+
+        uint64_t timestamp = 600000000000ULL;
+        for (std::size_t i = 0; i < count; i++) {
+            timestamp += rng() % 1000;
+            ids.emplace_back((timestamp << 22) | ((rng() % 4) << 17) | (i & 0xFFF));
+        }
+
+        return ids;
+    }
+
+    std::vector<std::string> MakeSnowflakeStrings(std::size_t count) {
+        std::vector<std::string> strings;
+        for (const discpp::Snowflake& id : MakeSnowflakes(count)) {
+            strings.push_back(std::to_string(static_cast<uint64_t>(id)));
+        }
+
+        return strings;
+    }
+
+    template <typename Map>
+    void BM_SnowflakeLookup(benchmark::State& state) {
+        std::vector<discpp::Snowflake> ids = MakeSnowflakes(static_cast<std::size_t>(state.range(0)));
+
+        Map map;
+        for (const discpp::Snowflake& id : ids) {
+            map.insert({ id, std::make_shared<int>(0) });
+        }
+
+        std::mt19937_64 rng(7);
+        std::vector<discpp::Snowflake> lookups;
+        for (int i = 0; i < 4096; i++) lookups.push_back(ids[rng() % ids.size()]);
+
+        std::size_t i = 0;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(map.find(lookups[i++ & 4095]));
+        }
+    }
+
+    template <typename Map>
+    void BM_SnowflakeInsert(benchmark::State& state) {
+        std::vector<discpp::Snowflake> ids = MakeSnowflakes(static_cast<std::size_t>(state.range(0)));
+
+        for (auto _ : state) {
+            Map map;
+            for (const discpp::Snowflake& id : ids) {
+                map.insert({ id, std::make_shared<int>(0) });
+            }
+
+            benchmark::DoNotOptimize(map.size());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+}
+
+static void BM_SnowflakeParseStoll(benchmark::State& state) {
+    std::vector<std::string> strings = MakeSnowflakeStrings(4096);
+
+    std::size_t i = 0;
+    for (auto _ : state) {
+        // The old constructor built a std::string from the rapidjson c string first.
+        const char* str = strings[i++ & 4095].c_str();
+        benchmark::DoNotOptimize(static_cast<uint64_t>(std::stoll(std::string(str))));
+    }
+}
+BENCHMARK(BM_SnowflakeParseStoll);
+
+static void BM_SnowflakeParse(benchmark::State& state) {
+    std::vector<std::string> strings = MakeSnowflakeStrings(4096);
+
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(discpp::Snowflake(strings[i++ & 4095].c_str()));
+    }
+}
+BENCHMARK(BM_SnowflakeParse);
+
+using UnorderedIdentityMap = std::unordered_map<discpp::Snowflake, std::shared_ptr<int>, IdentityHash>;
+using UnorderedMixedMap = std::unordered_map<discpp::Snowflake, std::shared_ptr<int>>;
+using FlatMap = discpp::SnowflakeMap<std::shared_ptr<int>>;
+
+BENCHMARK_TEMPLATE(BM_SnowflakeLookup, UnorderedIdentityMap)->Range(64, 1 << 17);
+BENCHMARK_TEMPLATE(BM_SnowflakeLookup, UnorderedMixedMap)->Range(64, 1 << 17);
+BENCHMARK_TEMPLATE(BM_SnowflakeLookup, FlatMap)->Range(64, 1 << 17);
+
+BENCHMARK_TEMPLATE(BM_SnowflakeInsert, UnorderedIdentityMap)->Range(64, 1 << 17);
+BENCHMARK_TEMPLATE(BM_SnowflakeInsert, FlatMap)->Range(64, 1 << 17);
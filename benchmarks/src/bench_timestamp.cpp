@@ -0,0 +1,68 @@
+#include <discpp/utils.h>
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <ctime>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+    // The sscanf and mktime based parser that TimePointFromDiscord replaced, without its debug log line.
+    time_t LegacyTimeFromDiscord(const std::string& time) {
+        int year, month, day, hour, minute;
+        int timezone_hr = 0, timezone_min = 0;
+        float second;
+        if (6 < sscanf(time.c_str(), "%d-%d-%dT%d:%d:%f%d:%d", &year, &month, &day, &hour, &minute, &second, &timezone_hr, &timezone_min)) {
+            hour += timezone_hr;
+
+            struct tm t{};
+            t.tm_year = year - 1900;
+            t.tm_mon = month - 1;
+            t.tm_mday = day;
+            t.tm_hour = hour;
+            t.tm_min = minute;
+            t.tm_sec = (int) second;
+
+            time_t utc_time = mktime(&t);
+            struct tm utc_buf = *localtime(&utc_time);
+            benchmark::DoNotOptimize(utc_buf);
+
+            return utc_time;
+        }
+
+        throw std::runtime_error("Failed to parse time");
+    }
+
+    std::vector<std::string> MakeTimestamps() {
+        std::vector<std::string> timestamps;
+        for (int i = 0; i < 1024; i++) {
+            char buffer[40];
+            std::snprintf(buffer, sizeof(buffer), "20%02d-%02d-%02dT%02d:%02d:%02d.%06d+00:00", 15 + i % 6, 1 + i % 12,
+                1 + i % 28, i % 24, i % 60, (i * 7) % 60, i * 977 % 1000000);
+            timestamps.emplace_back(buffer);
+        }
+
+        return timestamps;
+    }
+}
+
+static void BM_TimestampLegacy(benchmark::State& state) {
+    std::vector<std::string> timestamps = MakeTimestamps();
+
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(LegacyTimeFromDiscord(timestamps[i++ & 1023]));
+    }
+}
+BENCHMARK(BM_TimestampLegacy);
+
+static void BM_TimestampParse(benchmark::State& state) {
+    std::vector<std::string> timestamps = MakeTimestamps();
+
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(discpp::TimePointFromDiscord(timestamps[i++ & 1023]));
+    }
+}
+BENCHMARK(BM_TimestampParse);
@@ -45,7 +45,7 @@ int main(int argc, const char* argv[]) {
 	discpp::EventHandler<discpp::GuildMemberAddEvent>::RegisterListener([](discpp::GuildMemberAddEvent event) {
 		discpp::Channel channel((discpp::Snowflake) "638156895953223714");
 
-		channel.Send("Welcome <@" + std::to_string(event.member->user.id) + ">, hope you enjoy!");
+		channel.Send("Welcome <@" + std::to_string(event.member->user->id) + ">, hope you enjoy!");
 	});
 
 	discpp::EventHandler<discpp::ChannelPinsUpdateEvent>::RegisterListener([](discpp::ChannelPinsUpdateEvent event)->bool {
@@ -13,17 +13,172 @@
 #include "guild.h"
 #include "message.h"
 #include "channel.h"
+#include "concurrent_map.h"
+#include "message_cache.h"
+#include "cache_stats.h"
 
+#include <future>
 #include <memory>
-#include <unordered_map>
+#include <optional>
 
 namespace discpp {
+    /**
+     * @brief Holds every discord object the client has seen.
+     *
+     * The containers are sharded and internally locked, so they can be read and written from any
+     * dispatcher or listener thread. Lookups only lock the shard that owns the id.
+     */
     class Cache {
     public:
-        std::unordered_map<Snowflake, std::shared_ptr<Member>> members; /**< List of members the current bot can access. */
-        std::unordered_map<Snowflake, std::shared_ptr<Guild>> guilds; /**< List of guilds the current bot can access. */
-        std::unordered_map<Snowflake, std::shared_ptr<Message>> messages; /**< List of messages the current bot can access. */
-        std::unordered_map<discpp::Snowflake, discpp::Channel> private_channels; /**< List of dm channels the current client can access. */
+        discpp::ConcurrentMap<Snowflake, std::shared_ptr<User>> users; /**< Every user the bot can access, shared by all of their guild members. */
+        discpp::ConcurrentMap<Snowflake, std::shared_ptr<Guild>> guilds; /**< List of guilds the current bot can access. */
+        discpp::MessageCache messages; /**< Bounded store of recent messages, limited by ClientConfig::message_cache_size. */
+        discpp::ConcurrentMap<discpp::Snowflake, discpp::Channel> private_channels; /**< List of dm channels the current client can access. */
+        discpp::ConcurrentMap<discpp::Snowflake, discpp::Snowflake> channel_guilds; /**< Guild id of every cached guild channel, keyed by channel id. */
+
+        /**
+         * @brief Find a cached guild without throwing or requesting it.
+         *
+         * ```cpp
+         *      std::shared_ptr<discpp::Guild> guild = cache.FindGuild(guild_id);
+         *      if (guild) { ... }
+         * ```
+         *
+         * @param[in] guild_id The id of the guild.
+         *
+         * @return std::shared_ptr<discpp::Guild>, nullptr if the guild isn't cached.
+         */
+        std::shared_ptr<discpp::Guild> FindGuild(const Snowflake& guild_id) const;
+
+        /**
+         * @brief Replace a cached guild with a changed copy of it.
+         *
+         * Cached guilds are never changed in place, since listeners and other dispatcher threads may be
+         * reading them without a lock. The guild is copied, `func` changes the copy and the copy replaces
+         * the cached guild. This runs under the lock of the guild's shard, so two updates of one guild
+         * can't lose each other's changes. The copy shares the memoized permissions of the cached guild,
+         * which are checked against its roles and overwrites before they're used.
+         *
+         * The copy is shallow: it shares the immutable channel, role and emoji maps of the cached guild and
+         * its discpp::GuildMembers store. Replace one of those maps with UpdateGuildChannels, UpdateGuildRoles
+         * or UpdateGuildEmojis, and add, replace or remove members in the store directly.
+         *
+         * ```cpp
+         *      cache.UpdateGuild(guild_id, [&](discpp::Guild& guild) { guild.Update(json); });
+         * ```
+         *
+         * @param[in] guild_id The id of the guild.
+         * @param[in] func Called with the copy, must not access the guild cache.
+         *
+         * @return std::shared_ptr<discpp::Guild>, the new guild, nullptr if the guild isn't cached.
+         */
+        template <typename Func>
+        std::shared_ptr<discpp::Guild> UpdateGuild(const Snowflake& guild_id, Func&& func) {
+            std::shared_ptr<discpp::Guild> updated;
+            guilds.Update(guild_id, [&](std::shared_ptr<discpp::Guild>& cached) {
+                updated = std::make_shared<discpp::Guild>(*cached);
+                func(*updated);
+                cached = updated;
+            });
+
+            return updated;
+        }
+
+        /**
+         * @brief Replace the channels of a cached guild with a changed copy of them.
+         *
+         * Only the channel map is copied, the roles, emojis and members stay shared with the replaced guild.
+         *
+         * ```cpp
+         *      cache.UpdateGuildChannels(guild_id, [&](discpp::GuildChannels& channels) { channels.erase(channel_id); });
+         * ```
+         *
+         * @param[in] guild_id The id of the guild.
+         * @param[in] func Called with the copied channels, must not access the guild cache.
+         *
+         * @return std::shared_ptr<discpp::Guild>, the new guild, nullptr if the guild isn't cached.
+         */
+        template <typename Func>
+        std::shared_ptr<discpp::Guild> UpdateGuildChannels(const Snowflake& guild_id, Func&& func) {
+            return UpdateGuildPart(guild_id, &discpp::Guild::channels, std::forward<Func>(func));
+        }
+
+        /**
+         * @brief Replace the roles of a cached guild with a changed copy of them.
+         *
+         * Only the role map is copied, the roles themselves are shared.
+         *
+         * ```cpp
+         *      cache.UpdateGuildRoles(guild_id, [&](discpp::GuildRoles& roles) { roles[role->id] = role; });
+         * ```
+         *
+         * @param[in] guild_id The id of the guild.
+         * @param[in] func Called with the copied roles, must not access the guild cache.
+         *
+         * @return std::shared_ptr<discpp::Guild>, the new guild, nullptr if the guild isn't cached.
+         */
+        template <typename Func>
+        std::shared_ptr<discpp::Guild> UpdateGuildRoles(const Snowflake& guild_id, Func&& func) {
+            return UpdateGuildPart(guild_id, &discpp::Guild::roles, std::forward<Func>(func));
+        }
+
+        /**
+         * @brief Replace the emojis of a cached guild with a changed copy of them.
+         *
+         * ```cpp
+         *      cache.UpdateGuildEmojis(guild_id, [&](discpp::GuildEmojis& emojis) { emojis.erase(emoji_id); });
+         * ```
+         *
+         * @param[in] guild_id The id of the guild.
+         * @param[in] func Called with the copied emojis, must not access the guild cache.
+         *
+         * @return std::shared_ptr<discpp::Guild>, the new guild, nullptr if the guild isn't cached.
+         */
+        template <typename Func>
+        std::shared_ptr<discpp::Guild> UpdateGuildEmojis(const Snowflake& guild_id, Func&& func) {
+            return UpdateGuildPart(guild_id, &discpp::Guild::emojis, std::forward<Func>(func));
+        }
+
+        /**
+         * @brief Find a cached guild or DM channel without throwing or requesting it.
+         *
+         * ```cpp
+         *      std::optional<discpp::Channel> channel = cache.FindChannel(channel_id);
+         * ```
+         *
+         * @param[in] id The id of the channel.
+         *
+         * @return std::optional<discpp::Channel>, empty if the channel isn't cached.
+         */
+        std::optional<discpp::Channel> FindChannel(const Snowflake& id) const;
+
+        /**
+         * @brief Find a cached DM channel without throwing or requesting it.
+         *
+         * @param[in] id The id of the DM channel.
+         *
+         * @return std::optional<discpp::Channel>, empty if the channel isn't cached.
+         */
+        std::optional<discpp::Channel> FindDMChannel(const Snowflake& id) const;
+
+        /**
+         * @brief Find a cached member without throwing or requesting it.
+         *
+         * @param[in] guild_id The id of the member's guild.
+         * @param[in] id The id of the member.
+         *
+         * @return std::shared_ptr<discpp::Member>, nullptr if the guild or member isn't cached.
+         */
+        std::shared_ptr<discpp::Member> FindMember(const Snowflake& guild_id, const Snowflake& id) const;
+
+        /**
+         * @brief Find a cached user without throwing or requesting it.
+         *
+         * @param[in] id The id of the user.
+         *
+         * @return std::shared_ptr<discpp::User>, nullptr if the user isn't cached.
+         */
+        std::shared_ptr<discpp::User> FindUser(const Snowflake& id) const;
 
         /**
          * @brief Gets a discpp::Guild from a guild id.
@@ -39,6 +194,23 @@ namespace discpp {
          */
         std::shared_ptr<discpp::Guild> GetGuild(const Snowflake& guild_id, bool can_request = false);
 
+        /**
+         * @brief Gets a discpp::Guild from a guild id, requesting it without blocking if it isn't cached.
+         *
+         * A cached guild is returned as a ready future. Otherwise the guild is requested through
+         * discpp::RestEngine and added to the cache once it arrives. The guild is parsed and cached on the
+         * engine's loop thread, which holds up other async requests for as long as that takes.
+         *
+         * ```cpp
+         *      std::future<std::shared_ptr<discpp::Guild>> guild = cache.GetGuildAsync(guild_id);
+         * ```
+         *
+         * @param[in] guild_id The guild id of the guild you want to get.
+         *
+         * @return std::future<std::shared_ptr<discpp::Guild>>
+         */
+        std::future<std::shared_ptr<discpp::Guild>> GetGuildAsync(const Snowflake& guild_id);
+
         /**
          * @brief Gets a channel from guild cache and private caches.
          *
@@ -46,7 +218,8 @@ namespace discpp {
          * the channel from the REST API. But if its not true, and its not found, an exception will be
          * thrown of DiscordObjectNotFound.
          *
-         * If the id is of a DM channel's id, it will return that DM channel.
+         * If the id is of a DM channel's id, it will return that DM channel. Guild channels are found
+         * through `channel_guilds`, so a lookup never walks the guilds.
          *
          * @return discpp::Channel
          */
@@ -64,7 +237,7 @@ namespace discpp {
         discpp::Channel GetDMChannel(const discpp::Snowflake& id, bool can_request = false);
 
         /**
-         * @brief Get a member with id.
+         * @brief Get a member with id from the member cache of its guild.
          *
          * If you set `can_request` to true, and the member is not found in cache, then we will request
          * the member from the REST API. But if its not true, and its not found, an exception will be
@@ -88,6 +261,106 @@ namespace discpp {
          * @return discpp::Message
          */
         discpp::Message GetDiscordMessage(const Snowflake& channel_id, const Snowflake& id, bool can_request = false);
+
+        /**
+         * @brief Get a user with id.
+         *
+         * If you set `can_request` to true, and the user is not found in cache, then we will request
+         * the user from the REST API. But if its not true, and its not found, an exception will be
+         * thrown of DiscordObjectNotFound.
+         *
+         * @param[in] id The id of the user.
+         * @param[in] can_request Whether or not the library can request the user from the REST API.
+         *
+         * @return std::shared_ptr<discpp::User>
+         */
+        std::shared_ptr<discpp::User> GetUser(const Snowflake& id, bool can_request = false);
+
+        /**
+         * @brief Get the shared record of a user, creating or updating it from json.
+         *
+         * If the user is already cached, the record is updated from the fields present in the json, see
+         * UpdateUser.
+         *
+         * ```cpp
+         *      std::shared_ptr<discpp::User> user = cache.InternUser(user_json);
+         * ```
+         *
+         * @param[in] json The json of the (partial) user object.
+         *
+         * @return std::shared_ptr<discpp::User>
+         */
+        std::shared_ptr<discpp::User> InternUser(rapidjson::Document& json);
+
+        /**
+         * @brief Update the shared record of a cached user from json, without caching unknown users.
+         *
+         * Members and listeners read user records without a lock, so a record is never changed in place.
+         * If the json changes any field, the cached record is replaced by an updated copy, otherwise the
+         * cached record is returned without allocating anything. Members keep the record they have until
+         * they are replaced themselves, which the member and presence events do.
+         *
+         * ```cpp
+         *      std::shared_ptr<discpp::User> user = cache.UpdateUser(partial_user_json);
+         * ```
+         *
+         * @param[in] json The json of the (partial) user object.
+         *
+         * @return std::shared_ptr<discpp::User>, the current record, nullptr if the user isn't cached.
+         */
+        std::shared_ptr<discpp::User> UpdateUser(rapidjson::Document& json);
+
+        /**
+         * @brief Remove a guild from the cache, with its channels and the users that are in no other cached guild.
+         *
+         * The removed guild still references its members' users, and listeners may hold it for a while,
+         * so its users are dropped by membership instead of waiting for their use count to fall.
+         *
+         * ```cpp
+         *      std::shared_ptr<discpp::Guild> removed = cache.RemoveGuild(guild_id);
+         * ```
+         *
+         * @param[in] guild_id The id of the guild.
+         *
+         * @return std::shared_ptr<discpp::Guild>, the removed guild, nullptr if it wasn't cached.
+         */
+        std::shared_ptr<discpp::Guild> RemoveGuild(const Snowflake& guild_id);
+
+        /**
+         * @brief Remove users that are no longer referenced by any cached member.
+         *
+         * @return std::size_t, the amount of removed users.
+         */
+        std::size_t PruneUsers();
+
+        /**
+         * @brief Get the entry counts and approximate memory usage of everything cached.
+         *
+         * Cached guilds are never changed in place (see UpdateGuild), so the guilds are collected under
+         * the shard locks and each one is then walked without holding a lock. A guild that is replaced
+         * meanwhile is counted as it was when collected. The per guild breakdown is only built when
+         * asked for.
+         *
+         * ```cpp
+         *      discpp::CacheStats stats = cache.GetStats();
+         *      std::cout << "Members use ~" << stats.members.bytes / 1024 << " KiB" << std::endl;
+         * ```
+         *
+         * @param[in] per_guild Whether to fill discpp::CacheStats::per_guild.
+         *
+         * @return discpp::CacheStats
+         */
+        discpp::CacheStats GetStats(bool per_guild = false) const;
+    private:
+        // Copies one of the immutable maps of a guild, lets `func` change it and swaps it into a copy of the guild.
+        template <typename Map, typename Func>
+        std::shared_ptr<discpp::Guild> UpdateGuildPart(const Snowflake& guild_id, std::shared_ptr<const Map> discpp::Guild::* part, Func&& func) {
+            return UpdateGuild(guild_id, [&part, &func](discpp::Guild& copy) {
+                std::shared_ptr<Map> updated = std::make_shared<Map>(*(copy.*part));
+                func(*updated);
+                copy.*part = std::move(updated);
+            });
+        }
     };
 }
 
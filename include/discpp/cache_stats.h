@@ -0,0 +1,92 @@
+#ifndef DISCPP_CACHE_STATS_H
+#define DISCPP_CACHE_STATS_H
+
+#include "snowflake.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace discpp {
+    /**
+     * @brief Entry count and approximate memory usage of one kind of cached object.
+     *
+     * Bytes include the object itself, the heap storage of its strings and containers, and the
+     * node overhead of the container that holds it.
+     */
+    struct CacheEntryStats {
+        std::size_t count = 0; /**< Amount of cached entries. */
+        std::size_t bytes = 0; /**< Approximate bytes used by the entries. */
+
+        CacheEntryStats& operator+=(const CacheEntryStats& other) {
+            count += other.count;
+            bytes += other.bytes;
+
+            return *this;
+        }
+    };
+
+    /**
+     * @brief Memory usage of the objects cached inside a single guild.
+     */
+    struct GuildCacheStats {
+        discpp::Snowflake guild_id; /**< The id of the guild. */
+        int shard_id = 0; /**< The shard that receives this guild's events. */
+        CacheEntryStats guild; /**< The guild object itself, with its strings and features. */
+        CacheEntryStats members; /**< Entries of `Guild::members`, not counting the shared users. */
+        CacheEntryStats channels; /**< Entries of `Guild::channels`. */
+        CacheEntryStats roles; /**< Entries of `Guild::roles`. */
+        CacheEntryStats emojis; /**< Entries of `Guild::emojis`. */
+        CacheEntryStats voice_states; /**< Entries of `Guild::voice_states`. */
+
+        /**
+         * @brief Get the approximate bytes used by everything cached in this guild.
+         *
+         * @return std::size_t
+         */
+        std::size_t Bytes() const {
+            return guild.bytes + members.bytes + channels.bytes + roles.bytes + emojis.bytes + voice_states.bytes;
+        }
+    };
+
+    /**
+     * @brief Memory usage of every guild that one shard receives events for.
+     */
+    struct ShardCacheStats {
+        int shard_id = 0; /**< The id of the shard. */
+        std::size_t guilds = 0; /**< Amount of cached guilds on this shard. */
+        std::size_t bytes = 0; /**< Approximate bytes used by those guilds and their contents. */
+    };
+
+    /**
+     * @brief Snapshot of what the client cache holds, see discpp::Cache::GetStats.
+     *
+     * Totals are summed over every guild. The sizes are estimates from `sizeof`, string and container
+     * capacities, and typical node overhead, not exact allocator figures.
+     */
+    struct CacheStats {
+        CacheEntryStats guilds; /**< The guild objects, without the contents counted separately below. */
+        CacheEntryStats users; /**< Entries of `Cache::users`, shared by members. */
+        CacheEntryStats members; /**< Members of every guild. */
+        CacheEntryStats channels; /**< Channels of every guild. */
+        CacheEntryStats private_channels; /**< Entries of `Cache::private_channels`. */
+        CacheEntryStats roles; /**< Roles of every guild. */
+        CacheEntryStats emojis; /**< Emojis of every guild. */
+        CacheEntryStats voice_states; /**< Voice states of every guild. */
+        CacheEntryStats messages; /**< Entries of `Cache::messages`. */
+        CacheEntryStats ratelimit_buckets; /**< Buckets tracked by `discpp::rate_limiter`. */
+        std::vector<GuildCacheStats> per_guild; /**< Breakdown per guild, only filled when requested. */
+        std::vector<ShardCacheStats> per_shard; /**< Breakdown per shard, indexed by shard id. */
+
+        /**
+         * @brief Get the approximate bytes used by the whole cache.
+         *
+         * @return std::size_t
+         */
+        std::size_t Bytes() const {
+            return guilds.bytes + users.bytes + members.bytes + channels.bytes + private_channels.bytes + roles.bytes + emojis.bytes +
+                voice_states.bytes + messages.bytes + ratelimit_buckets.bytes;
+        }
+    };
+}
+
+#endif //DISCPP_CACHE_STATS_H
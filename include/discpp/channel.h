@@ -5,12 +5,16 @@
 #include "permission.h"
 #include "embed_builder.h"
 #include "utils.h"
+#include "file.h"
 
+#include <future>
 #include <variant>
 #include <vector>
 
 namespace discpp {
 	class Message;
+	struct MessageView;
+	template <typename T> class MessageHistory;
 	class GuildInvite;
 	class User;
 	class Guild;
@@ -88,10 +92,13 @@ namespace discpp {
         return request;
     }
 
-	struct File {
-		std::string file_name;
-		std::string file_path;
-	};
+    /**
+     * @brief Which way a discpp::MessageHistory walks through a channel.
+     */
+    enum class HistoryDirection : int {
+        OLDER, /**< From the newest message, or the start message, towards the oldest. */
+        NEWER /**< From the oldest message, or the start message, towards the newest. */
+    };
 
 	class Channel : public DiscordObject {
 	public:
@@ -142,6 +149,10 @@ namespace discpp {
          *      ctx.Send("Command output was too large to fit in an embed.", false, nullptr, { file }); // Sending files
          * ```
          *
+         * Messages with files or over 2000 characters are uploaded by discpp::RestEngine and waited for, so they
+         * throw discpp::exceptions::LoopThreadException on its loop thread, where waiting would never return.
+         * Use SendAsync there instead.
+         *
          * @param[in] text The text that goes along with the embed.
          * @param[in] tts Should it be a text to speech message?
          * @param[in] embed Embed to send
@@ -151,6 +162,25 @@ namespace discpp {
          */
 		discpp::Message Send(const std::string& text, const bool tts = false, discpp::EmbedBuilder* embed = nullptr, std::vector<discpp::File> files = {});
 
+        /**
+         * @brief Send a message in this channel without blocking.
+         *
+         * The request is performed by discpp::RestEngine, so the calling thread is free while it is
+         * in flight. Messages of 2000 characters or more are uploaded as a file, straight from memory.
+         *
+         * ```cpp
+         *      std::future<discpp::Message> message = channel.SendAsync("Hello, I'm a bot!");
+         * ```
+         *
+         * @param[in] text The text that goes along with the embed.
+         * @param[in] tts Should it be a text to speech message?
+         * @param[in] embed Embed to send, it is copied before this returns.
+         * @param[in] files Files to send, read while uploading.
+         *
+         * @return std::future<discpp::Message>
+         */
+        std::future<discpp::Message> SendAsync(const std::string& text, const bool tts = false, discpp::EmbedBuilder* embed = nullptr, std::vector<discpp::File> files = {});
+
         /**
          * @brief Modify the channel.
          *
@@ -199,6 +229,46 @@ namespace discpp {
          */
         std::vector<discpp::Message> RequestMessages(int amount, RequestChannelsMessageMethod get_method = {}) const;
 
+        /**
+         * @brief Walk the channel's history lazily, page by page.
+         *
+         * Pages of up to 100 messages are requested while iterating, and the next page is always prefetched
+         * while the current one is consumed. Include "message_history.h" to use the returned range.
+         *
+         * ```cpp
+         *      for (discpp::Message& message : channel.RequestHistory(discpp::HistoryDirection::OLDER, 0, 5000)) {
+         *          export_file << message.author.username << ": " << message.content << "\n";
+         *      }
+         * ```
+         *
+         * @param[in] direction Which way to walk.
+         * @param[in] start Walk from before (or after) this message id, 0 starts at the newest (or oldest) message.
+         * @param[in] limit The most messages to walk, 0 walks the whole history.
+         *
+         * @return discpp::MessageHistory<discpp::Message>
+         */
+        discpp::MessageHistory<discpp::Message> RequestHistory(HistoryDirection direction = HistoryDirection::OLDER, const Snowflake& start = 0, std::size_t limit = 0) const;
+
+        /**
+         * @brief Walk the channel's history lazily as lightweight discpp::MessageView's.
+         *
+         * Same as RequestHistory, but the messages aren't turned into discpp::Message's. That makes it the
+         * better choice for exports and purges of large channels.
+         *
+         * ```cpp
+         *      for (const discpp::MessageView& message : channel.RequestHistoryViews()) {
+         *          if (message.author_id == spammer_id) to_delete.push_back(message.id);
+         *      }
+         * ```
+         *
+         * @param[in] direction Which way to walk.
+         * @param[in] start Walk from before (or after) this message id, 0 starts at the newest (or oldest) message.
+         * @param[in] limit The most messages to walk, 0 walks the whole history.
+         *
+         * @return discpp::MessageHistory<discpp::MessageView>
+         */
+        discpp::MessageHistory<discpp::MessageView> RequestHistoryViews(HistoryDirection direction = HistoryDirection::OLDER, const Snowflake& start = 0, std::size_t limit = 0) const;
+
         /**
          * @brief Requests the channel's message from the discord api.
          *
@@ -244,7 +314,11 @@ namespace discpp {
 		std::vector<discpp::Message> GetPinnedMessages();
 
         /**
-         * @brief Delete several messages (2-100).
+         * @brief Delete several messages.
+         *
+         * The messages are split into bulk delete batches of up to 100, and messages older than 14 days,
+         * which bulk delete rejects, are deleted one by one. Use discpp::MessagePurger for purges by predicate
+         * or with progress reports.
          *
          * ```cpp
          *      channel.BulkDeleteMessage({message_a, message_b, message_c});
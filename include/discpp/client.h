@@ -12,6 +12,7 @@
 #include "settings.h"
 #include "channel.h"
 #include "cache.h"
+#include "gateway_limiter.h"
 
 namespace discpp {
 	class Role;
@@ -22,6 +23,7 @@ namespace discpp {
 	class Message;
 	class Logger;
 	class Image;
+	class JsonWriter;
 
 	class ClientUser : public User {
 	public:
@@ -321,6 +323,23 @@ namespace discpp {
          */
         void CreateWebsocketRequest(rapidjson::Document& json, const std::string& message = "");
 
+        /**
+         * @brief Send a request written with a discpp::JsonWriter to the websocket.
+         *
+         * Every payload counts against the gateway send limit of the connection, see discpp::GatewaySendLimiter.
+         * If the limit is reached, this blocks until the payload may be sent.
+         *
+         * ```cpp
+         *      shard.CreateWebsocketRequest(writer);
+         * ```
+         *
+         * @param[in] json The request to send to the websocket.
+         * @param[in] message The message to print to the debug log. If this is empty it will be set to default. (Default: "Sending gateway payload" + payload)
+         *
+         * @return void
+         */
+        void CreateWebsocketRequest(const JsonWriter& json, const std::string& message = "");
+
         enum Opcode : int {
             DISPATCH = 0,				// Receive
             HEARTBEAT = 1,				// Send/Receive
@@ -353,6 +372,7 @@ namespace discpp {
         ix::WebSocket websocket;
 
         discpp::Client::HeartbeatWaiter heartbeat_waiter;
+        discpp::GatewaySendLimiter send_limiter;
 
         bool ready = false;
         bool disconnected = true;
@@ -368,6 +388,7 @@ namespace discpp {
         void OnWebSocketPacket(rapidjson::Document& result);
         void HandleDiscordDisconnect(const ix::WebSocketMessagePtr& msg);
         void HandleHeartbeat();
+        void SendPayload(const std::string& json_payload, const std::string& message, bool heartbeat);
         std::unique_ptr<rapidjson::Document> GetIdentifyPacket();
     };
 }
@@ -2,6 +2,7 @@
 #define DISCPP_CLIENT_CONFIG_H
 
 #include "log.h"
+#include <cstddef>
 #include <string>
 #include <utility>
 #include <vector>
@@ -12,14 +13,49 @@ namespace discpp {
         BOT
     };
 
+    /**
+     * @brief Which guild members the client keeps in `Guild::members`.
+     */
+    enum class MemberCachePolicy {
+        ALL, /**< Cache every member the client sees. */
+        NONE, /**< Never cache members, they are fetched from the REST api when requested. */
+        LARGE_GUILDS, /**< Only cache members of guilds that Discord marks as large. */
+        ACTIVE /**< Skip the member lists sent with guilds, only cache members that join, change or send a message. */
+    };
+
+    /**
+     * @brief Controls which entities the client caches.
+     *
+     * Guilds are always cached. Disabled entities are not parsed at all, so turning off what a bot
+     * doesn't use saves both CPU and memory.
+     *
+     * ```cpp
+     *      discpp::ClientConfig* config = new discpp::ClientConfig({"!"});
+     *      config->cache_policy.members = discpp::MemberCachePolicy::NONE;
+     *      config->cache_policy.presences = false;
+     * ```
+     */
+    class CachePolicy {
+    public:
+        MemberCachePolicy members = MemberCachePolicy::ALL; /**< Which members to cache. */
+        bool channels = true; /**< Cache guild channels. */
+        bool presences = true; /**< Cache member presences. */
+        bool emojis = true; /**< Cache guild emojis. */
+        bool voice_states = true; /**< Cache guild voice states. */
+        bool rest_responses = false; /**< Cache responses of read mostly REST routes, see discpp::ResponseCache::EnableDefaults. */
+    };
+
 	class ClientConfig {
 	public:
 		std::vector<std::string> prefixes;
 		TokenType type;
 		int logger_flags;
 		int message_cache_size;
+		std::size_t message_cache_bytes = 0; /**< Approximate byte budget of the message cache, 0 means only `message_cache_size` applies. */
 		int shard_amount;
 		std::string logger_path;
+		CachePolicy cache_policy; /**< What the client caches, everything by default. */
+		std::string rest_proxy_url; /**< Base url of a rest proxy to send REST requests through, like "http://127.0.0.1:8080/api/v6". Empty sends them to Discord. */
 
         /**
          * @brief Creates a ClientConfig object.
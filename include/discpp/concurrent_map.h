@@ -0,0 +1,298 @@
+#ifndef DISCPP_CONCURRENT_MAP_H
+#define DISCPP_CONCURRENT_MAP_H
+
+#include "flat_hash_map.h"
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+namespace discpp {
+    /**
+     * @brief A hash map split into independently locked shards.
+     *
+     * Every key is routed to one shard by its hash, and each shard is guarded by its own reader-writer
+     * lock. Lookups only take a shared lock on the shard that owns the key, so readers never wait on
+     * a writer that is touching a different shard, and writers on different shards never contend.
+     *
+     * Values are handed out by copy, so store `std::shared_ptr`s for anything that is expensive to copy.
+     *
+     * ```cpp
+     *      discpp::ConcurrentMap<discpp::Snowflake, std::shared_ptr<discpp::Guild>> guilds;
+     *      guilds.InsertOrAssign(guild->id, guild);
+     *
+     *      std::shared_ptr<discpp::Guild> found;
+     *      if (guilds.Get(guild->id, found)) { ... }
+     * ```
+     */
+    template <typename Key, typename Value, typename Hash = std::hash<Key>, std::size_t ShardCount = 32>
+    class ConcurrentMap {
+        static_assert(ShardCount > 0 && (ShardCount & (ShardCount - 1)) == 0, "ShardCount must be a power of two");
+    public:
+        using MapType = discpp::FlatHashMap<Key, Value, Hash>;
+
+        ConcurrentMap() = default;
+        ConcurrentMap(const ConcurrentMap&) = delete;
+        ConcurrentMap& operator=(const ConcurrentMap&) = delete;
+
+        /**
+         * @brief Copy the value of `key` into `out`.
+         *
+         * @param[in] key The key to look up.
+         * @param[out] out Receives a copy of the value if the key was found.
+         *
+         * @return bool, true if the key was found.
+         */
+        bool Get(const Key& key, Value& out) const {
+            const Shard& shard = ShardFor(key);
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+
+            auto it = shard.map.find(key);
+            if (it == shard.map.end()) return false;
+
+            out = it->second;
+            return true;
+        }
+
+        /**
+         * @brief Get a copy of the value of `key`, or `fallback` if the key isn't present.
+         *
+         * @param[in] key The key to look up.
+         * @param[in] fallback The value to return if the key wasn't found.
+         *
+         * @return Value
+         */
+        Value GetOr(const Key& key, const Value& fallback = Value()) const {
+            Value out;
+            return Get(key, out) ? out : fallback;
+        }
+
+        /**
+         * @brief Check if the map contains `key`.
+         *
+         * @return bool
+         */
+        bool Contains(const Key& key) const {
+            const Shard& shard = ShardFor(key);
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+
+            return shard.map.find(key) != shard.map.end();
+        }
+
+        /**
+         * @brief Insert `value` if `key` isn't already present.
+         *
+         * @return bool, true if the value was inserted.
+         */
+        bool Insert(const Key& key, const Value& value) {
+            Shard& shard = ShardFor(key);
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+            return shard.map.emplace(key, value).second;
+        }
+
+        /**
+         * @brief Insert `value`, replacing the current value of `key` if there is one.
+         *
+         * @return bool, true if the key was newly inserted, false if it was replaced.
+         */
+        bool InsertOrAssign(const Key& key, const Value& value) {
+            Shard& shard = ShardFor(key);
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+            return shard.map.insert_or_assign(key, value).second;
+        }
+
+        /**
+         * @brief Run `func` on the value of `key` while holding the shard's exclusive lock.
+         *
+         * Use this to mutate a value in place without racing other writers of the same key.
+         *
+         * ```cpp
+         *      channels.Update(id, [&](discpp::Channel& channel) { channel.last_pin_timestamp = timestamp; });
+         * ```
+         *
+         * @param[in] key The key of the value to update.
+         * @param[in] func A callable taking `Value&`.
+         *
+         * @return bool, true if the key was found and `func` ran.
+         */
+        template <typename Func>
+        bool Update(const Key& key, Func&& func) {
+            Shard& shard = ShardFor(key);
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+            auto it = shard.map.find(key);
+            if (it == shard.map.end()) return false;
+
+            func(it->second);
+            return true;
+        }
+
+        /**
+         * @brief Remove `key` from the map.
+         *
+         * @return bool, true if the key was present.
+         */
+        bool Erase(const Key& key) {
+            Shard& shard = ShardFor(key);
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+            return shard.map.erase(key) != 0;
+        }
+
+        /**
+         * @brief Remove `key` from the map and move its value into `out`.
+         *
+         * @return bool, true if the key was present.
+         */
+        bool Take(const Key& key, Value& out) {
+            Shard& shard = ShardFor(key);
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+            auto it = shard.map.find(key);
+            if (it == shard.map.end()) return false;
+
+            out = std::move(it->second);
+            shard.map.erase(it);
+            return true;
+        }
+
+        /**
+         * @brief Call `func(key, value)` for every entry.
+         *
+         * Shards are visited one at a time under their shared lock, so this is not a snapshot of the
+         * whole map. `func` must not call back into this map for a write.
+         */
+        template <typename Func>
+        void ForEach(Func&& func) const {
+            for (const Shard& shard : shards) {
+                std::shared_lock<std::shared_mutex> lock(shard.mutex);
+
+                for (const auto& entry : shard.map) {
+                    func(entry.first, entry.second);
+                }
+            }
+        }
+
+        /**
+         * @brief Remove every entry for which `pred(key, value)` returns true.
+         *
+         * @return std::size_t, the amount of removed entries.
+         */
+        template <typename Pred>
+        std::size_t EraseIf(Pred&& pred) {
+            std::size_t erased = 0;
+            for (Shard& shard : shards) {
+                std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+                for (auto it = shard.map.begin(); it != shard.map.end();) {
+                    if (pred(it->first, it->second)) {
+                        it = shard.map.erase(it);
+                        erased++;
+                    } else {
+                        ++it;
+                    }
+                }
+            }
+
+            return erased;
+        }
+
+        /**
+         * @brief Copy every value out of the map.
+         *
+         * @return std::vector<Value>
+         */
+        std::vector<Value> Values() const {
+            std::vector<Value> values;
+            values.reserve(Size());
+
+            ForEach([&values](const Key&, const Value& value) {
+                values.push_back(value);
+            });
+
+            return values;
+        }
+
+        /**
+         * @brief Get the amount of entries in the map.
+         *
+         * @return std::size_t
+         */
+        std::size_t Size() const {
+            std::size_t size = 0;
+            for (const Shard& shard : shards) {
+                std::shared_lock<std::shared_mutex> lock(shard.mutex);
+                size += shard.map.size();
+            }
+
+            return size;
+        }
+
+        /**
+         * @brief Get the amount of slots the shards have allocated, used or not.
+         *
+         * @return std::size_t
+         */
+        std::size_t Capacity() const {
+            std::size_t capacity = 0;
+            for (const Shard& shard : shards) {
+                std::shared_lock<std::shared_mutex> lock(shard.mutex);
+                capacity += shard.map.capacity();
+            }
+
+            return capacity;
+        }
+
+        /**
+         * @brief Check if the map has no entries.
+         *
+         * @return bool
+         */
+        bool Empty() const {
+            return Size() == 0;
+        }
+
+        /**
+         * @brief Remove every entry.
+         */
+        void Clear() {
+            for (Shard& shard : shards) {
+                std::unique_lock<std::shared_mutex> lock(shard.mutex);
+                shard.map.clear();
+            }
+        }
+    private:
+        // Each shard sits on its own cache line so neighbouring locks don't false share.
+        struct alignas(64) Shard {
+            mutable std::shared_mutex mutex;
+            MapType map;
+        };
+
+        static std::size_t ShardIndex(const Key& key) {
+            // Mix the hash so keys that only differ in their high bits still spread over all shards.
+            uint64_t h = static_cast<uint64_t>(Hash()(key));
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+
+            return static_cast<std::size_t>(h & (ShardCount - 1));
+        }
+
+        Shard& ShardFor(const Key& key) {
+            return shards[ShardIndex(key)];
+        }
+
+        const Shard& ShardFor(const Key& key) const {
+            return shards[ShardIndex(key)];
+        }
+
+        std::array<Shard, ShardCount> shards;
+    };
+}
+
+#endif //DISCPP_CONCURRENT_MAP_H
@@ -13,6 +13,7 @@
 
 namespace discpp {
 	class Color;
+	class JsonWriter;
 
 	class EmbedBuilder {
     friend class Channel;
@@ -310,6 +311,20 @@ namespace discpp {
          * @return rapidjson::Document
          */
         std::unique_ptr<rapidjson::Document> ToJson() const;
+
+        /**
+         * @brief Write the embed json, without copying it into a new document.
+         *
+         * ```cpp
+         *      writer.Key("embed");
+         *      embed.ToJson(writer);
+         * ```
+         *
+         * @param[in] writer The writer to write to.
+         *
+         * @return void
+         */
+        void ToJson(JsonWriter& writer) const;
 	private:
         rapidjson::Document embed_json;
 	};
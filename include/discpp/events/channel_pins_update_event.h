@@ -11,7 +11,7 @@ namespace discpp {
 	public:
 		inline ChannelPinsUpdateEvent(discpp::Channel channel) : channel(channel) {}
 
-		discpp::Channel channel;
+		discpp::Channel channel; /**< The cached channel, or one with only its ids and pin timestamp set if it isn't cached. */
 	};
 }
 
@@ -10,9 +10,9 @@
 namespace discpp {
 	class GuildBanRemoveEvent : public Event {
 	public:
-		inline GuildBanRemoveEvent(discpp::Guild guild, discpp::User user) : guild(guild), user(user) {}
+		inline GuildBanRemoveEvent(std::shared_ptr<discpp::Guild> guild, discpp::User user) : guild(guild), user(user) {}
 
-		discpp::Guild guild;
+		std::shared_ptr<discpp::Guild> guild; /**< The cached guild, or one with only its id set if it isn't cached. This was a discpp::Guild value in earlier versions. */
 		discpp::User user;
 	};
 }
@@ -9,9 +9,9 @@
 namespace discpp {
 	class GuildIntegrationsUpdateEvent : public Event {
 	public:
-		inline GuildIntegrationsUpdateEvent(discpp::Guild guild) : guild(guild) {}
+		inline GuildIntegrationsUpdateEvent(std::shared_ptr<discpp::Guild> guild) : guild(guild) {}
 
-		discpp::Guild guild;
+		std::shared_ptr<discpp::Guild> guild; /**< The cached guild, or one with only its id set if it isn't cached. This was a discpp::Guild value in earlier versions. */
 	};
 }
 
@@ -92,6 +92,11 @@ namespace discpp {
             explicit InvalidAPIVersionException(const std::string &str) : std::runtime_error(str) {}
         };
 
+        class LoopThreadException : public std::runtime_error {
+        public:
+            explicit LoopThreadException(const std::string &str) : std::runtime_error(str) {}
+        };
+
         namespace http {
             class HTTPResponseException : public std::runtime_error {
             public:
@@ -0,0 +1,89 @@
+#ifndef DISCPP_FILE_H
+#define DISCPP_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace discpp {
+    /**
+     * @brief A file to upload with a message.
+     *
+     * The contents come from a path on disk, an owned buffer, a span of memory the caller keeps alive, or a
+     * stream. Paths and streams are read while uploading, so large files are never fully buffered.
+     *
+     * ```cpp
+     *      channel.Send("Logs", false, nullptr, { { "bot.log", "logs/bot.log" } }); // From disk
+     *      channel.Send("Export", false, nullptr, { discpp::File::FromBuffer("export.csv", csv) });
+     *      channel.Send("Chart", false, nullptr, { discpp::File::FromStream("chart.png", std::make_shared<std::ifstream>("chart.png", std::ios::binary)) });
+     * ```
+     */
+    struct File {
+        std::string file_name;
+        std::string file_path; /**< Read from disk while uploading, if none of the other sources are set. */
+        std::shared_ptr<const std::string> buffer; /**< Owned contents. */
+        std::string_view span; /**< Contents owned by the caller, they must stay alive until the upload finished. */
+        std::shared_ptr<std::istream> stream; /**< Read while uploading, from the position it had when the file was created. */
+        int64_t stream_size = -1; /**< Bytes to read from `stream`, -1 reads until its end but sends the request chunked. */
+        int64_t stream_start = -1; /**< Where the contents start in `stream`, so a retried upload can rewind it. -1 if it can't seek. */
+
+        /**
+         * @brief Create a file from an owned buffer.
+         *
+         * @param[in] file_name The name Discord shows for the file.
+         * @param[in] contents The file contents.
+         *
+         * @return discpp::File
+         */
+        static File FromBuffer(const std::string& file_name, std::string contents) {
+            File file;
+            file.file_name = file_name;
+            file.buffer = std::make_shared<const std::string>(std::move(contents));
+
+            return file;
+        }
+
+        /**
+         * @brief Create a file from memory owned by the caller, without copying it.
+         *
+         * @param[in] file_name The name Discord shows for the file.
+         * @param[in] data The file contents, they must stay alive until the upload finished.
+         * @param[in] size The size of the contents.
+         *
+         * @return discpp::File
+         */
+        static File FromSpan(const std::string& file_name, const void* data, std::size_t size) {
+            File file;
+            file.file_name = file_name;
+            file.span = std::string_view(static_cast<const char*>(data), size);
+
+            return file;
+        }
+
+        /**
+         * @brief Create a file that is read from a stream while uploading.
+         *
+         * The stream has to be seekable if the upload may be retried after a rate limit.
+         *
+         * @param[in] file_name The name Discord shows for the file.
+         * @param[in] stream The stream to read the contents from.
+         * @param[in] size Bytes to read from the stream, -1 reads until its end.
+         *
+         * @return discpp::File
+         */
+        static File FromStream(const std::string& file_name, std::shared_ptr<std::istream> stream, int64_t size = -1) {
+            File file;
+            file.file_name = file_name;
+            file.stream = std::move(stream);
+            file.stream_size = size;
+            file.stream_start = static_cast<int64_t>(file.stream->tellg());
+
+            return file;
+        }
+    };
+}
+
+#endif //DISCPP_FILE_H
@@ -0,0 +1,391 @@
+#ifndef DISCPP_FLAT_HASH_MAP_H
+#define DISCPP_FLAT_HASH_MAP_H
+
+#include "snowflake.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace discpp {
+    /**
+     * @brief An open addressing hash map that keeps every entry in one contiguous array.
+     *
+     * Entries are found by linear probing from a slot picked with Fibonacci hashing, so a lookup is
+     * usually a single cache miss instead of a bucket and a node. Erasing leaves a tombstone behind,
+     * which keeps iterators to the other entries valid. Tombstones are dropped on the next rehash.
+     *
+     * The interface follows `std::unordered_map`, with one difference: inserting may rehash, and a
+     * rehash moves every entry. That invalidates all iterators, pointers and references into the map.
+     *
+     * ```cpp
+     *      discpp::SnowflakeMap<discpp::Channel> channels;
+     *      channels.insert({ channel.id, channel });
+     *
+     *      auto it = channels.find(channel_id);
+     *      if (it != channels.end()) { ... }
+     * ```
+     */
+    template <typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+    class FlatHashMap {
+    public:
+        using key_type = Key;
+        using mapped_type = Value;
+        using value_type = std::pair<const Key, Value>;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using hasher = Hash;
+        using key_equal = KeyEqual;
+        using reference = value_type&;
+        using const_reference = const value_type&;
+    private:
+        enum : uint8_t { EMPTY = 0, DELETED = 1, FULL = 2 };
+
+        template <bool Const>
+        class Iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = typename FlatHashMap::value_type;
+            using difference_type = std::ptrdiff_t;
+            using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+            using reference = std::conditional_t<Const, const value_type&, value_type&>;
+
+            Iterator() = default;
+
+            template <bool OtherConst, typename = std::enable_if_t<Const && !OtherConst>>
+            Iterator(const Iterator<OtherConst>& other) : ctrl(other.ctrl), slot(other.slot), ctrl_end(other.ctrl_end) {}
+
+            reference operator*() const { return *slot; }
+            pointer operator->() const { return slot; }
+
+            Iterator& operator++() {
+                ++ctrl;
+                ++slot;
+                SkipFree();
+
+                return *this;
+            }
+
+            Iterator operator++(int) {
+                Iterator tmp = *this;
+                ++*this;
+
+                return tmp;
+            }
+
+            friend bool operator==(const Iterator& a, const Iterator& b) { return a.ctrl == b.ctrl; }
+            friend bool operator!=(const Iterator& a, const Iterator& b) { return a.ctrl != b.ctrl; }
+        private:
+            friend class FlatHashMap;
+            template <bool> friend class Iterator;
+
+            Iterator(const uint8_t* ctrl, pointer slot, const uint8_t* ctrl_end) : ctrl(ctrl), slot(slot), ctrl_end(ctrl_end) {
+                SkipFree();
+            }
+
+            void SkipFree() {
+                while (ctrl != ctrl_end && *ctrl != FULL) {
+                    ++ctrl;
+                    ++slot;
+                }
+            }
+
+            const uint8_t* ctrl = nullptr;
+            pointer slot = nullptr;
+            const uint8_t* ctrl_end = nullptr;
+        };
+    public:
+        using iterator = Iterator<false>;
+        using const_iterator = Iterator<true>;
+
+        FlatHashMap() = default;
+
+        FlatHashMap(std::initializer_list<value_type> init) {
+            reserve(init.size());
+            for (const value_type& entry : init) insert(entry);
+        }
+
+        template <typename InputIt>
+        FlatHashMap(InputIt first, InputIt last) {
+            for (; first != last; ++first) insert(*first);
+        }
+
+        FlatHashMap(const FlatHashMap& other) {
+            reserve(other.size_);
+            for (const value_type& entry : other) TryEmplace(entry.first, entry.second);
+        }
+
+        FlatHashMap(FlatHashMap&& other) noexcept {
+            swap(other);
+        }
+
+        FlatHashMap& operator=(FlatHashMap other) noexcept {
+            swap(other);
+            return *this;
+        }
+
+        ~FlatHashMap() {
+            DestroyAll();
+            Deallocate(ctrl, slots, capacity_);
+        }
+
+        iterator begin() noexcept { return iterator(ctrl, slots, ctrl + capacity_); }
+        const_iterator begin() const noexcept { return const_iterator(ctrl, slots, ctrl + capacity_); }
+        const_iterator cbegin() const noexcept { return begin(); }
+        iterator end() noexcept { return iterator(ctrl + capacity_, slots + capacity_, ctrl + capacity_); }
+        const_iterator end() const noexcept { return const_iterator(ctrl + capacity_, slots + capacity_, ctrl + capacity_); }
+        const_iterator cend() const noexcept { return end(); }
+
+        bool empty() const noexcept { return size_ == 0; }
+        size_type size() const noexcept { return size_; }
+
+        /**
+         * @brief Get the amount of slots, including empty ones and tombstones.
+         *
+         * @return size_type
+         */
+        size_type capacity() const noexcept { return capacity_; }
+
+        iterator find(const Key& key) {
+            size_type index = FindIndex(key);
+            return index == capacity_ ? end() : IteratorAt(index);
+        }
+
+        const_iterator find(const Key& key) const {
+            size_type index = FindIndex(key);
+            return index == capacity_ ? end() : const_iterator(ctrl + index, slots + index, ctrl + capacity_);
+        }
+
+        size_type count(const Key& key) const {
+            return FindIndex(key) == capacity_ ? 0 : 1;
+        }
+
+        Value& at(const Key& key) {
+            size_type index = FindIndex(key);
+            if (index == capacity_) throw std::out_of_range("discpp::FlatHashMap::at");
+
+            return slots[index].second;
+        }
+
+        const Value& at(const Key& key) const {
+            size_type index = FindIndex(key);
+            if (index == capacity_) throw std::out_of_range("discpp::FlatHashMap::at");
+
+            return slots[index].second;
+        }
+
+        Value& operator[](const Key& key) {
+            return TryEmplace(key).first->second;
+        }
+
+        std::pair<iterator, bool> insert(const value_type& entry) {
+            return TryEmplace(entry.first, entry.second);
+        }
+
+        std::pair<iterator, bool> insert(value_type&& entry) {
+            return TryEmplace(entry.first, std::move(entry.second));
+        }
+
+        template <typename K, typename V>
+        std::pair<iterator, bool> emplace(K&& key, V&& value) {
+            return TryEmplace(std::forward<K>(key), std::forward<V>(value));
+        }
+
+        template <typename... Args>
+        std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+            return TryEmplace(key, std::forward<Args>(args)...);
+        }
+
+        template <typename V>
+        std::pair<iterator, bool> insert_or_assign(const Key& key, V&& value) {
+            size_type index = FindIndex(key);
+            if (index != capacity_) {
+                slots[index].second = std::forward<V>(value);
+                return { IteratorAt(index), false };
+            }
+
+            return TryEmplace(key, std::forward<V>(value));
+        }
+
+        iterator erase(const_iterator pos) {
+            size_type index = static_cast<size_type>(pos.ctrl - ctrl);
+            slots[index].~value_type();
+            size_--;
+
+            // When the next slot is empty no probe sequence can continue past this one, so it doesn't
+            // need a tombstone.
+            if (ctrl[(index + 1) & (capacity_ - 1)] == EMPTY) {
+                ctrl[index] = EMPTY;
+                used--;
+            } else {
+                ctrl[index] = DELETED;
+            }
+
+            return iterator(ctrl + index + 1, slots + index + 1, ctrl + capacity_);
+        }
+
+        iterator erase(iterator pos) {
+            return erase(const_iterator(pos));
+        }
+
+        size_type erase(const Key& key) {
+            size_type index = FindIndex(key);
+            if (index == capacity_) return 0;
+
+            erase(const_iterator(ctrl + index, slots + index, ctrl + capacity_));
+            return 1;
+        }
+
+        void clear() noexcept {
+            DestroyAll();
+            if (capacity_ != 0) std::memset(ctrl, EMPTY, capacity_);
+
+            size_ = 0;
+            used = 0;
+        }
+
+        /**
+         * @brief Make room for at least `count` entries without another rehash.
+         *
+         * @param[in] count The amount of entries.
+         *
+         * @return void
+         */
+        void reserve(size_type count) {
+            size_type new_capacity = min_capacity;
+            while (new_capacity * max_load_numerator < count * max_load_denominator) new_capacity *= 2;
+
+            if (new_capacity > capacity_) Rehash(new_capacity);
+        }
+
+        void swap(FlatHashMap& other) noexcept {
+            std::swap(ctrl, other.ctrl);
+            std::swap(slots, other.slots);
+            std::swap(capacity_, other.capacity_);
+            std::swap(size_, other.size_);
+            std::swap(used, other.used);
+            std::swap(shift, other.shift);
+        }
+    private:
+        static constexpr size_type min_capacity = 8;
+        // Entries and tombstones may fill at most 7/8 of the slots, so every probe ends on an empty slot.
+        static constexpr size_type max_load_numerator = 7;
+        static constexpr size_type max_load_denominator = 8;
+
+        size_type IndexFor(const Key& key) const {
+            // Fibonacci hashing takes the high bits of the product, so hashes that only differ in their
+            // low bits still spread over the whole table.
+            return static_cast<size_type>((static_cast<uint64_t>(Hash()(key)) * 0x9E3779B97F4A7C15ULL) >> shift);
+        }
+
+        size_type FindIndex(const Key& key) const {
+            if (size_ == 0) return capacity_;
+
+            for (size_type i = IndexFor(key);; i = (i + 1) & (capacity_ - 1)) {
+                if (ctrl[i] == EMPTY) return capacity_;
+                if (ctrl[i] == FULL && KeyEqual()(slots[i].first, key)) return i;
+            }
+        }
+
+        iterator IteratorAt(size_type index) {
+            return iterator(ctrl + index, slots + index, ctrl + capacity_);
+        }
+
+        template <typename K, typename... Args>
+        std::pair<iterator, bool> TryEmplace(K&& key, Args&&... args) {
+            size_type index = FindIndex(key);
+            if (index != capacity_) return { IteratorAt(index), false };
+
+            if ((used + 1) * max_load_denominator > capacity_ * max_load_numerator) Grow();
+
+            // The key isn't present, so the first slot that isn't taken will do, tombstones included.
+            index = IndexFor(key);
+            while (ctrl[index] == FULL) index = (index + 1) & (capacity_ - 1);
+
+            ::new (static_cast<void*>(slots + index)) value_type(std::piecewise_construct,
+                std::forward_as_tuple(std::forward<K>(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+
+            if (ctrl[index] == EMPTY) used++;
+            ctrl[index] = FULL;
+            size_++;
+
+            return { IteratorAt(index), true };
+        }
+
+        void Grow() {
+            if (capacity_ == 0) {
+                Rehash(min_capacity);
+            } else if (size_ * 2 < capacity_) {
+                // Mostly tombstones, rehashing in place is enough to free them.
+                Rehash(capacity_);
+            } else {
+                Rehash(capacity_ * 2);
+            }
+        }
+
+        void Rehash(size_type new_capacity) {
+            uint8_t* new_ctrl = new uint8_t[new_capacity];
+            std::memset(new_ctrl, EMPTY, new_capacity);
+            value_type* new_slots = std::allocator<value_type>().allocate(new_capacity);
+
+            unsigned int new_shift = 64;
+            for (size_type c = new_capacity; c > 1; c >>= 1) new_shift--;
+
+            std::swap(shift, new_shift);
+            for (size_type i = 0; i < capacity_; i++) {
+                if (ctrl[i] != FULL) continue;
+
+                size_type index = IndexFor(slots[i].first);
+                while (new_ctrl[index] == FULL) index = (index + 1) & (new_capacity - 1);
+
+                ::new (static_cast<void*>(new_slots + index)) value_type(std::move(slots[i]));
+                new_ctrl[index] = FULL;
+                slots[i].~value_type();
+            }
+
+            Deallocate(ctrl, slots, capacity_);
+            ctrl = new_ctrl;
+            slots = new_slots;
+            capacity_ = new_capacity;
+            used = size_;
+        }
+
+        void DestroyAll() noexcept {
+            if (std::is_trivially_destructible<value_type>::value) return;
+
+            for (size_type i = 0; i < capacity_; i++) {
+                if (ctrl[i] == FULL) slots[i].~value_type();
+            }
+        }
+
+        static void Deallocate(uint8_t* old_ctrl, value_type* old_slots, size_type old_capacity) noexcept {
+            if (old_capacity == 0) return;
+
+            delete[] old_ctrl;
+            std::allocator<value_type>().deallocate(old_slots, old_capacity);
+        }
+
+        uint8_t* ctrl = nullptr;
+        value_type* slots = nullptr;
+        size_type capacity_ = 0;
+        size_type size_ = 0;
+        size_type used = 0; /**< Full slots plus tombstones. */
+        unsigned int shift = 64;
+    };
+
+    /**
+     * @brief Flat hash map keyed by discpp::Snowflake, used for the cache and the rate limit tables.
+     */
+    template <typename Value>
+    using SnowflakeMap = FlatHashMap<discpp::Snowflake, Value, discpp::SnowflakeHash>;
+}
+
+#endif //DISCPP_FLAT_HASH_MAP_H
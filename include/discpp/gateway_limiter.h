@@ -0,0 +1,98 @@
+#ifndef DISCPP_GATEWAY_LIMITER_H
+#define DISCPP_GATEWAY_LIMITER_H
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace discpp {
+    /**
+     * @brief Keeps the payloads sent on one gateway connection under Discord's limit of 120 per 60 seconds.
+     *
+     * Sends are counted in a rolling window. Heartbeats may use the whole budget, other payloads leave
+     * `reserved_for_heartbeats` sends free, so a burst of presence updates or member requests can't delay
+     * a heartbeat. A send over the limit blocks the sending thread until the oldest send leaves the window.
+     * The limit applies per connection, so Reset is called whenever a new connection opens.
+     *
+     * ```cpp
+     *      send_limiter.Acquire(false);
+     *      websocket.sendText(json_payload);
+     * ```
+     */
+    class GatewaySendLimiter {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        static constexpr std::size_t limit = 120; /**< How many payloads a connection may send per window. */
+        static constexpr std::size_t reserved_for_heartbeats = 3; /**< Sends of every window only heartbeats may use. */
+        static constexpr std::chrono::seconds window{ 60 }; /**< The window the limit applies to. */
+
+        GatewaySendLimiter() = default;
+        GatewaySendLimiter(const GatewaySendLimiter&) = delete;
+        GatewaySendLimiter& operator=(const GatewaySendLimiter&) = delete;
+
+        /**
+         * @brief Record a send if it fits in the window.
+         *
+         * ```cpp
+         *      if (send_limiter.TryAcquire(false) == discpp::GatewaySendLimiter::Clock::duration::zero()) websocket.sendText(json_payload);
+         * ```
+         *
+         * @param[in] heartbeat Whether the payload is a heartbeat, which may use the reserved sends.
+         * @param[in] now The current time.
+         *
+         * @return Clock::duration, zero if the send was recorded, otherwise how long until it fits.
+         */
+        Clock::duration TryAcquire(bool heartbeat, Clock::time_point now = Clock::now()) {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            while (!sends.empty() && sends.front() + window <= now) {
+                sends.pop_front();
+            }
+
+            std::size_t allowed = heartbeat ? limit : limit - reserved_for_heartbeats;
+            if (sends.size() < allowed) {
+                sends.push_back(now);
+                return Clock::duration::zero();
+            }
+
+            // The send fits once every send up to this one has left the window.
+            return sends[sends.size() - allowed] + window - now;
+        }
+
+        /**
+         * @brief Wait until a send fits in the window and record it.
+         *
+         * ```cpp
+         *      send_limiter.Acquire(false);
+         * ```
+         *
+         * @param[in] heartbeat Whether the payload is a heartbeat, which may use the reserved sends.
+         *
+         * @return void
+         */
+        void Acquire(bool heartbeat) {
+            for (Clock::duration wait = TryAcquire(heartbeat); wait > Clock::duration::zero(); wait = TryAcquire(heartbeat)) {
+                std::this_thread::sleep_for(wait);
+            }
+        }
+
+        /**
+         * @brief Forget every recorded send, for a new connection.
+         *
+         * @return void
+         */
+        void Reset() {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            sends.clear();
+        }
+    private:
+        std::mutex mutex;
+        std::deque<Clock::time_point> sends;
+    };
+}
+
+#endif //DISCPP_GATEWAY_LIMITER_H
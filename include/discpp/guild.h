@@ -6,8 +6,14 @@
 #include "image.h"
 #include "permission.h"
 #include "channel.h"
+#include "user.h"
 #include "emoji.h"
+#include "flat_hash_map.h"
+#include "concurrent_map.h"
+#include "slab.h"
+#include "permission_cache.h"
 
+#include <future>
 #include <utility>
 #include <variant>
 #include <optional>
@@ -196,6 +202,33 @@ namespace discpp {
         }
     };
 
+    /**
+     * @brief The cached members of a guild, keyed by user id.
+     *
+     * Every copy of a guild shares one store, so members are added, replaced and removed in place
+     * without copying the guild. The members themselves are never changed in place, a changed member
+     * replaces the cached one.
+     *
+     * ```cpp
+     *      std::shared_ptr<discpp::Member> member = guild->members->GetOr(user_id, nullptr);
+     * ```
+     */
+    using GuildMembers = discpp::ConcurrentMap<discpp::Snowflake, std::shared_ptr<discpp::Member>, discpp::SnowflakeHash, 8>;
+
+    using GuildChannels = discpp::SnowflakeMap<discpp::Channel>; /**< The channels of a guild, keyed by channel id. */
+    using GuildRoles = discpp::SnowflakeMap<std::shared_ptr<discpp::Role>>; /**< The roles of a guild, keyed by role id. */
+    using GuildEmojis = discpp::SnowflakeMap<discpp::Emoji>; /**< The custom emojis of a guild, keyed by emoji id. */
+
+    /**
+     * @brief A discord guild.
+     *
+     * Guilds in discpp::Cache are shared with listeners and never changed in place, every change replaces
+     * the cached guild with a changed copy, see discpp::Cache::UpdateGuild. The channels, roles and emojis
+     * are immutable maps that copies share until one of them changes, then only that map is copied.
+     * Members are the exception, they live in a discpp::GuildMembers store that every copy shares.
+     * Methods that change the guild through the REST api update the cached guild the same way instead of
+     * this object, so get the guild from the cache again to see the change.
+     */
 	class Guild : public DiscordObject {
 	public:
 		Guild() = default;
@@ -257,6 +290,23 @@ namespace discpp {
          */
 		void DeleteGuild();
 
+        /**
+         * @brief Updates this guild with the fields that are present in the json.
+         *
+         * Used to apply GUILD_UPDATE payloads to a copy of the cached guild, see discpp::Cache::UpdateGuild.
+         * Roles, emojis, channels, members and voice states are left untouched and stay shared with the
+         * cached guild, only a changed feature list is replaced.
+         *
+         * ```cpp
+         *      guild.Update(json);
+         * ```
+         *
+         * @param[in] json The json of the (partial) guild object.
+         *
+         * @return void
+         */
+        void Update(rapidjson::Document& json);
+
         /**
          * @brief Gets a list of channels in this guild.
          *
@@ -304,6 +354,19 @@ namespace discpp {
          */
         [[nodiscard]] discpp::Channel GetChannel(const Snowflake& id) const;
 
+        /**
+         * @brief Find a channel in this guild without throwing.
+         *
+         * ```cpp
+         *      std::optional<discpp::Channel> channel = guild.FindChannel(channel_id);
+         * ```
+         *
+         * @param[in] id The id of the channel.
+         *
+         * @return std::optional<discpp::Channel>, empty if the channel isn't cached.
+         */
+        [[nodiscard]] std::optional<discpp::Channel> FindChannel(const Snowflake& id) const;
+
         /**
          * @brief Creates a channel for this Guild.
          *
@@ -354,10 +417,52 @@ namespace discpp {
          */
         std::shared_ptr<discpp::Member> GetMember(const Snowflake& id, bool can_request = false);
 
+        /**
+         * @brief Find a cached member of this guild without throwing or requesting it.
+         *
+         * ```cpp
+         *      std::shared_ptr<discpp::Member> member = guild.FindMember(user_id);
+         * ```
+         *
+         * @param[in] id The member's id.
+         *
+         * @return std::shared_ptr<discpp::Member>, nullptr if the member isn't cached.
+         */
+        [[nodiscard]] std::shared_ptr<discpp::Member> FindMember(const Snowflake& id) const;
+
+        /**
+         * @brief Parses a member of this guild, allocating it from this guild's member slab.
+         *
+         * The member is not added to `members`, the caller decides whether to cache it.
+         *
+         * ```cpp
+         *      std::shared_ptr<discpp::Member> member = guild.ParseMember(json);
+         * ```
+         *
+         * @param[in] json The json of the member.
+         *
+         * @return std::shared_ptr<discpp::Member>
+         */
+        std::shared_ptr<discpp::Member> ParseMember(rapidjson::Document& json);
+
+        /**
+         * @brief Check if members of this guild may be cached under the client's cache policy.
+         *
+         * ```cpp
+         *      if (guild.CanCacheMember(true)) guild.members->Insert(member->user->id, member);
+         * ```
+         *
+         * @param[in] active Whether the member was just seen doing something, instead of being part of a member list.
+         *
+         * @return bool
+         */
+        bool CanCacheMember(bool active = false) const;
+
         /**
          * @brief Ensures the bot has a permission.
          *
-         * If the bot does not have the permission a discpp::NoPermissionException will be thrown.
+         * If the bot does not have the permission a discpp::NoPermissionException will be thrown. When
+         * the cache policy skipped the bot's own member it is requested once and cached from then on.
          *
          * ```cpp
          *      Guild::EnsureBotPermission(Permission::MANAGE_CHANNELS);
@@ -368,6 +473,69 @@ namespace discpp {
          */
         void EnsureBotPermission(const Permission& req_perm);
 
+        /**
+         * @brief Compute the effective permissions of a member, without memoizing them.
+         *
+         * Stacks the @everyone role and the member's roles, and applies the channel's overwrites in
+         * Discord's order: @everyone, then roles, then the member. Owners and administrators get
+         * every permission.
+         *
+         * ```cpp
+         *      uint64_t permissions = guild.ComputePermissions(member, &channel);
+         * ```
+         *
+         * @param[in] member The member to compute the permissions of.
+         * @param[in] channel The channel whose overwrites apply, or nullptr for guild level permissions.
+         *
+         * @return uint64_t, a mask of discpp::Permission bits.
+         */
+        [[nodiscard]] uint64_t ComputePermissions(const discpp::Member& member, const discpp::Channel* channel = nullptr) const;
+
+        /**
+         * @brief Get the effective permissions of a member, memoized per member and channel.
+         *
+         * Every copy of a guild shares the memoized masks. A mask is only reused while the owner, the
+         * member's roles, the channel's overwrites and the guild's role map are the ones it was computed
+         * from, so the member passed in doesn't have to be the cached one. If the channel isn't cached,
+         * the guild level permissions are returned.
+         *
+         * ```cpp
+         *      bool can_send = (guild.GetEffectivePermissions(member, channel.id) & discpp::Permission::SEND_MESSAGES) != 0;
+         * ```
+         *
+         * @param[in] member The member to get the permissions of.
+         * @param[in] channel_id The id of the channel, or 0 for guild level permissions.
+         *
+         * @return uint64_t, a mask of discpp::Permission bits.
+         */
+        [[nodiscard]] uint64_t GetEffectivePermissions(const discpp::Member& member, const discpp::Snowflake& channel_id = 0) const;
+
+        /**
+         * @brief Drop the memoized permissions of a member, or of every member if the id is 0.
+         *
+         * ```cpp
+         *      guild->InvalidatePermissions(member_id);
+         * ```
+         *
+         * @param[in] member_id The id of the member.
+         *
+         * @return void
+         */
+        void InvalidatePermissions(const discpp::Snowflake& member_id = 0) const;
+
+        /**
+         * @brief Drop the memoized permissions of every member in a channel.
+         *
+         * ```cpp
+         *      guild->InvalidateChannelPermissions(channel_id);
+         * ```
+         *
+         * @param[in] channel_id The id of the channel.
+         *
+         * @return void
+         */
+        void InvalidateChannelPermissions(const discpp::Snowflake& channel_id) const;
+
         /**
          * @brief Adds a discpp::Member to this guild.
          *
@@ -451,6 +619,36 @@ namespace discpp {
          */
 		void BanMemberById(const Snowflake& user_id, const std::string& reason = "");
 
+        /**
+         * @brief Ban a guild member without blocking.
+         *
+         * ```cpp
+         *      std::future<void> ban = guild.BanMemberAsync(member, "Reason");
+         * ```
+         *
+         * @param[in] member The member to ban.
+         * @param[in] reason The reason to ban them.
+         *
+         * @return std::future<void>
+         */
+        std::future<void> BanMemberAsync(const discpp::Member& member, const std::string& reason = "");
+
+        /**
+         * @brief Ban a guild member by id without blocking.
+         *
+         * The permission check still happens before this returns, and throws like BanMemberById.
+         *
+         * ```cpp
+         *      std::future<void> ban = guild.BanMemberByIdAsync(150312037426135041, "Reason");
+         * ```
+         *
+         * @param[in] user_id The id to ban.
+         * @param[in] reason The reason to ban them.
+         *
+         * @return std::future<void>
+         */
+        std::future<void> BanMemberByIdAsync(const Snowflake& user_id, const std::string& reason = "");
+
         /**
          * @brief Unban a guild member.
          *
@@ -516,6 +714,19 @@ namespace discpp {
          */
         [[nodiscard]] std::shared_ptr<discpp::Role> GetRole(const Snowflake& id) const;
 
+        /**
+         * @brief Find a guild role without throwing.
+         *
+         * ```cpp
+         *      std::shared_ptr<discpp::Role> role = guild.FindRole(638157816325996565);
+         * ```
+         *
+         * @param[in] id The id of the role.
+         *
+         * @return std::shared_ptr<discpp::Role>, nullptr if the guild has no such role.
+         */
+        [[nodiscard]] std::shared_ptr<discpp::Role> FindRole(const Snowflake& id) const;
+
         /**
          * @brief Create a guild role.
          *
@@ -950,39 +1161,41 @@ namespace discpp {
 
 		std::string name; /**< Guild name. */
 		Snowflake owner_id; /**< ID of the guild owner. */
-		int permissions; /**< Total permissions for the bot in the guild (does not include channel overrides). */
+		int permissions = 0; /**< Total permissions for the bot in the guild (does not include channel overrides). */
 		std::string region; /**< Voice region id for the guild. */
 		Snowflake afk_channel_id; /**< ID of afk channel. */
-		int afk_timeout; /**< AFK timeout in seconds. */
+		int afk_timeout = 0; /**< AFK timeout in seconds. */
 		discpp::specials::VerificationLevel verification_level; /**< Verification level required for the guild. */
 		discpp::specials::DefaultMessageNotificationLevel default_message_notifications; /**< Default message notifications level. */
 		discpp::specials::ExplicitContentFilterLevel explicit_content_filter; /**< Explicit content filter level. */
-		std::unordered_map<Snowflake, std::shared_ptr<Role>> roles; /**< Roles in the guild. */
-		std::unordered_map<Snowflake, Emoji> emojis; /**< Custom guild emojis. */
-		std::vector<std::string> features; /**< Enabled guild features. */
+		std::shared_ptr<const discpp::GuildRoles> roles = std::make_shared<discpp::GuildRoles>(); /**< Roles in the guild, replaced as a whole when they change. */
+		std::shared_ptr<const discpp::GuildEmojis> emojis = std::make_shared<discpp::GuildEmojis>(); /**< Custom guild emojis, replaced as a whole when they change. */
+		std::shared_ptr<const std::vector<std::string>> features = std::make_shared<std::vector<std::string>>(); /**< Enabled guild features, replaced as a whole when they change. */
 		discpp::specials::MFALevel mfa_level; /**< Required MFA level for the guild. */
 		Snowflake application_id; /**< Application id of the guild creator if it is bot-created. */
 		bool widget_enabled; /**< Whether or not the server widget is enabled. */
 		Snowflake widget_channel_id; /**< The channel id for the server widget. */
 		Snowflake system_channel_id; /**< The id of the channel where guild notices such as welcome messages and boost events are posted. */
-        int system_channel_flags; /**< System channel flags. */
+        int system_channel_flags = 0; /**< System channel flags. */
         Snowflake rules_channel_id; /**< The id of the channel where "PUBLIC" guilds display rules and/or guidelines. */
         std::chrono::system_clock::time_point joined_at; /**< When this guild was joined at. */
-		int member_count; /**< Total number of members in this guild. */
-		std::vector<discpp::VoiceState> voice_states; /**< Array of partial voice state objects. */
-		std::unordered_map<Snowflake, std::shared_ptr<Member>> members; /**< Users in the guild. */
-		std::unordered_map<Snowflake, discpp::Channel> channels; /**< Channels in the guild. */
-		int max_presences; /**< The maximum amount of presences for the guild (the default value, currently 25000, is in effect when null is returned). */
-		int max_members; /**< The maximum amount of members for the guild. */
+		int member_count = 0; /**< Total number of members in this guild. */
+		std::shared_ptr<const std::vector<discpp::VoiceState>> voice_states = std::make_shared<std::vector<discpp::VoiceState>>(); /**< Array of partial voice state objects, replaced as a whole when they change. */
+		std::shared_ptr<discpp::GuildMembers> members = std::make_shared<discpp::GuildMembers>(); /**< Cached members of the guild, shared by every copy of it. */
+		std::shared_ptr<const discpp::GuildChannels> channels = std::make_shared<discpp::GuildChannels>(); /**< Channels in the guild, replaced as a whole when they change. */
+		int max_presences = 0; /**< The maximum amount of presences for the guild (the default value, currently 25000, is in effect when null is returned). */
+		int max_members = 0; /**< The maximum amount of members for the guild. */
 		std::string vanity_url_code; /**< The vanity url code for the guild. */
 		std::string description; /**< The description for the guild. */
 		discpp::specials::NitroTier premium_tier; /**< Premium tier (Server Boost level). */
-		int premium_subscription_count; /**< The number of boosts this server currently has. */
+		int premium_subscription_count = 0; /**< The number of boosts this server currently has. */
 		std::string preferred_locale; /**< The preferred locale of a "PUBLIC" guild used in server discovery and notices from Discord; defaults to "en-US". */
         discpp::Channel public_updates_channel; /**< The channel where admins and moderators of "PUBLIC" guilds receive notices from Discord. */
 		int approximate_member_count; /**< Approximate number of members in this guild, returned from the GET /guild/<id> endpoint when with_counts is true. */
 		int approximate_presence_count; /**< Approximate number of online members in this guild, returned from the GET /guild/<id> endpoint when with_counts is true. */
 	private:
+        discpp::SlabHandle member_slab; /**< Contiguous storage for the members of this guild. */
+        std::shared_ptr<discpp::PermissionCache> permission_cache = std::make_shared<discpp::PermissionCache>(); /**< Memoized results of GetEffectivePermissions, shared by every copy of the guild. */
         unsigned char flags = 0b0;
         uint64_t icon_hex[2] = {0, 0};
         uint64_t splash_hex[2] = {0, 0};
@@ -1,6 +1,8 @@
 #ifndef DISCPP_IMAGE_H
 #define DISCPP_IMAGE_H
 
+#include <fstream>
+#include <string>
 #include <utility>
 
 #include "discord_object.h"
@@ -26,6 +28,21 @@ namespace discpp {
          */
 		Image(std::ifstream* image, std::string location) : image(image), location(std::move(location)) {}
 
+        /**
+         * @brief Constructs a discpp::Image object from a file path.
+         *
+         * The file is memory mapped while it is converted, instead of being read through a stream.
+         *
+         * ```cpp
+         *      discpp::Image image("emojis/party.png");
+         * ```
+         *
+         * @param[in] location The image location.
+         *
+         * @return discpp::Image, this is a constructor.
+         */
+		explicit Image(std::string location) : location(std::move(location)) {}
+
         /**
          * @brief Converts the image to the Data URI scheme.
          *
@@ -34,11 +51,15 @@ namespace discpp {
          *		std::string data_uri = image.ToDataURI();
          * ```
          *
+         * The image is Base64 encoded straight into the returned string, without extra copies.
+         *
+         * @throws std::runtime_error If the image can't be read, or its file extension isn't supported.
+         *
          * @return std::string
          */
 		std::string ToDataURI();
 	private:
-		std::ifstream* image;
+		std::ifstream* image = nullptr;
 		std::string location;
 	};
 }
@@ -0,0 +1,122 @@
+#ifndef DISCPP_JSON_WRITER_H
+#define DISCPP_JSON_WRITER_H
+
+#ifndef RAPIDJSON_HAS_STDSTRING
+#define RAPIDJSON_HAS_STDSTRING 1
+#endif
+
+#include "snowflake.h"
+
+#include <rapidjson/document.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace discpp {
+    /**
+     * @brief Append `text` to `out` escaped for a json string, without the surrounding quotes.
+     *
+     * Quotes, backslashes and control characters are escaped, everything else, including UTF-8, is copied
+     * as is. Runs without anything to escape are found 16 bytes at a time with SSE2 where available.
+     *
+     * ```cpp
+     *      std::string body = "{\"content\": \"";
+     *      discpp::AppendEscapedJson(body, text);
+     *      body += "\"}";
+     * ```
+     *
+     * @param[out] out The string to append to.
+     * @param[in] text The text to escape.
+     *
+     * @return void
+     */
+    void AppendEscapedJson(std::string& out, std::string_view text);
+
+    /**
+     * @brief Writes json straight into a reusable buffer, for building request bodies without a DOM.
+     *
+     * Buffers are kept per thread and handed back when the writer is destroyed, so building a body doesn't
+     * allocate once the thread has built one of a similar size. Commas are placed automatically. The writer
+     * is also a rapidjson handler, so a `rapidjson::Value` can be written into it with `value.Accept(writer)`.
+     *
+     * ```cpp
+     *      discpp::JsonWriter writer;
+     *      writer.StartObject();
+     *      writer.Key("content");
+     *      writer.String(text);
+     *      writer.Key("embed");
+     *      embed.ToJson(writer);
+     *      writer.EndObject();
+     *
+     *      cpr::Body body(writer.ToString());
+     * ```
+     */
+    class JsonWriter {
+    public:
+        using Ch = char;
+
+        JsonWriter();
+        JsonWriter(const JsonWriter&) = delete;
+        JsonWriter& operator=(const JsonWriter&) = delete;
+        ~JsonWriter();
+
+        bool StartObject();
+        bool EndObject(rapidjson::SizeType member_count = 0);
+        bool StartArray();
+        bool EndArray(rapidjson::SizeType element_count = 0);
+
+        bool Key(std::string_view key);
+        bool Key(const char* key, rapidjson::SizeType length, bool copy = false) { return Key(std::string_view(key, length)); }
+        bool String(std::string_view text);
+        bool String(const char* text, rapidjson::SizeType length, bool copy = false) { return String(std::string_view(text, length)); }
+
+        bool Null();
+        bool Bool(bool value);
+        bool Int(int value) { return Int64(value); }
+        bool Uint(unsigned value) { return Uint64(value); }
+        bool Int64(int64_t value);
+        bool Uint64(uint64_t value);
+        bool Double(double value);
+        bool RawNumber(const char* number, rapidjson::SizeType length, bool copy = false);
+
+        /**
+         * @brief Write a snowflake as a json string, the way Discord sends and expects ids.
+         *
+         * @param[in] id The id.
+         *
+         * @return bool
+         */
+        bool Id(const Snowflake& id);
+
+        /**
+         * @brief Write json that is already serialized as the next value.
+         *
+         * @param[in] json The serialized json.
+         *
+         * @return bool
+         */
+        bool Raw(std::string_view json);
+
+        /**
+         * @brief Get the json written so far.
+         *
+         * @return std::string_view, valid until the writer is written to again or destroyed.
+         */
+        std::string_view View() const { return *buffer; }
+
+        /**
+         * @brief Get a copy of the json written so far.
+         *
+         * @return std::string
+         */
+        std::string ToString() const { return *buffer; }
+    private:
+        void BeforeValue();
+
+        std::string* buffer;
+        bool need_comma = false;
+    };
+}
+
+#endif //DISCPP_JSON_WRITER_H
@@ -5,12 +5,14 @@
 #include "user.h"
 #include "presence.h"
 #include "permission.h"
+#include "small_vector.h"
 
 #include <vector>
 
 namespace discpp {
 	class Role;
 	class Guild;
+	class Channel;
 
 	class Member {
 	public:
@@ -48,7 +50,7 @@ namespace discpp {
 		Member(rapidjson::Document& json, const discpp::Guild& guild);
 
         Member(const discpp::Member& member);
-        Member operator=(const discpp::Member& mbr);
+        Member& operator=(const discpp::Member& mbr);
 
         /**
          * @brief Modifies this guild member.
@@ -119,6 +121,20 @@ namespace discpp {
          */
 		bool HasPermission(const discpp::Permission& perm);
 
+        /**
+         * @brief Check if this member has a permission in a channel, with the channel's overwrites applied.
+         *
+         * ```cpp
+         *      bool can_send = member.HasPermission(discpp::Permission::SEND_MESSAGES, channel);
+         * ```
+         *
+         * @param[in] perm The permission to check that the member has.
+         * @param[in] channel The channel to check the permission in.
+         *
+         * @return bool
+         */
+		bool HasPermission(const discpp::Permission& perm, const discpp::Channel& channel);
+
         /**
          * @brief Check if a member is banned.
          *
@@ -221,13 +237,21 @@ namespace discpp {
          */
         std::shared_ptr<discpp::Guild> GetGuild();
 
-		discpp::User user; /**< The user this guild member represents. */
+        /**
+         * @brief Find the cached guild of this member without throwing.
+         *
+         * @return std::shared_ptr<discpp::Guild>, nullptr if the guild isn't cached.
+         */
+        std::shared_ptr<discpp::Guild> FindGuild() const;
+
+		// Fields are ordered largest first so the object packs without padding holes.
+		std::shared_ptr<discpp::User> user; /**< The user this guild member represents, shared with every other member of the same user through discpp::Cache::users. */
+        std::string nick; /**< This members guild nickname. If the member has no nickname, its empty. */
+        discpp::SmallVector<discpp::Snowflake, 4> roles; /**< The ids of this member's roles, up to 4 are stored without a heap allocation. */
 		discpp::Snowflake guild_id; /**< The ID of the guild this member is in. */
-        std::string nick; /**< This members guild nickname. If the member has no nickname, its a nullptr. */
-		time_t joined_at; /**< When the user joined the guild. */
-        time_t premium_since; /**< When the user started boosting the guild. */
 		std::unique_ptr<discpp::Presence> presence = nullptr; /**< Presence for the current member. If the member has no presence, its a nullptr. */
-        std::vector<discpp::Snowflake> roles;
+		uint32_t joined_at = 0; /**< When the user joined the guild, in seconds since the unix epoch. */
+        uint32_t premium_since = 0; /**< When the user started boosting the guild, in seconds since the unix epoch. */
 	private:
 	    unsigned char flags = 0b0;
 	};
@@ -0,0 +1,188 @@
+#ifndef DISCPP_MESSAGE_CACHE_H
+#define DISCPP_MESSAGE_CACHE_H
+
+#include "flat_hash_map.h"
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <shared_mutex>
+#include <vector>
+
+namespace discpp {
+    class Message;
+
+    /**
+     * @brief Bounded store of recently seen messages.
+     *
+     * Every message is indexed by id for O(1) lookup, and also kept in a per-channel buffer ordered by
+     * id. When either the message count or the byte budget is exceeded the oldest message, the one with
+     * the lowest id, is evicted. Messages fetched from history arrive long after newer ones, so the age
+     * comes from the snowflake rather than the order of insertion.
+     *
+     * All methods are thread safe.
+     */
+    class MessageCache {
+    public:
+        MessageCache() = default;
+        MessageCache(const MessageCache&) = delete;
+        MessageCache& operator=(const MessageCache&) = delete;
+
+        /**
+         * @brief Set the limits of the cache, evicting messages if the cache is now over them.
+         *
+         * ```cpp
+         *      cache.messages.SetLimits(5000, 16 * 1024 * 1024);
+         * ```
+         *
+         * @param[in] max_messages The maximum amount of messages to keep, 0 disables caching.
+         * @param[in] max_bytes The maximum approximate amount of bytes to keep, 0 means no byte limit.
+         *
+         * @return void
+         */
+        void SetLimits(std::size_t max_messages, std::size_t max_bytes = 0);
+
+        /**
+         * @brief Insert or replace a message.
+         *
+         * @param[in] message The message to cache.
+         *
+         * @return void
+         */
+        void Insert(const std::shared_ptr<discpp::Message>& message);
+
+        /**
+         * @brief Replace a cached message with a changed copy of it.
+         *
+         * Listeners may hold and read cached messages at any time, so they are never changed in place.
+         * `func` changes a copy under the cache's lock, then the copy replaces the message and its size
+         * is estimated again. `func` must not change the id or channel of the message.
+         *
+         * ```cpp
+         *      cache.messages.Update(message_id, [](discpp::Message& message) { message.reactions.clear(); });
+         * ```
+         *
+         * @param[in] id The id of the message.
+         * @param[in] func Called with the copy, must not access the message cache.
+         *
+         * @return std::shared_ptr<discpp::Message>, the new message, nullptr if the message isn't cached.
+         */
+        std::shared_ptr<discpp::Message> Update(const discpp::Snowflake& id, const std::function<void(discpp::Message&)>& func);
+
+        /**
+         * @brief Get a cached message.
+         *
+         * @param[in] id The id of the message.
+         * @param[out] out Receives the message if it was found.
+         *
+         * @return bool, true if the message was found.
+         */
+        bool Get(const discpp::Snowflake& id, std::shared_ptr<discpp::Message>& out) const;
+
+        /**
+         * @brief Get a cached message, or nullptr if its not cached.
+         *
+         * @param[in] id The id of the message.
+         *
+         * @return std::shared_ptr<discpp::Message>
+         */
+        std::shared_ptr<discpp::Message> Get(const discpp::Snowflake& id) const;
+
+        /**
+         * @brief Check if a message is cached.
+         *
+         * @return bool
+         */
+        bool Contains(const discpp::Snowflake& id) const;
+
+        /**
+         * @brief Remove a message from the cache and return it.
+         *
+         * @param[in] id The id of the message.
+         * @param[out] out Receives the message if it was cached.
+         *
+         * @return bool, true if the message was cached.
+         */
+        bool Take(const discpp::Snowflake& id, std::shared_ptr<discpp::Message>& out);
+
+        /**
+         * @brief Remove a message from the cache.
+         *
+         * @return bool, true if the message was cached.
+         */
+        bool Erase(const discpp::Snowflake& id);
+
+        /**
+         * @brief Remove every cached message of a channel.
+         *
+         * @return std::size_t, the amount of removed messages.
+         */
+        std::size_t EraseChannel(const discpp::Snowflake& channel_id);
+
+        /**
+         * @brief Get the cached messages of a channel, oldest first.
+         *
+         * @param[in] channel_id The channel to get messages of.
+         * @param[in] limit The maximum amount of messages to return, the newest are kept. 0 returns all of them.
+         *
+         * @return std::vector<std::shared_ptr<discpp::Message>>
+         */
+        std::vector<std::shared_ptr<discpp::Message>> GetChannelMessages(const discpp::Snowflake& channel_id, std::size_t limit = 0) const;
+
+        /**
+         * @brief Get the amount of cached messages.
+         *
+         * @return std::size_t
+         */
+        std::size_t Size() const;
+
+        /**
+         * @brief Get the approximate amount of bytes used by cached messages.
+         *
+         * @return std::size_t
+         */
+        std::size_t Bytes() const;
+
+        /**
+         * @brief Check if there are no cached messages.
+         *
+         * @return bool
+         */
+        bool Empty() const;
+
+        /**
+         * @brief Remove every cached message.
+         *
+         * @return void
+         */
+        void Clear();
+
+        /**
+         * @brief Estimate the amount of heap memory a message uses, including strings and containers.
+         *
+         * @param[in] message The message to estimate.
+         *
+         * @return std::size_t
+         */
+        static std::size_t EstimateSize(const discpp::Message& message);
+    private:
+        struct Entry {
+            std::shared_ptr<discpp::Message> message;
+            discpp::Snowflake channel_id;
+            std::size_t bytes;
+        };
+
+        void EraseLocked(discpp::SnowflakeMap<Entry>::iterator it);
+        void EvictLocked();
+
+        mutable std::shared_mutex mutex;
+        discpp::SnowflakeMap<Entry> index; /**< Every cached message by id. */
+        discpp::SnowflakeMap<std::deque<discpp::Snowflake>> channels; /**< Per channel message ids, sorted oldest first. */
+        std::vector<discpp::Snowflake> eviction_heap; /**< Min heap of message ids, may contain ids that have since been erased. */
+        std::size_t max_messages = 5000;
+        std::size_t max_bytes = 0;
+        std::size_t bytes = 0;
+    };
+}
+
+#endif //DISCPP_MESSAGE_CACHE_H
@@ -0,0 +1,197 @@
+#ifndef DISCPP_MESSAGE_HISTORY_H
+#define DISCPP_MESSAGE_HISTORY_H
+
+#include "message.h"
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace discpp {
+    /**
+     * @brief The fields of a message that exports and purges need, without building a discpp::Message.
+     *
+     * Views skip the cache lookups, users and members a discpp::Message creates, so walking a large
+     * history with views costs little more than parsing the json.
+     */
+    struct MessageView {
+        MessageView() = default;
+
+        /**
+         * @brief Constructs a discpp::MessageView from a message in a history page.
+         *
+         * @param[in] json The json of the message.
+         *
+         * @return discpp::MessageView, this is a constructor.
+         */
+        MessageView(const rapidjson::Value& json);
+
+        Snowflake id;
+        Snowflake channel_id;
+        Snowflake author_id;
+        bool author_bot = false;
+        std::string content;
+        std::chrono::system_clock::time_point timestamp;
+        bool pinned = false;
+        std::size_t attachment_count = 0;
+        std::size_t embed_count = 0;
+    };
+
+    /**
+     * @brief Fetches the pages of a channel's history, always keeping the next page in flight.
+     *
+     * As soon as a page arrives, the request for the one after it is sent through discpp::RestEngine, so the
+     * next page downloads while the current one is consumed. Requests go through the channel's rate limit
+     * bucket like every other message request. Only the current and the prefetched page are kept in memory.
+     */
+    class MessageHistoryPager {
+    public:
+        using Fetch = std::function<std::future<std::unique_ptr<rapidjson::Document>>(const std::string& url)>;
+
+        /**
+         * @brief Constructs a pager and requests the first page.
+         *
+         * @param[in] channel_id The channel to walk.
+         * @param[in] direction Which way to walk.
+         * @param[in] start Walk from after (or before) this message id, 0 starts at the newest or oldest message.
+         * @param[in] limit The most messages to fetch, 0 fetches the whole history.
+         * @param[in] fetch Requests the page at a url, by default a GET through discpp::RestEngine.
+         *
+         * @return discpp::MessageHistoryPager, this is a constructor.
+         */
+        MessageHistoryPager(const Snowflake& channel_id, HistoryDirection direction, const Snowflake& start, std::size_t limit, Fetch fetch = nullptr);
+
+        /**
+         * @brief Get the next page, ordered in the walking direction. Blocks only if the page didn't arrive yet.
+         *
+         * @return std::unique_ptr<rapidjson::Document>, an array that is empty once the history is exhausted.
+         */
+        std::unique_ptr<rapidjson::Document> NextPage();
+    private:
+        void Prefetch();
+
+        Snowflake channel_id;
+        HistoryDirection direction;
+        Snowflake cursor;
+        std::size_t requested = 0;
+        std::size_t remaining;
+        bool unlimited;
+        bool exhausted = false;
+        Fetch fetch;
+        std::future<std::unique_ptr<rapidjson::Document>> pending;
+    };
+
+    /**
+     * @brief Convert one message of a history page.
+     *
+     * Only defined for discpp::Message and discpp::MessageView.
+     *
+     * @param[in] json The json of the message.
+     *
+     * @return T
+     */
+    template <typename T>
+    T ParseHistoryEntry(rapidjson::Value& json);
+
+    template <>
+    discpp::Message ParseHistoryEntry<discpp::Message>(rapidjson::Value& json);
+
+    template <>
+    discpp::MessageView ParseHistoryEntry<discpp::MessageView>(rapidjson::Value& json);
+
+    /**
+     * @brief A lazy range over a channel's history, see discpp::Channel::RequestHistory.
+     *
+     * Pages of up to 100 messages are fetched while iterating, with the next page always being prefetched.
+     * The range can only be walked once.
+     *
+     * ```cpp
+     *      for (const discpp::MessageView& message : channel.RequestHistoryViews()) {
+     *          if (message.author_id == spammer_id) to_delete.push_back(message.id);
+     *      }
+     * ```
+     */
+    template <typename T>
+    class MessageHistory {
+    public:
+        class Iterator {
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = T*;
+            using reference = T&;
+
+            Iterator() = default;
+            explicit Iterator(MessageHistory* history) : history(history) {
+                if (!history->Load()) this->history = nullptr;
+            }
+
+            reference operator*() const { return history->page[history->index]; }
+            pointer operator->() const { return &history->page[history->index]; }
+
+            Iterator& operator++() {
+                history->index++;
+                if (!history->Load()) history = nullptr;
+
+                return *this;
+            }
+
+            bool operator==(const Iterator& other) const { return history == other.history; }
+            bool operator!=(const Iterator& other) const { return history != other.history; }
+        private:
+            MessageHistory* history = nullptr;
+        };
+
+        /**
+         * @brief Constructs a history range, the first page is requested right away.
+         *
+         * @param[in] channel_id The channel to walk.
+         * @param[in] direction Which way to walk.
+         * @param[in] start Walk from after (or before) this message id, 0 starts at the newest or oldest message.
+         * @param[in] limit The most messages to walk, 0 walks the whole history.
+         *
+         * @return discpp::MessageHistory, this is a constructor.
+         */
+        MessageHistory(const Snowflake& channel_id, HistoryDirection direction, const Snowflake& start, std::size_t limit)
+                : pager(std::make_unique<MessageHistoryPager>(channel_id, direction, start, limit)) {}
+
+        Iterator begin() { return Iterator(this); }
+        Iterator end() { return Iterator(); }
+    private:
+        // Make sure `index` points at a message, fetching the next page if this one is used up.
+        bool Load() {
+            while (index >= page.size()) {
+                if (done) return false;
+
+                std::unique_ptr<rapidjson::Document> json = pager->NextPage();
+                page.clear();
+                index = 0;
+
+                if (json->Empty()) {
+                    done = true;
+                    return false;
+                }
+
+                page.reserve(json->Size());
+                for (auto& message : json->GetArray()) {
+                    page.push_back(ParseHistoryEntry<T>(message));
+                }
+            }
+
+            return true;
+        }
+
+        std::unique_ptr<MessageHistoryPager> pager;
+        std::vector<T> page;
+        std::size_t index = 0;
+        bool done = false;
+    };
+}
+
+#endif //DISCPP_MESSAGE_HISTORY_H
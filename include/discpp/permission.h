@@ -13,6 +13,7 @@
 #include <stdexcept>
 
 namespace discpp {
+	class JsonWriter;
 
 	enum class PermissionType : unsigned char {
 		ROLE,
@@ -88,6 +89,19 @@ namespace discpp {
 	    return permission_str_map[perm];
 	}
 
+    /**
+     * @brief Read a permission mask from json, a number in api v6 and a string in later versions.
+     *
+     * ```cpp
+     *      uint64_t allow = discpp::PermissionsFromJson(json["allow"]);
+     * ```
+     *
+     * @param[in] value The json value of the mask.
+     *
+     * @return uint64_t
+     */
+    uint64_t PermissionsFromJson(const rapidjson::Value& value);
+
 	class PermissionOverwrite {
 	public:
 		PermissionOverwrite() = default;
@@ -103,7 +117,7 @@ namespace discpp {
          *
          * @return discpp::PermissionOverwrite, this is a constructor.
          */
-		PermissionOverwrite(const int& value) : value(value) {}
+		PermissionOverwrite(const uint64_t& value) : value(value) {}
 
         /**
          * @brief Checks if the permission overwrites has a permission.
@@ -131,7 +145,7 @@ namespace discpp {
          */
 		void AddPermission(const Permission& permission);
 
-		unsigned int value = 0;
+		uint64_t value = 0; /**< Mask of discpp::Permission bits, 64 bits wide like Discord's. */
 	};
 
 	class NoPermissionException : public std::runtime_error {
@@ -161,7 +175,7 @@ namespace discpp {
          *
          * @return discpp::Permissions, this is a constructor.
          */
-		Permissions(const PermissionType& permission_type, const int& byte_set);
+		Permissions(const PermissionType& permission_type, const uint64_t& byte_set);
 
         /**
          * @brief Constructs a discpp::Permissions object by parsing json.
@@ -185,7 +199,20 @@ namespace discpp {
          *
          * @return rapidjson::Document
          */
-        rapidjson::Document ToJson();
+        rapidjson::Document ToJson() const;
+
+        /**
+         * @brief Writes this permissions object as a permission overwrite, without building a document.
+         *
+         * ```cpp
+         *      permissions.ToJson(writer);
+         * ```
+         *
+         * @param[in] writer The writer to write to.
+         *
+         * @return void
+         */
+        void ToJson(JsonWriter& writer) const;
 
 		Snowflake role_user_id;
 		PermissionOverwrite allow_perms;
@@ -0,0 +1,123 @@
+#ifndef DISCPP_PERMISSION_CACHE_H
+#define DISCPP_PERMISSION_CACHE_H
+
+#include "flat_hash_map.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+
+namespace discpp {
+    /**
+     * @brief Memoized effective permission masks of a guild, keyed by member and channel.
+     *
+     * A channel id of 0 holds the guild level permissions of a member. Every copy of a guild shares one
+     * cache, so each mask is stored with what it was computed from: a stamp of the owner, the member's
+     * roles and the channel's overwrites, and the role map of the guild. A mask whose stamp or role map
+     * doesn't match is recomputed, so a member object with other roles or an older guild snapshot never
+     * gets a stale mask. Entries are dropped per member or per channel when those change, and all at
+     * once when the roles change.
+     */
+    class PermissionCache {
+    public:
+        PermissionCache() = default;
+        PermissionCache(const PermissionCache&) = delete;
+        PermissionCache& operator=(const PermissionCache&) = delete;
+
+        /**
+         * @brief Get a memoized permission mask.
+         *
+         * @param[in] member_id The id of the member.
+         * @param[in] channel_id The id of the channel, or 0 for the guild level permissions.
+         * @param[in] stamp The stamp of the member's roles and the channel's overwrites the mask must match.
+         * @param[in] roles The role map of the guild the mask must have been computed with.
+         * @param[out] out The memoized mask, only set when it was found and still matches.
+         *
+         * @return bool
+         */
+        bool Get(const Snowflake& member_id, const Snowflake& channel_id, uint64_t stamp, const std::shared_ptr<const void>& roles, uint64_t& out) const {
+            std::shared_lock<std::shared_mutex> lock(mutex);
+
+            auto member_it = masks.find(member_id);
+            if (member_it == masks.end()) return false;
+
+            auto it = member_it->second.find(channel_id);
+            if (it == member_it->second.end()) return false;
+
+            // Ordering by owner compares the control blocks, which the weak_ptr keeps from being reused.
+            const Entry& entry = it->second;
+            if (entry.stamp != stamp || entry.roles.owner_before(roles) || roles.owner_before(entry.roles)) return false;
+
+            out = entry.mask;
+            return true;
+        }
+
+        /**
+         * @brief Memoize a permission mask, replacing the one of the same member and channel.
+         *
+         * @param[in] member_id The id of the member.
+         * @param[in] channel_id The id of the channel, or 0 for the guild level permissions.
+         * @param[in] stamp The stamp of the member's roles and the channel's overwrites.
+         * @param[in] roles The role map of the guild the mask was computed with.
+         * @param[in] mask The mask.
+         *
+         * @return void
+         */
+        void Set(const Snowflake& member_id, const Snowflake& channel_id, uint64_t stamp, const std::shared_ptr<const void>& roles, uint64_t mask) {
+            std::unique_lock<std::shared_mutex> lock(mutex);
+
+            masks[member_id][channel_id] = Entry{ mask, stamp, roles };
+        }
+
+        /**
+         * @brief Drop every memoized mask of a member.
+         *
+         * @param[in] member_id The id of the member.
+         *
+         * @return void
+         */
+        void Invalidate(const Snowflake& member_id) {
+            std::unique_lock<std::shared_mutex> lock(mutex);
+
+            masks.erase(member_id);
+        }
+
+        /**
+         * @brief Drop the memoized masks of every member in a channel.
+         *
+         * @param[in] channel_id The id of the channel.
+         *
+         * @return void
+         */
+        void InvalidateChannel(const Snowflake& channel_id) {
+            std::unique_lock<std::shared_mutex> lock(mutex);
+
+            for (auto& member : masks) {
+                member.second.erase(channel_id);
+            }
+        }
+
+        /**
+         * @brief Drop every memoized mask.
+         *
+         * @return void
+         */
+        void Clear() {
+            std::unique_lock<std::shared_mutex> lock(mutex);
+
+            masks.clear();
+        }
+    private:
+        struct Entry {
+            uint64_t mask = 0;
+            uint64_t stamp = 0;
+            std::weak_ptr<const void> roles;
+        };
+
+        mutable std::shared_mutex mutex;
+        SnowflakeMap<SnowflakeMap<Entry>> masks;
+    };
+}
+
+#endif //DISCPP_PERMISSION_CACHE_H
@@ -7,6 +7,7 @@
 #include "snowflake.h"
 #include "utils.h"
 #include "emoji.h"
+#include "json_writer.h"
 
 namespace discpp {
 
@@ -154,18 +155,55 @@ namespace discpp {
 
 		Presence(std::shared_ptr<discpp::Activity> activity, const bool afk, const std::string& status) : game(activity), afk(afk), status(status) {}
 
-		std::unique_ptr<rapidjson::Document> ToJson() {
-		    std::string str_activity = "{\"status\": \"" + status + "\", \"afk\": " + (afk ? "true" : "false") + ", \"game\": " + \
-                "{\"name\": \"" + game->name + "\", \"type\": " + std::to_string(static_cast<int>(game->type)) + \
-                ((!game->url.empty()) ? ", \"url\": \"" + game->url + "\"" : "") + "}, \"since\": \"" + \
-                std::to_string(time(NULL) - 10) + "\"}";
+		std::unique_ptr<rapidjson::Document> ToJson() const {
+		    JsonWriter writer;
+		    ToJson(writer);
 
             auto result = std::make_unique<rapidjson::Document>(rapidjson::kObjectType);
-		    result->Parse(str_activity.c_str());
+		    result->Parse(writer.View().data(), writer.View().size());
 
 	        return result;
 		}
 
+        /**
+         * @brief Writes the presence update payload, without building a document.
+         *
+         * ```cpp
+         *      presence.ToJson(writer);
+         * ```
+         *
+         * @param[in] writer The writer to write to.
+         *
+         * @return void
+         */
+		void ToJson(JsonWriter& writer) const {
+		    writer.StartObject();
+		    writer.Key("status");
+		    writer.String(status);
+		    writer.Key("afk");
+		    writer.Bool(afk);
+
+		    writer.Key("game");
+		    if (game != nullptr) {
+		        writer.StartObject();
+		        writer.Key("name");
+		        writer.String(game->name);
+		        writer.Key("type");
+		        writer.Int(static_cast<int>(game->type));
+		        if (!game->url.empty()) {
+		            writer.Key("url");
+		            writer.String(game->url);
+		        }
+		        writer.EndObject();
+		    } else {
+		        writer.Null();
+		    }
+
+		    writer.Key("since");
+		    writer.String(std::to_string(time(NULL) - 10));
+		    writer.EndObject();
+		}
+
 		std::string status;
 		std::shared_ptr<discpp::Activity> game;
 		std::vector<discpp::Activity> activities;
@@ -0,0 +1,138 @@
+#ifndef DISCPP_PURGE_H
+#define DISCPP_PURGE_H
+
+#include "message_history.h"
+#include "rest_engine.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace discpp {
+    /**
+     * @brief How far a purge got, passed to discpp::PurgeOptions::on_progress.
+     */
+    struct PurgeProgress {
+        std::size_t scanned = 0; /**< Messages looked at by the predicate. */
+        std::size_t deleted = 0; /**< Messages deleted, in bulk or one by one. */
+        std::size_t failed = 0; /**< Messages whose delete request failed. */
+    };
+
+    struct PurgeOptions {
+        std::size_t max_in_flight = 4; /**< Delete requests to keep queued on the channel's bucket before waiting for one. */
+        bool stop_on_error = false; /**< Rethrow the first failed delete request instead of counting it in PurgeProgress::failed, queued requests aren't sent. */
+        std::function<void(const PurgeProgress&)> on_progress; /**< Called on the purging thread after every finished delete request. */
+    };
+
+    /**
+     * @brief The delete requests a purge of known messages is made of.
+     */
+    struct PurgePlan {
+        std::vector<std::vector<Snowflake>> bulk_batches; /**< Batches of 2-100 messages, young enough for bulk delete. */
+        std::vector<Snowflake> singles; /**< Messages that have to be deleted one by one, only old ones unless a single message is young. */
+    };
+
+    /**
+     * @brief Deletes many messages of a guild channel as fast as the rate limits allow.
+     *
+     * Messages younger than 14 days are deleted in bulk delete batches of up to 100, older ones are deleted
+     * one by one since bulk delete rejects them. Every request goes through the channel's rate limit bucket,
+     * and up to PurgeOptions::max_in_flight of them are queued at once so there is always a request ready
+     * when the bucket resets.
+     *
+     * ```cpp
+     *      discpp::PurgeOptions options;
+     *      options.on_progress = [](const discpp::PurgeProgress& progress) { std::cout << progress.deleted << "\n"; };
+     *
+     *      discpp::MessagePurger purger(channel.id, options);
+     *      purger.PurgeWhere([&](const discpp::MessageView& message) { return message.author_id == raider_id; }, 0, 10000);
+     * ```
+     */
+    class MessagePurger {
+    public:
+        /**
+         * @brief Constructs a purger for a guild channel.
+         *
+         * @param[in] channel_id The channel to delete messages from.
+         * @param[in] options How to run the purge.
+         *
+         * @return discpp::MessagePurger, this is a constructor.
+         */
+        MessagePurger(const Snowflake& channel_id, PurgeOptions options = {});
+
+        /**
+         * @brief Walk the channel's history from newest to oldest and delete every message the predicate matches.
+         *
+         * Matches are deleted while the history is still being fetched.
+         *
+         * @param[in] predicate Returns true for the messages to delete.
+         * @param[in] before Only look at messages before this message id, 0 starts at the newest message.
+         * @param[in] scan_limit The most messages to look at, 0 looks at the whole history.
+         *
+         * @throws std::exception The first failed delete request, if PurgeOptions::stop_on_error is set.
+         *
+         * @return discpp::PurgeProgress, once every delete request finished.
+         */
+        PurgeProgress PurgeWhere(const std::function<bool(const MessageView&)>& predicate, const Snowflake& before = 0, std::size_t scan_limit = 0);
+
+        /**
+         * @brief Delete the given messages.
+         *
+         * @param[in] messages The messages to delete, duplicates are only deleted once.
+         *
+         * @throws std::exception The first failed delete request, if PurgeOptions::stop_on_error is set.
+         *
+         * @return discpp::PurgeProgress, once every delete request finished.
+         */
+        PurgeProgress PurgeIds(const std::vector<Snowflake>& messages);
+
+        /**
+         * @brief Split messages into bulk delete batches and single deletes by their age.
+         *
+         * ```cpp
+         *      discpp::PurgePlan plan = discpp::MessagePurger::Plan(message_ids);
+         * ```
+         *
+         * @param[in] messages The messages to delete.
+         * @param[in] now The time the requests will be sent at.
+         *
+         * @return discpp::PurgePlan
+         */
+        static PurgePlan Plan(std::vector<Snowflake> messages, std::chrono::system_clock::time_point now = std::chrono::system_clock::now());
+
+        /**
+         * @brief Check if a message is young enough for bulk delete.
+         *
+         * @param[in] message The message id.
+         * @param[in] now The time the request will be sent at.
+         *
+         * @return bool
+         */
+        static bool BulkDeletable(const Snowflake& message, std::chrono::system_clock::time_point now);
+    private:
+        using Response = std::future<void>;
+
+        void Add(const Snowflake& message);
+        void SendRecent();
+        void SendBulk(std::vector<Snowflake> batch);
+        void SendSingle(const Snowflake& message);
+        void Send(RestEngine::Request request, std::size_t count);
+        void Reap(std::size_t keep);
+        PurgeProgress Finish();
+
+        Snowflake channel_id;
+        PurgeOptions options;
+        PurgeProgress progress;
+        std::vector<Snowflake> recent;
+        std::deque<std::pair<Response, std::size_t>> in_flight;
+        std::shared_ptr<std::atomic<bool>> stopped = std::make_shared<std::atomic<bool>>(false); /**< Set once a request failed with stop_on_error, so queued requests aren't sent. */
+    };
+}
+
+#endif //DISCPP_PURGE_H
@@ -0,0 +1,173 @@
+#ifndef DISCPP_RATE_LIMITER_H
+#define DISCPP_RATE_LIMITER_H
+
+#include "snowflake.h"
+
+#include <cpr/cpr.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace discpp {
+    /**
+     * @brief Schedules REST requests against Discord's per route rate limit buckets.
+     *
+     * Requests are grouped by their route, like `POST /channels/:id/messages`, and their major parameter.
+     * Once a response names the route's `X-RateLimit-Bucket`, every route with that hash shares one bucket
+     * per major parameter. A bucket dispatches its requests in FIFO order while it has budget left and holds
+     * the rest until it resets, which is tracked at millisecond precision from `X-RateLimit-Reset-After`.
+     * A global 429 holds every bucket until its `retry_after` has passed.
+     *
+     * Held requests are released by a timer thread, so nothing sleeps while waiting for a reset.
+     *
+     * ```cpp
+     *      discpp::rate_limiter.Acquire("POST", url, channel_id);
+     *      cpr::Response response = cpr::Post(cpr::Url{ url }, body);
+     *      bool retry = discpp::rate_limiter.Complete("POST", url, channel_id, response);
+     * ```
+     */
+    class RateLimiter {
+    public:
+        using Clock = std::chrono::steady_clock;
+        using Dispatch = std::function<void()>;
+
+        static constexpr int max_retries = 3; /**< How often a request that still got a 429 is sent again. */
+
+        RateLimiter() = default;
+        RateLimiter(const RateLimiter&) = delete;
+        RateLimiter& operator=(const RateLimiter&) = delete;
+
+        /**
+         * @brief Stops the timer thread. Requests that are still held are dropped.
+         */
+        ~RateLimiter();
+
+        /**
+         * @brief Queue a request in its bucket, `dispatch` is called once the request may be sent.
+         *
+         * `dispatch` may run on the calling thread, the timer thread, or the thread that completes another
+         * request of the bucket, so it must not block. Every dispatched request must be passed to Complete.
+         *
+         * @param[in] method The http method.
+         * @param[in] url The url the request goes to.
+         * @param[in] major The major parameter of the route, the guild, channel or webhook id.
+         * @param[in] dispatch Sends the request.
+         *
+         * @return void
+         */
+        void Acquire(const std::string& method, const std::string& url, const Snowflake& major, Dispatch dispatch);
+
+        /**
+         * @brief Wait until the request may be sent, in FIFO order with the other requests of its bucket.
+         *
+         * @param[in] method The http method.
+         * @param[in] url The url the request goes to.
+         * @param[in] major The major parameter of the route, the guild, channel or webhook id.
+         *
+         * @return void
+         */
+        void Acquire(const std::string& method, const std::string& url, const Snowflake& major);
+
+        /**
+         * @brief Update the bucket of a request from its response, and release held requests that now fit.
+         *
+         * @param[in] method The http method.
+         * @param[in] url The url the request went to.
+         * @param[in] major The major parameter of the route, the guild, channel or webhook id.
+         * @param[in] response The response of the request.
+         *
+         * @return bool, true if the request got a 429 and should be sent again.
+         */
+        bool Complete(const std::string& method, const std::string& url, const Snowflake& major, const cpr::Response& response);
+
+        /**
+         * @brief Get the amount of buckets that are tracked.
+         *
+         * @return std::size_t
+         */
+        std::size_t BucketCount() const;
+
+        /**
+         * @brief Get the approximate bytes used by the tracked buckets and routes.
+         *
+         * @return std::size_t
+         */
+        std::size_t Bytes() const;
+
+        /**
+         * @brief Get the route template of a request, ids and tokens in its path are replaced with placeholders.
+         *
+         * ```cpp
+         *      discpp::RateLimiter::Route("DELETE", "https://discordapp.com/api/v6/channels/1234/messages/5678"); // "DELETE /channels/:id/messages/:id"
+         * ```
+         *
+         * @param[in] method The http method.
+         * @param[in] url The url the request goes to.
+         *
+         * @return std::string
+         */
+        static std::string Route(const std::string& method, const std::string& url);
+
+        /**
+         * @brief Get where the route starts in a REST url, after its scheme, host, base path and api version.
+         *
+         * Urls under `globals::api_base_url` skip all of it, so a rest proxy can be served from any base path.
+         * Other urls skip up to the api version, like `/api/v6`, or only the scheme and host without an `/api/`.
+         *
+         * ```cpp
+         *      discpp::RateLimiter::RouteStart("https://discordapp.com/api/v6/channels/1234"); // 29, the '/' before channels
+         *      discpp::RateLimiter::RouteStart("/api/v6/channels/1234"); // 7
+         * ```
+         *
+         * @param[in] url The url or the path of a request.
+         *
+         * @return std::size_t, the index of the '/' the route starts with, or the size of `url` if it has no route.
+         */
+        static std::size_t RouteStart(const std::string& url);
+    private:
+        struct Bucket {
+            int limit = 1;
+            int remaining = 1;
+            int in_flight = 0;
+            Clock::time_point reset_at; /**< Default constructed while the reset is unknown. */
+            std::deque<Dispatch> waiting;
+        };
+
+        struct RouteInfo {
+            std::string hash; /**< The `X-RateLimit-Bucket` of the route, empty until a response named it. */
+            int limit = 1;
+        };
+
+        std::string BucketKey(const std::string& route, const Snowflake& major);
+        std::shared_ptr<Bucket>& FindBucket(const std::string& route, const Snowflake& major);
+        Bucket& MoveBucket(const std::string& from, const std::string& to);
+        void Drain(Bucket& bucket, Clock::time_point now, std::vector<Dispatch>& ready);
+        void DrainAll(Clock::time_point now, std::vector<Dispatch>& ready);
+        void PruneIdle(Clock::time_point now);
+        void ScheduleWake(Clock::time_point when);
+        void RunTimer();
+
+        mutable std::mutex mutex;
+        std::condition_variable timer_cv;
+        std::thread timer;
+        bool stopping = false;
+        Clock::time_point next_wake = Clock::time_point::max();
+        Clock::time_point global_until;
+        std::size_t completions = 0;
+
+        std::unordered_map<std::string, RouteInfo> routes;
+        std::unordered_map<std::string, std::shared_ptr<Bucket>> buckets; /**< Keyed by bucket hash, or route until it's known, and major parameter. */
+    };
+
+    inline RateLimiter rate_limiter;
+}
+
+#endif //DISCPP_RATE_LIMITER_H
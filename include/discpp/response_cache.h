@@ -0,0 +1,176 @@
+#ifndef DISCPP_RESPONSE_CACHE_H
+#define DISCPP_RESPONSE_CACHE_H
+
+#ifndef RAPIDJSON_HAS_STDSTRING
+#define RAPIDJSON_HAS_STDSTRING 1
+#endif
+
+#include <rapidjson/document.h>
+#include <cpr/cpr.h>
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace discpp {
+    /**
+     * @brief Caches responses of read mostly REST GET routes, like guild bans or pinned messages.
+     *
+     * Nothing is cached until a route is given a time to live. Fresh responses are returned without a
+     * request. Once a response is stale and the server sent an `ETag`, the next request carries
+     * `If-None-Match`, and a 304 renews the cached response instead of downloading it again.
+     *
+     * Successful POST, PUT, PATCH and DELETE requests drop the cached responses of the guild, channel or
+     * user they changed. Gateway events that change a cached route drop it as well. A GET that was already
+     * in flight when its url was invalidated may carry the old state, so its response isn't stored.
+     *
+     * ```cpp
+     *      discpp::rest_cache.SetTTL("/guilds/:id/bans", std::chrono::seconds(60));
+     *      discpp::rest_cache.Invalidate(discpp::Endpoint("/guilds/" + std::to_string(guild_id) + "/bans"));
+     * ```
+     */
+    class ResponseCache {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        std::size_t max_entries = 1024; /**< When full, expired responses and then the ones closest to expiring are dropped. */
+
+        /**
+         * @brief Set how long responses of a route stay fresh.
+         *
+         * @param[in] route The path of the route with its ids replaced by `:id`, like `/channels/:id/pins`.
+         * @param[in] ttl How long responses stay fresh, zero stops caching the route.
+         *
+         * @return void
+         */
+        void SetTTL(const std::string& route, std::chrono::milliseconds ttl);
+
+        /**
+         * @brief Cache the routes behind Guild::GetBans, GetInvites, GetIntegrations, GetEmojis, GetAuditLog,
+         * Channel::GetPinnedMessages and Client::GetBotUserConnections.
+         *
+         * @return void
+         */
+        void EnableDefaults();
+
+        /**
+         * @brief Check if responses of a url are cached.
+         *
+         * @param[in] url The url of the request.
+         *
+         * @return bool
+         */
+        bool Cacheable(const std::string& url) const;
+
+        /**
+         * @brief Get a copy of the cached response of a url if it is still fresh.
+         *
+         * @param[in] url The url of the request.
+         *
+         * @return std::unique_ptr<rapidjson::Document>, nullptr if there is no fresh response.
+         */
+        std::unique_ptr<rapidjson::Document> Get(const std::string& url) const;
+
+        /**
+         * @brief Get the `ETag` of the cached response of a url, to revalidate it with `If-None-Match`.
+         *
+         * @param[in] url The url of the request.
+         *
+         * @return std::string, empty if there is none.
+         */
+        std::string GetETag(const std::string& url) const;
+
+        /**
+         * @brief Renew the cached response of a url after the server answered 304, and get a copy of it.
+         *
+         * @param[in] url The url of the request.
+         *
+         * @return std::unique_ptr<rapidjson::Document>, nullptr if the response isn't cached anymore.
+         */
+        std::unique_ptr<rapidjson::Document> Revalidate(const std::string& url);
+
+        /**
+         * @brief Get the current invalidation generation, take it before sending a GET and pass it to Store.
+         *
+         * @return uint64_t
+         */
+        uint64_t Generation() const;
+
+        /**
+         * @brief Cache the response of a url, if its route is cached and the url wasn't invalidated since `generation`.
+         *
+         * ```cpp
+         *      uint64_t generation = discpp::rest_cache.Generation();
+         *      cpr::Response response = cpr::Get(cpr::Url{ url });
+         *      discpp::rest_cache.Store(url, *discpp::HandleResponse(response, id, bucket), response.header, generation);
+         * ```
+         *
+         * @param[in] url The url of the request.
+         * @param[in] json The parsed response.
+         * @param[in] header The response headers.
+         * @param[in] generation The result of Generation from before the request was sent.
+         *
+         * @return void
+         */
+        void Store(const std::string& url, const rapidjson::Document& json, const cpr::Header& header, uint64_t generation);
+
+        /**
+         * @brief Drop the cached responses of every url that starts with `url_prefix`.
+         *
+         * @param[in] url_prefix The start of the urls to drop, like `discpp::Endpoint("/guilds/1234/bans")`.
+         *
+         * @return void
+         */
+        void Invalidate(const std::string& url_prefix);
+
+        /**
+         * @brief Drop the cached responses of the guild, channel or user a url belongs to.
+         *
+         * @param[in] url The url of a request that changed something.
+         *
+         * @return void
+         */
+        void InvalidateResource(const std::string& url);
+
+        /**
+         * @brief Get the amount of cached responses.
+         *
+         * @return std::size_t
+         */
+        std::size_t Size() const;
+
+        /**
+         * @brief Drop every cached response.
+         *
+         * @return void
+         */
+        void Clear();
+    private:
+        struct Entry {
+            std::shared_ptr<const rapidjson::Document> json;
+            std::string etag;
+            Clock::time_point expires_at;
+            std::chrono::milliseconds ttl;
+        };
+
+        std::chrono::milliseconds TTLFor(const std::string& url) const;
+        void MakeRoom(Clock::time_point now);
+        bool InvalidatedSince(const std::string& url, uint64_t generation) const;
+        static std::unique_ptr<rapidjson::Document> Copy(const std::shared_ptr<const rapidjson::Document>& json);
+
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, std::chrono::milliseconds> ttls;
+        std::map<std::string, Entry> entries; /**< Ordered by url so invalidation can drop a whole prefix. */
+
+        uint64_t current_generation = 0; /**< Bumped by every invalidation. */
+        uint64_t forgotten_generation = 0; /**< Invalidations up to this generation are no longer in `invalidated`. */
+        std::unordered_map<std::string, uint64_t> invalidated; /**< The generation of the last invalidation of each url prefix. */
+    };
+
+    inline ResponseCache rest_cache;
+}
+
+#endif //DISCPP_RESPONSE_CACHE_H
@@ -0,0 +1,307 @@
+#ifndef DISCPP_REST_ENGINE_H
+#define DISCPP_REST_ENGINE_H
+
+#include "utils.h"
+#include "rate_limiter.h"
+#include "file.h"
+
+#include <curl/curl.h>
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace discpp {
+    /**
+     * @brief Non-blocking HTTP client driven by a single curl multi event loop thread.
+     *
+     * Requests are queued from any thread and performed concurrently on the loop thread, so thousands
+     * of requests in flight only cost their curl handles instead of a blocked thread each. The multi
+     * handle shares its connections between requests, and TLS sessions and DNS lookups are shared too.
+     * HTTP/2 is negotiated when the server supports it, which lets requests multiplex over one connection.
+     *
+     * Completion callbacks run on the loop thread, so they must not block. While one runs no other
+     * response is handled and no request is started, so a slow callback stalls every async REST request.
+     * Before the callback of any request but a GET runs, the cached responses of the guild, channel or
+     * user it went to are dropped from discpp::rest_cache.
+     *
+     * ```cpp
+     *      discpp::RestEngine::Request request;
+     *      request.method = "GET";
+     *      request.url = discpp::Endpoint("/gateway");
+     *      request.callback = [](cpr::Response& response) { ... };
+     *
+     *      discpp::RestEngine::Instance().Perform(std::move(request));
+     * ```
+     */
+    class RestEngine {
+    public:
+        using Callback = std::function<void(cpr::Response&)>;
+
+        struct Request {
+            std::string method = "GET"; /**< GET, POST, PUT, PATCH or DELETE. */
+            std::string url;
+            cpr::Header headers;
+            std::string body; /**< The json body, or the payload_json part if there are files. */
+            std::vector<File> files; /**< Sends the request as multipart/form-data, read from memory, streams or disk while uploading. */
+            std::chrono::steady_clock::time_point not_before; /**< The request isn't started before this time. */
+            std::chrono::milliseconds timeout{ 0 }; /**< Fails the request if it takes longer once started, 0 for no limit. */
+            std::chrono::milliseconds connect_timeout{ 10000 }; /**< Fails the request if no connection is made in time, 0 for curl's default. */
+            std::shared_ptr<const std::atomic<bool>> cancelled; /**< If set once the request is due, it completes with status code 0 without being sent. */
+            Callback callback; /**< Called with the response, on the loop thread. */
+        };
+
+        RestEngine();
+        RestEngine(const RestEngine&) = delete;
+        RestEngine& operator=(const RestEngine&) = delete;
+
+        /**
+         * @brief Stops the loop thread. Requests that are still queued or in flight are dropped.
+         */
+        ~RestEngine();
+
+        /**
+         * @brief Get the engine used by the async REST helpers, it is started on first use.
+         *
+         * @return discpp::RestEngine&
+         */
+        static RestEngine& Instance();
+
+        /**
+         * @brief Queue a request to be performed on the loop thread.
+         *
+         * @param[in] request The request to perform.
+         *
+         * @return void
+         */
+        void Perform(Request request);
+
+        /**
+         * @brief Queue a request behind its rate limit bucket in discpp::rate_limiter.
+         *
+         * The request is performed once its bucket has budget left, and performed again if it still got
+         * a 429, up to discpp::RateLimiter::max_retries times.
+         *
+         * @param[in] request The request to perform.
+         * @param[in] major The major parameter of the route, the guild, channel or webhook id.
+         * @param[in] retries How often a 429 response may still be retried.
+         *
+         * @return void
+         */
+        void PerformRateLimited(Request request, const Snowflake& major, int retries = RateLimiter::max_retries);
+
+        /**
+         * @brief Queue a request behind its rate limit bucket in `limiter`, for requests of another token.
+         *
+         * @param[in] request The request to perform.
+         * @param[in] major The major parameter of the route, the guild, channel or webhook id.
+         * @param[in] limiter The rate limiter of the request's token, it must outlive the request.
+         * @param[in] retries How often a 429 response may still be retried.
+         *
+         * @return void
+         */
+        void PerformRateLimited(Request request, const Snowflake& major, RateLimiter& limiter, int retries = RateLimiter::max_retries);
+
+        /**
+         * @brief Get the amount of requests that are queued or in flight.
+         *
+         * @return std::size_t
+         */
+        std::size_t Pending() const;
+
+        /**
+         * @brief Check if this is the loop thread, like inside a completion callback or `convert`.
+         *
+         * Waiting there for a request of this engine never returns, since only the loop thread can complete it.
+         *
+         * @return bool
+         */
+        bool OnLoopThread() const;
+    private:
+        struct Transfer;
+        struct PartSource;
+
+        void Run();
+        void StartDueRequests();
+        void FinishTransfer(CURL* handle, CURLcode result);
+        static void AttachMultipart(CURL* handle, Transfer& transfer);
+        static size_t WriteCallback(char* data, size_t size, size_t count, void* user);
+        static size_t HeaderCallback(char* data, size_t size, size_t count, void* user);
+        static size_t ReadPartCallback(char* buffer, size_t size, size_t count, void* user);
+        static int SeekPartCallback(void* user, curl_off_t offset, int origin);
+
+        CURLM* multi;
+        CURLSH* share;
+        std::thread thread;
+        std::atomic<bool> running{true};
+        std::atomic<std::size_t> pending{0};
+
+        std::mutex queue_mutex;
+        std::multimap<std::chrono::steady_clock::time_point, Request> queue; /**< Requests waiting for their start time. */
+        std::unordered_map<CURL*, std::unique_ptr<Transfer>> transfers; /**< Requests in flight, only touched by the loop thread. */
+    };
+
+    /**
+     * @brief Perform a prepared REST request without blocking and convert its json response.
+     *
+     * Use this to send files, which the other helpers can't.
+     *
+     * ```cpp
+     *      discpp::RestEngine::Request request;
+     *      request.method = "POST";
+     *      request.url = discpp::Endpoint("/channels/" + std::to_string(id) + "/messages");
+     *      request.headers = discpp::DefaultHeaders();
+     *      request.body = payload_json;
+     *      request.files = { discpp::File::FromBuffer("message.txt", text) };
+     *
+     *      std::future<discpp::Message> message = discpp::SendRequestAsync<discpp::Message>(std::move(request), id,
+     *          discpp::RateLimitBucketType::CHANNEL, [](rapidjson::Document& json) { return discpp::Message(json); });
+     * ```
+     *
+     * `convert` runs on the loop thread of discpp::RestEngine. It may build objects and use the cache, which
+     * is thread safe, but no other response is handled until it returns. Anything slower than turning the
+     * json into the result belongs after the future is ready, on the caller's thread.
+     *
+     * @param[in] request The request, its callback is replaced.
+     * @param[in] object The object id to handle the ratelimits for.
+     * @param[in] ratelimit_bucket The rate limit bucket.
+     * @param[in] convert Turns the response json into the result of the future, on the loop thread.
+     *
+     * @return std::future<T>
+     */
+    template <typename T, typename Convert>
+    std::future<T> SendRequestAsync(RestEngine::Request request, const Snowflake& object, const RateLimitBucketType& ratelimit_bucket, Convert&& convert) {
+        auto promise = std::make_shared<std::promise<T>>();
+        std::future<T> future = promise->get_future();
+
+        request.callback = [promise, object, ratelimit_bucket, convert = std::forward<Convert>(convert)](cpr::Response& response) {
+            try {
+                std::unique_ptr<rapidjson::Document> json = HandleResponse(response, object, ratelimit_bucket);
+                if constexpr (std::is_void<T>::value) {
+                    convert(*json);
+                    promise->set_value();
+                } else {
+                    promise->set_value(convert(*json));
+                }
+            } catch (...) {
+                promise->set_exception(std::current_exception());
+            }
+        };
+
+        RestEngine::Instance().PerformRateLimited(std::move(request), object);
+        return future;
+    }
+
+    /**
+     * @brief Perform a REST request without blocking and convert its json response.
+     *
+     * The response goes through discpp::HandleResponse, so the future throws the same exceptions as the
+     * blocking helpers. `convert` runs on the loop thread, see the overload above.
+     *
+     * ```cpp
+     *      std::future<discpp::Message> message = discpp::SendRequestAsync<discpp::Message>("POST", url, headers, id,
+     *          discpp::RateLimitBucketType::CHANNEL, body, [](rapidjson::Document& json) { return discpp::Message(json); });
+     * ```
+     *
+     * @param[in] method The http method.
+     * @param[in] url The url to create a request to.
+     * @param[in] headers The http header.
+     * @param[in] object The object id to handle the ratelimits for.
+     * @param[in] ratelimit_bucket The rate limit bucket.
+     * @param[in] body The request body.
+     * @param[in] convert Turns the response json into the result of the future.
+     *
+     * @return std::future<T>
+     */
+    template <typename T, typename Convert>
+    std::future<T> SendRequestAsync(const std::string& method, const std::string& url, const cpr::Header& headers, const Snowflake& object,
+            const RateLimitBucketType& ratelimit_bucket, const cpr::Body& body, Convert&& convert) {
+        RestEngine::Request request;
+        request.method = method;
+        request.url = url;
+        request.headers = headers;
+        request.body = body;
+
+        return SendRequestAsync<T>(std::move(request), object, ratelimit_bucket, std::forward<Convert>(convert));
+    }
+
+    /**
+     * @brief Sends a get request to a url without blocking.
+     *
+     * ```cpp
+     *      std::future<std::unique_ptr<rapidjson::Document>> response = discpp::SendGetRequestAsync(url, discpp::DefaultHeaders(), object, discpp::RateLimitBucketType::CHANNEL);
+     * ```
+     *
+     * @param[in] url The url to create a request to.
+     * @param[in] headers The http header.
+     * @param[in] object The object id to handle the ratelimits for.
+     * @param[in] ratelimit_bucket The rate limit bucket.
+     * @param[in] body The request body.
+     *
+     * @return std::future<std::unique_ptr<rapidjson::Document>>
+     */
+    std::future<std::unique_ptr<rapidjson::Document>> SendGetRequestAsync(const std::string& url, const cpr::Header& headers, const Snowflake& object, const RateLimitBucketType& ratelimit_bucket, const cpr::Body& body = {});
+
+    /**
+     * @brief Sends a post request to a url without blocking.
+     *
+     * @param[in] url The url to create a request to.
+     * @param[in] headers The http header.
+     * @param[in] object The object id to handle the ratelimits for.
+     * @param[in] ratelimit_bucket The rate limit bucket.
+     * @param[in] body The request body.
+     *
+     * @return std::future<std::unique_ptr<rapidjson::Document>>
+     */
+    std::future<std::unique_ptr<rapidjson::Document>> SendPostRequestAsync(const std::string& url, const cpr::Header& headers, const Snowflake& object, const RateLimitBucketType& ratelimit_bucket, const cpr::Body& body = {});
+
+    /**
+     * @brief Sends a put request to a url without blocking.
+     *
+     * @param[in] url The url to create a request to.
+     * @param[in] headers The http header.
+     * @param[in] object The object id to handle the ratelimits for.
+     * @param[in] ratelimit_bucket The rate limit bucket.
+     * @param[in] body The request body.
+     *
+     * @return std::future<std::unique_ptr<rapidjson::Document>>
+     */
+    std::future<std::unique_ptr<rapidjson::Document>> SendPutRequestAsync(const std::string& url, const cpr::Header& headers, const Snowflake& object, const RateLimitBucketType& ratelimit_bucket, const cpr::Body& body = {});
+
+    /**
+     * @brief Sends a patch request to a url without blocking.
+     *
+     * @param[in] url The url to create a request to.
+     * @param[in] headers The http header.
+     * @param[in] object The object id to handle the ratelimits for.
+     * @param[in] ratelimit_bucket The rate limit bucket.
+     * @param[in] body The request body.
+     *
+     * @return std::future<std::unique_ptr<rapidjson::Document>>
+     */
+    std::future<std::unique_ptr<rapidjson::Document>> SendPatchRequestAsync(const std::string& url, const cpr::Header& headers, const Snowflake& object, const RateLimitBucketType& ratelimit_bucket, const cpr::Body& body = {});
+
+    /**
+     * @brief Sends a delete request to a url without blocking.
+     *
+     * @param[in] url The url to create a request to.
+     * @param[in] headers The http header.
+     * @param[in] object The object id to handle the ratelimits for.
+     * @param[in] ratelimit_bucket The rate limit bucket.
+     *
+     * @return std::future<std::unique_ptr<rapidjson::Document>>
+     */
+    std::future<std::unique_ptr<rapidjson::Document>> SendDeleteRequestAsync(const std::string& url, const cpr::Header& headers, const Snowflake& object, const RateLimitBucketType& ratelimit_bucket);
+}
+
+#endif //DISCPP_REST_ENGINE_H
@@ -0,0 +1,82 @@
+#ifndef DISCPP_REST_PROXY_H
+#define DISCPP_REST_PROXY_H
+
+#include "rest_engine.h"
+
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace discpp {
+    /**
+     * @brief Forwards REST requests of other processes to Discord, behind one shared set of rate limit buckets.
+     *
+     * Bots that run several processes on one token each track their own buckets and together still run into
+     * 429s. The rest proxy executable (`tools/rest_proxy`, built with `BUILD_REST_PROXY`) serves this class
+     * over HTTP, so every process can send its requests through it by setting `ClientConfig::rest_proxy_url`.
+     * The proxy then holds the only connection pool and the only bucket state for the token.
+     *
+     * Requests are bucketed by their route and major parameter like the client does, and a 429 is retried in
+     * the proxy, so the processes behind it rarely see one. Discord limits every token separately, so every
+     * `Authorization` header gets its own set of buckets.
+     *
+     * ```cpp
+     *      discpp::RestProxy proxy;
+     *      cpr::Response response = proxy.Forward("GET", "/api/v6/channels/1234/messages?limit=50", headers, "").get();
+     * ```
+     */
+    class RestProxy {
+    public:
+        /**
+         * @brief Creates a proxy that forwards to `upstream`.
+         *
+         * @param[in] upstream The scheme and host requests are forwarded to, the request target is appended to it.
+         *
+         * @return discpp::RestProxy, this is a constructor.
+         */
+        explicit RestProxy(std::string upstream = "https://discordapp.com") : upstream(std::move(upstream)) {}
+
+        RestProxy(const RestProxy&) = delete;
+        RestProxy& operator=(const RestProxy&) = delete;
+
+        /**
+         * @brief Forward a request, once its bucket has budget left.
+         *
+         * Only the headers Discord needs are forwarded, and only the content and rate limit headers of the
+         * response are kept. A request that couldn't be performed completes with status code 0. The proxy
+         * must outlive the requests it forwards, since their buckets belong to it.
+         *
+         * @param[in] method The http method.
+         * @param[in] target The path and query of the request, like `/api/v6/channels/1234/messages`.
+         * @param[in] headers The request headers.
+         * @param[in] body The request body, forwarded as is, so multipart bodies keep their boundary.
+         *
+         * @return std::future<cpr::Response>
+         */
+        std::future<cpr::Response> Forward(const std::string& method, const std::string& target, const cpr::Header& headers, std::string body);
+
+        /**
+         * @brief Get the major parameter of a request target, the channel, guild or webhook id it starts with.
+         *
+         * ```cpp
+         *      discpp::RestProxy::MajorParameter("/api/v6/channels/1234/messages/5678"); // 1234
+         * ```
+         *
+         * @param[in] target The path or url of the request.
+         *
+         * @return discpp::Snowflake, 0 if the route has no major parameter.
+         */
+        static Snowflake MajorParameter(const std::string& target);
+    private:
+        RateLimiter& LimiterFor(const std::string& authorization);
+
+        std::string upstream;
+
+        std::mutex limiters_mutex;
+        std::unordered_map<std::string, std::unique_ptr<RateLimiter>> limiters; /**< Keyed by the `Authorization` header. */
+    };
+}
+
+#endif //DISCPP_REST_PROXY_H
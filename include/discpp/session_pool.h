@@ -0,0 +1,105 @@
+#ifndef DISCPP_SESSION_POOL_H
+#define DISCPP_SESSION_POOL_H
+
+#include <cpr/cpr.h>
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace discpp {
+    /**
+     * @brief Pool of reusable HTTP sessions for the REST API.
+     *
+     * Each cpr::Session owns a curl easy handle, and curl keeps the connection and the TLS session of
+     * a handle alive between requests. Reusing sessions therefore skips the TCP and TLS handshakes that
+     * a fresh `cpr::Get` or `cpr::Post` pays on every call.
+     *
+     * A session is only used by one request at a time. Concurrent requests get their own session, and
+     * at most `max_idle` of them are kept around once they are returned.
+     *
+     * Idle sessions are kept per HTTP method. cpr sets the method on the curl handle with options like
+     * `CURLOPT_CUSTOMREQUEST` that its other methods don't all reset, so a session that sent a DELETE
+     * could otherwise send its next GET as a DELETE.
+     *
+     * ```cpp
+     *      discpp::SessionPool::Lease session = discpp::rest_sessions.Acquire("GET");
+     *      session->SetUrl(cpr::Url{ url });
+     *      cpr::Response response = session->Get();
+     * ```
+     */
+    class SessionPool {
+    public:
+        /**
+         * @brief Exclusive use of a pooled session, which is returned to the pool on destruction.
+         */
+        class Lease {
+        public:
+            Lease(SessionPool& pool, std::string method, std::unique_ptr<cpr::Session> session) : pool(&pool), method(std::move(method)), session(std::move(session)) {}
+            Lease(Lease&& other) noexcept = default;
+            Lease& operator=(Lease&& other) noexcept = delete;
+            Lease(const Lease&) = delete;
+            Lease& operator=(const Lease&) = delete;
+            ~Lease() {
+                if (session != nullptr) pool->Release(method, std::move(session));
+            }
+
+            cpr::Session& operator*() const { return *session; }
+            cpr::Session* operator->() const { return session.get(); }
+        private:
+            SessionPool* pool;
+            std::string method;
+            std::unique_ptr<cpr::Session> session;
+        };
+
+        explicit SessionPool(std::size_t max_idle = 8) : max_idle(max_idle) {}
+        SessionPool(const SessionPool&) = delete;
+        SessionPool& operator=(const SessionPool&) = delete;
+
+        /**
+         * @brief Take an idle session that was used for `method` out of the pool, or create one if there is none.
+         *
+         * @param[in] method The HTTP method the session will send, like "GET" or "POST".
+         *
+         * @return discpp::SessionPool::Lease
+         */
+        Lease Acquire(const std::string& method);
+
+        /**
+         * @brief Change how many idle sessions are kept, dropping the ones over the new limit.
+         *
+         * @param[in] max_idle The maximum amount of idle sessions.
+         *
+         * @return void
+         */
+        void SetMaxIdle(std::size_t max_idle);
+
+        /**
+         * @brief Get the amount of idle sessions in the pool, over all methods.
+         *
+         * @return std::size_t
+         */
+        std::size_t IdleCount() const;
+
+        /**
+         * @brief Close every idle session and its connection.
+         *
+         * @return void
+         */
+        void Clear();
+    private:
+        void Release(const std::string& method, std::unique_ptr<cpr::Session> session);
+
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, std::vector<std::unique_ptr<cpr::Session>>> idle; /**< Idle sessions by the method they last sent. */
+        std::size_t idle_count = 0; /**< Idle sessions over all methods. */
+        std::size_t max_idle;
+    };
+
+    inline SessionPool rest_sessions; /**< Sessions used by discpp::SendGetRequest and the other REST helpers. */
+}
+
+#endif //DISCPP_SESSION_POOL_H
@@ -0,0 +1,139 @@
+#ifndef DISCPP_SLAB_H
+#define DISCPP_SLAB_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace discpp {
+    /**
+     * @brief Pool of equally sized blocks carved out of large contiguous chunks.
+     *
+     * A slab hands out blocks of the first size it is asked for, and serves any other size with the
+     * global allocator. Freed blocks are reused, and chunks are only released when the slab dies.
+     *
+     * The slab is reference counted by its owner handle and by every live block, so blocks may
+     * outlive the object that owns the slab. Use discpp::SlabHandle to own one.
+     */
+    class Slab {
+    public:
+        /**
+         * @brief Create a new slab, owned by the returned pointer's single reference.
+         *
+         * @param[in] blocks_per_chunk The amount of blocks allocated together in one chunk.
+         *
+         * @return discpp::Slab*
+         */
+        static Slab* Create(std::size_t blocks_per_chunk = 256);
+
+        void Retain() noexcept;
+        void Release() noexcept;
+
+        void* Allocate(std::size_t size, std::size_t alignment);
+        void Deallocate(void* ptr, std::size_t size, std::size_t alignment) noexcept;
+
+        /**
+         * @brief Get the amount of bytes reserved by the chunks of this slab.
+         *
+         * @return std::size_t
+         */
+        std::size_t ReservedBytes() const;
+
+        /**
+         * @brief Get the amount of blocks currently handed out.
+         *
+         * @return std::size_t
+         */
+        std::size_t LiveBlocks() const;
+    private:
+        explicit Slab(std::size_t blocks_per_chunk) : blocks_per_chunk(blocks_per_chunk) {}
+        ~Slab() = default;
+
+        struct FreeBlock {
+            FreeBlock* next;
+        };
+
+        mutable std::mutex mutex;
+        std::atomic<std::size_t> references{1};
+        std::vector<std::unique_ptr<unsigned char[]>> chunks;
+        FreeBlock* free_list = nullptr;
+        unsigned char* chunk_cursor = nullptr;
+        unsigned char* chunk_end = nullptr;
+        std::size_t block_size = 0;
+        std::size_t block_alignment = 0;
+        std::size_t blocks_per_chunk;
+        std::size_t live_blocks = 0;
+    };
+
+    /**
+     * @brief Owning, copyable handle to a discpp::Slab.
+     */
+    class SlabHandle {
+    public:
+        SlabHandle() : slab(Slab::Create()) {}
+        SlabHandle(const SlabHandle& other) noexcept : slab(other.slab) { slab->Retain(); }
+        SlabHandle& operator=(const SlabHandle& other) noexcept {
+            if (slab != other.slab) {
+                other.slab->Retain();
+                slab->Release();
+                slab = other.slab;
+            }
+
+            return *this;
+        }
+        ~SlabHandle() { slab->Release(); }
+
+        Slab* Get() const noexcept { return slab; }
+    private:
+        Slab* slab;
+    };
+
+    /**
+     * @brief Standard allocator that takes single objects from a discpp::Slab.
+     *
+     * Meant for `std::allocate_shared`, so an object and its control block share one slab block.
+     *
+     * ```cpp
+     *      auto member = std::allocate_shared<discpp::Member>(discpp::SlabAllocator<discpp::Member>(slab.Get()), json, guild);
+     * ```
+     */
+    template <typename T>
+    class SlabAllocator {
+    public:
+        using value_type = T;
+
+        explicit SlabAllocator(Slab* slab) noexcept : slab(slab) {}
+
+        template <typename U>
+        SlabAllocator(const SlabAllocator<U>& other) noexcept : slab(other.slab) {}
+
+        T* allocate(std::size_t n) {
+            if (n == 1) return static_cast<T*>(slab->Allocate(sizeof(T), alignof(T)));
+
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        }
+
+        void deallocate(T* ptr, std::size_t n) noexcept {
+            if (n == 1) {
+                slab->Deallocate(ptr, sizeof(T), alignof(T));
+            } else {
+                ::operator delete(ptr);
+            }
+        }
+
+        template <typename U>
+        bool operator==(const SlabAllocator<U>& other) const noexcept { return slab == other.slab; }
+
+        template <typename U>
+        bool operator!=(const SlabAllocator<U>& other) const noexcept { return slab != other.slab; }
+    private:
+        template <typename U> friend class SlabAllocator;
+
+        Slab* slab;
+    };
+}
+
+#endif //DISCPP_SLAB_H
@@ -0,0 +1,196 @@
+#ifndef DISCPP_SMALL_VECTOR_H
+#define DISCPP_SMALL_VECTOR_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace discpp {
+    /**
+     * @brief A vector of trivially copyable values with inline storage for the first `N` elements.
+     *
+     * It only allocates once it grows past `N`. Member role lists almost always fit inline, which
+     * saves the separate heap block that std::vector needs for every member.
+     *
+     * ```cpp
+     *      discpp::SmallVector<discpp::Snowflake, 4> roles;
+     *      roles.push_back(role_id);
+     * ```
+     */
+    template <typename T, std::size_t N>
+    class SmallVector {
+        static_assert(std::is_trivially_copyable<T>::value, "SmallVector only supports trivially copyable types");
+        static_assert(N > 0, "SmallVector needs inline capacity");
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+        using iterator = T*;
+        using const_iterator = const T*;
+        using reference = T&;
+        using const_reference = const T&;
+
+        static constexpr size_type inline_capacity = N; /**< How many elements are stored without a heap allocation. */
+
+        SmallVector() noexcept : length(0), capacity_(N) {}
+
+        SmallVector(std::initializer_list<T> init) : SmallVector() {
+            reserve(init.size());
+            for (const T& value : init) push_back(value);
+        }
+
+        SmallVector(const SmallVector& other) : SmallVector() {
+            reserve(other.length);
+            std::memcpy(data(), other.data(), other.length * sizeof(T));
+            length = other.length;
+        }
+
+        SmallVector(SmallVector&& other) noexcept : SmallVector() {
+            MoveFrom(other);
+        }
+
+        ~SmallVector() {
+            if (IsHeap()) std::free(storage.heap);
+        }
+
+        SmallVector& operator=(const SmallVector& other) {
+            if (this != &other) {
+                clear();
+                reserve(other.length);
+                std::memcpy(data(), other.data(), other.length * sizeof(T));
+                length = other.length;
+            }
+
+            return *this;
+        }
+
+        SmallVector& operator=(SmallVector&& other) noexcept {
+            if (this != &other) {
+                if (IsHeap()) std::free(storage.heap);
+                length = 0;
+                capacity_ = N;
+
+                MoveFrom(other);
+            }
+
+            return *this;
+        }
+
+        T* data() noexcept { return IsHeap() ? storage.heap : reinterpret_cast<T*>(storage.inline_data); }
+        const T* data() const noexcept { return IsHeap() ? storage.heap : reinterpret_cast<const T*>(storage.inline_data); }
+
+        iterator begin() noexcept { return data(); }
+        iterator end() noexcept { return data() + length; }
+        const_iterator begin() const noexcept { return data(); }
+        const_iterator end() const noexcept { return data() + length; }
+        const_iterator cbegin() const noexcept { return begin(); }
+        const_iterator cend() const noexcept { return end(); }
+
+        size_type size() const noexcept { return length; }
+        size_type capacity() const noexcept { return capacity_; }
+        bool empty() const noexcept { return length == 0; }
+
+        reference operator[](size_type i) { return data()[i]; }
+        const_reference operator[](size_type i) const { return data()[i]; }
+
+        reference at(size_type i) {
+            if (i >= length) throw std::out_of_range("SmallVector::at");
+            return data()[i];
+        }
+
+        const_reference at(size_type i) const {
+            if (i >= length) throw std::out_of_range("SmallVector::at");
+            return data()[i];
+        }
+
+        reference front() { return data()[0]; }
+        const_reference front() const { return data()[0]; }
+        reference back() { return data()[length - 1]; }
+        const_reference back() const { return data()[length - 1]; }
+
+        void reserve(size_type new_capacity) {
+            if (new_capacity <= capacity_) return;
+
+            T* heap = static_cast<T*>(std::malloc(new_capacity * sizeof(T)));
+            if (heap == nullptr) throw std::bad_alloc();
+
+            std::memcpy(heap, data(), length * sizeof(T));
+            if (IsHeap()) std::free(storage.heap);
+
+            storage.heap = heap;
+            capacity_ = static_cast<uint32_t>(new_capacity);
+        }
+
+        void push_back(const T& value) {
+            if (length == capacity_) {
+                // Copy first, since value may point into our own storage.
+                T copy = value;
+                reserve(capacity_ * 2);
+                data()[length++] = copy;
+            } else {
+                data()[length++] = value;
+            }
+        }
+
+        template <typename... Args>
+        reference emplace_back(Args&&... args) {
+            push_back(T(std::forward<Args>(args)...));
+            return back();
+        }
+
+        void pop_back() { length--; }
+
+        iterator erase(const_iterator pos) {
+            return erase(pos, pos + 1);
+        }
+
+        iterator erase(const_iterator first, const_iterator last) {
+            T* begin_ptr = data();
+            size_type from = static_cast<size_type>(first - begin_ptr);
+            size_type count = static_cast<size_type>(last - first);
+
+            std::memmove(begin_ptr + from, begin_ptr + from + count, (length - from - count) * sizeof(T));
+            length -= static_cast<uint32_t>(count);
+
+            return begin_ptr + from;
+        }
+
+        void clear() noexcept { length = 0; }
+
+        bool operator==(const SmallVector& other) const {
+            return length == other.length && std::equal(begin(), end(), other.begin());
+        }
+
+        bool operator!=(const SmallVector& other) const { return !(*this == other); }
+    private:
+        bool IsHeap() const noexcept { return capacity_ > N; }
+
+        void MoveFrom(SmallVector& other) noexcept {
+            if (other.IsHeap()) {
+                storage.heap = other.storage.heap;
+                capacity_ = other.capacity_;
+            } else {
+                std::memcpy(storage.inline_data, other.storage.inline_data, other.length * sizeof(T));
+            }
+
+            length = other.length;
+            other.length = 0;
+            other.capacity_ = N;
+        }
+
+        union Storage {
+            T* heap;
+            alignas(T) unsigned char inline_data[N * sizeof(T)];
+        } storage;
+
+        uint32_t length;
+        uint32_t capacity_;
+    };
+}
+
+#endif //DISCPP_SMALL_VECTOR_H
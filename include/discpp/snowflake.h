@@ -1,7 +1,10 @@
 #ifndef DISCPP_SNOWFLAKE_H
 #define DISCPP_SNOWFLAKE_H
 
+#include <charconv>
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 namespace discpp {
     class Snowflake {
@@ -10,19 +13,56 @@ namespace discpp {
     public:
         constexpr Snowflake() noexcept : id(0) {}
         constexpr Snowflake(const uint64_t& snowflake) noexcept : id(snowflake) {}
-        explicit Snowflake(const std::string& snowflake) noexcept : id(std::stoll(snowflake)) {}
+        explicit Snowflake(std::string_view snowflake) noexcept : id(Parse(snowflake)) {}
         operator uint64_t() const { return id; }
         operator std::string() const { return std::to_string(id); }
+
+        /**
+         * @brief Parse a decimal snowflake without allocating.
+         *
+         * ```cpp
+         *      uint64_t id = discpp::Snowflake::Parse(json["id"].GetString());
+         * ```
+         *
+         * @param[in] snowflake The decimal digits of the snowflake.
+         *
+         * @return uint64_t, 0 if the string isn't a valid snowflake.
+         */
+        static uint64_t Parse(std::string_view snowflake) noexcept {
+            uint64_t out = 0;
+            auto result = std::from_chars(snowflake.data(), snowflake.data() + snowflake.size(), out);
+
+            return result.ec == std::errc() ? out : 0;
+        }
+    };
+
+    /**
+     * @brief Hash for snowflakes.
+     *
+     * Snowflakes keep a timestamp in their high bits and a counter in their low bits, so they are far
+     * from uniform. Mixing every bit into the result keeps hash tables and shards evenly loaded.
+     */
+    struct SnowflakeHash {
+        std::size_t operator()(const Snowflake& k) const noexcept {
+            uint64_t h = k;
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            h *= 0xc4ceb9fe1a85ec53ULL;
+            h ^= h >> 33;
+
+            return static_cast<std::size_t>(h);
+        }
     };
 }
 
 namespace std {
     template <>
     struct hash<discpp::Snowflake> {
-        std::size_t operator()(const discpp::Snowflake& k) const {
-            return hash<uint64_t>()(k);
+        std::size_t operator()(const discpp::Snowflake& k) const noexcept {
+            return discpp::SnowflakeHash()(k);
         }
     };
 }
 
-#endif
\ No newline at end of file
+#endif
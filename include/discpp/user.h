@@ -73,6 +73,36 @@ namespace discpp {
          */
 		User(rapidjson::Document& json);
 
+        /**
+         * @brief Updates this user with the fields that are present in the json.
+         *
+         * Used on copies of cached users with partial user objects, like the ones in PRESENCE_UPDATE.
+         *
+         * ```cpp
+         *      bool changed = user.Update(json);
+         * ```
+         *
+         * @param[in] json The json of the (partial) user object.
+         *
+         * @return bool, true if any field changed.
+         */
+        bool Update(rapidjson::Document& json);
+
+        /**
+         * @brief Check if updating this user with the json would change any field.
+         *
+         * Lets the cache keep its record when a partial user object only repeats what it already has.
+         *
+         * ```cpp
+         *      if (user->WouldChange(json)) user = updated_copy;
+         * ```
+         *
+         * @param[in] json The json of the (partial) user object.
+         *
+         * @return bool, true if Update would change any field.
+         */
+        [[nodiscard]] bool WouldChange(rapidjson::Document& json) const;
+
         /**
          * @brief Create a DM channel with this user.
          *
@@ -149,7 +179,7 @@ namespace discpp {
 		// int public_flags; // Is this ever needed?
     private:
         unsigned char flags = 0b0;
-        unsigned short discriminator;
+        unsigned short discriminator = 0;
 
         uint64_t avatar_hex[2] = {0, 0};
         bool is_avatar_gif = false;
@@ -8,9 +8,12 @@
 #include <rapidjson/document.h>
 
 #include "discord_object.h"
+#include "flat_hash_map.h"
 
 #include <cpr/cpr.h>
 
+#include <chrono>
+#include <string_view>
 #include <unordered_map>
 #include <climits>
 
@@ -20,6 +23,7 @@ namespace discpp {
 
 	namespace globals {
 		inline discpp::Client* client_instance;
+		inline std::string api_base_url = "https://discordapp.com/api/v6"; /**< Set from `ClientConfig::rest_proxy_url` to send REST requests through a discpp::RestProxy. */
 	}
 
 	namespace specials {
@@ -81,7 +85,7 @@ namespace discpp {
 
 	inline std::string Endpoint(const std::string& endpoint_format) {
 		std::string tmp = endpoint_format[0] == '/' ? endpoint_format : '/' + endpoint_format;
-		return "https://discordapp.com/api/v6" + tmp;
+		return globals::api_base_url + tmp;
 	}
 
 	template <typename type>
@@ -96,13 +100,8 @@ namespace discpp {
 
 	inline discpp::Snowflake GetIDSafely(rapidjson::Document& json, const char* value_name) {
         rapidjson::Value::ConstMemberIterator itr = json.FindMember(value_name);
-        if (itr != json.MemberEnd()) {
-            if (!json[value_name].IsNull()) {
-                rapidjson::Document t_doc;
-                t_doc.CopyFrom(json[value_name], t_doc.GetAllocator());
-
-                return discpp::Snowflake(std::string(t_doc.GetString()));
-            }
+        if (itr != json.MemberEnd() && itr->value.IsString()) {
+            return discpp::Snowflake(std::string_view(itr->value.GetString(), itr->value.GetStringLength()));
         }
 
         return 0;
@@ -159,53 +158,13 @@ namespace discpp {
     std::string DumpJson(rapidjson::Value& json);
     std::unique_ptr<rapidjson::Document> GetDocumentInsideJson(rapidjson::Document &json, const char* value_name);
 
-	// Rate limits
-	struct RateLimit {
-		int limit = 500;
-		int remaining_limit = 500;
-		double ratelimit_reset = 0;
-	};
-
+	// Rate limits, requests are scheduled by discpp::RateLimiter.
 	enum RateLimitBucketType : int {
 		CHANNEL,
 		GUILD,
 		WEBHOOK,
 		GLOBAL
 	};
-
-	inline std::unordered_map<Snowflake, RateLimit> guild_ratelimit;
-	inline std::unordered_map<Snowflake, RateLimit> channel_ratelimit;
-	inline std::unordered_map<Snowflake, RateLimit> webhook_ratelimit;
-	inline RateLimit global_ratelimit;
-
-    /**
-     * @brief Wait for rate limits.
-     *
-     * ```cpp
-     *      discpp::WaitForRateLimits(message.id, discpp::RateLimitBucketType::CHANNEL);
-     * ```
-     *
-     * @param[in] object The object id.
-     * @param[in] ratelimit_bucket The rate limit bucket.
-     *
-     * @return int
-     */
-	int WaitForRateLimits(const Snowflake& object, const RateLimitBucketType& ratelimit_bucket);
-
-    /**
-     * @brief Handle rate limites
-     *
-     * ```cpp
-     *      discpp::HandleRateLimits(header, id, bucket);
-     * ```
-     *
-     * @param[in] header The headers to get the wait rate limit from.
-     * @param[in] object The object id.
-     * @param[in] ratelimit_bucket The rate limit bucket.
-     *
-     * @return int
-     */
-	void HandleRateLimits(cpr::Header& header, const Snowflake& object, const RateLimitBucketType& ratelimit_bucket);
 	// End of rate limits
 
     /**
@@ -226,6 +185,9 @@ namespace discpp {
     /**
      * @brief Sends a get request to a url.
      *
+     * Concurrent get requests to the same url without a body share one request. The callers that
+     * joined an in flight request get a copy of its parsed response, or its exception.
+     *
      * ```cpp
      *      rapidjson::Document response = discpp::SendGetRequest(url, discpp::DefaultHeaders(), object, discpp::RateLimitBucketType::CHANNEL, {});
      * ```
@@ -310,6 +272,8 @@ namespace discpp {
     /**
      * @brief Gets the default headers to communicate with the discpp servers.
      *
+     * The Authorization header carries the token of the client, and is left out while there is no client.
+     *
      * ```cpp
      *      cpr::Header default_headers = discpp::DefaultHeaders({});
      * ```
@@ -379,6 +343,8 @@ namespace discpp {
     /**
      * @brief Encode Base64.
      *
+     * Uses AVX2 or SSSE3 when the CPU supports them.
+     *
      * ```cpp
      *		std::string encodedStuff = Base64Encode("text");
      * ```
@@ -387,7 +353,34 @@ namespace discpp {
      *
      * @return std::string
      */
-	std::string Base64Encode(const std::string& text);
+	std::string Base64Encode(std::string_view text);
+
+    /**
+     * @brief Encode Base64 into a buffer of at least discpp::Base64EncodedSize(size) bytes.
+     *
+     * ```cpp
+     *      std::string data_uri = "data:image/png;base64,";
+     *      std::size_t prefix = data_uri.size();
+     *      data_uri.resize(prefix + discpp::Base64EncodedSize(size));
+     *      discpp::Base64Encode(data, size, &data_uri[prefix]);
+     * ```
+     *
+     * @param[in] data The bytes to encode.
+     * @param[in] size The amount of bytes to encode.
+     * @param[out] out Where the encoded text is written, it isn't null terminated.
+     *
+     * @return char*, the end of the encoded text.
+     */
+	char* Base64Encode(const void* data, std::size_t size, char* out);
+
+    /**
+     * @brief Get the length of the Base64 encoding of `size` bytes, padding included.
+     *
+     * @param[in] size The amount of bytes to encode.
+     *
+     * @return std::size_t
+     */
+	std::size_t Base64EncodedSize(std::size_t size);
 
     /**
      * @brief Replace all occurences of sub strings
@@ -403,12 +396,13 @@ namespace discpp {
 	std::string ReplaceAll(const std::string& data, const std::string& to_search, const std::string& replace_str);
 
     /**
-     * @brief Escape strings for discpp json endpoints and cpr body
+     * @brief Escape a string to be put between the quotes of a json string.
+     *
+     * Don't escape strings that go into a rapidjson document or a discpp::JsonWriter, those escape them
+     * when they are written.
      *
      * ```cpp
-     *      std::string raw_text = "{\"content\":\"" + EscapeString(text) + (tts ? "\",\"tts\":\"true\"" : "\"") + "}";
-     *		cpr::Body body = cpr::Body(raw_text);
-     *		std::unique_ptr<rapidjson::Document> result = SendPostRequest(Endpoint("/channels/%/messages", id), DefaultHeaders({ { "Content-Type", "application/json" } }), id, RateLimitBucketType::CHANNEL, body);
+     *      cpr::Body body("{\"reason\": \"" + EscapeString(reason) + "\"}");
      * ```
      *
      * @param[in] string The string to escape.
@@ -417,7 +411,38 @@ namespace discpp {
      */
 	std::string EscapeString(const std::string& string);
 
-	time_t TimeFromDiscord(const std::string& time);
+    /**
+     * @brief Parse an ISO-8601 timestamp sent by Discord to a UTC time point.
+     *
+     * Accepts `YYYY-MM-DDTHH:MM:SS` with optional fractional seconds and an optional `Z` or `+HH:MM`
+     * offset. The parser doesn't allocate and doesn't call into libc's time functions.
+     *
+     * ```cpp
+     *      std::chrono::system_clock::time_point timestamp = discpp::TimePointFromDiscord(json["timestamp"].GetString());
+     * ```
+     *
+     * @param[in] time The timestamp to parse.
+     *
+     * @throws std::runtime_error If the timestamp is malformed.
+     *
+     * @return std::chrono::system_clock::time_point, with millisecond precision.
+     */
+    std::chrono::system_clock::time_point TimePointFromDiscord(std::string_view time);
+
+    /**
+     * @brief Parse an ISO-8601 timestamp sent by Discord to UTC seconds since the epoch.
+     *
+     * ```cpp
+     *      time_t joined_at = discpp::TimeFromDiscord(json["joined_at"].GetString());
+     * ```
+     *
+     * @param[in] time The timestamp to parse.
+     *
+     * @throws std::runtime_error If the timestamp is malformed.
+     *
+     * @return time_t
+     */
+	time_t TimeFromDiscord(std::string_view time);
 	time_t TimeFromSnowflake(const Snowflake& snow);
     std::string FormatTime(const time_t& time, const std::string& format = "%F @ %r %Z");
 	std::string URIEncode(const std::string& str);
@@ -23,6 +23,19 @@ namespace discpp {
 	    Webhook(rapidjson::Document& json);
 		Webhook(const Snowflake& id, const std::string& token);
 
+		/**
+		 * @brief Send a message through this webhook.
+		 *
+		 * Files are uploaded by discpp::RestEngine and waited for, so sending them throws
+		 * discpp::exceptions::LoopThreadException on its loop thread, where waiting would never return.
+		 *
+		 * @param[in] text The message text.
+		 * @param[in] tts Should it be a text to speech message?
+		 * @param[in] embed Embed to send
+		 * @param[in] files Files to send
+		 *
+		 * @return discpp::Message
+		 */
 		discpp::Message Send(const std::string& text, const bool tts = false, discpp::EmbedBuilder* embed = nullptr, const std::vector<discpp::File>& files = {});
 		void EditName(std::string& name);
 		void Remove();
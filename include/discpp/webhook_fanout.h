@@ -0,0 +1,91 @@
+#ifndef DISCPP_WEBHOOK_FANOUT_H
+#define DISCPP_WEBHOOK_FANOUT_H
+
+#include "webhook.h"
+#include "message.h"
+
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace discpp {
+    /**
+     * @brief The outcome of sending the message to one webhook, see discpp::WebhookFanout.
+     */
+    struct WebhookSendResult {
+        Snowflake webhook_id;
+        std::exception_ptr error; /**< Set if the request failed, rethrow it to get the discpp exception. */
+        long status_code = 0; /**< 0 if no response was received. */
+        std::chrono::microseconds latency{0}; /**< From queueing the request to its response, including time spent waiting on the bucket. */
+        std::optional<discpp::Message> message; /**< The sent message, only with WebhookFanoutOptions::wait. */
+
+        bool Succeeded() const { return error == nullptr; }
+    };
+
+    struct WebhookFanoutOptions {
+        std::size_t max_in_flight = 64; /**< Requests to queue at once, the rest start as they finish. */
+        bool wait = false; /**< Have Discord return the sent messages, which costs a parse per target. */
+
+        /**
+         * Called with every result as it arrives, in the order the responses come in, before Send returns.
+         *
+         * It runs on the loop thread of discpp::RestEngine. While it runs no other response is handled and no
+         * request is started, for this fan-out or any other REST request of the bot, so it must return quickly.
+         * Waiting on a REST request there, like sending a message, never returns.
+         */
+        std::function<void(const WebhookSendResult&)> on_result;
+    };
+
+    /**
+     * @brief Sends one message to many webhooks concurrently.
+     *
+     * The body is serialized once. Every webhook has its own rate limit bucket, so the requests don't wait on
+     * each other and are sent together over the REST engine's pooled connections.
+     *
+     * ```cpp
+     *      discpp::WebhookFanout fanout("Relayed message");
+     *      for (const discpp::WebhookSendResult& result : fanout.Send(webhooks)) {
+     *          if (!result.Succeeded()) std::cout << "Failed to relay to " << result.webhook_id << "\n";
+     *      }
+     * ```
+     */
+    class WebhookFanout {
+    public:
+        /**
+         * @brief Prepares a message to send to webhooks.
+         *
+         * @param[in] text The message text, must be shorter than 2000 characters.
+         * @param[in] tts Whether the message is text to speech.
+         * @param[in] embed An optional embed to send with the message.
+         *
+         * @return discpp::WebhookFanout, this is a constructor.
+         */
+        WebhookFanout(const std::string& text, const bool tts = false, const discpp::EmbedBuilder* embed = nullptr);
+
+        /**
+         * @brief Send the message to every webhook and wait for all of them.
+         *
+         * A failed webhook only fails its own result, the others are still sent. Waiting on the loop thread of
+         * discpp::RestEngine would never return, so this throws discpp::exceptions::LoopThreadException there.
+         *
+         * @param[in] webhooks The webhooks to send to.
+         * @param[in] options How to send.
+         *
+         * @return std::vector<discpp::WebhookSendResult>, in the order of `webhooks`.
+         */
+        std::vector<WebhookSendResult> Send(const std::vector<discpp::Webhook>& webhooks, const WebhookFanoutOptions& options = {}) const;
+    private:
+        struct State;
+
+        static void Dispatch(const std::shared_ptr<State>& state, std::size_t index);
+
+        std::string body;
+    };
+}
+
+#endif //DISCPP_WEBHOOK_FANOUT_H
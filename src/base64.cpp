@@ -0,0 +1,126 @@
+#include "utils.h"
+
+#include <cstdint>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define DISCPP_BASE64_X86 1
+#include <immintrin.h>
+#endif
+
+namespace discpp {
+    namespace {
+        constexpr char base64_chars[] =
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+            "abcdefghijklmnopqrstuvwxyz"
+            "0123456789+/";
+
+        char* EncodeScalar(const uint8_t* in, std::size_t size, char* out) {
+            for (; size >= 3; size -= 3, in += 3) {
+                uint32_t triple = (uint32_t(in[0]) << 16) | (uint32_t(in[1]) << 8) | in[2];
+                *out++ = base64_chars[(triple >> 18) & 0x3f];
+                *out++ = base64_chars[(triple >> 12) & 0x3f];
+                *out++ = base64_chars[(triple >> 6) & 0x3f];
+                *out++ = base64_chars[triple & 0x3f];
+            }
+
+            if (size > 0) {
+                uint32_t triple = (uint32_t(in[0]) << 16) | (size == 2 ? uint32_t(in[1]) << 8 : 0);
+                *out++ = base64_chars[(triple >> 18) & 0x3f];
+                *out++ = base64_chars[(triple >> 12) & 0x3f];
+                *out++ = size == 2 ? base64_chars[(triple >> 6) & 0x3f] : '=';
+                *out++ = '=';
+            }
+
+            return out;
+        }
+
+#ifdef DISCPP_BASE64_X86
+        // Vectorized encoding after Wojciech Muła's SSE and AVX2 base64 encoders. Every 16 byte lane turns 12 input
+        // bytes into 16 six bit indices, which are then mapped to their characters with an offset lookup.
+        __attribute__((target("ssse3"))) inline __m128i SplitSSSE3(__m128i in) {
+            in = _mm_shuffle_epi8(in, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+
+            __m128i high = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+            __m128i low = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+
+            return _mm_or_si128(high, low);
+        }
+
+        __attribute__((target("ssse3"))) inline __m128i LookupSSSE3(__m128i indices) {
+            // 0-25 map to offset 13, 26-51 to 0, 52-61 to 1-10, 62 to 11 and 63 to 12.
+            __m128i offsets = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+            __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+            offsets = _mm_or_si128(offsets, _mm_and_si128(upper, _mm_set1_epi8(13)));
+
+            const __m128i shift = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+            return _mm_add_epi8(_mm_shuffle_epi8(shift, offsets), indices);
+        }
+
+        __attribute__((target("ssse3"))) char* EncodeSSSE3(const uint8_t* in, std::size_t size, char* out) {
+            // Each step loads 16 bytes but only consumes 12.
+            for (; size >= 16; size -= 12, in += 12, out += 16) {
+                __m128i indices = SplitSSSE3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out), LookupSSSE3(indices));
+            }
+
+            return EncodeScalar(in, size, out);
+        }
+
+        __attribute__((target("avx2"))) char* EncodeAVX2(const uint8_t* in, std::size_t size, char* out) {
+            const __m256i shuffle = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+            const __m256i shift = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+                'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+            // Each step consumes 24 bytes, the second lane loads 16 bytes from 12 bytes in.
+            for (; size >= 28; size -= 24, in += 24, out += 32) {
+                __m256i data = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in))),
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 12)), 1);
+                data = _mm256_shuffle_epi8(data, shuffle);
+
+                __m256i high = _mm256_mulhi_epu16(_mm256_and_si256(data, _mm256_set1_epi32(0x0fc0fc00)), _mm256_set1_epi32(0x04000040));
+                __m256i low = _mm256_mullo_epi16(_mm256_and_si256(data, _mm256_set1_epi32(0x003f03f0)), _mm256_set1_epi32(0x01000010));
+                __m256i indices = _mm256_or_si256(high, low);
+
+                __m256i offsets = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+                __m256i upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+                offsets = _mm256_or_si256(offsets, _mm256_and_si256(upper, _mm256_set1_epi8(13)));
+
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_add_epi8(_mm256_shuffle_epi8(shift, offsets), indices));
+            }
+
+            return EncodeSSSE3(in, size, out);
+        }
+#endif
+
+        using Encoder = char* (*)(const uint8_t*, std::size_t, char*);
+
+        Encoder PickEncoder() {
+#ifdef DISCPP_BASE64_X86
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2")) return &EncodeAVX2;
+            if (__builtin_cpu_supports("ssse3")) return &EncodeSSSE3;
+#endif
+            return &EncodeScalar;
+        }
+    }
+
+    std::size_t Base64EncodedSize(std::size_t size) {
+        return (size + 2) / 3 * 4;
+    }
+
+    char* Base64Encode(const void* data, std::size_t size, char* out) {
+        static const Encoder encode = PickEncoder();
+        return encode(static_cast<const uint8_t*>(data), size, out);
+    }
+
+    std::string Base64Encode(std::string_view text) {
+        std::string encoded(Base64EncodedSize(text.size()), '\0');
+        Base64Encode(text.data(), text.size(), &encoded[0]);
+
+        return encoded;
+    }
+}
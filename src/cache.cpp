@@ -7,55 +7,121 @@
 #include "cache.h"
 #include "exceptions.h"
 #include "utils.h"
+#include "client.h"
+#include "client_config.h"
+#include "role.h"
+#include "presence.h"
+#include "permission.h"
+#include "rest_engine.h"
+#include "rate_limiter.h"
+
+#include <algorithm>
+
+std::shared_ptr<discpp::Guild> discpp::Cache::FindGuild(const discpp::Snowflake& guild_id) const {
+    std::shared_ptr<discpp::Guild> guild;
+    guilds.Get(guild_id, guild);
+
+    return guild;
+}
+
+std::optional<discpp::Channel> discpp::Cache::FindChannel(const discpp::Snowflake& id) const {
+    std::optional<discpp::Channel> channel = FindDMChannel(id);
+    if (channel) {
+        return channel;
+    }
+
+    discpp::Snowflake guild_id;
+    std::shared_ptr<discpp::Guild> guild;
+    if (channel_guilds.Get(id, guild_id) && guilds.Get(guild_id, guild)) {
+        return guild->FindChannel(id);
+    }
+
+    return std::nullopt;
+}
+
+std::optional<discpp::Channel> discpp::Cache::FindDMChannel(const discpp::Snowflake& id) const {
+    discpp::Channel channel;
+    if (private_channels.Get(id, channel)) {
+        return channel;
+    }
+
+    return std::nullopt;
+}
+
+std::shared_ptr<discpp::Member> discpp::Cache::FindMember(const discpp::Snowflake& guild_id, const discpp::Snowflake& id) const {
+    std::shared_ptr<discpp::Guild> guild = FindGuild(guild_id);
+
+    return guild != nullptr ? guild->FindMember(id) : nullptr;
+}
+
+std::shared_ptr<discpp::User> discpp::Cache::FindUser(const discpp::Snowflake& id) const {
+    std::shared_ptr<discpp::User> user;
+    users.Get(id, user);
+
+    return user;
+}
 
 std::shared_ptr<discpp::Guild> discpp::Cache::GetGuild(const discpp::Snowflake &guild_id, bool can_request) {
-    auto it = guilds.find(guild_id);
-    if (it != guilds.end()) {
-        return it->second;
+    std::shared_ptr<discpp::Guild> guild = FindGuild(guild_id);
+    if (guild != nullptr) {
+        return guild;
     }
 
     if (can_request) {
         std::unique_ptr<rapidjson::Document> result = SendGetRequest(Endpoint("/guilds/" + std::to_string(guild_id)), DefaultHeaders(), guild_id, RateLimitBucketType::GUILD);
-        auto guild = std::make_shared<discpp::Guild>(*result);
-        guilds.emplace(guild->id, guild);
+        guild = std::make_shared<discpp::Guild>(*result);
+
+        // Callers that shared the request each built a guild, they all get the one that made it into the cache.
+        if (!guilds.Insert(guild->id, guild)) {
+            guilds.Get(guild->id, guild);
+        }
         return guild;
     } else {
         throw exceptions::DiscordObjectNotFound("Guild not found of id: " + std::to_string(guild_id));
     }
 }
 
+std::future<std::shared_ptr<discpp::Guild>> discpp::Cache::GetGuildAsync(const discpp::Snowflake &guild_id) {
+    std::shared_ptr<discpp::Guild> guild = FindGuild(guild_id);
+    if (guild != nullptr) {
+        std::promise<std::shared_ptr<discpp::Guild>> promise;
+        promise.set_value(guild);
+        return promise.get_future();
+    }
+
+    return SendRequestAsync<std::shared_ptr<discpp::Guild>>("GET", Endpoint("/guilds/" + std::to_string(guild_id)), DefaultHeaders(), guild_id,
+        RateLimitBucketType::GUILD, {}, [this](rapidjson::Document& json) {
+            auto requested = std::make_shared<discpp::Guild>(json);
+            guilds.Insert(requested->id, requested);
+            return requested;
+        });
+}
+
 discpp::Channel discpp::Cache::GetChannel(const discpp::Snowflake &id, bool can_request) {
-    try {
-        return GetDMChannel(id, can_request);
-    } catch (exceptions::DiscordObjectNotFound) {
-        for (const auto &guild : guilds) {
-            try {
-                discpp::Channel channel = guild.second->GetChannel(id);
-
-                if (channel.id != 0) return channel;
-            } catch (exceptions::DiscordObjectNotFound) {}
-        }
+    std::optional<discpp::Channel> channel = FindChannel(id);
+    if (channel) {
+        return *channel;
+    }
 
-        if (can_request) {
-            std::unique_ptr<rapidjson::Document> result = SendGetRequest(Endpoint("/channels/" + std::to_string(id)), DefaultHeaders(), id, RateLimitBucketType::CHANNEL);
-            return discpp::Channel(*result);
-        } else {
-            throw exceptions::DiscordObjectNotFound("Channel not found of id: " + std::to_string(id));
-        }
+    if (can_request) {
+        std::unique_ptr<rapidjson::Document> result = SendGetRequest(Endpoint("/channels/" + std::to_string(id)), DefaultHeaders(), id, RateLimitBucketType::CHANNEL);
+        return discpp::Channel(*result);
+    } else {
+        throw exceptions::DiscordObjectNotFound("Channel not found of id: " + std::to_string(id));
     }
 }
 
 discpp::Channel discpp::Cache::GetDMChannel(const discpp::Snowflake &id, bool can_request) {
-    auto it = private_channels.find(id);
-    if (it != private_channels.end()) {
-        return it->second;
+    std::optional<discpp::Channel> cached = FindDMChannel(id);
+    if (cached) {
+        return *cached;
     }
 
     if (can_request) {
         std::unique_ptr<rapidjson::Document> result = SendGetRequest(Endpoint("/channels/" + std::to_string(id)), DefaultHeaders(), id, RateLimitBucketType::CHANNEL);
         discpp::Channel channel(*result);
 
-        private_channels.emplace(channel.id, channel);
+        private_channels.Insert(channel.id, channel);
         return channel;
     } else {
         throw exceptions::DiscordObjectNotFound("DM Channel not found of id: " + std::to_string(id));
@@ -63,33 +129,254 @@ discpp::Channel discpp::Cache::GetDMChannel(const discpp::Snowflake &id, bool ca
 }
 
 std::shared_ptr<discpp::Member> discpp::Cache::GetMember(const discpp::Snowflake& guild_id, const discpp::Snowflake &id, bool can_request) {
-    auto it = members.find(id);
-    if (it != members.end()) {
-        return it->second;
-    }
-
-    if (can_request) {
-        std::unique_ptr<rapidjson::Document> result = SendGetRequest(Endpoint("/guilds/" + std::to_string(guild_id) + "/members/" + std::to_string(id)), DefaultHeaders(), guild_id, RateLimitBucketType::GUILD);
-        auto member = std::make_shared<discpp::Member>(*result, guild_id);
-        members.emplace(member->user.id, member);
-        return member;
-    } else {
-        throw exceptions::DiscordObjectNotFound("Member not found of id: " + std::to_string(guild_id) + ", in guild of id: " + std::to_string(guild_id));
-    }
+    // Members are only unique per guild, so they are cached in their guild.
+    return GetGuild(guild_id, can_request)->GetMember(id, can_request);
 }
 
 discpp::Message discpp::Cache::GetDiscordMessage(const discpp::Snowflake &channel_id, const discpp::Snowflake &id, bool can_request) {
-    auto message = messages.find(id);
-    if (message != messages.end()) {
-        return *message->second;
+    std::shared_ptr<discpp::Message> message;
+    if (messages.Get(id, message)) {
+        return *message;
     }
 
     if (can_request) {
         std::unique_ptr<rapidjson::Document> result = SendGetRequest(Endpoint("/channels/" + std::to_string(channel_id) + "/messages/" + std::to_string(id)),
             DefaultHeaders(), channel_id, RateLimitBucketType::CHANNEL);
 
-        return Message(*result);
+        auto message = std::make_shared<discpp::Message>(*result);
+        messages.Insert(message);
+        return *message;
     } else {
         throw exceptions::DiscordObjectNotFound("Message of id \"" + std::to_string(id) + "\" was not found!");
     }
 }
+
+std::shared_ptr<discpp::User> discpp::Cache::GetUser(const discpp::Snowflake& id, bool can_request) {
+    std::shared_ptr<discpp::User> user = FindUser(id);
+    if (user != nullptr) {
+        return user;
+    }
+
+    if (can_request) {
+        std::unique_ptr<rapidjson::Document> result = SendGetRequest(Endpoint("/users/" + std::to_string(id)), DefaultHeaders(), 0, RateLimitBucketType::GLOBAL);
+        return InternUser(*result);
+    } else {
+        throw exceptions::DiscordObjectNotFound("User not found of id: " + std::to_string(id));
+    }
+}
+
+std::shared_ptr<discpp::User> discpp::Cache::InternUser(rapidjson::Document& json) {
+    discpp::Snowflake id = GetIDSafely(json, "id");
+    if (id == 0) {
+        return std::make_shared<discpp::User>(json);
+    }
+
+    std::shared_ptr<discpp::User> user = UpdateUser(json);
+    if (user != nullptr) {
+        return user;
+    }
+
+    user = std::make_shared<discpp::User>(json);
+    if (!users.Insert(id, user)) {
+        // Another thread interned the user first, so use its record.
+        std::shared_ptr<discpp::User> interned = UpdateUser(json);
+        if (interned != nullptr) user = interned;
+    }
+
+    return user;
+}
+
+std::shared_ptr<discpp::User> discpp::Cache::UpdateUser(rapidjson::Document& json) {
+    std::shared_ptr<discpp::User> user;
+    users.Update(GetIDSafely(json, "id"), [&json, &user](std::shared_ptr<discpp::User>& cached) {
+        // Most user objects repeat the cached record, so only copy it when a field actually changes.
+        if (cached->WouldChange(json)) {
+            std::shared_ptr<discpp::User> updated = std::make_shared<discpp::User>(*cached);
+            updated->Update(json);
+            cached = updated;
+        }
+
+        user = cached;
+    });
+
+    return user;
+}
+
+std::shared_ptr<discpp::Guild> discpp::Cache::RemoveGuild(const discpp::Snowflake& guild_id) {
+    std::shared_ptr<discpp::Guild> guild;
+    if (!guilds.Take(guild_id, guild)) {
+        return nullptr;
+    }
+
+    for (const auto& channel : *guild->channels) {
+        channel_guilds.Erase(channel.first);
+    }
+
+    std::vector<discpp::Snowflake> orphans;
+    orphans.reserve(guild->members->Size());
+    guild->members->ForEach([&orphans](const discpp::Snowflake& id, const std::shared_ptr<discpp::Member>&) {
+        orphans.push_back(id);
+    });
+
+    for (const std::shared_ptr<discpp::Guild>& other : guilds.Values()) {
+        if (orphans.empty()) break;
+
+        orphans.erase(std::remove_if(orphans.begin(), orphans.end(), [&other](const discpp::Snowflake& id) {
+            return other->members->Contains(id);
+        }), orphans.end());
+    }
+
+    for (const discpp::Snowflake& id : orphans) {
+        users.Erase(id);
+    }
+
+    return guild;
+}
+
+std::size_t discpp::Cache::PruneUsers() {
+    return users.EraseIf([](const discpp::Snowflake&, const std::shared_ptr<discpp::User>& user) {
+        return user.use_count() == 1;
+    });
+}
+
+namespace {
+    // Per entry cost of the sharded maps on top of the key and value: the control byte of its slot.
+    constexpr std::size_t map_slot_overhead = 1;
+
+    std::size_t StringBytes(const std::string& str) {
+        // Strings that fit the small string buffer don't allocate.
+        return str.capacity() > std::string().capacity() ? str.capacity() + 1 : 0;
+    }
+
+    std::size_t UserBytes(const discpp::User& user) {
+        return sizeof(discpp::User) + StringBytes(user.username);
+    }
+
+    std::size_t ChannelBytes(const discpp::Channel& channel) {
+        std::size_t bytes = sizeof(discpp::Channel) + StringBytes(channel.name) + StringBytes(channel.topic);
+        bytes += channel.permissions.capacity() * sizeof(discpp::Permissions);
+        bytes += channel.recipients.capacity() * sizeof(discpp::User);
+        for (const discpp::User& recipient : channel.recipients) {
+            bytes += StringBytes(recipient.username);
+        }
+
+        return bytes;
+    }
+
+    std::size_t MemberBytes(const discpp::Member& member) {
+        // The shared_ptr control block is allocated together with the member.
+        std::size_t bytes = sizeof(discpp::Member) + 2 * sizeof(long) + StringBytes(member.nick);
+        if (member.roles.capacity() > decltype(member.roles)::inline_capacity) bytes += member.roles.capacity() * sizeof(discpp::Snowflake);
+
+        if (member.presence != nullptr) {
+            bytes += sizeof(discpp::Presence) + StringBytes(member.presence->status);
+            bytes += member.presence->activities.capacity() * sizeof(discpp::Activity);
+            if (member.presence->game != nullptr) bytes += sizeof(discpp::Activity);
+        }
+
+        return bytes;
+    }
+
+    std::size_t EmojiBytes(const discpp::Emoji& emoji) {
+        return sizeof(discpp::Emoji) + StringBytes(emoji.name) + emoji.unicode.capacity() * sizeof(wchar_t) +
+            emoji.roles.capacity() * sizeof(discpp::Snowflake);
+    }
+
+    // Bytes of the slot array of a flat map, empty slots included. The values are counted by the caller.
+    template <typename Map>
+    std::size_t MapSlotBytes(const Map& map) {
+        return map.capacity() * (sizeof(typename Map::value_type) + map_slot_overhead) - map.size() * sizeof(typename Map::mapped_type);
+    }
+}
+
+discpp::CacheStats discpp::Cache::GetStats(bool per_guild) const {
+    discpp::CacheStats stats;
+
+    int shard_amount = 1;
+    if (globals::client_instance != nullptr && globals::client_instance->config != nullptr) {
+        shard_amount = std::max(globals::client_instance->config->shard_amount, 1);
+    }
+    stats.per_shard.resize(shard_amount);
+    for (int i = 0; i < shard_amount; i++) {
+        stats.per_shard[i].shard_id = i;
+    }
+
+    // Walk snapshots without the shard locks, so dispatcher threads aren't blocked on a large guild.
+    for (const std::shared_ptr<discpp::Guild>& guild : guilds.Values()) {
+        discpp::GuildCacheStats guild_stats;
+        guild_stats.guild_id = guild->id;
+        guild_stats.shard_id = static_cast<int>((static_cast<uint64_t>(guild->id) >> 22) % shard_amount);
+
+        guild_stats.guild.count = 1;
+        guild_stats.guild.bytes = sizeof(discpp::Guild) + sizeof(std::shared_ptr<discpp::Guild>) + map_slot_overhead +
+            StringBytes(guild->name) + StringBytes(guild->region) + StringBytes(guild->vanity_url_code) +
+            StringBytes(guild->description) + StringBytes(guild->preferred_locale) +
+            sizeof(std::vector<std::string>) + guild->features->capacity() * sizeof(std::string);
+        for (const std::string& feature : *guild->features) {
+            guild_stats.guild.bytes += StringBytes(feature);
+        }
+
+        // The member store is shared by every copy of the guild and changes under us, so count it in one pass.
+        guild_stats.members.bytes = sizeof(discpp::GuildMembers) +
+            guild->members->Capacity() * (sizeof(discpp::GuildMembers::MapType::value_type) + map_slot_overhead);
+        guild->members->ForEach([&guild_stats](const discpp::Snowflake&, const std::shared_ptr<discpp::Member>& member) {
+            guild_stats.members.count++;
+            guild_stats.members.bytes += MemberBytes(*member);
+        });
+
+        guild_stats.channels.count = guild->channels->size();
+        guild_stats.channels.bytes = sizeof(discpp::GuildChannels) + MapSlotBytes(*guild->channels);
+        for (const auto& channel : *guild->channels) {
+            guild_stats.channels.bytes += ChannelBytes(channel.second);
+        }
+
+        guild_stats.roles.count = guild->roles->size();
+        guild_stats.roles.bytes = sizeof(discpp::GuildRoles) + MapSlotBytes(*guild->roles) + guild->roles->size() * sizeof(std::shared_ptr<discpp::Role>);
+        for (const auto& role : *guild->roles) {
+            guild_stats.roles.bytes += sizeof(discpp::Role) + 2 * sizeof(long) + StringBytes(role.second->name);
+        }
+
+        guild_stats.emojis.count = guild->emojis->size();
+        guild_stats.emojis.bytes = sizeof(discpp::GuildEmojis) + MapSlotBytes(*guild->emojis);
+        for (const auto& emoji : *guild->emojis) {
+            guild_stats.emojis.bytes += EmojiBytes(emoji.second);
+        }
+
+        guild_stats.voice_states.count = guild->voice_states->size();
+        guild_stats.voice_states.bytes = sizeof(std::vector<discpp::VoiceState>) + guild->voice_states->capacity() * sizeof(discpp::VoiceState);
+        for (const discpp::VoiceState& voice_state : *guild->voice_states) {
+            guild_stats.voice_states.bytes += StringBytes(voice_state.session_id);
+        }
+
+        stats.guilds += guild_stats.guild;
+        stats.members += guild_stats.members;
+        stats.channels += guild_stats.channels;
+        stats.roles += guild_stats.roles;
+        stats.emojis += guild_stats.emojis;
+        stats.voice_states += guild_stats.voice_states;
+
+        discpp::ShardCacheStats& shard_stats = stats.per_shard[guild_stats.shard_id];
+        shard_stats.guilds++;
+        shard_stats.bytes += guild_stats.Bytes();
+
+        if (per_guild) stats.per_guild.push_back(guild_stats);
+    }
+
+    users.ForEach([&stats](const discpp::Snowflake&, const std::shared_ptr<discpp::User>& user) {
+        stats.users.count++;
+        stats.users.bytes += sizeof(discpp::Snowflake) + map_slot_overhead + sizeof(std::shared_ptr<discpp::User>) +
+            2 * sizeof(long) + UserBytes(*user);
+    });
+
+    private_channels.ForEach([&stats](const discpp::Snowflake&, const discpp::Channel& channel) {
+        stats.private_channels.count++;
+        stats.private_channels.bytes += sizeof(discpp::Snowflake) + map_slot_overhead + ChannelBytes(channel);
+    });
+
+    stats.messages.count = messages.Size();
+    stats.messages.bytes = messages.Bytes();
+
+    stats.ratelimit_buckets = { rate_limiter.BucketCount(), rate_limiter.Bytes() };
+
+    return stats;
+}
@@ -5,8 +5,31 @@
 #include "log.h"
 #include "guild.h"
 #include "exceptions.h"
+#include "rest_engine.h"
+#include "message_history.h"
+#include "purge.h"
+#include "json_writer.h"
 
 namespace discpp {
+    namespace {
+        std::string MessageBody(const std::string& text, const bool tts, const discpp::EmbedBuilder* embed) {
+            JsonWriter writer;
+            writer.StartObject();
+            writer.Key("content");
+            writer.String(text);
+            writer.Key("tts");
+            writer.Bool(tts);
+
+            if (embed != nullptr) {
+                writer.Key("embed");
+                embed->ToJson(writer);
+            }
+            writer.EndObject();
+
+            return writer.ToString();
+        }
+    }
+
 	Channel::Channel(const Snowflake& id, bool can_request) : discpp::DiscordObject(id) {
 		*this = globals::client_instance->cache.GetChannel(id, can_request);
 	}
@@ -61,73 +84,50 @@ namespace discpp {
 	}
 
 	discpp::Message Channel::Send(const std::string& text, const bool tts, discpp::EmbedBuilder* embed, std::vector<File> files) {
-        // Send a file filled with message contents if the message is more than 2000 characters.
-        if (text.size() >= 2000) {
-            // Write message to file
-            std::ofstream message("message.txt", std::ios::out | std::ios::binary);
-            message << text;
-            message.close();
-
-            // Ensure the file will be deleted even if it runs into an exception sending the file.
-            discpp::Message sent_message;
-            try {
-                // Send the message
-                std::vector<discpp::File> files;
-                files.push_back({ "message.txt", "message.txt" });
-                sent_message = Send("Message was too large to fit in 2000 characters", tts, nullptr, files);
-
-                // Delete the temporary message file
-                remove("message.txt");
-            } catch (const std::runtime_error& e) {
-                // Delete the temporary message file and then throw this exception again.
-                remove("message.txt");
-
-                throw std::runtime_error(e);
+        // Multipart uploads only go through the engine, wait for it here.
+        if (text.size() >= 2000 || !files.empty()) {
+            if (RestEngine::Instance().OnLoopThread()) {
+                throw exceptions::LoopThreadException("Channel::Send can't wait for an upload on the REST engine's thread, use Channel::SendAsync there");
             }
 
-            return sent_message;
+            return SendAsync(text, tts, embed, std::move(files)).get();
         }
 
-        rapidjson::Document message_json(rapidjson::kObjectType);
-        message_json.AddMember("content", text, message_json.GetAllocator());
-        message_json.AddMember("tts", tts, message_json.GetAllocator());
+        std::string message_json = MessageBody(text, tts, embed);
 
-        if (embed != nullptr) {
-            rapidjson::Value embed_value(rapidjson::kObjectType);
-            embed_value.CopyFrom(embed->embed_json, message_json.GetAllocator());
-
-            message_json.AddMember("embed", embed_value, message_json.GetAllocator());
-        }
-
-        if (!files.empty()) {
-            cpr::Multipart multipart_data{};
-
-            for (int i = 0; i < files.size(); i++) {
-                multipart_data.parts.emplace_back("file" + std::to_string(i), cpr::File(files[i].file_path), "application/octet-stream");
-            }
-
-            globals::client_instance->logger->Debug("Sending payload_json inside multipart data for files: " + DumpJson(message_json));
+        cpr::Body body(message_json);
+        std::unique_ptr<rapidjson::Document> result = SendPostRequest(Endpoint("/channels/" + std::to_string(id) + "/messages"), DefaultHeaders({ { "Content-Type", "application/json" } }), id, RateLimitBucketType::CHANNEL, body);
 
-            multipart_data.parts.emplace_back("payload_json", DumpJson(message_json));
+        return discpp::Message(*result);
+	}
 
-            WaitForRateLimits(id, RateLimitBucketType::CHANNEL);
+    std::future<discpp::Message> Channel::SendAsync(const std::string& text, const bool tts, discpp::EmbedBuilder* embed, std::vector<File> files) {
+        // Upload the message as a file if it is more than 2000 characters, straight from memory.
+        if (text.size() >= 2000) {
+            files.insert(files.begin(), discpp::File::FromBuffer("message.txt", text));
+            return SendAsync("Message was too large to fit in 2000 characters", tts, embed, std::move(files));
+        }
 
-            cpr::Response response = cpr::Post(cpr::Url{ Endpoint("/channels/" + std::to_string(id) + "/messages") }, DefaultHeaders({ {"Content-Type", "multipart/form-data"} }), multipart_data);
-            globals::client_instance->logger->Debug("Received requested payload: " + response.text);
+        std::string message_json = MessageBody(text, tts, embed);
 
-            HandleRateLimits(response.header, id, RateLimitBucketType::CHANNEL);
+        if (!files.empty()) {
+            globals::client_instance->logger->Debug("Sending payload_json inside multipart data for files: " + message_json);
 
-            rapidjson::Document result_json(rapidjson::kObjectType);
-            result_json.Parse(response.text);
+            RestEngine::Request request;
+            request.method = "POST";
+            request.url = Endpoint("/channels/" + std::to_string(id) + "/messages");
+            request.headers = DefaultHeaders();
+            request.body = message_json;
+            request.files = std::move(files);
 
-            return discpp::Message(result_json);
+            return SendRequestAsync<discpp::Message>(std::move(request), id, RateLimitBucketType::CHANNEL,
+                [](rapidjson::Document& json) { return discpp::Message(json); });
         }
 
-        cpr::Body body(DumpJson(message_json));
-        std::unique_ptr<rapidjson::Document> result = SendPostRequest(Endpoint("/channels/" + std::to_string(id) + "/messages"), DefaultHeaders({ { "Content-Type", "application/json" } }), id, RateLimitBucketType::CHANNEL, body);
-
-        return discpp::Message(*result);
-	}
+        cpr::Body body(message_json);
+        return SendRequestAsync<discpp::Message>("POST", Endpoint("/channels/" + std::to_string(id) + "/messages"), DefaultHeaders({ { "Content-Type", "application/json" } }),
+            id, RateLimitBucketType::CHANNEL, body, [](rapidjson::Document& json) { return discpp::Message(json); });
+    }
 
 	std::string ChannelPropertyToString(ChannelProperty prop) {
         std::unordered_map<ChannelProperty, std::string> prop_str_map = {
@@ -195,6 +195,14 @@ namespace discpp {
 		return messages;
 	}
 
+	discpp::MessageHistory<discpp::Message> Channel::RequestHistory(HistoryDirection direction, const Snowflake& start, std::size_t limit) const {
+	    return discpp::MessageHistory<discpp::Message>(id, direction, start, limit);
+	}
+
+	discpp::MessageHistory<discpp::MessageView> Channel::RequestHistoryViews(HistoryDirection direction, const Snowflake& start, std::size_t limit) const {
+	    return discpp::MessageHistory<discpp::MessageView>(id, direction, start, limit);
+	}
+
 	discpp::Message Channel::FindMessage(const Snowflake& message_id) {
 		std::unique_ptr<rapidjson::Document> result = SendGetRequest(Endpoint("/channels/" + std::to_string(id) + "/messages/" + std::to_string(message_id)), DefaultHeaders(), id, RateLimitBucketType::CHANNEL);
 
@@ -206,7 +214,7 @@ namespace discpp {
 	}
 
 	std::vector<discpp::Message> Channel::GetPinnedMessages() {
-        std::unique_ptr<rapidjson::Document> result = SendGetRequest(Endpoint("/channels/" + std::to_string(id) = "/pins"), DefaultHeaders(), {}, {});
+        std::unique_ptr<rapidjson::Document> result = SendGetRequest(Endpoint("/channels/" + std::to_string(id) + "/pins"), DefaultHeaders(), id, RateLimitBucketType::CHANNEL);
 
         std::vector<discpp::Message> messages;
         for (auto &message : result->GetArray()) {
@@ -228,19 +236,10 @@ namespace discpp {
             throw std::runtime_error("discpp::Channel::BulkDeleteMessage only available for guild channels!");
         }
 
-		std::string endpoint = Endpoint("/channels/" + std::to_string(id) + "/messages/bulk-delete");
-
-		std::string combined_message = "";
-		for (Snowflake message : messages) {
-			if (message == messages[0]) {
-				combined_message += "\"" + std::to_string(message) + "\"";
-			} else {
-				combined_message += ", \"" + std::to_string(message) + "\"";
-			}
-		}
+        discpp::PurgeOptions options;
+        options.stop_on_error = true;
 
-		cpr::Body body("{\"messages\": [" + combined_message + "]}");
-		std::unique_ptr<rapidjson::Document> result = SendPostRequest(endpoint, DefaultHeaders({ { "Content-Type", "application/json" } }), id, RateLimitBucketType::CHANNEL, body);
+        discpp::MessagePurger(id, options).PurgeIds(messages);
 	}
 
     void Channel::DeletePermission(const discpp::Permissions& permissions) {
@@ -314,7 +313,7 @@ namespace discpp {
         }
 
 	    std::unordered_map<discpp::Snowflake, discpp::Channel> tmp;
-	    for (auto const chnl : this->GetGuild()->channels) {
+	    for (auto const& chnl : *this->GetGuild()->channels) {
 	        if (chnl.second.category_id == this->id) {
                 tmp.insert({ chnl.first, chnl.second });
 	        } else {
@@ -344,7 +343,7 @@ namespace discpp {
 	}
 
     discpp::Message Channel::RequestMessage(discpp::Snowflake id) {
-        std::unique_ptr<rapidjson::Document> result = SendGetRequest(Endpoint("/channels/" + std::to_string(this->id) + "/messages/" + std::to_string(id)), DefaultHeaders(), {}, {});
+        std::unique_ptr<rapidjson::Document> result = SendGetRequest(Endpoint("/channels/" + std::to_string(this->id) + "/messages/" + std::to_string(id)), DefaultHeaders(), this->id, RateLimitBucketType::CHANNEL);
 
         return discpp::Message(*result);
     }
@@ -9,12 +9,16 @@
 #include "event_handler.h"
 #include "event_dispatcher.h"
 #include "client_config.h"
+#include "response_cache.h"
+#include "json_writer.h"
 #include "exceptions.h"
 #include "settings.h"
 #include "events/reconnect_event.h"
 
 #include <ixwebsocket/IXNetSystem.h>
 
+#include <algorithm>
+
 namespace discpp {
     Client::Client(const std::string& token, ClientConfig* config) : token(token), config(config) {
         fire_command_method = std::bind(discpp::FireCommand, std::placeholders::_1, std::placeholders::_2);
@@ -22,6 +26,9 @@ namespace discpp {
         discpp::globals::client_instance = this;
 
         message_cache_count = config->message_cache_size;
+        cache.messages.SetLimits(std::max(config->message_cache_size, 0), config->message_cache_bytes);
+        if (config->cache_policy.rest_responses) rest_cache.EnableDefaults();
+        if (!config->rest_proxy_url.empty()) globals::api_base_url = config->rest_proxy_url;
 
         if (config->logger_path.empty()) {
             logger = new discpp::Logger(config->logger_flags);
@@ -97,15 +104,25 @@ namespace discpp {
     }
 
     void Shard::CreateWebsocketRequest(rapidjson::Document& json, const std::string& message) {
-        std::string json_payload = DumpJson(json);
+        JsonWriter writer;
+        json.Accept(writer);
+
+        CreateWebsocketRequest(writer, message);
+    }
+
+    void Shard::CreateWebsocketRequest(const JsonWriter& json, const std::string& message) {
+        SendPayload(json.ToString(), message, false);
+    }
 
+    void Shard::SendPayload(const std::string& json_payload, const std::string& message, bool heartbeat) {
         if (message.empty()) {
             client.logger->Debug("[SHARD " + std::to_string(id) + "] Sending gateway payload: " + json_payload);
         } else {
             client.logger->Debug(message);
         }
 
-        WaitForRateLimits(client.client_user.id, RateLimitBucketType::GLOBAL);
+        // Discord closes connections that send more than 120 payloads a minute.
+        send_limiter.Acquire(heartbeat);
 
         //std::lock_guard<std::mutex> lock = std::lock_guard(websocket_client_mutex);
         websocket.sendText(json_payload);
@@ -167,6 +184,7 @@ namespace discpp {
             case ix::WebSocketMessageType::Open:
                 client.logger->Info(LogTextColor::GREEN + "[SHARD " + std::to_string(id) + "] Connected to gateway!");
                 disconnected = false;
+                send_limiter.Reset();
                 break;
             case ix::WebSocketMessageType::Close: {
                 std::lock_guard<std::mutex> futures_guard(client.futures_mutex);
@@ -274,7 +292,7 @@ namespace discpp {
                 }
 
                 std::string json_payload = DumpJson(data);
-                CreateWebsocketRequest(data, "[SHARD " + std::to_string(id) + "] Sending heartbeat payload: " + json_payload);
+                SendPayload(json_payload, "[SHARD " + std::to_string(id) + "] Sending heartbeat payload: " + json_payload, true);
 
                 heartbeat_acked = false;
 
@@ -496,7 +514,15 @@ namespace discpp {
     }
 
     discpp::User Client::ModifyCurrentUser(const std::string& username, discpp::Image& avatar) {
-        cpr::Body body("{\"username\": \"" + username + "\", \"avatar\": " + avatar.ToDataURI() + "}");
+        JsonWriter writer;
+        writer.StartObject();
+        writer.Key("username");
+        writer.String(username);
+        writer.Key("avatar");
+        writer.String(avatar.ToDataURI());
+        writer.EndObject();
+
+        cpr::Body body(writer.ToString());
         std::unique_ptr<rapidjson::Document> result = SendPatchRequest(Endpoint("/users/@me"), DefaultHeaders(), 0, discpp::RateLimitBucketType::GLOBAL, body);
 
         client_user = discpp::ClientUser(*result);
@@ -509,23 +535,19 @@ namespace discpp {
     }
 
     void Client::UpdatePresence(discpp::Presence& presence) {
-        rapidjson::Document payload(rapidjson::kObjectType);
-        std::unique_ptr<rapidjson::Document> activity_json = presence.ToJson();
-
-        payload.AddMember("op", Shard::Opcode::STATUS_UPDATE, payload.GetAllocator());
-        payload.AddMember("d", *activity_json, payload.GetAllocator());
-
-        shards.front()->CreateWebsocketRequest(payload);
+        JsonWriter writer;
+        writer.StartObject();
+        writer.Key("op");
+        writer.Int(Shard::Opcode::STATUS_UPDATE);
+        writer.Key("d");
+        presence.ToJson(writer);
+        writer.EndObject();
+
+        shards.front()->CreateWebsocketRequest(writer);
     }
 
     discpp::User Client::ReqestUserIfNotCached(const discpp::Snowflake& id) {
-        discpp::User user(id);
-        if (user.username.empty()) {
-            std::unique_ptr<rapidjson::Document> result = SendGetRequest(Endpoint("/users/" + std::to_string(id)), DefaultHeaders(), 0, RateLimitBucketType::GLOBAL);
-            return discpp::User(*result);
-        }
-
-        return user;
+        return *cache.GetUser(id, true);
     }
 
     std::vector<discpp::User::Connection> Client::GetBotUserConnections() {
@@ -2,6 +2,7 @@
 #include "color.h"
 #include "utils.h"
 #include "log.h"
+#include "json_writer.h"
 
 #include <discpp/client.h>
 
@@ -11,7 +12,7 @@ namespace discpp {
 	}
 
 	EmbedBuilder::EmbedBuilder(const std::string& title, const std::string& description, const discpp::Color& color) : EmbedBuilder() {
-		SetTitle(EscapeString(title));
+		SetTitle(title);
 		SetDescription(description);
 		SetColor(color);
 	}
@@ -35,9 +36,9 @@ namespace discpp {
 
 		if (ContainsNotNull(embed_json, "title")) {
             embed_json["title"].SetNull();
-            embed_json["title"].SetString(EscapeString(title).c_str(), embed_json.GetAllocator());
+            embed_json["title"].SetString(title.c_str(), embed_json.GetAllocator());
 		} else {
-		    embed_json.AddMember("title", EscapeString(title), embed_json.GetAllocator());
+		    embed_json.AddMember("title", title, embed_json.GetAllocator());
 		}
 
 
@@ -47,9 +48,9 @@ namespace discpp {
 	EmbedBuilder& EmbedBuilder::SetType(const std::string& type) {
         if (ContainsNotNull(embed_json, "type")) {
             embed_json["type"].SetNull();
-            embed_json["type"].SetString(EscapeString(type).c_str(), embed_json.GetAllocator());
+            embed_json["type"].SetString(type.c_str(), embed_json.GetAllocator());
         } else {
-            embed_json.AddMember("type", EscapeString(type), embed_json.GetAllocator());
+            embed_json.AddMember("type", type, embed_json.GetAllocator());
         }
 
 		return *this;
@@ -63,9 +64,9 @@ namespace discpp {
 
 		if (ContainsNotNull(embed_json, "description")) {
             embed_json["description"].SetNull();
-            embed_json["description"].SetString(EscapeString(description).c_str(), embed_json.GetAllocator());
+            embed_json["description"].SetString(description.c_str(), embed_json.GetAllocator());
         } else {
-            embed_json.AddMember("description", EscapeString(description), embed_json.GetAllocator());
+            embed_json.AddMember("description", description, embed_json.GetAllocator());
         }
 
 		return *this;
@@ -86,9 +87,9 @@ namespace discpp {
 
         if (ContainsNotNull(embed_json, "timestamp")) {
             embed_json["timestamp"].SetNull();
-            embed_json["timestamp"].SetString(EscapeString(timestamp).c_str(), embed_json.GetAllocator());
+            embed_json["timestamp"].SetString(timestamp.c_str(), embed_json.GetAllocator());
         } else {
-            embed_json.AddMember("timestamp", EscapeString(timestamp), embed_json.GetAllocator());
+            embed_json.AddMember("timestamp", timestamp, embed_json.GetAllocator());
         }
 
 		return *this;
@@ -210,7 +211,7 @@ namespace discpp {
 		}
 
         rapidjson::Value author(rapidjson::kObjectType);
-        author.AddMember("name", EscapeString(name), embed_json.GetAllocator());
+        author.AddMember("name", name, embed_json.GetAllocator());
 
 		if (!url.empty()) {
             author.AddMember("url", url, embed_json.GetAllocator());
@@ -261,8 +262,8 @@ namespace discpp {
 		}
 
         rapidjson::Value field(rapidjson::kObjectType);
-		field.AddMember("name", EscapeString(name), embed_json.GetAllocator());
-        field.AddMember("value", EscapeString(value), embed_json.GetAllocator());
+		field.AddMember("name", name, embed_json.GetAllocator());
+        field.AddMember("value", value, embed_json.GetAllocator());
         field.AddMember("inline", is_inline, embed_json.GetAllocator());
 
         embed_json["fields"].GetArray().PushBack(field, embed_json.GetAllocator());
@@ -277,6 +278,10 @@ namespace discpp {
 		return json_copy;
 	}
 
+    void EmbedBuilder::ToJson(JsonWriter& writer) const {
+        embed_json.Accept(writer);
+    }
+
     std::string EmbedBuilder::GetDescription() const {
         return embed_json["description"].GetString();
     }
@@ -324,8 +329,8 @@ namespace discpp {
 
             for (auto const &field : fields) {
                 rapidjson::Document field_json(rapidjson::kObjectType);
-                field_json.AddMember("name", EscapeString(std::get<0>(field)), embed_json.GetAllocator());
-                field_json.AddMember("value", EscapeString(std::get<1>(field)), embed_json.GetAllocator());
+                field_json.AddMember("name", std::get<0>(field), embed_json.GetAllocator());
+                field_json.AddMember("value", std::get<1>(field), embed_json.GetAllocator());
                 field_json.AddMember("inline", std::get<2>(field), embed_json.GetAllocator());
 
                 fields_json.PushBack(field_json, embed_json.GetAllocator());
@@ -4,8 +4,8 @@
 
 namespace discpp {
 	Emoji::Emoji(const discpp::Guild& guild, const Snowflake& id) : id(id) {
-		auto it = guild.emojis.find(id);
-		if (it != guild.emojis.end()) {
+		auto it = guild.emojis->find(id);
+		if (it != guild.emojis->end()) {
 			*this = it->second;
 		}
 	}
@@ -2,8 +2,46 @@
 #include "event_handler.h"
 #include "events/all_discord_events.h"
 #include "client_config.h"
+#include "response_cache.h"
 
 namespace discpp {
+    namespace {
+        // Stands in for a guild that isn't cached, so its events are still dispatched.
+        std::shared_ptr<discpp::Guild> GuildStub(const discpp::Snowflake& guild_id) {
+            std::shared_ptr<discpp::Guild> guild = std::make_shared<discpp::Guild>();
+            guild->id = guild_id;
+
+            return guild;
+        }
+
+        // The channel and guild of a reaction event's message, as they are cached now.
+        void FindReactionLocation(rapidjson::Document& result, discpp::Channel& channel, std::shared_ptr<discpp::Guild>& guild) {
+            if (ContainsNotNull(result, "guild_id")) {
+                guild = globals::client_instance->cache.FindGuild(discpp::Snowflake(result["guild_id"].GetString()));
+                if (guild != nullptr) {
+                    channel.guild_id = guild->id;
+
+                    std::optional<discpp::Channel> guild_channel = guild->FindChannel(discpp::Snowflake(result["channel_id"].GetString()));
+                    if (guild_channel) channel = *guild_channel;
+                }
+            } else {
+                globals::client_instance->cache.private_channels.Get(discpp::Snowflake(result["channel_id"].GetString()), channel);
+            }
+        }
+
+        // Cached messages are only ever replaced. If the message was evicted in the meantime the change
+        // is still applied to a copy, so the event carries it.
+        discpp::Message UpdateMessage(const discpp::Message& message, const std::function<void(discpp::Message&)>& func) {
+            std::shared_ptr<discpp::Message> updated = globals::client_instance->cache.messages.Update(message.id, func);
+            if (updated != nullptr) return *updated;
+
+            discpp::Message copy = message;
+            func(copy);
+
+            return copy;
+        }
+    }
+
     void EventDispatcher::ReadyEvent(Shard& shard, rapidjson::Document& result) {
         // Check if we're just resuming, and if we are dont try to create a new thread.
         if (!shard.heartbeat_thread.joinable()) {
@@ -37,7 +75,7 @@ namespace discpp {
 
                 discpp::Channel dm_channel(private_channel_json);
 
-                discpp::globals::client_instance->cache.private_channels.insert({ dm_channel.id, dm_channel });
+                discpp::globals::client_instance->cache.private_channels.InsertOrAssign(dm_channel.id, dm_channel);
             }
         } else {
             if (globals::client_instance->client_user.id == 0) {
@@ -66,14 +104,18 @@ namespace discpp {
     void EventDispatcher::ChannelCreateEvent(Shard& shard, rapidjson::Document& result) {
         if (ContainsNotNull(result, "guild_id")) {
             discpp::Channel new_channel(result);
-            std::shared_ptr<discpp::Guild> guild = globals::client_instance->cache.GetGuild(discpp::Snowflake(result["guild_id"].GetString()));
 
-            guild->channels.insert({ new_channel.id, new_channel });
+            if (globals::client_instance->config->cache_policy.channels) {
+                std::shared_ptr<discpp::Guild> guild = globals::client_instance->cache.UpdateGuildChannels(discpp::Snowflake(result["guild_id"].GetString()), [&new_channel](discpp::GuildChannels& channels) {
+                    channels.insert({ new_channel.id, new_channel });
+                });
+                if (guild != nullptr) globals::client_instance->cache.channel_guilds.InsertOrAssign(new_channel.id, guild->id);
+            }
             discpp::DispatchEvent(discpp::ChannelCreateEvent(new_channel));
         } else {
             discpp::Channel new_channel(result);
 
-            globals::client_instance->cache.private_channels.insert({ new_channel.id, new_channel });
+            globals::client_instance->cache.private_channels.InsertOrAssign(new_channel.id, new_channel);
             discpp::DispatchEvent(discpp::ChannelCreateEvent(new_channel));
         }
     }
@@ -81,90 +123,138 @@ namespace discpp {
     void EventDispatcher::ChannelUpdateEvent(Shard& shard, rapidjson::Document& result) {
         if (ContainsNotNull(result, "guild_id")) {
             discpp::Channel updated_channel(result);
-            std::shared_ptr<discpp::Guild> guild = globals::client_instance->cache.GetGuild(discpp::Snowflake(result["guild_id"].GetString()));
-
-            auto guild_chan_it = guild->channels.find(updated_channel.id);
-            if (guild_chan_it != guild->channels.end()) {
-                guild_chan_it->second = updated_channel;
-            }
+            discpp::Snowflake guild_id(result["guild_id"].GetString());
+
+            bool cached = false;
+            std::shared_ptr<discpp::Guild> guild = globals::client_instance->cache.UpdateGuildChannels(guild_id, [&updated_channel, &cached](discpp::GuildChannels& channels) {
+                auto guild_chan_it = channels.find(updated_channel.id);
+                if (guild_chan_it != channels.end()) {
+                    guild_chan_it->second = updated_channel;
+                    cached = true;
+                }
+            });
+            if (cached) globals::client_instance->cache.channel_guilds.InsertOrAssign(updated_channel.id, guild_id);
+            // Only masks in this channel depend on its overwrites.
+            if (guild != nullptr) guild->InvalidateChannelPermissions(updated_channel.id);
 
             discpp::DispatchEvent(discpp::ChannelUpdateEvent(updated_channel));
         } else {
             discpp::Channel updated_channel(result);
 
-            auto client_chan_it = discpp::globals::client_instance->cache.private_channels.find(updated_channel.id);
-            client_chan_it->second = updated_channel;
+            discpp::globals::client_instance->cache.private_channels.InsertOrAssign(updated_channel.id, updated_channel);
 
             discpp::DispatchEvent(discpp::ChannelUpdateEvent(updated_channel));
         }
     }
 
     void EventDispatcher::ChannelDeleteEvent(Shard& shard, rapidjson::Document& result) {
+        globals::client_instance->cache.messages.EraseChannel(discpp::Snowflake(result["id"].GetString()));
+
         if (ContainsNotNull(result, "guild_id")) {
-            discpp::Channel updated_channel(result);
-            std::shared_ptr<discpp::Guild> guild = globals::client_instance->cache.GetGuild(discpp::Snowflake(result["guild_id"].GetString()));
+            discpp::Channel deleted_channel(result);
 
-            discpp::DispatchEvent(discpp::ChannelUpdateEvent(updated_channel));
+            std::shared_ptr<discpp::Guild> guild = globals::client_instance->cache.UpdateGuildChannels(discpp::Snowflake(result["guild_id"].GetString()), [&deleted_channel](discpp::GuildChannels& channels) {
+                channels.erase(deleted_channel.id);
+            });
+            globals::client_instance->cache.channel_guilds.Erase(deleted_channel.id);
+            if (guild != nullptr) guild->InvalidateChannelPermissions(deleted_channel.id);
+
+            discpp::DispatchEvent(discpp::ChannelDeleteEvent(deleted_channel));
         } else {
-            discpp::Channel updated_channel(result);
+            discpp::Channel deleted_channel(result);
 
-            discpp::DispatchEvent(discpp::ChannelUpdateEvent(updated_channel));
+            globals::client_instance->cache.private_channels.Erase(deleted_channel.id);
+
+            discpp::DispatchEvent(discpp::ChannelDeleteEvent(deleted_channel));
         }
     }
 
     void EventDispatcher::ChannelPinsUpdateEvent(Shard& shard, rapidjson::Document& result) {
-        if (ContainsNotNull(result, "guild_id")) {
-            discpp::Channel pin_update_channel = discpp::Channel(discpp::Snowflake(result["channel_id"].GetString()));
-            discpp::Guild guild(pin_update_channel.guild_id);
+        rest_cache.Invalidate(Endpoint("/channels/" + std::string(result["channel_id"].GetString()) + "/pins"));
 
-            auto it = guild.channels.find(pin_update_channel.id);
-            if (it != guild.channels.end()) {
-                it->second.last_pin_timestamp = TimeFromDiscord(result["last_pin_timestamp"].GetString());
+        discpp::Snowflake channel_id(result["channel_id"].GetString());
+        auto update = [&result](discpp::Channel& channel) {
+            if (ContainsNotNull(result, "last_pin_timestamp")) {
+                channel.last_pin_timestamp = TimeFromDiscord(result["last_pin_timestamp"].GetString());
             }
+        };
 
-            discpp::DispatchEvent(discpp::ChannelPinsUpdateEvent(pin_update_channel));
-        } else {
-            discpp::Channel pin_update_channel = discpp::Channel(discpp::Snowflake(result["channel_id"].GetString()));
+        discpp::Channel channel;
+        bool cached = false;
+        if (ContainsNotNull(result, "guild_id")) {
+            channel.guild_id = discpp::Snowflake(result["guild_id"].GetString());
 
-            auto it = globals::client_instance->cache.private_channels.find(pin_update_channel.id);
-            if (it != globals::client_instance->cache.private_channels.end()) {
-                it->second.last_pin_timestamp = TimeFromDiscord(result["last_pin_timestamp"].GetString());
-            }
+            globals::client_instance->cache.UpdateGuildChannels(channel.guild_id, [&](discpp::GuildChannels& channels) {
+                auto it = channels.find(channel_id);
+                if (it == channels.end()) return;
+
+                update(it->second);
+                channel = it->second;
+                cached = true;
+            });
+        } else {
+            cached = globals::client_instance->cache.private_channels.Update(channel_id, [&](discpp::Channel& cached_channel) {
+                update(cached_channel);
+                channel = cached_channel;
+            });
+        }
 
-            discpp::DispatchEvent(discpp::ChannelPinsUpdateEvent(pin_update_channel));
+        // Channels that aren't cached are still dispatched, with only their ids and the timestamp.
+        if (!cached) {
+            channel.id = channel_id;
+            update(channel);
         }
+
+        discpp::DispatchEvent(discpp::ChannelPinsUpdateEvent(channel));
     }
 
     void EventDispatcher::GuildCreateEvent(Shard& shard, rapidjson::Document& result) {
         Snowflake guild_id = discpp::Snowflake(result["id"].GetString());
 
         std::shared_ptr<discpp::Guild> guild = std::make_shared<discpp::Guild>(result);
-        globals::client_instance->cache.guilds.emplace(guild_id, guild);
-        globals::client_instance->cache.members.insert(guild->members.begin(), guild->members.end());
+        globals::client_instance->cache.guilds.InsertOrAssign(guild_id, guild);
+        for (const auto& channel : *guild->channels) {
+            globals::client_instance->cache.channel_guilds.InsertOrAssign(channel.first, guild_id);
+        }
 
         discpp::DispatchEvent(discpp::GuildCreateEvent(guild));
     }
 
     void EventDispatcher::GuildUpdateEvent(Shard& shard, rapidjson::Document& result) {
-        std::shared_ptr<discpp::Guild> guild = std::make_shared<discpp::Guild>(result);
+        discpp::Snowflake guild_id(result["id"].GetString());
 
-        auto it = globals::client_instance->cache.guilds.find(guild->id);
-        if (it != globals::client_instance->cache.guilds.end()) {
-            it->second = guild;
+        // The payload has no roles, emojis, channels or members, so apply it to a shallow copy that keeps
+        // sharing them, only the scalars and strings of the guild are copied.
+        std::shared_ptr<discpp::Guild> guild = globals::client_instance->cache.UpdateGuild(guild_id, [&result](discpp::Guild& copy) {
+            copy.Update(result);
+        });
+
+        if (guild == nullptr) {
+            guild = std::make_shared<discpp::Guild>(result);
+            globals::client_instance->cache.guilds.InsertOrAssign(guild_id, guild);
         }
 
         discpp::DispatchEvent(discpp::GuildUpdateEvent(guild));
     }
 
     void EventDispatcher::GuildDeleteEvent(Shard& shard, rapidjson::Document& result) {
-        std::shared_ptr<discpp::Guild> guild = std::make_shared<discpp::Guild>(discpp::Snowflake(result["id"].GetString()));
+        discpp::Snowflake guild_id(result["id"].GetString());
+        rest_cache.Invalidate(Endpoint("/guilds/" + std::to_string(guild_id)));
+
+        std::shared_ptr<discpp::Guild> guild = globals::client_instance->cache.RemoveGuild(guild_id);
+        if (guild == nullptr) guild = GuildStub(guild_id);
 
-        globals::client_instance->cache.guilds.erase(guild->id);
         discpp::DispatchEvent(discpp::GuildDeleteEvent(guild));
     }
 
     void EventDispatcher::GuildBanAddEvent(Shard& shard, rapidjson::Document& result) {
-        discpp::Guild guild(discpp::Snowflake(result["guild_id"].GetString()));
+        rest_cache.Invalidate(Endpoint("/guilds/" + std::string(result["guild_id"].GetString()) + "/bans"));
+        rest_cache.Invalidate(Endpoint("/guilds/" + std::string(result["guild_id"].GetString()) + "/audit-logs"));
+
+        discpp::Snowflake guild_id(result["guild_id"].GetString());
+        std::shared_ptr<discpp::Guild> guild = globals::client_instance->cache.FindGuild(guild_id);
+        if (guild == nullptr) guild = GuildStub(guild_id);
+
         rapidjson::Document user_json;
         user_json.CopyFrom(result["user"], user_json.GetAllocator());
         discpp::User user(user_json);
@@ -173,7 +263,13 @@ namespace discpp {
     }
 
     void EventDispatcher::GuildBanRemoveEvent(Shard& shard, rapidjson::Document& result) {
-        discpp::Guild guild(discpp::Snowflake(result["guild_id"].GetString()));
+        rest_cache.Invalidate(Endpoint("/guilds/" + std::string(result["guild_id"].GetString()) + "/bans"));
+        rest_cache.Invalidate(Endpoint("/guilds/" + std::string(result["guild_id"].GetString()) + "/audit-logs"));
+
+        discpp::Snowflake guild_id(result["guild_id"].GetString());
+        std::shared_ptr<discpp::Guild> guild = globals::client_instance->cache.FindGuild(guild_id);
+        if (guild == nullptr) guild = GuildStub(guild_id);
+
         rapidjson::Document user_json;
         user_json.CopyFrom(result["user"], user_json.GetAllocator());
         discpp::User user(user_json);
@@ -182,58 +278,93 @@ namespace discpp {
     }
 
     void EventDispatcher::GuildEmojisUpdateEvent(Shard& shard, rapidjson::Document& result) {
-        std::shared_ptr<discpp::Guild> guild = globals::client_instance->cache.GetGuild(discpp::Snowflake(result["guild_id"].GetString()));
+        rest_cache.Invalidate(Endpoint("/guilds/" + std::string(result["guild_id"].GetString()) + "/emojis"));
 
-        std::unordered_map<Snowflake, Emoji> emojis;
-        for (auto& emoji : result["emojis"].GetArray()) {
-            rapidjson::Document emoji_json;
-            emoji_json.CopyFrom(emoji, emoji_json.GetAllocator());
+        discpp::Snowflake guild_id(result["guild_id"].GetString());
 
-            discpp::Emoji tmp = discpp::Emoji(emoji_json);
-            emojis.insert({ tmp.id, tmp });
-        }
+        std::shared_ptr<discpp::Guild> guild;
+        if (globals::client_instance->config->cache_policy.emojis) {
+            // The payload carries every emoji, so swap in a new map rather than copying the cached one.
+            std::shared_ptr<discpp::GuildEmojis> emojis = std::make_shared<discpp::GuildEmojis>();
+            for (auto& emoji : result["emojis"].GetArray()) {
+                rapidjson::Document emoji_json;
+                emoji_json.CopyFrom(emoji, emoji_json.GetAllocator());
+
+                discpp::Emoji tmp = discpp::Emoji(emoji_json);
+                emojis->insert({ tmp.id, tmp });
+            }
 
-        guild->emojis = emojis;
-        auto it = globals::client_instance->cache.guilds.find(guild->id);
-        if (it != globals::client_instance->cache.guilds.end()) {
-            it->second = guild;
+            guild = globals::client_instance->cache.UpdateGuild(guild_id, [&emojis](discpp::Guild& copy) {
+                copy.emojis = emojis;
+            });
+        } else {
+            guild = globals::client_instance->cache.FindGuild(guild_id);
         }
+        if (guild == nullptr) return;
 
         discpp::DispatchEvent(discpp::GuildEmojisUpdateEvent(guild));
     }
 
     void EventDispatcher::GuildIntegrationsUpdateEvent(Shard& shard, rapidjson::Document& result) {
-        discpp::DispatchEvent(discpp::GuildIntegrationsUpdateEvent(discpp::Guild(discpp::Snowflake(result["guild_id"].GetString()))));
+        rest_cache.Invalidate(Endpoint("/guilds/" + std::string(result["guild_id"].GetString()) + "/integrations"));
+
+        discpp::Snowflake guild_id(result["guild_id"].GetString());
+        std::shared_ptr<discpp::Guild> guild = globals::client_instance->cache.FindGuild(guild_id);
+        if (guild == nullptr) guild = GuildStub(guild_id);
+
+        discpp::DispatchEvent(discpp::GuildIntegrationsUpdateEvent(guild));
     }
 
     void EventDispatcher::GuildMemberAddEvent(Shard& shard, rapidjson::Document& result) {
-        std::shared_ptr<discpp::Guild> guild = globals::client_instance->cache.GetGuild(discpp::Snowflake(result["guild_id"].GetString()));
-        std::shared_ptr<discpp::Member> member = std::make_shared<discpp::Member>(result, *guild);
-        globals::client_instance->cache.members.insert({ member->user.id, member });
+        std::shared_ptr<discpp::Guild> guild = globals::client_instance->cache.FindGuild(discpp::Snowflake(result["guild_id"].GetString()));
+        if (guild == nullptr) return;
+        std::shared_ptr<discpp::Member> member = guild->ParseMember(result);
+        if (guild->CanCacheMember(true)) {
+            guild->members->InsertOrAssign(member->user->id, member);
+        }
 
         discpp::DispatchEvent(discpp::GuildMemberAddEvent(guild, member));
     }
 
     void EventDispatcher::GuildMemberRemoveEvent(Shard& shard, rapidjson::Document& result) {
-        std::shared_ptr<discpp::Guild> guild = globals::client_instance->cache.GetGuild(discpp::Snowflake(result["guild_id"].GetString()));
-        std::shared_ptr<discpp::Member> member = std::make_shared<discpp::Member>(discpp::Snowflake(result["user"]["id"].GetString()), *guild);
-        globals::client_instance->cache.members.erase(member->user.id);
+        std::shared_ptr<discpp::Guild> guild = globals::client_instance->cache.FindGuild(discpp::Snowflake(result["guild_id"].GetString()));
+        if (guild == nullptr) return;
+        discpp::Snowflake user_id(result["user"]["id"].GetString());
+
+        std::shared_ptr<discpp::Member> member;
+        guild->members->Take(user_id, member);
+        guild->InvalidatePermissions(user_id);
+
+        if (member == nullptr) {
+            rapidjson::Document user_json;
+            user_json.CopyFrom(result["user"], user_json.GetAllocator());
+
+            member = std::make_shared<discpp::Member>();
+            member->guild_id = guild->id;
+            member->user = std::make_shared<discpp::User>(user_json);
+        }
 
         discpp::DispatchEvent(discpp::GuildMemberRemoveEvent(guild, member));
     }
 
     void EventDispatcher::GuildMemberUpdateEvent(Shard& shard, rapidjson::Document& result) {
-        std::shared_ptr<discpp::Guild> guild = std::make_shared<discpp::Guild>(discpp::Snowflake(result["guild_id"].GetString()));
-        auto it = guild->members.find(static_cast<Snowflake>(discpp::Snowflake(result["user"]["id"].GetString())));
+        std::shared_ptr<discpp::Guild> guild = globals::client_instance->cache.FindGuild(discpp::Snowflake(result["guild_id"].GetString()));
+        if (guild == nullptr) return;
+        std::shared_ptr<discpp::Member> cached = guild->FindMember(discpp::Snowflake(result["user"]["id"].GetString()));
 
+        // The cached member may be read by listeners, so change a copy of it and replace it with that.
         std::shared_ptr<discpp::Member> member;
-        if (it != guild->members.end()) {
-            member = it->second;
+        if (cached != nullptr) {
+            member = std::make_shared<discpp::Member>(*cached);
         } else {
-            member = std::make_shared<discpp::Member>(discpp::Snowflake(result["user"]["id"].GetString()), *guild);
-            guild->members.insert({ member->user.id, member });
+            // The update carries the whole member, so parse it instead of looking up a member we don't have.
+            member = guild->ParseMember(result);
         }
 
+        rapidjson::Document user_json;
+        user_json.CopyFrom(result["user"], user_json.GetAllocator());
+        member->user = globals::client_instance->cache.InternUser(user_json);
+
         member->roles.clear();
         for (auto& role : result["roles"].GetArray()) {
             rapidjson::Document role_json;
@@ -246,18 +377,27 @@ namespace discpp {
             member->nick = result["nick"].GetString();
         }
 
+        bool replaced = guild->members->Update(member->user->id, [&member](std::shared_ptr<discpp::Member>& cached_member) {
+            cached_member = member;
+        });
+        if (!replaced && guild->CanCacheMember(true)) {
+            guild->members->Insert(member->user->id, member);
+        }
+        guild->InvalidatePermissions(member->user->id);
+
         discpp::DispatchEvent(discpp::GuildMemberUpdateEvent(guild, member));
     }
 
     void EventDispatcher::GuildMembersChunkEvent(Shard& shard, rapidjson::Document& result) {
-        std::shared_ptr<discpp::Guild> guild = globals::client_instance->cache.GetGuild(discpp::Snowflake(result["guild_id"].GetString()));
+        std::shared_ptr<discpp::Guild> guild = globals::client_instance->cache.FindGuild(discpp::Snowflake(result["guild_id"].GetString()));
+        if (guild == nullptr) return;
         std::unordered_map<discpp::Snowflake, discpp::Member> members;
         for (auto const& member : result["members"].GetArray()) {
             rapidjson::Document member_json(rapidjson::kObjectType);
             member_json.CopyFrom(member, member_json.GetAllocator());
 
             discpp::Member tmp(member_json, *guild);
-            members.emplace(tmp.user.id, tmp);
+            members.emplace(tmp.user->id, tmp);
         }
 
         int chunk_index = result["chunk_index"].GetInt();
@@ -282,6 +422,14 @@ namespace discpp {
         std::unique_ptr<rapidjson::Document> role_json = GetDocumentInsideJson(result, "role");
         discpp::Role role(*role_json);
 
+        // A member update can arrive before the role it assigns, so masks memoized without the role
+        // must go. They no longer match the new role map, dropping them frees the old one.
+        std::shared_ptr<discpp::Role> created_role = std::make_shared<discpp::Role>(role);
+        std::shared_ptr<discpp::Guild> guild = globals::client_instance->cache.UpdateGuildRoles(discpp::Snowflake(result["guild_id"].GetString()), [&created_role](discpp::GuildRoles& roles) {
+            roles[created_role->id] = created_role;
+        });
+        if (guild != nullptr) guild->InvalidatePermissions();
+
         discpp::DispatchEvent(discpp::GuildRoleCreateEvent(role));
     }
 
@@ -289,27 +437,36 @@ namespace discpp {
         std::unique_ptr<rapidjson::Document> role_json = GetDocumentInsideJson(result, "role");
         discpp::Role role(*role_json);
 
+        std::shared_ptr<discpp::Role> updated_role = std::make_shared<discpp::Role>(role);
+        std::shared_ptr<discpp::Guild> guild = globals::client_instance->cache.UpdateGuildRoles(discpp::Snowflake(result["guild_id"].GetString()), [&updated_role](discpp::GuildRoles& roles) {
+            roles[updated_role->id] = updated_role;
+        });
+        if (guild != nullptr) guild->InvalidatePermissions();
+
         discpp::DispatchEvent(discpp::GuildRoleUpdateEvent(role));
     }
 
     void EventDispatcher::GuildRoleDeleteEvent(Shard& shard, rapidjson::Document& result) {
-        discpp::Guild guild(discpp::Snowflake((result["guild_id"].GetString())));
-        discpp::Role role(discpp::Snowflake(result["role_id"].GetString()), guild);
+        std::shared_ptr<discpp::Guild> guild = globals::client_instance->cache.FindGuild(discpp::Snowflake(result["guild_id"].GetString()));
+        discpp::Snowflake role_id(result["role_id"].GetString());
+
+        discpp::Role role;
+        if (guild != nullptr) {
+            role = discpp::Role(role_id, *guild);
 
-        guild.roles.erase(role.id);
+            globals::client_instance->cache.UpdateGuildRoles(guild->id, [&role_id](discpp::GuildRoles& roles) {
+                roles.erase(role_id);
+            });
+            guild->InvalidatePermissions();
+        }
+        role.id = role_id;
 
         discpp::DispatchEvent(discpp::GuildRoleDeleteEvent(role));
     }
 
     void EventDispatcher::MessageCreateEvent(Shard& shard, rapidjson::Document& result) {
         std::shared_ptr<discpp::Message> message = std::make_shared<discpp::Message>(result);
-        if (!globals::client_instance->cache.messages.empty()) {
-            if (globals::client_instance->cache.messages.size() >= discpp::globals::client_instance->message_cache_count) {
-                globals::client_instance->cache.messages.erase(globals::client_instance->cache.messages.begin());
-            }
-
-            globals::client_instance->cache.messages.insert({message->id, message});
-        }
+        globals::client_instance->cache.messages.Insert(message);
 
         if (discpp::globals::client_instance->config->type == discpp::TokenType::BOT) {
             discpp::globals::client_instance->DoFunctionLater(discpp::globals::client_instance->fire_command_method, discpp::globals::client_instance, *message);
@@ -319,29 +476,36 @@ namespace discpp {
     }
 
     void EventDispatcher::MessageUpdateEvent(Shard& shard, rapidjson::Document& result) {
-        auto message_it = globals::client_instance->cache.messages.find(discpp::Snowflake(result["id"].GetString()));
+        std::shared_ptr<discpp::Message> cached_message;
 
         discpp::Message old_message;
         discpp::Message edited_message = discpp::Message(result);
         bool is_edited = ContainsNotNull(result, "edited_timestamp");
-        if (message_it != globals::client_instance->cache.messages.end()) {
-            if (globals::client_instance->cache.messages.size() >= discpp::globals::client_instance->message_cache_count) {
-                globals::client_instance->cache.messages.erase(globals::client_instance->cache.messages.begin());
+        if (globals::client_instance->cache.messages.Get(discpp::Snowflake(result["id"].GetString()), cached_message)) {
+            old_message = *cached_message;
+
+            // Updates such as embed unfurls are partial, so keep whatever the payload doesn't carry.
+            if (!ContainsNotNull(result, "author")) {
+                edited_message.author = old_message.author;
+                edited_message.member = old_message.member;
             }
+            if (!result.HasMember("content")) edited_message.content = old_message.content;
+            if (!ContainsNotNull(result, "timestamp")) edited_message.timestamp = old_message.timestamp;
+            if (!result.HasMember("reactions")) edited_message.reactions = old_message.reactions;
 
-            old_message = *message_it->second;
+            globals::client_instance->cache.messages.Insert(std::make_shared<discpp::Message>(edited_message));
+        } else if (ContainsNotNull(result, "author")) {
+            globals::client_instance->cache.messages.Insert(std::make_shared<discpp::Message>(edited_message));
         }
 
         discpp::DispatchEvent(discpp::MessageUpdateEvent(edited_message, old_message, is_edited));
     }
 
     void EventDispatcher::MessageDeleteEvent(Shard& shard, rapidjson::Document& result) {
-        auto message = globals::client_instance->cache.messages.find(discpp::Snowflake(result["id"].GetString()));
+        std::shared_ptr<discpp::Message> message;
 
-        if (message != globals::client_instance->cache.messages.end()) {
-            discpp::DispatchEvent(discpp::MessageDeleteEvent(*message->second));
-
-            globals::client_instance->cache.messages.erase(message);
+        if (globals::client_instance->cache.messages.Take(discpp::Snowflake(result["id"].GetString()), message)) {
+            discpp::DispatchEvent(discpp::MessageDeleteEvent(*message));
         }
     }
 
@@ -350,57 +514,44 @@ namespace discpp {
         for (auto& id : result["ids"].GetArray()) {
             rapidjson::Document id_json;
             id_json.CopyFrom(id, id_json.GetAllocator());
-            auto message = globals::client_instance->cache.messages.find(discpp::Snowflake(id_json.GetString()));
+            std::shared_ptr<discpp::Message> message;
 
-            if (message != globals::client_instance->cache.messages.end()) {
-                // Make sure the messages values are up to date.
+            if (globals::client_instance->cache.messages.Get(discpp::Snowflake(id_json.GetString()), message)) {
+                // Make sure the messages values are up to date, on a copy since listeners may still hold the cached one.
+                discpp::Message deleted_message = *message;
                 if (ContainsNotNull(result, "guild_id")) {
-                    std::shared_ptr<discpp::Guild> guild = globals::client_instance->cache.GetGuild(discpp::Snowflake(result["guild_id"].GetString()));;
-                    message->second->guild = guild;
-
-                    auto channel_it = guild->channels.find(discpp::Snowflake(result["channel_id"].GetString()));
-                    if (channel_it != guild->channels.end()) {
-                        message->second->channel = channel_it->second;
+                    std::shared_ptr<discpp::Guild> guild = globals::client_instance->cache.FindGuild(discpp::Snowflake(result["guild_id"].GetString()));
+                    if (guild != nullptr) {
+                        deleted_message.guild = guild;
+
+                        auto channel_it = guild->channels->find(discpp::Snowflake(result["channel_id"].GetString()));
+                        if (channel_it != guild->channels->end()) {
+                            deleted_message.channel = channel_it->second;
+                        }
                     }
                 } else {
-                    auto channel_it = globals::client_instance->cache.private_channels.find(discpp::Snowflake(result["channel_id"].GetString()));
-
-                    if (channel_it != globals::client_instance->cache.private_channels.end()) {
-                        message->second->channel = channel_it->second;
-                    }
+                    globals::client_instance->cache.private_channels.Get(discpp::Snowflake(result["channel_id"].GetString()), deleted_message.channel);
                 }
 
-                msgs.push_back(*message->second);
+                msgs.push_back(deleted_message);
             }
         }
 
         for (discpp::Message message : msgs) {
-            globals::client_instance->cache.messages.erase(message.id);
+            globals::client_instance->cache.messages.Erase(message.id);
         }
 
         discpp::DispatchEvent(discpp::MessageBulkDeleteEvent(msgs));
     }
 
     void EventDispatcher::MessageReactionAddEvent(Shard& shard, rapidjson::Document& result) {
-        auto message = globals::client_instance->cache.messages.find(discpp::Snowflake(result["message_id"].GetString()));
+        std::shared_ptr<discpp::Message> message;
 
-        if (message != globals::client_instance->cache.messages.end()) {
+        if (globals::client_instance->cache.messages.Get(discpp::Snowflake(result["message_id"].GetString()), message)) {
             // Make sure the messages values are up to date.
-            discpp::Channel channel;
-            if (ContainsNotNull(result, "guild_id")) {
-                std::shared_ptr<discpp::Guild> guild = globals::client_instance->cache.GetGuild(discpp::Snowflake(result["guild_id"].GetString()));
-
-                message->second->channel.guild_id = guild->id;
-                message->second->guild = guild;
-                channel = guild->GetChannel(discpp::Snowflake(result["channel_id"].GetString()));
-            } else {
-                auto it = globals::client_instance->cache.private_channels.find(discpp::Snowflake(result["channel_id"].GetString()));
-
-                if (it != globals::client_instance->cache.private_channels.end()) {
-                    channel = it->second;
-                }
-            }
-            message->second->channel = channel;
+            discpp::Channel channel = message->channel;
+            std::shared_ptr<discpp::Guild> guild;
+            FindReactionLocation(result, channel, guild);
 
             rapidjson::Document emoji_json;
             emoji_json.CopyFrom(result["emoji"], emoji_json.GetAllocator());
@@ -408,31 +559,39 @@ namespace discpp {
 
             discpp::User user(discpp::Snowflake(result["user_id"].GetString()));
 
-            auto reaction = std::find_if(message->second->reactions.begin(), message->second->reactions.end(),
-            [&emoji](discpp::Reaction react) {
-                return react.emoji == emoji;
-            });
+            discpp::Message updated_message = UpdateMessage(*message, [&](discpp::Message& copy) {
+                if (guild != nullptr) copy.guild = guild;
+                copy.channel = channel;
+
+                auto reaction = std::find_if(copy.reactions.begin(), copy.reactions.end(),
+                [&emoji](discpp::Reaction react) {
+                    return react.emoji == emoji;
+                });
 
-            if (reaction != message->second->reactions.end()) {
-                reaction->count++;
+                if (reaction != copy.reactions.end()) {
+                    reaction->count++;
 
-                if (user.IsBot()) {
-                    reaction->from_bot = true;
+                    if (user.IsBot()) {
+                        reaction->from_bot = true;
+                    }
+                } else {
+                    discpp::Reaction r = discpp::Reaction(1, user.IsBot(), emoji);
+                    copy.reactions.push_back(r);
                 }
-            } else {
-                discpp::Reaction r = discpp::Reaction(1, user.IsBot(), emoji);
-                message->second->reactions.push_back(r);
-            }
+            });
 
-            discpp::DispatchEvent(discpp::MessageReactionAddEvent(*message->second, emoji, user));
+            discpp::DispatchEvent(discpp::MessageReactionAddEvent(updated_message, emoji, user));
         } else {
-            discpp::Channel channel = globals::client_instance->cache.GetChannel(discpp::Snowflake(result["channel_id"].GetString()));
+            discpp::Snowflake channel_id(result["channel_id"].GetString());
+            discpp::Channel channel = globals::client_instance->cache.FindChannel(channel_id).value_or(discpp::Channel());
+            channel.id = channel_id;
             discpp::Message message = channel.RequestMessage(discpp::Snowflake(result["message_id"].GetString()));
 
             if (ContainsNotNull(result, "guild_id")) {
                 channel.guild_id = Snowflake(result["guild_id"].GetString());
-                message.guild = globals::client_instance->cache.GetGuild(Snowflake(result["guild_id"].GetString()));
+                message.guild = globals::client_instance->cache.FindGuild(Snowflake(result["guild_id"].GetString()));
             }
+            globals::client_instance->cache.messages.Insert(std::make_shared<discpp::Message>(message));
 
             rapidjson::Document emoji_json;
             emoji_json.CopyFrom(result["emoji"], emoji_json.GetAllocator());
@@ -444,24 +603,13 @@ namespace discpp {
     }
 
     void EventDispatcher::MessageReactionRemoveEvent(Shard& shard, rapidjson::Document& result) {
-        auto message = globals::client_instance->cache.messages.find(discpp::Snowflake(result["message_id"].GetString()));
+        std::shared_ptr<discpp::Message> message;
 
-        if (message != globals::client_instance->cache.messages.end()) {
+        if (globals::client_instance->cache.messages.Get(discpp::Snowflake(result["message_id"].GetString()), message)) {
             // Make sure the messages values are up to date.
-            discpp::Channel channel;
-            if (ContainsNotNull(result, "guild_id")) {
-                std::shared_ptr<discpp::Guild> guild = globals::client_instance->cache.GetGuild(discpp::Snowflake(result["guild_id"].GetString()));
-
-                message->second->guild = guild;
-                channel = guild->GetChannel(discpp::Snowflake(result["channel_id"].GetString()));
-            } else {
-                auto it = globals::client_instance->cache.private_channels.find(discpp::Snowflake(result["channel_id"].GetString()));
-
-                if (it != globals::client_instance->cache.private_channels.end()) {
-                    channel = it->second;
-                }
-            }
-            message->second->channel = channel;
+            discpp::Channel channel = message->channel;
+            std::shared_ptr<discpp::Guild> guild;
+            FindReactionLocation(result, channel, guild);
 
             rapidjson::Document emoji_json;
             emoji_json.CopyFrom(result["emoji"], emoji_json.GetAllocator());
@@ -469,30 +617,38 @@ namespace discpp {
 
             discpp::User user(discpp::Snowflake(result["user_id"].GetString()));
 
-            auto reaction = std::find_if(message->second->reactions.begin(), message->second->reactions.end(),
-                 [&emoji](discpp::Reaction react) {
-                     return react.emoji == emoji;
-                 });
+            discpp::Message updated_message = UpdateMessage(*message, [&](discpp::Message& copy) {
+                if (guild != nullptr) copy.guild = guild;
+                copy.channel = channel;
 
-            if (reaction != message->second->reactions.end()) {
-                if (reaction->count == 1) {
-                    message->second->reactions.erase(reaction);
-                } else {
-                    reaction->count--;
+                auto reaction = std::find_if(copy.reactions.begin(), copy.reactions.end(),
+                     [&emoji](discpp::Reaction react) {
+                         return react.emoji == emoji;
+                     });
+
+                if (reaction != copy.reactions.end()) {
+                    if (reaction->count == 1) {
+                        copy.reactions.erase(reaction);
+                    } else {
+                        reaction->count--;
 
-                    // @TODO: Add a way to change reaction::from_bot
+                        // @TODO: Add a way to change reaction::from_bot
+                    }
                 }
-            }
+            });
 
-            discpp::DispatchEvent(discpp::MessageReactionRemoveEvent(*message->second, emoji, user));
+            discpp::DispatchEvent(discpp::MessageReactionRemoveEvent(updated_message, emoji, user));
         } else {
-            discpp::Channel channel = globals::client_instance->cache.GetChannel(discpp::Snowflake(result["channel_id"].GetString()));
+            discpp::Snowflake channel_id(result["channel_id"].GetString());
+            discpp::Channel channel = globals::client_instance->cache.FindChannel(channel_id).value_or(discpp::Channel());
+            channel.id = channel_id;
             discpp::Message message = channel.RequestMessage(discpp::Snowflake(result["message_id"].GetString()));
 
             if (ContainsNotNull(result, "guild_id")) {
                 channel.guild_id = Snowflake(result["guild_id"].GetString());
-                message.guild = globals::client_instance->cache.GetGuild(Snowflake(result["guild_id"].GetString()));
+                message.guild = globals::client_instance->cache.FindGuild(Snowflake(result["guild_id"].GetString()));
             }
+            globals::client_instance->cache.messages.Insert(std::make_shared<discpp::Message>(message));
 
             rapidjson::Document emoji_json;
             emoji_json.CopyFrom(result["emoji"], emoji_json.GetAllocator());
@@ -504,33 +660,31 @@ namespace discpp {
     }
 
     void EventDispatcher::MessageReactionRemoveAllEvent(Shard& shard, rapidjson::Document& result) {
-        auto message = globals::client_instance->cache.messages.find(discpp::Snowflake(result["message_id"].GetString()));
-
-        if (message != globals::client_instance->cache.messages.end()) {
-            discpp::Channel channel;
-            if (ContainsNotNull(result, "guild_id")) {
-                std::shared_ptr<discpp::Guild> guild = globals::client_instance->cache.GetGuild(discpp::Snowflake(result["guild_id"].GetString()));
+        std::shared_ptr<discpp::Message> message;
 
-                message->second->guild = guild;
-                channel = guild->GetChannel(discpp::Snowflake(result["channel_id"].GetString()));
-            } else {
-                auto it = globals::client_instance->cache.private_channels.find(discpp::Snowflake(result["channel_id"].GetString()));
+        if (globals::client_instance->cache.messages.Get(discpp::Snowflake(result["message_id"].GetString()), message)) {
+            discpp::Channel channel = message->channel;
+            std::shared_ptr<discpp::Guild> guild;
+            FindReactionLocation(result, channel, guild);
 
-                if (it != globals::client_instance->cache.private_channels.end()) {
-                    channel = it->second;
-                }
-            }
-            message->second->channel = channel;
+            discpp::Message updated_message = UpdateMessage(*message, [&](discpp::Message& copy) {
+                if (guild != nullptr) copy.guild = guild;
+                copy.channel = channel;
+                copy.reactions.clear();
+            });
 
-            discpp::DispatchEvent(discpp::MessageReactionRemoveAllEvent(*message->second));
+            discpp::DispatchEvent(discpp::MessageReactionRemoveAllEvent(updated_message));
         } else {
-            discpp::Channel channel = globals::client_instance->cache.GetChannel(discpp::Snowflake(result["channel_id"].GetString()));
+            discpp::Snowflake channel_id(result["channel_id"].GetString());
+            discpp::Channel channel = globals::client_instance->cache.FindChannel(channel_id).value_or(discpp::Channel());
+            channel.id = channel_id;
             discpp::Message message = channel.RequestMessage(discpp::Snowflake(result["message_id"].GetString()));
 
             if (ContainsNotNull(result, "guild_id")) {
                 channel.guild_id = Snowflake(result["guild_id"].GetString());
-                message.guild = globals::client_instance->cache.GetGuild(Snowflake(result["guild_id"].GetString()));
+                message.guild = globals::client_instance->cache.FindGuild(Snowflake(result["guild_id"].GetString()));
             }
+            globals::client_instance->cache.messages.Insert(std::make_shared<discpp::Message>(message));
 
             discpp::DispatchEvent(discpp::MessageReactionRemoveAllEvent(message));
         }
@@ -539,19 +693,38 @@ namespace discpp {
     void EventDispatcher::PresenceUpdateEvent(Shard& shard, rapidjson::Document& result) {
         rapidjson::Document user_json;
         user_json.CopyFrom(result["user"], user_json.GetAllocator());
-        discpp::DispatchEvent(discpp::PresenseUpdateEvent(discpp::User(user_json)));
+
+        // The user object is partial, so only update users we already know instead of interning a stub.
+        std::shared_ptr<discpp::User> cached_user = globals::client_instance->cache.UpdateUser(user_json);
+        discpp::User user = cached_user != nullptr ? *cached_user : discpp::User(user_json);
+
+        if (globals::client_instance->config->cache_policy.presences && ContainsNotNull(result, "guild_id")) {
+            discpp::Snowflake guild_id(result["guild_id"].GetString());
+
+            std::shared_ptr<discpp::Guild> guild = globals::client_instance->cache.FindGuild(guild_id);
+            if (guild != nullptr && guild->members->Contains(user.id)) {
+                discpp::Presence presence(result);
+
+                // Replace the member with a copy that has the new presence and user record.
+                guild->members->Update(user.id, [&](std::shared_ptr<discpp::Member>& cached_member) {
+                    std::shared_ptr<discpp::Member> member = std::make_shared<discpp::Member>(*cached_member);
+                    member->presence = std::make_unique<discpp::Presence>(presence);
+                    if (cached_user != nullptr) member->user = cached_user;
+                    cached_member = member;
+                });
+            }
+        }
+
+        discpp::DispatchEvent(discpp::PresenseUpdateEvent(user));
     }
 
     void EventDispatcher::TypingStartEvent(Shard& shard, rapidjson::Document& result) {
         discpp::User user(discpp::Snowflake(result["user_id"].GetString()));
 
-        discpp::Channel channel;
-        if (ContainsNotNull(result, "guild_id")) {
-            discpp::Guild guild(discpp::Snowflake(result["guild_id"].GetString()));
-            channel = guild.GetChannel(discpp::Snowflake(result["channel_id"].GetString()));
-        } else {
-            channel = discpp::Channel(discpp::Snowflake(result["channel_id"].GetString()));
-        }
+        discpp::Snowflake channel_id(result["channel_id"].GetString());
+        discpp::Channel channel = globals::client_instance->cache.FindChannel(channel_id).value_or(discpp::Channel());
+        channel.id = channel_id;
+        if (ContainsNotNull(result, "guild_id")) channel.guild_id = discpp::Snowflake(result["guild_id"].GetString());
 
         int timestamp = result["timestamp"].GetInt();
 
@@ -559,9 +732,9 @@ namespace discpp {
     }
 
     void EventDispatcher::UserUpdateEvent(Shard& shard, rapidjson::Document& result) {
-        discpp::User user(result);
+        std::shared_ptr<discpp::User> user = globals::client_instance->cache.InternUser(result);
 
-        discpp::DispatchEvent(discpp::UserUpdateEvent(user));
+        discpp::DispatchEvent(discpp::UserUpdateEvent(*user));
     }
 
     void EventDispatcher::VoiceStateUpdateEvent(Shard& shard, rapidjson::Document& result) {
@@ -1,173 +1,269 @@
 #include "exceptions.h"
 #include "guild.h"
 #include "client.h"
+#include "client_config.h"
 #include "log.h"
 #include "member.h"
 #include "role.h"
 #include "channel.h"
 #include "audit_log.h"
 #include "user.h"
+#include "rest_engine.h"
+#include "json_writer.h"
 
+#include <algorithm>
 #include <memory>
 
 namespace discpp {
-	Guild::Guild(const Snowflake& id, bool can_request) : DiscordObject(id) {
-        *this = *globals::client_instance->cache.GetGuild(id, can_request);
-	}
+    namespace {
+        std::string RoleBody(const std::string& name, const Permissions& permissions, const int color, const bool hoist, const bool mentionable) {
+            JsonWriter writer;
+            writer.StartObject();
+            writer.Key("name");
+            writer.String(name);
+            writer.Key("permissions");
+            writer.Uint64(permissions.allow_perms.value);
+            writer.Key("color");
+            writer.Int(color);
+            writer.Key("hoist");
+            writer.Bool(hoist);
+            writer.Key("mentionable");
+            writer.Bool(mentionable);
+            writer.EndObject();
+
+            return writer.ToString();
+        }
 
-	Guild::Guild(rapidjson::Document& json) {
-		id = discpp::Snowflake(json["id"].GetString());
-        name = json["name"].GetString();
+        uint64_t MixStamp(uint64_t stamp, uint64_t value) {
+            stamp ^= value + 0x9e3779b97f4a7c15ULL + (stamp << 6) + (stamp >> 2);
+            return discpp::SnowflakeHash()(stamp);
+        }
 
-        if (ContainsNotNull(json, "icon")) {
-            std::string icon_str = json["icon"].GetString();
+        // Everything a memoized mask depends on besides the guild's roles: the owner, the member's roles
+        // and the overwrites of the channel.
+        uint64_t PermissionStamp(const discpp::Snowflake& owner_id, const discpp::Member& member, const discpp::Channel* channel) {
+            uint64_t stamp = MixStamp(owner_id, member.roles.size());
+            for (const discpp::Snowflake& role_id : member.roles) {
+                stamp = MixStamp(stamp, role_id);
+            }
 
-            if (StartsWith(icon_str, "a_")) {
-                is_icon_gif = true;
-                SplitAvatarHash(icon_str.substr(2), icon_hex);
-            } else {
-                SplitAvatarHash(icon_str, icon_hex);
+            if (channel != nullptr) {
+                for (const discpp::Permissions& overwrite : channel->permissions) {
+                    stamp = MixStamp(stamp, overwrite.role_user_id);
+                    stamp = MixStamp(stamp, static_cast<uint64_t>(overwrite.permission_type));
+                    stamp = MixStamp(stamp, overwrite.allow_perms.value);
+                    stamp = MixStamp(stamp, overwrite.deny_perms.value);
+                }
             }
-        }
 
-        if (ContainsNotNull(json, "splash")) {
-            SplitAvatarHash(json["splash"].GetString(), splash_hex);
+            return stamp;
         }
+    }
 
-        if (ContainsNotNull(json, "discovery_splash")) {
-            SplitAvatarHash(json["discovery_splash"].GetString(), discovery_hex);
-        }
+	Guild::Guild(const Snowflake& id, bool can_request) : DiscordObject(id) {
+        *this = *globals::client_instance->cache.GetGuild(id, can_request);
+	}
 
-		if (GetDataSafely<bool>(json, "owner")) flags |= 0b1;
-		owner_id = GetIDSafely(json, "owner_id");
-		permissions = GetDataSafely<int>(json, "permissions");
-		region = json["region"].GetString();
-		afk_channel_id = GetIDSafely(json, "afk_channel_id");
-		afk_timeout = json["afk_timeout"].GetInt();
-        if (GetDataSafely<bool>(json, "embed_enabled")) flags |= 0b10;
-		verification_level = static_cast<discpp::specials::VerificationLevel>(json["verification_level"].GetInt());
-		default_message_notifications = static_cast<discpp::specials::DefaultMessageNotificationLevel>(json["default_message_notifications"].GetInt());
-		explicit_content_filter = static_cast<discpp::specials::ExplicitContentFilterLevel>(json["explicit_content_filter"].GetInt());
+	Guild::Guild(rapidjson::Document& json) {
+		id = discpp::Snowflake(json["id"].GetString());
 
 		if (ContainsNotNull(json, "roles")) {
+		    std::shared_ptr<discpp::GuildRoles> parsed_roles = std::make_shared<discpp::GuildRoles>();
 			for (auto const& role : json["roles"].GetArray()) {
                 rapidjson::Document role_json;
                 role_json.CopyFrom(role, role_json.GetAllocator());
 
 				discpp::Role tmp = discpp::Role(role_json);
-				roles.insert({ tmp.id, std::make_shared<discpp::Role>(tmp) });
+				parsed_roles->insert({ tmp.id, std::make_shared<discpp::Role>(tmp) });
 			}
+			roles = std::move(parsed_roles);
 		}
 
-        if (ContainsNotNull(json, "emojis")) {
+        const discpp::CachePolicy& cache_policy = globals::client_instance->config->cache_policy;
+
+        if (cache_policy.emojis && ContainsNotNull(json, "emojis")) {
+            std::shared_ptr<discpp::GuildEmojis> parsed_emojis = std::make_shared<discpp::GuildEmojis>();
             for (auto const& emoji : json["emojis"].GetArray()) {
                 rapidjson::Document emoji_json;
                 emoji_json.CopyFrom(emoji, emoji_json.GetAllocator());
 
                 discpp::Emoji tmp = discpp::Emoji(emoji_json);
-                emojis.insert({ tmp.id, tmp });
+                parsed_emojis->insert({ tmp.id, tmp });
             }
+            emojis = std::move(parsed_emojis);
         }
 
-        if (ContainsNotNull(json, "features")) {
-            for (auto const& feature : json["features"].GetArray()) {
-                rapidjson::Document feature_json;
-                feature_json.CopyFrom(feature, feature_json.GetAllocator());
-
-                features.push_back(feature_json.GetString());
-            }
-        }
-
-		mfa_level = static_cast<discpp::specials::MFALevel>(json["mfa_level"].GetInt());
-		application_id = GetIDSafely(json, "application_id");
-        if (GetDataSafely<bool>(json, "widget_enabled")) flags |= 0b100;
-		widget_channel_id = GetIDSafely(json, "widget_channel_id");
-		system_channel_id = GetIDSafely(json, "system_channel_id");
-		system_channel_flags = json["system_channel_flags"].GetInt();
-        rules_channel_id = GetIDSafely(json, "rules_channel_id");
-
-        if (ContainsNotNull(json, "joined_at")) {
-            joined_at = std::chrono::system_clock::from_time_t(TimeFromDiscord(json["joined_at"].GetString()));
-        }
-
-        if (GetDataSafely<bool>(json, "large")) flags |= 0b1000;
-        if (GetDataSafely<bool>(json, "unavailable")) flags |= 0b10000;
-		member_count = GetDataSafely<int>(json, "member_count");
-
-        if (ContainsNotNull(json, "voice_states")) {
+        if (cache_policy.voice_states && ContainsNotNull(json, "voice_states")) {
+            std::shared_ptr<std::vector<discpp::VoiceState>> parsed_voice_states = std::make_shared<std::vector<discpp::VoiceState>>();
             for (auto const& voice_state : json["voice_states"].GetArray()) {
                 rapidjson::Document voice_state_json;
                 voice_state_json.CopyFrom(voice_state, voice_state_json.GetAllocator());
 
                 discpp::VoiceState tmp(voice_state_json);
-                voice_states.push_back(tmp);
+                parsed_voice_states->push_back(tmp);
             }
+            voice_states = std::move(parsed_voice_states);
         }
 
-        if (ContainsNotNull(json, "channels")) {
+        if (cache_policy.channels && ContainsNotNull(json, "channels")) {
+            std::shared_ptr<discpp::GuildChannels> parsed_channels = std::make_shared<discpp::GuildChannels>();
             for (auto const& channel : json["channels"].GetArray()) {
                 rapidjson::Document channel_json;
                 channel_json.CopyFrom(channel, channel_json.GetAllocator());
 
                 discpp::Channel tmp(channel_json);
                 tmp.guild_id = id;
-                channels.insert({ tmp.id, tmp });
+                parsed_channels->insert({ tmp.id, tmp });
             }
+            channels = std::move(parsed_channels);
         }
 
-		max_presences = GetDataSafely<int>(json, "max_presences");
-		max_members = GetDataSafely<int>(json, "max_members");
+        // The scalar fields are shared with GUILD_UPDATE. Channels must be parsed first for the public
+        // updates channel, and members after, since the cache policy may depend on the large flag.
+        Update(json);
+
+        bool cache_members = CanCacheMember();
+        if (ContainsNotNull(json, "members")) {
+            const discpp::Snowflake& bot_id = globals::client_instance->client_user.id;
+            for (auto const& member : json["members"].GetArray()) {
+                // The bot's own member is kept under every policy, since each permission check needs it.
+                if (!cache_members && discpp::Snowflake(member["user"]["id"].GetString()) != bot_id) continue;
+
+                rapidjson::Document member_json;
+                member_json.CopyFrom(member, member_json.GetAllocator());
+
+                std::shared_ptr<discpp::Member> tmp = ParseMember(member_json);
+                members->Insert(tmp->user->id, tmp);
+            }
+        }
+
+		if (cache_members && cache_policy.presences && ContainsNotNull(json, "presences") && ContainsNotNull(json, "members")) {
+            for (auto const& presence : json["presences"].GetArray()) {
+                rapidjson::Document presence_json;
+                presence_json.CopyFrom(presence, presence_json.GetAllocator());
+
+                // The members were just parsed and aren't shared with anyone yet, so set the presence in place.
+                std::shared_ptr<discpp::Member> member = FindMember(discpp::Snowflake(presence_json["user"]["id"].GetString()));
+                if (member != nullptr) {
+                    member->presence = std::make_unique<discpp::Presence>(presence_json);
+                }
+            }
+		}
+	}
 
-        if (ContainsNotNull(json, "vanity_url_code")) {
-            vanity_url_code = json["vanity_url_code"].GetString();
+	void Guild::Update(rapidjson::Document& json) {
+        if (ContainsNotNull(json, "name")) name = json["name"].GetString();
+
+        if (json.HasMember("icon")) {
+            is_icon_gif = false;
+            icon_hex[0] = icon_hex[1] = 0;
+
+            if (!json["icon"].IsNull()) {
+                std::string icon_str = json["icon"].GetString();
+
+                if (StartsWith(icon_str, "a_")) {
+                    is_icon_gif = true;
+                    SplitAvatarHash(icon_str.substr(2), icon_hex);
+                } else {
+                    SplitAvatarHash(icon_str, icon_hex);
+                }
+            }
         }
 
-        if (ContainsNotNull(json, "description")) {
-            description = json["description"].GetString();
+        if (json.HasMember("splash")) {
+            splash_hex[0] = splash_hex[1] = 0;
+            if (!json["splash"].IsNull()) SplitAvatarHash(json["splash"].GetString(), splash_hex);
         }
 
-        if (ContainsNotNull(json, "banner")) {
-            SplitAvatarHash(json["banner"].GetString(), banner_hex);
+        if (json.HasMember("discovery_splash")) {
+            discovery_hex[0] = discovery_hex[1] = 0;
+            if (!json["discovery_splash"].IsNull()) SplitAvatarHash(json["discovery_splash"].GetString(), discovery_hex);
         }
 
-		premium_tier = static_cast<discpp::specials::NitroTier>(json["premium_tier"].GetInt());
-		premium_subscription_count = GetDataSafely<int>(json, "premium_subscription_count");
-		preferred_locale = json["preferred_locale"].GetString();
+        if (json.HasMember("banner")) {
+            banner_hex[0] = banner_hex[1] = 0;
+            if (!json["banner"].IsNull()) SplitAvatarHash(json["banner"].GetString(), banner_hex);
+        }
 
-		if (ContainsNotNull(json, "public_updates_channel_id")) {
-		    auto channel = channels.find(Snowflake(json["public_updates_channel_id"].GetString()));
-		    if (channel != channels.end()) {
-                public_updates_channel = channel->second;
-		    }
+        if (ContainsNotNull(json, "owner")) {
+            flags = json["owner"].GetBool() ? (flags | 0b1) : (flags & ~0b1);
+        }
+        if (ContainsNotNull(json, "embed_enabled")) {
+            flags = json["embed_enabled"].GetBool() ? (flags | 0b10) : (flags & ~0b10);
+        }
+        if (ContainsNotNull(json, "widget_enabled")) {
+            flags = json["widget_enabled"].GetBool() ? (flags | 0b100) : (flags & ~0b100);
+        }
+        if (ContainsNotNull(json, "large")) {
+            flags = json["large"].GetBool() ? (flags | 0b1000) : (flags & ~0b1000);
+        }
+        if (ContainsNotNull(json, "unavailable")) {
+            flags = json["unavailable"].GetBool() ? (flags | 0b10000) : (flags & ~0b10000);
         }
 
-        if (ContainsNotNull(json, "members")) {
-            for (auto const& member : json["members"].GetArray()) {
-                rapidjson::Document member_json;
-                member_json.CopyFrom(member, member_json.GetAllocator());
+        if (json.HasMember("owner_id")) owner_id = GetIDSafely(json, "owner_id");
+        if (ContainsNotNull(json, "permissions")) permissions = json["permissions"].GetInt();
+        if (ContainsNotNull(json, "region")) region = json["region"].GetString();
+        if (json.HasMember("afk_channel_id")) afk_channel_id = GetIDSafely(json, "afk_channel_id");
+        if (ContainsNotNull(json, "afk_timeout")) afk_timeout = json["afk_timeout"].GetInt();
 
-                discpp::Member tmp(member_json, *this);
-                members.insert({ tmp.user.id, std::make_shared<discpp::Member>(tmp)});
+        if (ContainsNotNull(json, "verification_level")) {
+            verification_level = static_cast<discpp::specials::VerificationLevel>(json["verification_level"].GetInt());
+        }
+        if (ContainsNotNull(json, "default_message_notifications")) {
+            default_message_notifications = static_cast<discpp::specials::DefaultMessageNotificationLevel>(json["default_message_notifications"].GetInt());
+        }
+        if (ContainsNotNull(json, "explicit_content_filter")) {
+            explicit_content_filter = static_cast<discpp::specials::ExplicitContentFilterLevel>(json["explicit_content_filter"].GetInt());
+        }
+
+        if (ContainsNotNull(json, "features")) {
+            std::shared_ptr<std::vector<std::string>> parsed_features = std::make_shared<std::vector<std::string>>();
+            for (auto const& feature : json["features"].GetArray()) {
+                parsed_features->emplace_back(feature.GetString());
             }
+            // Keep sharing the old list when the features didn't change, which they rarely do.
+            if (*parsed_features != *features) features = std::move(parsed_features);
         }
 
-		if (ContainsNotNull(json, "presences") && ContainsNotNull(json, "members")) {
-            for (auto const& presence : json["presences"].GetArray()) {
-                rapidjson::Document presence_json;
-                presence_json.CopyFrom(presence, presence_json.GetAllocator());
+        if (ContainsNotNull(json, "mfa_level")) mfa_level = static_cast<discpp::specials::MFALevel>(json["mfa_level"].GetInt());
+        if (json.HasMember("application_id")) application_id = GetIDSafely(json, "application_id");
+        if (json.HasMember("widget_channel_id")) widget_channel_id = GetIDSafely(json, "widget_channel_id");
+        if (json.HasMember("system_channel_id")) system_channel_id = GetIDSafely(json, "system_channel_id");
+        if (ContainsNotNull(json, "system_channel_flags")) system_channel_flags = json["system_channel_flags"].GetInt();
+        if (json.HasMember("rules_channel_id")) rules_channel_id = GetIDSafely(json, "rules_channel_id");
 
-                auto it = members.find(discpp::Snowflake(presence_json["user"]["id"].GetString()));
+        if (ContainsNotNull(json, "joined_at")) {
+            joined_at = TimePointFromDiscord(json["joined_at"].GetString());
+        }
 
-                if (it != members.end()) {
-                    rapidjson::Document activity_json;
-                    if (ContainsNotNull(json, "game")) {
-                        activity_json.CopyFrom(json["game"], activity_json.GetAllocator());
-                    }
+        if (ContainsNotNull(json, "member_count")) member_count = json["member_count"].GetInt();
+        if (ContainsNotNull(json, "max_presences")) max_presences = json["max_presences"].GetInt();
+        if (ContainsNotNull(json, "max_members")) max_members = json["max_members"].GetInt();
 
-                    it->second->presence = std::make_unique<discpp::Presence>(presence_json);
+        if (json.HasMember("vanity_url_code")) {
+            vanity_url_code = json["vanity_url_code"].IsNull() ? "" : json["vanity_url_code"].GetString();
+        }
+        if (json.HasMember("description")) {
+            description = json["description"].IsNull() ? "" : json["description"].GetString();
+        }
+
+        if (ContainsNotNull(json, "premium_tier")) premium_tier = static_cast<discpp::specials::NitroTier>(json["premium_tier"].GetInt());
+        if (ContainsNotNull(json, "premium_subscription_count")) {
+            premium_subscription_count = json["premium_subscription_count"].GetInt();
+        }
+        if (ContainsNotNull(json, "preferred_locale")) preferred_locale = json["preferred_locale"].GetString();
+
+        if (json.HasMember("public_updates_channel_id")) {
+            public_updates_channel = discpp::Channel();
+
+            if (!json["public_updates_channel_id"].IsNull()) {
+                auto channel = channels->find(Snowflake(json["public_updates_channel_id"].GetString()));
+                if (channel != channels->end()) {
+                    public_updates_channel = channel->second;
                 }
             }
-		}
+        }
 	}
 
 	void Guild::DeleteGuild() {
@@ -218,55 +314,75 @@ namespace discpp {
 	}
 
     discpp::Channel Guild::GetChannel(const Snowflake& id) const {
-	    auto it = channels.find(id);
-	    if (it != channels.end()) {
-            return it->second;
+	    std::optional<discpp::Channel> channel = FindChannel(id);
+	    if (channel) {
+            return *channel;
 	    }
 
 		throw discpp::exceptions::DiscordObjectNotFound("Failed to find guild channel");
 	}
 
+    std::optional<discpp::Channel> Guild::FindChannel(const Snowflake& id) const {
+        auto it = channels->find(id);
+        if (it != channels->end()) {
+            return it->second;
+        }
+
+        return std::nullopt;
+    }
+
     discpp::Channel Guild::CreateChannel(const std::string& name, const std::string& topic, const ChannelType& type, const int& bitrate, const int& user_limit, const int& rate_limit_per_user, const int& position, const std::vector<discpp::Permissions>& permission_overwrites, const discpp::Snowflake& parent_id, const bool nsfw) {
 		Guild::EnsureBotPermission(Permission::MANAGE_CHANNELS);
         int tmp = bitrate;
 		if (tmp < 8000) tmp = 8000;
 
-		rapidjson::Document channel_json(rapidjson::kObjectType);
-        rapidjson::Document::AllocatorType& allocator = channel_json.GetAllocator();
-
-		rapidjson::Value permission_json_array(rapidjson::kArrayType);
-
-		for (auto permission : permission_overwrites) {
-			rapidjson::Document doc = permission.ToJson();
-			permission_json_array.PushBack(doc, allocator);
+		JsonWriter writer;
+		writer.StartObject();
+		writer.Key("name");
+		writer.String(name);
+		writer.Key("type");
+		writer.Int(static_cast<int>(type));
+		writer.Key("rate_limit_per_user");
+		writer.Int(rate_limit_per_user);
+		writer.Key("position");
+		writer.Int(position);
+		writer.Key("nsfw");
+		writer.Bool(nsfw);
+
+		if (!topic.empty()) {
+			writer.Key("topic");
+			writer.String(topic);
 		}
 
-		channel_json.AddMember("name", rapidjson::StringRef(name.c_str()), allocator);
-        channel_json.AddMember("type", type, allocator);
-        channel_json.AddMember("rate_limit_per_user", rate_limit_per_user, allocator);
-        channel_json.AddMember("position", position, allocator);
-        channel_json.AddMember("nsfw", nsfw, allocator);
-
-		if (!topic.empty()) channel_json.AddMember("topic", rapidjson::StringRef(EscapeString(topic).c_str()), allocator);
 		if (type == ChannelType::GUILD_VOICE) {
-            channel_json.AddMember("bitrate", tmp, allocator);
-            channel_json.AddMember("user_limit", user_limit, allocator);
+			writer.Key("bitrate");
+			writer.Int(tmp);
+			writer.Key("user_limit");
+			writer.Int(user_limit);
 		}
 
-		if (permission_json_array.Size() > 0) {
-            channel_json.AddMember("permission_overwrites", permission_json_array, allocator);
+		if (!permission_overwrites.empty()) {
+			writer.Key("permission_overwrites");
+			writer.StartArray();
+			for (const discpp::Permissions& permission : permission_overwrites) {
+				permission.ToJson(writer);
+			}
+			writer.EndArray();
 		}
 
 		if (parent_id != 0) {
-            channel_json.AddMember("parent_id", parent_id, allocator);
+			writer.Key("parent_id");
+			writer.Id(parent_id);
 		}
+		writer.EndObject();
 
-
-		cpr::Body body(DumpJson(channel_json));
+		cpr::Body body(writer.ToString());
 		std::unique_ptr<rapidjson::Document> result = SendPostRequest(Endpoint("/guilds/" + std::to_string(id) + "/channels"), DefaultHeaders({ { "Content-Type", "application/json" } }), id, discpp::RateLimitBucketType::CHANNEL, body);
 
         discpp::Channel channel(*result);
-        channels.insert({ channel.id, channel });
+        globals::client_instance->cache.UpdateGuildChannels(id, [&channel](discpp::GuildChannels& channels) {
+            channels.insert({ channel.id, channel });
+        });
 
 		return channel;
 	}
@@ -274,18 +390,19 @@ namespace discpp {
 	void Guild::ModifyChannelPositions(const std::vector<discpp::Channel>& new_channel_positions) {
 		Guild::EnsureBotPermission(Permission::MANAGE_CHANNELS);
 
-		rapidjson::Document json_raw(rapidjson::kArrayType);
-		auto array = json_raw.GetArray();
-
-		for (int i = 0; i < new_channel_positions.size(); i++) {
-		    rapidjson::Document channel_pos_json(rapidjson::kObjectType);
-		    channel_pos_json.AddMember("id", new_channel_positions[i].id, channel_pos_json.GetAllocator());
-            channel_pos_json.AddMember("position", i, channel_pos_json.GetAllocator());
-
-			json_raw.PushBack(channel_pos_json, json_raw.GetAllocator());
+		JsonWriter writer;
+		writer.StartArray();
+		for (std::size_t i = 0; i < new_channel_positions.size(); i++) {
+			writer.StartObject();
+			writer.Key("id");
+			writer.Id(new_channel_positions[i].id);
+			writer.Key("position");
+			writer.Uint64(i);
+			writer.EndObject();
 		}
+		writer.EndArray();
 
-		cpr::Body body(DumpJson(json_raw));
+		cpr::Body body(writer.ToString());
 		SendPatchRequest(Endpoint("/guilds/" + std::to_string(id) + "/channels"), DefaultHeaders({ { "Content-Type", "application/json" } }), id, discpp::RateLimitBucketType::CHANNEL, body);
 	}
 
@@ -295,15 +412,17 @@ namespace discpp {
 	    if (id == 0) {
 			throw exceptions::DiscordObjectNotFound("Member id: " + std::to_string(id) + " is not valid!");
 		} else {
-            auto it = members.find(id);
-            if (it != members.end()) {
-                member = it->second;
-            } else {
+            member = FindMember(id);
+            if (member == nullptr) {
                 if (can_request) {
                     std::unique_ptr<rapidjson::Document> result = SendGetRequest(Endpoint("/guilds/" + std::to_string(this->id) + "/members/"+ std::to_string(id)), DefaultHeaders(), id, RateLimitBucketType::CHANNEL);
 
-                    member = std::make_shared<discpp::Member>(*result, this->id);
-                    members.emplace(member->user.id, member);
+                    member = ParseMember(*result);
+
+                    // The bot's own member is kept under every policy, since each permission check needs it.
+                    if (CanCacheMember(true) || id == globals::client_instance->client_user.id) {
+                        members->Insert(member->user->id, member);
+                    }
                 } else {
                     throw exceptions::DiscordObjectNotFound("Member not found of id: " + std::to_string(id));
                 }
@@ -312,36 +431,162 @@ namespace discpp {
 	    return member;
 	}
 
+	std::shared_ptr<discpp::Member> Guild::FindMember(const Snowflake& id) const {
+	    return members->GetOr(id, nullptr);
+	}
+
+	std::shared_ptr<discpp::Member> Guild::ParseMember(rapidjson::Document& json) {
+	    return std::allocate_shared<discpp::Member>(discpp::SlabAllocator<discpp::Member>(member_slab.Get()), json, *this);
+	}
+
+	bool Guild::CanCacheMember(bool active) const {
+	    switch (globals::client_instance->config->cache_policy.members) {
+	    case MemberCachePolicy::ALL:
+	        return true;
+	    case MemberCachePolicy::LARGE_GUILDS:
+	        return IsLarge();
+	    case MemberCachePolicy::ACTIVE:
+	        return active;
+	    default:
+	        return false;
+	    }
+	}
+
 	void Guild::EnsureBotPermission(const Permission& req_perm) {
-	    auto tmp = GetMember(discpp::globals::client_instance->client_user.id);
-	    if (tmp) {
-            if (this->owner_id != tmp->user.id && !tmp->HasPermission(req_perm) && !tmp->HasPermission(Permission::ADMINISTRATOR)) {
-                globals::client_instance->logger->Error(LogTextColor::RED + "The bot does not have permission: " + PermissionToString(req_perm) + " (Exceptions like these should be handled)!");
+	    // The cache policy may skip the bot's own member, so request it instead of failing every check.
+	    const discpp::Snowflake& bot_id = discpp::globals::client_instance->client_user.id;
+	    std::shared_ptr<discpp::Member> bot_member = FindMember(bot_id);
+	    if (bot_member == nullptr) bot_member = GetMember(bot_id, true);
 
-                throw NoPermissionException(req_perm);
-            }
+	    if ((GetEffectivePermissions(*bot_member) & req_perm) != static_cast<uint64_t>(req_perm)) {
+	        globals::client_instance->logger->Error(LogTextColor::RED + "The bot does not have permission: " + PermissionToString(req_perm) + " (Exceptions like these should be handled)!");
+
+	        throw NoPermissionException(req_perm);
+	    }
+	}
+
+	uint64_t Guild::ComputePermissions(const discpp::Member& member, const discpp::Channel* channel) const {
+	    constexpr uint64_t all_permissions = ~static_cast<uint64_t>(0);
+
+	    if (member.user != nullptr && member.user->id == owner_id) {
+	        return all_permissions;
+	    }
+
+	    // The @everyone role shares its id with the guild.
+	    uint64_t permissions = 0;
+	    std::shared_ptr<discpp::Role> everyone = FindRole(id);
+	    if (everyone != nullptr) {
+	        permissions = everyone->permissions.allow_perms.value;
+	    }
+
+	    for (const discpp::Snowflake& role_id : member.roles) {
+	        std::shared_ptr<discpp::Role> role = FindRole(role_id);
+	        if (role != nullptr) {
+	            permissions |= role->permissions.allow_perms.value;
+	        }
+	    }
+
+	    if ((permissions & Permission::ADMINISTRATOR) == Permission::ADMINISTRATOR) {
+	        return all_permissions;
+	    }
+
+	    if (channel == nullptr) {
+	        return permissions;
+	    }
+
+	    uint64_t role_allow = 0;
+	    uint64_t role_deny = 0;
+	    const discpp::Permissions* everyone_overwrite = nullptr;
+	    const discpp::Permissions* member_overwrite = nullptr;
+	    for (const discpp::Permissions& overwrite : channel->permissions) {
+	        if (overwrite.permission_type == PermissionType::MEMBER) {
+	            if (member.user != nullptr && overwrite.role_user_id == member.user->id) {
+	                member_overwrite = &overwrite;
+	            }
+	        } else if (overwrite.role_user_id == id) {
+	            everyone_overwrite = &overwrite;
+	        } else if (std::find(member.roles.begin(), member.roles.end(), overwrite.role_user_id) != member.roles.end()) {
+	            role_allow |= overwrite.allow_perms.value;
+	            role_deny |= overwrite.deny_perms.value;
+	        }
+	    }
+
+	    if (everyone_overwrite != nullptr) {
+	        permissions &= ~everyone_overwrite->deny_perms.value;
+	        permissions |= everyone_overwrite->allow_perms.value;
+	    }
+
+	    permissions &= ~role_deny;
+	    permissions |= role_allow;
+
+	    if (member_overwrite != nullptr) {
+	        permissions &= ~member_overwrite->deny_perms.value;
+	        permissions |= member_overwrite->allow_perms.value;
+	    }
+
+	    return permissions;
+	}
+
+	uint64_t Guild::GetEffectivePermissions(const discpp::Member& member, const discpp::Snowflake& channel_id) const {
+	    discpp::Snowflake member_id = member.user != nullptr ? member.user->id : discpp::Snowflake();
+
+	    auto channel_it = channel_id != 0 ? channels->find(channel_id) : channels->end();
+	    discpp::Snowflake key = channel_it != channels->end() ? channel_id : discpp::Snowflake();
+
+	    const discpp::Channel* channel = channel_it != channels->end() ? &channel_it->second : nullptr;
+
+	    // The mask must match this member's roles and the roles of this snapshot, not just the member id.
+	    uint64_t stamp = PermissionStamp(owner_id, member, channel);
+	    uint64_t permissions;
+	    if (permission_cache->Get(member_id, key, stamp, roles, permissions)) {
+	        return permissions;
+	    }
+
+	    permissions = ComputePermissions(member, channel);
+	    permission_cache->Set(member_id, key, stamp, roles, permissions);
+
+	    return permissions;
+	}
+
+	void Guild::InvalidatePermissions(const discpp::Snowflake& member_id) const {
+	    if (member_id == 0) {
+	        permission_cache->Clear();
+	    } else {
+	        permission_cache->Invalidate(member_id);
 	    }
 	}
 
+	void Guild::InvalidateChannelPermissions(const discpp::Snowflake& channel_id) const {
+	    permission_cache->InvalidateChannel(channel_id);
+	}
+
 	std::shared_ptr<discpp::Member> Guild::AddMember(const Snowflake& id, const std::string& access_token, const std::string& nick, const std::vector<discpp::Role>& roles, const bool mute, const bool deaf) {
-		std::string json_roles = "[";
-		for (discpp::Role role : roles) {
-			if (&role == &roles.front()) {
-				json_roles += "\"" + std::to_string(role.id) + "\"";
-			} else {
-				json_roles += ", \"" + std::to_string(role.id) + "\"";
-			}
+		JsonWriter writer;
+		writer.StartObject();
+		writer.Key("access_token");
+		writer.String(access_token);
+		writer.Key("nick");
+		writer.String(nick);
+		writer.Key("roles");
+		writer.StartArray();
+		for (const discpp::Role& role : roles) {
+			writer.Id(role.id);
 		}
-		json_roles += "]";
-
-		cpr::Body body("{\"access_token\": \"" + access_token + "\", \"nick\": \"" + nick + "\", \"roles\": " + json_roles + ", \"mute\": " + std::to_string(mute) + ", \"deaf\": " + std::to_string(deaf) + "}");
+		writer.EndArray();
+		writer.Key("mute");
+		writer.Bool(mute);
+		writer.Key("deaf");
+		writer.Bool(deaf);
+		writer.EndObject();
+
+		cpr::Body body(writer.ToString());
 		std::unique_ptr<rapidjson::Document> result = SendPutRequest(Endpoint("/guilds/" + std::to_string(this->id) + "/members/" + std::to_string(id)), DefaultHeaders(), id, RateLimitBucketType::GUILD, body);
 
 		return std::make_shared<discpp::Member>((result->Empty()) ? discpp::Member(id, *this) : discpp::Member(*result, *this)); // If the member is already added, return it.
 	}
 
 	void Guild::RemoveMember(const discpp::Member& member) {
-		SendDeleteRequest(Endpoint("/guilds/" + std::to_string(id) + "/members/" + std::to_string(member.user.id)), DefaultHeaders(), id, RateLimitBucketType::GUILD);
+		SendDeleteRequest(Endpoint("/guilds/" + std::to_string(id) + "/members/" + std::to_string(member.user->id)), DefaultHeaders(), id, RateLimitBucketType::GUILD);
 	}
 
 	std::vector<discpp::GuildBan> Guild::GetBans() const {
@@ -370,14 +615,14 @@ namespace discpp {
 	}
 
 	std::string Guild::GetMemberBanReason(const discpp::Member& member) const {
-		std::unique_ptr<rapidjson::Document> result = SendGetRequest(Endpoint("/guilds/" + std::to_string(id) + "/bans/" + std::to_string(member.user.id)), DefaultHeaders(), id, RateLimitBucketType::GUILD);
+		std::unique_ptr<rapidjson::Document> result = SendGetRequest(Endpoint("/guilds/" + std::to_string(id) + "/bans/" + std::to_string(member.user->id)), DefaultHeaders(), id, RateLimitBucketType::GUILD);
 		if (ContainsNotNull(*result, "reason")) return (*result)["reason"].GetString();
 
 		return "";
 	}
 
 	void Guild::BanMember(const discpp::Member& member, const std::string& reason) {
-		BanMemberById(member.user.id, reason);
+		BanMemberById(member.user->id, reason);
 	}
 
     void Guild::BanMemberById(const discpp::Snowflake& user_id, const std::string& reason) {
@@ -386,8 +631,19 @@ namespace discpp {
         SendPutRequest(Endpoint("/guilds/" + std::to_string(id) + "/bans/" + std::to_string(user_id)), DefaultHeaders(), id, RateLimitBucketType::GUILD, body);
     }
 
+    std::future<void> Guild::BanMemberAsync(const discpp::Member& member, const std::string& reason) {
+        return BanMemberByIdAsync(member.user->id, reason);
+    }
+
+    std::future<void> Guild::BanMemberByIdAsync(const discpp::Snowflake& user_id, const std::string& reason) {
+        Guild::EnsureBotPermission(Permission::BAN_MEMBERS);
+        cpr::Body body("{\"reason\": \"" + EscapeString(reason) + "\"}");
+        return SendRequestAsync<void>("PUT", Endpoint("/guilds/" + std::to_string(id) + "/bans/" + std::to_string(user_id)), DefaultHeaders(), id,
+            RateLimitBucketType::GUILD, body, [](rapidjson::Document&) {});
+    }
+
 	void Guild::UnbanMember(const discpp::Member& member) {
-		UnbanMemberById(member.user.id);
+		UnbanMemberById(member.user->id);
 	}
 
     void Guild::UnbanMemberById(const Snowflake& user_id) {
@@ -396,7 +652,7 @@ namespace discpp {
     }
 
 	void Guild::KickMember(const discpp::Member& member, const std::string& reason) {
-		KickMemberById(member.user.id, reason);
+		KickMemberById(member.user->id, reason);
 	}
 
     void Guild::KickMemberById(const Snowflake& member_id, const std::string& reason) {
@@ -411,29 +667,30 @@ namespace discpp {
 	}
 
 	std::shared_ptr<discpp::Role> Guild::GetRole(const Snowflake& id) const {
-		auto it = roles.find(id);
-		if (it != roles.end()) {
-            return it->second;
+		std::shared_ptr<discpp::Role> role = FindRole(id);
+		if (role != nullptr) {
+            return role;
 		}
 
 		throw discpp::exceptions::DiscordObjectNotFound("Role not found!");
 	}
 
+	std::shared_ptr<discpp::Role> Guild::FindRole(const Snowflake& id) const {
+		auto it = roles->find(id);
+
+		return it != roles->end() ? it->second : nullptr;
+	}
+
     std::shared_ptr<discpp::Role> Guild::CreateRole(const std::string& name, const Permissions& permissions, const int& color, const bool hoist, const bool mentionable) {
 		Guild::EnsureBotPermission(Permission::MANAGE_ROLES);
 
-		rapidjson::Document json_body(rapidjson::kObjectType);
-		json_body.AddMember("name", rapidjson::StringRef(EscapeString(name).c_str()), json_body.GetAllocator());
-        json_body.AddMember("permissions", permissions.allow_perms.value, json_body.GetAllocator());
-        json_body.AddMember("color", color, json_body.GetAllocator());
-        json_body.AddMember("hoist", hoist, json_body.GetAllocator());
-        json_body.AddMember("mentionable", mentionable, json_body.GetAllocator());
-
-		cpr::Body body(DumpJson(json_body));
+		cpr::Body body(RoleBody(name, permissions, color, hoist, mentionable));
 		std::unique_ptr<rapidjson::Document> result = SendPostRequest(Endpoint("/guilds/" + std::to_string(id) + "/roles"), DefaultHeaders(), id, RateLimitBucketType::GUILD, body);
 		std::shared_ptr<discpp::Role> new_role = std::make_shared<discpp::Role>(discpp::Role(*result));
 
-		roles.insert({ new_role->id, new_role });
+		globals::client_instance->cache.UpdateGuildRoles(id, [&new_role](discpp::GuildRoles& roles) {
+			roles.insert({ new_role->id, new_role });
+		});
 
 		return new_role;
 	}
@@ -457,21 +714,16 @@ namespace discpp {
 	std::shared_ptr<discpp::Role> Guild::ModifyRole(const discpp::Role& role, const std::string& name, const Permissions& permissions, const int& color, const bool hoist, const bool mentionable) {
 		Guild::EnsureBotPermission(Permission::MANAGE_ROLES);
 
-		rapidjson::Document json_body(rapidjson::kObjectType);
-        json_body.AddMember("name", rapidjson::StringRef(EscapeString(name).c_str()), json_body.GetAllocator());
-        json_body.AddMember("permissions", permissions.allow_perms.value, json_body.GetAllocator());
-        json_body.AddMember("color", color, json_body.GetAllocator());
-        json_body.AddMember("hoist", hoist, json_body.GetAllocator());
-        json_body.AddMember("mentionable", mentionable, json_body.GetAllocator());
-
-		cpr::Body body(DumpJson(json_body));
+		cpr::Body body(RoleBody(name, permissions, color, hoist, mentionable));
 		std::unique_ptr<rapidjson::Document> result = SendPatchRequest(Endpoint("/guilds/" + std::to_string(id) + "/roles/" + std::to_string(role.id)), DefaultHeaders(), id, RateLimitBucketType::GUILD, body);
 		std::shared_ptr<discpp::Role> modified_role = std::make_shared<discpp::Role>(discpp::Role(*result));
 
-		auto it = roles.find(role.id);
-		if (it != roles.end()) {
-			it->second = modified_role;
-		}
+		globals::client_instance->cache.UpdateGuildRoles(id, [&modified_role](discpp::GuildRoles& roles) {
+			auto it = roles.find(modified_role->id);
+			if (it != roles.end()) {
+				it->second = modified_role;
+			}
+		});
 
 		return modified_role;
 	}
@@ -480,7 +732,9 @@ namespace discpp {
 		Guild::EnsureBotPermission(Permission::MANAGE_ROLES);
 		SendDeleteRequest(Endpoint("/guilds/" + std::to_string(id) + "/roles/" + std::to_string(role.id)), DefaultHeaders(), id, RateLimitBucketType::GUILD);
 
-		roles.erase(role.id);
+		globals::client_instance->cache.UpdateGuildRoles(id, [&role](discpp::GuildRoles& roles) {
+			roles.erase(role.id);
+		});
 	}
 
 	int Guild::GetPruneAmount(const int& days) const {
@@ -501,7 +755,7 @@ namespace discpp {
 	}
 
 	std::vector<discpp::GuildInvite> Guild::GetInvites() const {
-        std::unique_ptr<rapidjson::Document> result = SendGetRequest(Endpoint("/guilds/" + std::to_string(id) + "/invites"), DefaultHeaders(), {}, {});
+        std::unique_ptr<rapidjson::Document> result = SendGetRequest(Endpoint("/guilds/" + std::to_string(id) + "/invites"), DefaultHeaders(), id, RateLimitBucketType::GUILD);
 
         std::vector<discpp::GuildInvite> guild_invites;
         for (auto const& guild_invite : result->GetArray()) {
@@ -516,7 +770,7 @@ namespace discpp {
 	}
 
 	std::vector<discpp::Integration> Guild::GetIntegrations() const {
-        std::unique_ptr<rapidjson::Document> result = SendGetRequest(Endpoint("/guilds/" + std::to_string(id) + "/integrations"), DefaultHeaders(), {}, {});
+        std::unique_ptr<rapidjson::Document> result = SendGetRequest(Endpoint("/guilds/" + std::to_string(id) + "/integrations"), DefaultHeaders(), id, RateLimitBucketType::GUILD);
 
         std::vector<discpp::Integration> guild_integrations;
         for (auto const& guild_integration : result->GetArray()) {
@@ -591,7 +845,7 @@ namespace discpp {
 	}
 
 	std::unordered_map<Snowflake, Emoji> Guild::GetEmojis() {
-        std::unique_ptr<rapidjson::Document> result = SendGetRequest(Endpoint("/guilds/" + std::to_string(id) + "/emojis"), DefaultHeaders(), {}, {});
+        std::unique_ptr<rapidjson::Document> result = SendGetRequest(Endpoint("/guilds/" + std::to_string(id) + "/emojis"), DefaultHeaders(), id, RateLimitBucketType::GUILD);
 
         std::unordered_map<Snowflake, Emoji> emojis;
         for (auto const& emoji : result->GetArray()) {
@@ -604,7 +858,11 @@ namespace discpp {
             }
         }
 
-        this->emojis = emojis;
+        // Every emoji was fetched, so swap in a new map rather than copying the cached one.
+        std::shared_ptr<const discpp::GuildEmojis> fetched = std::make_shared<discpp::GuildEmojis>(emojis.begin(), emojis.end());
+        globals::client_instance->cache.UpdateGuild(id, [&fetched](discpp::Guild& copy) {
+            copy.emojis = fetched;
+        });
 	    return emojis;
 	}
 
@@ -616,21 +874,27 @@ namespace discpp {
     Emoji Guild::CreateEmoji(const std::string& name, discpp::Image& image, const std::vector<discpp::Role>& roles) {
 		Guild::EnsureBotPermission(Permission::MANAGE_EMOJIS);
 
-		rapidjson::Document role_json(rapidjson::kObjectType);
-		for (discpp::Role role : roles) {
-			role_json.PushBack(role.id, role_json.GetAllocator());
-		}
-
-        rapidjson::Document body_raw(rapidjson::kObjectType);
-        body_raw.AddMember("name", rapidjson::StringRef(EscapeString(name).c_str()), body_raw.GetAllocator());
-        body_raw.AddMember("image", rapidjson::StringRef(image.ToDataURI().c_str()), body_raw.GetAllocator());
-        body_raw.AddMember("roles", role_json, body_raw.GetAllocator());
+        JsonWriter writer;
+        writer.StartObject();
+        writer.Key("name");
+        writer.String(name);
+        writer.Key("image");
+        writer.String(image.ToDataURI());
+        writer.Key("roles");
+        writer.StartArray();
+        for (const discpp::Role& role : roles) {
+            writer.Id(role.id);
+        }
+        writer.EndArray();
+        writer.EndObject();
 
-		cpr::Body body(DumpJson(body_raw));
+		cpr::Body body(writer.ToString());
 		std::unique_ptr<rapidjson::Document> result = SendPostRequest(Endpoint("/guilds/" + std::to_string(id) + "/emojis"), DefaultHeaders({ { "Content-Type", "application/json" } }), id, RateLimitBucketType::GUILD, body);
 
         Emoji emoji = discpp::Emoji(*result);
-        emojis.insert({ emoji.id, emoji });
+        globals::client_instance->cache.UpdateGuildEmojis(id, [&emoji](discpp::GuildEmojis& emojis) {
+            emojis.insert({ emoji.id, emoji });
+        });
 
 		return emoji;
 	}
@@ -653,10 +917,12 @@ namespace discpp {
 
 		discpp::Emoji resulted_emoji = discpp::Emoji(*result);
 
-		auto it = emojis.find(resulted_emoji.id);
-		if (it != emojis.end()) {
-			it->second = resulted_emoji;
-		}
+		globals::client_instance->cache.UpdateGuildEmojis(id, [&resulted_emoji](discpp::GuildEmojis& emojis) {
+			auto it = emojis.find(resulted_emoji.id);
+			if (it != emojis.end()) {
+				it->second = resulted_emoji;
+			}
+		});
 
 		return resulted_emoji;
 	}
@@ -665,7 +931,9 @@ namespace discpp {
 		Guild::EnsureBotPermission(Permission::MANAGE_EMOJIS);
 		SendDeleteRequest(Endpoint("/guilds/" + std::to_string(this->id) + "/emojis/" + std::to_string(id)), DefaultHeaders(), id, RateLimitBucketType::GUILD);
 
-		emojis.erase(emoji.id);
+		globals::client_instance->cache.UpdateGuildEmojis(id, [&emoji](discpp::GuildEmojis& emojis) {
+			emojis.erase(emoji.id);
+		});
 	}
 
 	std::string Guild::GetIconURL(const discpp::ImageType& img_type) const {
@@ -768,7 +1036,7 @@ namespace discpp {
             std::variant<std::string, int, Image> variant = request.second;
             std::visit(overloaded {
                     [&](int i) { j_body[GuildPropertyToString(request.first).c_str()].SetInt(i); },
-                    [&](Image img) { j_body[GuildPropertyToString(request.first).c_str()].SetString(rapidjson::StringRef(img.ToDataURI().c_str())); },
+                    [&](Image img) { j_body[GuildPropertyToString(request.first).c_str()].SetString(img.ToDataURI(), j_body.GetAllocator()); },
                     [&](const std::string& str) { j_body[GuildPropertyToString(request.first).c_str()].SetString(rapidjson::StringRef(str.c_str())); }
             }, variant);
         }
@@ -893,9 +1161,19 @@ namespace discpp {
     GuildInvite::GuildInvite(rapidjson::Document &json) {
         code = json["code"].GetString();
         if (ContainsNotNull(json, "guild")) {
-            guild = discpp::globals::client_instance->cache.GetGuild(discpp::Snowflake(json["guild"]["id"].GetString()));
+            guild = discpp::globals::client_instance->cache.FindGuild(discpp::Snowflake(json["guild"]["id"].GetString()));
+        }
+
+        std::optional<discpp::Channel> cached_channel;
+        if (guild != nullptr) cached_channel = guild->FindChannel(Snowflake(json["channel"]["id"].GetString()));
+        if (cached_channel) {
+            channel = *cached_channel;
+        } else {
+            // Invites can point to guilds the client isn't in, so use the partial channel sent with it.
+            rapidjson::Document channel_json;
+            channel_json.CopyFrom(json["channel"], channel_json.GetAllocator());
+            channel = discpp::Channel(channel_json);
         }
-        channel = discpp::Channel(guild->GetChannel(Snowflake(json["channel"]["id"].GetString())));
         if (ContainsNotNull(json, "inviter")) {
             rapidjson::Document inviter_json;
             inviter_json.CopyFrom(json["inviter"], inviter_json.GetAllocator());
@@ -919,8 +1197,9 @@ namespace discpp {
 			rapidjson::Document member_json;
 			member_json.CopyFrom(json["member"], member_json.GetAllocator());
 
-			discpp::Guild guild(guild_id);
-			member = std::make_shared<discpp::Member>(member_json, guild);
+			// The guild isn't cached yet while its GUILD_CREATE is being parsed, so the member is optional.
+			std::shared_ptr<discpp::Guild> guild = globals::client_instance->cache.FindGuild(guild_id);
+			if (guild != nullptr) member = guild->ParseMember(member_json);
 		}
 		session_id = json["session_id"].GetString();
 		deaf = json["deaf"].GetBool();
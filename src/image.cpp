@@ -3,16 +3,92 @@
 #include "utils.h"
 #include "client.h"
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#undef WIN32_LEAN_AND_MEAN
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <fstream>
+
 namespace discpp {
 	std::string GetFileExtension(const std::string& file_name) {
 		return file_name.substr(file_name.find_last_of('.') + 1);
 	}
 
-	std::string Image::ToDataURI() {
-		if (image->is_open()) {
-			std::stringstream buffer;
-			buffer << image->rdbuf();
+	namespace {
+		// Read only view of a whole file, unmapped when it goes out of scope.
+		class MappedFile {
+		public:
+			explicit MappedFile(const std::string& path) {
+#ifdef _WIN32
+				file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+				if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("Failed to open image!");
+
+				LARGE_INTEGER file_size;
+				GetFileSizeEx(file, &file_size);
+				size = static_cast<std::size_t>(file_size.QuadPart);
+				if (size == 0) return;
+
+				mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+				if (mapping != nullptr) data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+				fd = open(path.c_str(), O_RDONLY);
+				if (fd < 0) throw std::runtime_error("Failed to open image!");
+
+				struct stat file_stat{};
+				fstat(fd, &file_stat);
+				size = static_cast<std::size_t>(file_stat.st_size);
+				if (size == 0) return;
+
+				void* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+				if (view != MAP_FAILED) {
+					madvise(view, size, MADV_SEQUENTIAL);
+					data = static_cast<const char*>(view);
+				}
+#endif
+				if (data == nullptr) {
+					Close();
+					throw std::runtime_error("Failed to map image!");
+				}
+			}
 
+			MappedFile(const MappedFile&) = delete;
+			MappedFile& operator=(const MappedFile&) = delete;
+
+			~MappedFile() {
+				Close();
+			}
+
+			const char* data = nullptr;
+			std::size_t size = 0;
+		private:
+			void Close() {
+#ifdef _WIN32
+				if (data != nullptr) UnmapViewOfFile(data);
+				if (mapping != nullptr) CloseHandle(mapping);
+				if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+				if (data != nullptr) munmap(const_cast<char*>(data), size);
+				if (fd >= 0) close(fd);
+#endif
+			}
+
+#ifdef _WIN32
+			HANDLE file = INVALID_HANDLE_VALUE;
+			HANDLE mapping = nullptr;
+#else
+			int fd = -1;
+#endif
+		};
+
+		std::string DataURIPrefix(const std::string& location) {
 			std::string ext = GetFileExtension(location);
 			std::string data_uri_ext = "";
 			if (ext == "jpg" || ext == "jpeg") {
@@ -25,9 +101,60 @@ namespace discpp {
 				throw std::runtime_error("The file extension, \"" + ext + "\" is not supported by Discord!");
 			}
 
-			return "data:image/" + data_uri_ext + ";base64," + Base64Encode(buffer.str());
+			return "data:image/" + data_uri_ext + ";base64,";
+		}
+
+		// Encode the rest of the stream in chunks straight into the data uri, without buffering the whole file.
+		void AppendStream(std::string& data_uri, std::ifstream& image) {
+			std::streamoff start = image.tellg();
+			image.seekg(0, std::ios::end);
+			std::streamoff end = image.tellg();
+			image.seekg(start);
+
+			if (start < 0 || end < start) {
+				std::string contents = ReadEntireFile(image);
+				std::size_t prefix = data_uri.size();
+				data_uri.resize(prefix + Base64EncodedSize(contents.size()));
+				Base64Encode(contents.data(), contents.size(), &data_uri[prefix]);
+				return;
+			}
+
+			std::size_t remaining = static_cast<std::size_t>(end - start);
+			std::size_t prefix = data_uri.size();
+			data_uri.resize(prefix + Base64EncodedSize(remaining));
+			char* out = &data_uri[prefix];
+
+			// A multiple of 3, so only the last chunk is padded.
+			char chunk[3 * 16384];
+			while (remaining > 0) {
+				std::size_t want = std::min(sizeof(chunk), remaining);
+				image.read(chunk, static_cast<std::streamsize>(want));
+				std::size_t read = static_cast<std::size_t>(image.gcount());
+				if (read != want) throw std::runtime_error("Failed to read image!");
+
+				out = Base64Encode(chunk, read, out);
+				remaining -= read;
+			}
+		}
+	}
+
+	std::string Image::ToDataURI() {
+		if (image == nullptr) {
+			std::string data_uri = DataURIPrefix(location);
+
+			MappedFile file(location);
+			std::size_t prefix = data_uri.size();
+			data_uri.resize(prefix + Base64EncodedSize(file.size));
+			Base64Encode(file.data, file.size, &data_uri[prefix]);
+
+			return data_uri;
+		} else if (image->is_open()) {
+			std::string data_uri = DataURIPrefix(location);
+			AppendStream(data_uri, *image);
+
+			return data_uri;
 		} else {
 			throw std::runtime_error("Failed to open image!");
 		}
 	}
-}
\ No newline at end of file
+}
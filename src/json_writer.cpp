@@ -0,0 +1,228 @@
+#include "json_writer.h"
+
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DISCPP_JSON_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace discpp {
+    namespace {
+        // Buffers larger than this aren't kept, so one huge body doesn't pin its memory to the thread.
+        constexpr std::size_t max_kept_capacity = 1 << 20;
+        constexpr std::size_t max_kept_buffers = 4;
+
+        thread_local std::vector<std::unique_ptr<std::string>> spare_buffers;
+
+        bool NeedsEscape(unsigned char c) {
+            return c < 0x20 || c == '"' || c == '\\';
+        }
+
+        // Index of the first byte that needs escaping, or the size of the text if none does.
+        std::size_t FindEscape(const char* text, std::size_t size) {
+            std::size_t i = 0;
+#ifdef DISCPP_JSON_SSE2
+            const __m128i quote = _mm_set1_epi8('"');
+            const __m128i backslash = _mm_set1_epi8('\\');
+            const __m128i control = _mm_set1_epi8(0x1f);
+
+            for (; i + 16 <= size; i += 16) {
+                __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+
+                // Bytes at most 0x1f are the ones left unchanged by an unsigned max with 0x1f.
+                __m128i matches = _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash));
+                matches = _mm_or_si128(matches, _mm_cmpeq_epi8(_mm_max_epu8(chunk, control), control));
+
+                int mask = _mm_movemask_epi8(matches);
+                if (mask != 0) {
+#if defined(_MSC_VER) && !defined(__clang__)
+                    unsigned long bit;
+                    _BitScanForward(&bit, static_cast<unsigned long>(mask));
+                    return i + bit;
+#else
+                    return i + __builtin_ctz(static_cast<unsigned>(mask));
+#endif
+                }
+            }
+#endif
+            for (; i < size; i++) {
+                if (NeedsEscape(static_cast<unsigned char>(text[i]))) return i;
+            }
+
+            return size;
+        }
+    }
+
+    void AppendEscapedJson(std::string& out, std::string_view text) {
+        static const char hex[] = "0123456789abcdef";
+
+        const char* data = text.data();
+        std::size_t size = text.size();
+        while (size > 0) {
+            std::size_t clean = FindEscape(data, size);
+            out.append(data, clean);
+            if (clean == size) return;
+
+            unsigned char c = static_cast<unsigned char>(data[clean]);
+            switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\b': out += "\\b"; break;
+                case '\f': out += "\\f"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default: {
+                    const char escaped[] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf] };
+                    out.append(escaped, sizeof(escaped));
+                }
+            }
+
+            data += clean + 1;
+            size -= clean + 1;
+        }
+    }
+
+    JsonWriter::JsonWriter() {
+        if (spare_buffers.empty()) {
+            buffer = new std::string();
+            buffer->reserve(256);
+        } else {
+            buffer = spare_buffers.back().release();
+            spare_buffers.pop_back();
+        }
+    }
+
+    JsonWriter::~JsonWriter() {
+        if (buffer->capacity() <= max_kept_capacity && spare_buffers.size() < max_kept_buffers) {
+            buffer->clear();
+            spare_buffers.emplace_back(buffer);
+        } else {
+            delete buffer;
+        }
+    }
+
+    void JsonWriter::BeforeValue() {
+        if (need_comma) buffer->push_back(',');
+    }
+
+    bool JsonWriter::StartObject() {
+        BeforeValue();
+        buffer->push_back('{');
+        need_comma = false;
+
+        return true;
+    }
+
+    bool JsonWriter::EndObject(rapidjson::SizeType) {
+        buffer->push_back('}');
+        need_comma = true;
+
+        return true;
+    }
+
+    bool JsonWriter::StartArray() {
+        BeforeValue();
+        buffer->push_back('[');
+        need_comma = false;
+
+        return true;
+    }
+
+    bool JsonWriter::EndArray(rapidjson::SizeType) {
+        buffer->push_back(']');
+        need_comma = true;
+
+        return true;
+    }
+
+    bool JsonWriter::Key(std::string_view key) {
+        BeforeValue();
+        buffer->push_back('"');
+        AppendEscapedJson(*buffer, key);
+        buffer->append("\":", 2);
+        need_comma = false;
+
+        return true;
+    }
+
+    bool JsonWriter::String(std::string_view text) {
+        BeforeValue();
+        buffer->push_back('"');
+        AppendEscapedJson(*buffer, text);
+        buffer->push_back('"');
+        need_comma = true;
+
+        return true;
+    }
+
+    bool JsonWriter::Null() {
+        return Raw("null");
+    }
+
+    bool JsonWriter::Bool(bool value) {
+        return Raw(value ? "true" : "false");
+    }
+
+    bool JsonWriter::Int64(int64_t value) {
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+
+        return Raw(std::string_view(digits, result.ptr - digits));
+    }
+
+    bool JsonWriter::Uint64(uint64_t value) {
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+
+        return Raw(std::string_view(digits, result.ptr - digits));
+    }
+
+    bool JsonWriter::Double(double value) {
+        // Json has no infinity or NaN.
+        if (!std::isfinite(value)) return Null();
+
+        // The shortest digits that parse back to the same double, so 0.1 stays 0.1 instead of 0.10000000000000001.
+        char digits[32];
+#if defined(__cpp_lib_to_chars)
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        std::size_t length = static_cast<std::size_t>(result.ptr - digits);
+#else
+        // Without floating point std::to_chars, try the precisions that can be needed from the shortest up.
+        int length = 0;
+        for (int precision = 15; precision <= 17; precision++) {
+            length = std::snprintf(digits, sizeof(digits), "%.*g", precision, value);
+            if (std::strtod(digits, nullptr) == value) break;
+        }
+#endif
+
+        return Raw(std::string_view(digits, static_cast<std::size_t>(length)));
+    }
+
+    bool JsonWriter::RawNumber(const char* number, rapidjson::SizeType length, bool) {
+        return Raw(std::string_view(number, length));
+    }
+
+    bool JsonWriter::Id(const Snowflake& id) {
+        char digits[24];
+        digits[0] = '"';
+        auto result = std::to_chars(digits + 1, digits + sizeof(digits) - 1, static_cast<uint64_t>(id));
+        *result.ptr = '"';
+
+        return Raw(std::string_view(digits, result.ptr + 1 - digits));
+    }
+
+    bool JsonWriter::Raw(std::string_view json) {
+        BeforeValue();
+        buffer->append(json.data(), json.size());
+        need_comma = true;
+
+        return true;
+    }
+}
@@ -1,7 +1,9 @@
 #include "member.h"
 #include "guild.h"
 #include "client.h"
+#include "client_config.h"
 #include "role.h"
+#include "json_writer.h"
 
 #include <climits>
 
@@ -11,7 +13,14 @@ namespace discpp {
 	}
 
 	Member::Member(rapidjson::Document& json, const discpp::Guild& guild) : guild_id(guild.id) {
-		user = ConstructDiscppObjectFromJson(json, "user", discpp::User());
+		if (ContainsNotNull(json, "user")) {
+			rapidjson::Document user_json;
+			user_json.CopyFrom(json["user"], user_json.GetAllocator());
+
+			user = globals::client_instance->cache.InternUser(user_json);
+		} else {
+			user = std::make_shared<discpp::User>();
+		}
 		nick = GetDataSafely<std::string>(json, "nick");
 
         int highest_hiearchy = 0;
@@ -20,7 +29,7 @@ namespace discpp {
 				rapidjson::Document role_json;
 				role_json.CopyFrom(role, role_json.GetAllocator());
 
-				auto tmp = guild.GetRole(discpp::Snowflake(role_json.GetString()));
+				auto tmp = guild.FindRole(discpp::Snowflake(role_json.GetString()));
 				if (tmp) {
                     std::shared_ptr<discpp::Role> r = tmp;
                     if (r->position > highest_hiearchy) {
@@ -31,15 +40,15 @@ namespace discpp {
 				}
 			}
 		}
-        joined_at = ContainsNotNull(json, "joined_at") ? TimeFromDiscord(json["joined_at"].GetString()) : 0;
-        premium_since = ContainsNotNull(json, "premium_since") ? TimeFromDiscord(json["premium_since"].GetString()) : 0;
+        joined_at = ContainsNotNull(json, "joined_at") ? static_cast<uint32_t>(TimeFromDiscord(json["joined_at"].GetString())) : 0;
+        premium_since = ContainsNotNull(json, "premium_since") ? static_cast<uint32_t>(TimeFromDiscord(json["premium_since"].GetString())) : 0;
 		if (GetDataSafely<bool>(json, "deaf")) {
 		    flags |= 0b1;
 		}
 		if (GetDataSafely<bool>(json, "mute")) {
             flags |= 0b10;
 		}
-		if (discpp::ContainsNotNull(json, "presence")) {
+		if (globals::client_instance->config->cache_policy.presences && discpp::ContainsNotNull(json, "presence")) {
             rapidjson::Document json_presence;
             json_presence.CopyFrom(json["presence"], json_presence.GetAllocator());
 
@@ -56,16 +65,25 @@ namespace discpp {
 	}
 
 	void Member::ModifyMember(const std::string& nick, std::vector<discpp::Role>& roles, const bool mute, const bool deaf, const Snowflake& channel_id) {
-		std::string json_roles = "[";
-		for (discpp::Role role : roles) {
-			if (&role == &roles.front()) {
-				json_roles += "\"" + std::to_string(role.id) + "\"";
-			}
-			else {
-				json_roles += ", \"" + std::to_string(role.id) + "\"";
-			}
+		JsonWriter writer;
+		writer.StartObject();
+		writer.Key("nick");
+		writer.String(nick);
+		writer.Key("roles");
+		writer.StartArray();
+		for (const discpp::Role& role : roles) {
+			writer.Id(role.id);
 		}
-		json_roles += "]";
+		writer.EndArray();
+		writer.Key("mute");
+		writer.Bool(mute);
+		writer.Key("deaf");
+		writer.Bool(deaf);
+		if (channel_id != 0) {
+			writer.Key("channel_id");
+			writer.Id(channel_id);
+		}
+		writer.EndObject();
 
 		// Update permissions variable.
 		discpp::Permissions permissions;
@@ -80,21 +98,21 @@ namespace discpp {
 			}
 		}
 
-		cpr::Body body("{\"nick\": \"" + EscapeString(nick) + "\", \"roles\": " + json_roles + ", \"mute\": " + std::to_string(mute) + ", \"deaf\": " + std::to_string(deaf) + "\"channel_id\": \"" + std::to_string(channel_id) + "\"" + "}");
-		SendPatchRequest(Endpoint("/guilds/" + std::to_string(this->user.id) + "/members/" + std::to_string(user.id)), DefaultHeaders({ { "Content-Type", "application/json" } }), guild_id, RateLimitBucketType::GUILD, body);
+		cpr::Body body(writer.ToString());
+		SendPatchRequest(Endpoint("/guilds/" + std::to_string(guild_id) + "/members/" + std::to_string(user->id)), DefaultHeaders({ { "Content-Type", "application/json" } }), guild_id, RateLimitBucketType::GUILD, body);
 	}
 
 	void Member::AddRole(const discpp::Role& role) {
-		SendPutRequest(Endpoint("/guilds/" + std::to_string(guild_id) + "/members/" + std::to_string(user.id) + "/roles/" + std::to_string(role.id)), DefaultHeaders(), guild_id, RateLimitBucketType::GUILD);
+		SendPutRequest(Endpoint("/guilds/" + std::to_string(guild_id) + "/members/" + std::to_string(user->id) + "/roles/" + std::to_string(role.id)), DefaultHeaders(), guild_id, RateLimitBucketType::GUILD);
 	}
 
 	void Member::RemoveRole(const discpp::Role& role) {
-		SendDeleteRequest(Endpoint("/guilds/" + std::to_string(guild_id) + "/members/" + std::to_string(user.id) + "/roles/" + std::to_string(role.id)), DefaultHeaders(), guild_id, RateLimitBucketType::GUILD);
+		SendDeleteRequest(Endpoint("/guilds/" + std::to_string(guild_id) + "/members/" + std::to_string(user->id) + "/roles/" + std::to_string(role.id)), DefaultHeaders(), guild_id, RateLimitBucketType::GUILD);
 	}
 
 	bool Member::IsBanned() {
 
-		std::unique_ptr<rapidjson::Document> result = SendGetRequest(Endpoint("/guilds/" + std::to_string(guild_id) + "/bans/" + std::to_string(user.id)), DefaultHeaders(), guild_id, RateLimitBucketType::GUILD);
+		std::unique_ptr<rapidjson::Document> result = SendGetRequest(Endpoint("/guilds/" + std::to_string(guild_id) + "/bans/" + std::to_string(user->id)), DefaultHeaders(), guild_id, RateLimitBucketType::GUILD);
 		rapidjson::Value::ConstMemberIterator itr = result->FindMember("reason");
 		return itr != result->MemberEnd();
 	}
@@ -110,25 +128,28 @@ namespace discpp {
     }
 
 	bool Member::HasPermission(const discpp::Permission& perm) {
-        discpp::Permissions permissions = GetPermissions();
-
-		// Check if the member has the permission, has the admin permission, or is the guild owner.
-		bool has_perm = permissions.allow_perms.HasPermission(perm) && !permissions.deny_perms.HasPermission(perm);
-		has_perm = has_perm || (permissions.allow_perms.HasPermission(Permission::ADMINISTRATOR) && !permissions.deny_perms.HasPermission(Permission::ADMINISTRATOR));
-		has_perm = has_perm || discpp::Guild(guild_id).owner_id == user.id;
+        // Owners and administrators are already given every permission by the guild.
+		return (GetGuild()->GetEffectivePermissions(*this) & perm) == static_cast<uint64_t>(perm);
+	}
 
-		return has_perm;
+	bool Member::HasPermission(const discpp::Permission& perm, const discpp::Channel& channel) {
+		return (GetGuild()->GetEffectivePermissions(*this, channel.id) & perm) == static_cast<uint64_t>(perm);
 	}
 
     discpp::Permissions Member::GetPermissions() {
         discpp::Permissions permissions;
 
         std::shared_ptr<discpp::Guild> guild = GetGuild();
+        bool first = true;
         for (auto const& role : roles) {
-            auto role_ptr = guild->GetRole(role);
-            if (role == roles.front()) {
+            // Skip roles that were deleted after this member was cached.
+            auto role_ptr = guild->FindRole(role);
+            if (role_ptr == nullptr) continue;
+
+            if (first) {
                 permissions.allow_perms.value = role_ptr->permissions.allow_perms.value;
                 permissions.deny_perms.value = role_ptr->permissions.deny_perms.value;
+                first = false;
             } else {
                 permissions.allow_perms.value |= role_ptr->permissions.allow_perms.value;
                 permissions.deny_perms.value |= role_ptr->permissions.deny_perms.value;
@@ -140,13 +161,13 @@ namespace discpp {
 
     int Member::GetHierarchy() {
 	    std::shared_ptr<discpp::Guild> guild = GetGuild();
-        if (guild->owner_id == user.id) {
+        if (guild->owner_id == user->id) {
             return INT_MAX;
         } else {
             int highest_hiearchy = 0;
             for (auto& role : roles) {
-                auto r_ptr = guild->GetRole(role);
-                if (r_ptr->position > highest_hiearchy) {
+                auto r_ptr = guild->FindRole(role);
+                if (r_ptr != nullptr && r_ptr->position > highest_hiearchy) {
                     highest_hiearchy = r_ptr->position;
                 }
             }
@@ -171,8 +192,21 @@ namespace discpp {
         this->flags = member.flags;
     }
 
-    Member Member::operator=(const discpp::Member& mbr) {
-        return std::move(Member(mbr));
+    Member& Member::operator=(const discpp::Member& mbr) {
+        if (this == &mbr) return *this;
+
+        this->user = mbr.user;
+        this->guild_id = mbr.guild_id;
+        this->nick = mbr.nick;
+
+        this->roles = mbr.roles;
+        this->joined_at = mbr.joined_at;
+        this->premium_since = mbr.premium_since;
+        this->presence = mbr.presence != nullptr ? std::make_unique<discpp::Presence>(*mbr.presence) : nullptr;
+
+        this->flags = mbr.flags;
+
+        return *this;
     }
 
     std::unordered_map<discpp::Snowflake, std::shared_ptr<discpp::Role>> Member::GetRoles() {
@@ -180,8 +214,8 @@ namespace discpp {
 
         std::shared_ptr<discpp::Guild> guild = GetGuild();
 	    for (auto const& role : roles) {
-	        auto r_ptr = guild->GetRole(role);
-            r.emplace(role, r_ptr);
+	        auto r_ptr = guild->FindRole(role);
+            if (r_ptr != nullptr) r.emplace(role, r_ptr);
 	    }
 
         return r;
@@ -192,8 +226,8 @@ namespace discpp {
 
         std::shared_ptr<discpp::Guild> guild = GetGuild();
         for (auto const& role : roles) {
-            auto r_ptr = guild->GetRole(role);
-            tmp.push_back(r_ptr);
+            auto r_ptr = guild->FindRole(role);
+            if (r_ptr != nullptr) tmp.push_back(r_ptr);
         }
 
         std::sort(tmp.begin(), tmp.end(), [](std::shared_ptr<discpp::Role> x, std::shared_ptr<discpp::Role> y) {
@@ -222,4 +256,8 @@ namespace discpp {
     std::shared_ptr<discpp::Guild> Member::GetGuild() {
         return discpp::globals::client_instance->cache.GetGuild(guild_id);
     }
+
+    std::shared_ptr<discpp::Guild> Member::FindGuild() const {
+        return discpp::globals::client_instance->cache.FindGuild(guild_id);
+    }
 }
\ No newline at end of file
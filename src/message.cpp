@@ -5,6 +5,7 @@
 #include "member.h"
 #include "embed_builder.h"
 #include "exceptions.h"
+#include "json_writer.h"
 
 namespace discpp {
 	Message::Message(const Snowflake& channel_id, const Snowflake& id, bool can_request) : discpp::DiscordObject(id) {
@@ -13,38 +14,49 @@ namespace discpp {
 
 	Message::Message(rapidjson::Document& json) {
 		id = GetIDSafely(json, "id");
-        channel = globals::client_instance->cache.GetChannel(discpp::Snowflake(json["channel_id"].GetString()));
-		try {
-            guild = channel.GetGuild();
-        } catch (const exceptions::DiscordObjectNotFound&) {
-		} catch (const exceptions::ProhibitedEndpointException&) {}
+        discpp::Snowflake channel_id(json["channel_id"].GetString());
+        std::optional<discpp::Channel> cached_channel = globals::client_instance->cache.FindChannel(channel_id);
+        if (cached_channel) {
+            channel = *cached_channel;
+        } else {
+            // Message creation is too hot a path to throw on a miss, so fall back to a partial channel.
+            channel.id = channel_id;
+            channel.guild_id = GetIDSafely(json, "guild_id");
+        }
+
+        if (channel.guild_id != 0) {
+            guild = globals::client_instance->cache.FindGuild(channel.guild_id);
+        }
 
 		author = ConstructDiscppObjectFromJson(json, "author", discpp::User());
         if (ContainsNotNull(json, "member")) {
             if (guild != nullptr) {
-                try {
-                    auto mbr = guild->GetMember(author.id);
-                    member = mbr;
-                } catch (const exceptions::DiscordObjectNotFound&) {
+                member = guild->FindMember(author.id);
+                if (member == nullptr) {
                     rapidjson::Document doc(rapidjson::kObjectType);
                     doc.CopyFrom(json["member"], doc.GetAllocator());
 
                     // Since the member isn't cached, create it.
-                    auto mbr = std::make_shared<discpp::Member>(discpp::Member(doc, *guild));
-                    mbr->user = author;
+                    auto mbr = guild->ParseMember(doc);
+                    rapidjson::Document author_json;
+                    author_json.CopyFrom(json["author"], author_json.GetAllocator());
+                    mbr->user = globals::client_instance->cache.InternUser(author_json);
                     member = mbr;
 
-                    // Add the new member into cache since it isn't already.
-                    guild->members.emplace(id, mbr);
+                    // Add the new member into cache since it isn't already. The store is shared by every
+                    // copy of the guild, so this doesn't replace the guild.
+                    if (guild->CanCacheMember(true)) {
+                        guild->members->Insert(mbr->user->id, mbr);
+                    }
                 }
             }
         }
 		content = GetDataSafely<std::string>(json, "content");
         if (discpp::ContainsNotNull(json, "timestamp")) {
-            timestamp = std::chrono::system_clock::from_time_t(TimeFromDiscord(json["timestamp"].GetString()));
+            timestamp = TimePointFromDiscord(json["timestamp"].GetString());
         }
 		if (discpp::ContainsNotNull(json, "edited_timestamp")) {
-		    edited_timestamp = std::chrono::system_clock::from_time_t(TimeFromDiscord(json["edited_timestamp"].GetString()));
+		    edited_timestamp = TimePointFromDiscord(json["edited_timestamp"].GetString());
 		}
 		if (GetDataSafely<bool>(json, "tts")) {
 		    bit_flags |= 0b1;
@@ -188,8 +200,14 @@ namespace discpp {
 
 	discpp::Message Message::EditMessage(const std::string& text) {
 		std::string endpoint = Endpoint("/channels/" + std::to_string(channel.id) + "/messages/" + std::to_string(id));
-		cpr::Body body("{\"content\": \"" + EscapeString(text) + "\"}");
-		std::unique_ptr<rapidjson::Document> result = SendPatchRequest(endpoint, DefaultHeaders({ { "Content-Type", "application/json" } }), id, RateLimitBucketType::CHANNEL);
+		JsonWriter writer;
+		writer.StartObject();
+		writer.Key("content");
+		writer.String(text);
+		writer.EndObject();
+
+		cpr::Body body(writer.ToString());
+		std::unique_ptr<rapidjson::Document> result = SendPatchRequest(endpoint, DefaultHeaders({ { "Content-Type", "application/json" } }), id, RateLimitBucketType::CHANNEL, body);
 
 		*this = discpp::Message(*result);
 		return *this;
@@ -198,8 +216,13 @@ namespace discpp {
 	discpp::Message Message::EditMessage(const discpp::EmbedBuilder& embed) {
 
 		std::string endpoint = Endpoint("/channels/" + std::to_string(channel.id) + "/messages/" + std::to_string(id));
-		std::unique_ptr<rapidjson::Document> json = embed.ToJson();
-		cpr::Body body("{\"embed\": " + DumpJson(*json) + "}");
+		JsonWriter writer;
+		writer.StartObject();
+		writer.Key("embed");
+		embed.ToJson(writer);
+		writer.EndObject();
+
+		cpr::Body body(writer.ToString());
 		std::unique_ptr<rapidjson::Document> result = SendPatchRequest(endpoint, DefaultHeaders({ { "Content-Type", "application/json" } }), id, RateLimitBucketType::CHANNEL, body);
 
         *this = discpp::Message(*result);
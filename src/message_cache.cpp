@@ -0,0 +1,223 @@
+#include "message_cache.h"
+#include "message.h"
+#include "embed_builder.h"
+
+#include <algorithm>
+#include <mutex>
+
+namespace discpp {
+    void MessageCache::SetLimits(std::size_t max_messages, std::size_t max_bytes) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+
+        this->max_messages = max_messages;
+        this->max_bytes = max_bytes;
+        EvictLocked();
+    }
+
+    void MessageCache::Insert(const std::shared_ptr<discpp::Message>& message) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        if (max_messages == 0) return;
+
+        std::size_t message_bytes = EstimateSize(*message);
+
+        auto it = index.find(message->id);
+        if (it != index.end()) {
+            bytes = bytes - it->second.bytes + message_bytes;
+            it->second.message = message;
+            it->second.bytes = message_bytes;
+
+            EvictLocked();
+            return;
+        }
+
+        index.emplace(message->id, Entry{ message, message->channel.id, message_bytes });
+        bytes += message_bytes;
+
+        // Messages almost always arrive newest last, so appending keeps the channel buffer sorted.
+        std::deque<discpp::Snowflake>& channel_buffer = channels[message->channel.id];
+        if (channel_buffer.empty() || channel_buffer.back() < message->id) {
+            channel_buffer.push_back(message->id);
+        } else {
+            channel_buffer.insert(std::lower_bound(channel_buffer.begin(), channel_buffer.end(), message->id), message->id);
+        }
+        eviction_heap.push_back(message->id);
+        std::push_heap(eviction_heap.begin(), eviction_heap.end(), std::greater<discpp::Snowflake>());
+
+        EvictLocked();
+    }
+
+    std::shared_ptr<discpp::Message> MessageCache::Update(const discpp::Snowflake& id, const std::function<void(discpp::Message&)>& func) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+
+        auto it = index.find(id);
+        if (it == index.end()) return nullptr;
+
+        std::shared_ptr<discpp::Message> updated = std::make_shared<discpp::Message>(*it->second.message);
+        func(*updated);
+
+        std::size_t message_bytes = EstimateSize(*updated);
+        bytes = bytes - it->second.bytes + message_bytes;
+        it->second.message = updated;
+        it->second.bytes = message_bytes;
+
+        EvictLocked();
+        return updated;
+    }
+
+    bool MessageCache::Get(const discpp::Snowflake& id, std::shared_ptr<discpp::Message>& out) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+
+        auto it = index.find(id);
+        if (it == index.end()) return false;
+
+        out = it->second.message;
+        return true;
+    }
+
+    std::shared_ptr<discpp::Message> MessageCache::Get(const discpp::Snowflake& id) const {
+        std::shared_ptr<discpp::Message> message;
+        Get(id, message);
+
+        return message;
+    }
+
+    bool MessageCache::Contains(const discpp::Snowflake& id) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+
+        return index.find(id) != index.end();
+    }
+
+    bool MessageCache::Take(const discpp::Snowflake& id, std::shared_ptr<discpp::Message>& out) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+
+        auto it = index.find(id);
+        if (it == index.end()) return false;
+
+        out = it->second.message;
+        EraseLocked(it);
+
+        return true;
+    }
+
+    bool MessageCache::Erase(const discpp::Snowflake& id) {
+        std::shared_ptr<discpp::Message> message;
+
+        return Take(id, message);
+    }
+
+    std::size_t MessageCache::EraseChannel(const discpp::Snowflake& channel_id) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+
+        auto channel_it = channels.find(channel_id);
+        if (channel_it == channels.end()) return 0;
+
+        // Copy the ids since erasing the last one removes the channel buffer.
+        std::deque<discpp::Snowflake> ids = channel_it->second;
+        for (const discpp::Snowflake& id : ids) {
+            auto it = index.find(id);
+            if (it != index.end()) EraseLocked(it);
+        }
+
+        return ids.size();
+    }
+
+    std::vector<std::shared_ptr<discpp::Message>> MessageCache::GetChannelMessages(const discpp::Snowflake& channel_id, std::size_t limit) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+
+        std::vector<std::shared_ptr<discpp::Message>> messages;
+        auto channel_it = channels.find(channel_id);
+        if (channel_it == channels.end()) return messages;
+
+        const std::deque<discpp::Snowflake>& ids = channel_it->second;
+        std::size_t start = (limit == 0 || limit >= ids.size()) ? 0 : ids.size() - limit;
+
+        messages.reserve(ids.size() - start);
+        for (std::size_t i = start; i < ids.size(); i++) {
+            messages.push_back(index.at(ids[i]).message);
+        }
+
+        return messages;
+    }
+
+    std::size_t MessageCache::Size() const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+
+        return index.size();
+    }
+
+    std::size_t MessageCache::Bytes() const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+
+        return bytes;
+    }
+
+    bool MessageCache::Empty() const {
+        return Size() == 0;
+    }
+
+    void MessageCache::Clear() {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+
+        index.clear();
+        channels.clear();
+        eviction_heap.clear();
+        bytes = 0;
+    }
+
+    std::size_t MessageCache::EstimateSize(const discpp::Message& message) {
+        std::size_t size = sizeof(discpp::Message);
+
+        size += message.content.capacity();
+        size += message.author.username.capacity();
+        size += message.channel.name.capacity() + message.channel.topic.capacity();
+        size += message.mentions.size() * (sizeof(std::pair<const discpp::Snowflake, discpp::User>) + 2 * sizeof(void*));
+        size += message.mentioned_roles.capacity() * sizeof(discpp::Snowflake);
+        size += message.mention_channels.size() * (sizeof(std::pair<const discpp::Snowflake, discpp::Message::ChannelMention>) + 2 * sizeof(void*));
+        size += message.attachments.capacity() * sizeof(discpp::Attachment);
+        size += message.embeds.capacity() * sizeof(discpp::EmbedBuilder);
+        size += message.reactions.capacity() * sizeof(discpp::Reaction);
+
+        return size;
+    }
+
+    void MessageCache::EraseLocked(discpp::SnowflakeMap<Entry>::iterator it) {
+        auto channel_it = channels.find(it->second.channel_id);
+        if (channel_it != channels.end()) {
+            std::deque<discpp::Snowflake>& ids = channel_it->second;
+
+            // The oldest message of a channel is what gets evicted, so check the front first.
+            if (!ids.empty() && ids.front() == it->first) {
+                ids.pop_front();
+            } else {
+                auto id_it = std::lower_bound(ids.begin(), ids.end(), it->first);
+                if (id_it != ids.end() && *id_it == it->first) ids.erase(id_it);
+            }
+
+            if (ids.empty()) channels.erase(channel_it);
+        }
+
+        bytes -= it->second.bytes;
+        index.erase(it);
+
+        // Explicitly erased ids are left in the heap, so rebuild it once it's mostly stale.
+        if (eviction_heap.size() > 2 * index.size() + 64) {
+            eviction_heap.clear();
+            for (const auto& entry : index) {
+                eviction_heap.push_back(entry.first);
+            }
+
+            std::make_heap(eviction_heap.begin(), eviction_heap.end(), std::greater<discpp::Snowflake>());
+        }
+    }
+
+    void MessageCache::EvictLocked() {
+        while (!eviction_heap.empty() && (index.size() > max_messages || (max_bytes != 0 && bytes > max_bytes))) {
+            std::pop_heap(eviction_heap.begin(), eviction_heap.end(), std::greater<discpp::Snowflake>());
+            discpp::Snowflake oldest = eviction_heap.back();
+            eviction_heap.pop_back();
+
+            auto it = index.find(oldest);
+            if (it != index.end()) EraseLocked(it);
+        }
+    }
+}
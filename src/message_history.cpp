@@ -0,0 +1,121 @@
+#include "message_history.h"
+#include "rest_engine.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <string_view>
+
+namespace discpp {
+    namespace {
+        Snowflake IdOf(const rapidjson::Value& json, const char* name) {
+            auto it = json.FindMember(name);
+            if (it == json.MemberEnd() || !it->value.IsString()) return Snowflake();
+
+            return Snowflake(std::string_view(it->value.GetString(), it->value.GetStringLength()));
+        }
+
+        std::size_t ArraySize(const rapidjson::Value& json, const char* name) {
+            auto it = json.FindMember(name);
+            return (it != json.MemberEnd() && it->value.IsArray()) ? it->value.Size() : 0;
+        }
+    }
+
+    MessageView::MessageView(const rapidjson::Value& json) {
+        id = IdOf(json, "id");
+        channel_id = IdOf(json, "channel_id");
+
+        auto author = json.FindMember("author");
+        if (author != json.MemberEnd() && author->value.IsObject()) {
+            author_id = IdOf(author->value, "id");
+
+            auto bot = author->value.FindMember("bot");
+            author_bot = bot != author->value.MemberEnd() && bot->value.IsBool() && bot->value.GetBool();
+        }
+
+        auto text = json.FindMember("content");
+        if (text != json.MemberEnd() && text->value.IsString()) {
+            content.assign(text->value.GetString(), text->value.GetStringLength());
+        }
+
+        auto time = json.FindMember("timestamp");
+        if (time != json.MemberEnd() && time->value.IsString()) {
+            timestamp = TimePointFromDiscord(std::string_view(time->value.GetString(), time->value.GetStringLength()));
+        }
+
+        auto pin = json.FindMember("pinned");
+        pinned = pin != json.MemberEnd() && pin->value.IsBool() && pin->value.GetBool();
+
+        attachment_count = ArraySize(json, "attachments");
+        embed_count = ArraySize(json, "embeds");
+    }
+
+    MessageHistoryPager::MessageHistoryPager(const Snowflake& channel_id, HistoryDirection direction, const Snowflake& start, std::size_t limit, Fetch fetch)
+            : channel_id(channel_id), direction(direction), cursor(start), remaining(limit), unlimited(limit == 0), fetch(std::move(fetch)) {
+        if (this->fetch == nullptr) {
+            this->fetch = [channel_id](const std::string& url) {
+                return SendGetRequestAsync(url, DefaultHeaders(), channel_id, RateLimitBucketType::CHANNEL);
+            };
+        }
+
+        Prefetch();
+    }
+
+    std::unique_ptr<rapidjson::Document> MessageHistoryPager::NextPage() {
+        if (!pending.valid()) {
+            auto empty = std::make_unique<rapidjson::Document>();
+            empty->SetArray();
+            return empty;
+        }
+
+        std::unique_ptr<rapidjson::Document> page = pending.get();
+        if (!page->IsArray()) page->SetArray();
+
+        // Discord sends every page newest first, walking towards newer messages needs it the other way around.
+        rapidjson::SizeType count = page->Size();
+        if (direction == HistoryDirection::NEWER && count > 1 && IdOf((*page)[0], "id") > IdOf((*page)[count - 1], "id")) {
+            for (rapidjson::SizeType i = 0; i < count / 2; i++) {
+                (*page)[i].Swap((*page)[count - 1 - i]);
+            }
+        }
+
+        if (!unlimited) remaining -= std::min<std::size_t>(remaining, count);
+        if (count > 0) cursor = IdOf((*page)[count - 1], "id");
+
+        // A short page is the end of the history.
+        exhausted = count < requested;
+        Prefetch();
+
+        return page;
+    }
+
+    void MessageHistoryPager::Prefetch() {
+        if (exhausted || (!unlimited && remaining == 0)) {
+            exhausted = true;
+            return;
+        }
+
+        requested = unlimited ? 100 : std::min<std::size_t>(remaining, 100);
+
+        std::string url = Endpoint("/channels/" + std::to_string(channel_id) + "/messages?limit=" + std::to_string(requested));
+        if (direction == HistoryDirection::OLDER) {
+            if (cursor != 0) url += "&before=" + std::to_string(cursor);
+        } else {
+            url += "&after=" + std::to_string(cursor);
+        }
+
+        pending = fetch(url);
+    }
+
+    template <>
+    discpp::Message ParseHistoryEntry<discpp::Message>(rapidjson::Value& json) {
+        rapidjson::Document message_json;
+        message_json.CopyFrom(json, message_json.GetAllocator());
+
+        return discpp::Message(message_json);
+    }
+
+    template <>
+    discpp::MessageView ParseHistoryEntry<discpp::MessageView>(rapidjson::Value& json) {
+        return discpp::MessageView(json);
+    }
+}
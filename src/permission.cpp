@@ -1,23 +1,35 @@
 #include "permission.h"
 #include "utils.h"
+#include "json_writer.h"
+
+#include <cstdlib>
 
 namespace discpp {
-	Permissions::Permissions(const PermissionType& permission_type, const int& byte_set) : permission_type(permission_type) {
+	uint64_t PermissionsFromJson(const rapidjson::Value& value) {
+		if (value.IsString()) {
+			return std::strtoull(value.GetString(), nullptr, 10);
+		}
+
+		return value.IsUint64() ? value.GetUint64() : static_cast<uint64_t>(value.GetInt64());
+	}
+
+	Permissions::Permissions(const PermissionType& permission_type, const uint64_t& byte_set) : permission_type(permission_type) {
 		allow_perms = PermissionOverwrite(byte_set);
 	}
 
 	Permissions::Permissions(rapidjson::Document& json) {
 		role_user_id = discpp::Snowflake(json["id"].GetString());
 		permission_type = (json["type"] == "role") ? PermissionType::ROLE : PermissionType::MEMBER;
-		allow_perms = PermissionOverwrite(json["allow"].GetInt());
-		deny_perms = PermissionOverwrite(json["deny"].GetInt());
+		allow_perms = PermissionOverwrite(PermissionsFromJson(json["allow"]));
+		deny_perms = PermissionOverwrite(PermissionsFromJson(json["deny"]));
 	}
 
-    rapidjson::Document Permissions::ToJson() {
+    rapidjson::Document Permissions::ToJson() const {
 		std::string str_type = (permission_type == PermissionType::ROLE) ? "role" : "member";
+		std::string str_id = std::to_string(role_user_id);
 
-        rapidjson::Document json;
-        json.AddMember("id", role_user_id, json.GetAllocator());
+        rapidjson::Document json(rapidjson::kObjectType);
+        json.AddMember("id", str_id, json.GetAllocator());
         json.AddMember("type", str_type, json.GetAllocator());
         json.AddMember("allow", allow_perms.value, json.GetAllocator());
         json.AddMember("deny", deny_perms.value, json.GetAllocator());
@@ -25,6 +37,19 @@ namespace discpp {
 		return json;
 	}
 
+    void Permissions::ToJson(JsonWriter& writer) const {
+        writer.StartObject();
+        writer.Key("id");
+        writer.Id(role_user_id);
+        writer.Key("type");
+        writer.String((permission_type == PermissionType::ROLE) ? "role" : "member");
+        writer.Key("allow");
+        writer.Uint64(allow_perms.value);
+        writer.Key("deny");
+        writer.Uint64(deny_perms.value);
+        writer.EndObject();
+    }
+
 	bool PermissionOverwrite::HasPermission(const Permission& permission) {
 		return (value & permission) == permission;
 	}
@@ -0,0 +1,175 @@
+#include "purge.h"
+#include "rest_engine.h"
+#include "json_writer.h"
+#include "utils.h"
+
+#include <algorithm>
+
+namespace discpp {
+    namespace {
+        // Bulk delete rejects messages older than 14 days, keep a margin for batches that wait on the bucket.
+        constexpr std::chrono::minutes bulk_delete_max_age = std::chrono::hours(24 * 14) - std::chrono::minutes(5);
+        constexpr std::size_t bulk_delete_max = 100;
+    }
+
+    MessagePurger::MessagePurger(const Snowflake& channel_id, PurgeOptions options) : channel_id(channel_id), options(std::move(options)) {
+        if (this->options.max_in_flight == 0) this->options.max_in_flight = 1;
+    }
+
+    PurgeProgress MessagePurger::PurgeWhere(const std::function<bool(const MessageView&)>& predicate, const Snowflake& before, std::size_t scan_limit) {
+        stopped = std::make_shared<std::atomic<bool>>(false);
+        for (const MessageView& message : MessageHistory<MessageView>(channel_id, HistoryDirection::OLDER, before, scan_limit)) {
+            progress.scanned++;
+            if (predicate(message)) Add(message.id);
+        }
+
+        return Finish();
+    }
+
+    PurgeProgress MessagePurger::PurgeIds(const std::vector<Snowflake>& messages) {
+        stopped = std::make_shared<std::atomic<bool>>(false);
+
+        PurgePlan plan = Plan(messages);
+        for (std::vector<Snowflake>& batch : plan.bulk_batches) {
+            SendBulk(std::move(batch));
+        }
+
+        for (const Snowflake& message : plan.singles) {
+            SendSingle(message);
+        }
+
+        return Finish();
+    }
+
+    PurgePlan MessagePurger::Plan(std::vector<Snowflake> messages, std::chrono::system_clock::time_point now) {
+        std::sort(messages.begin(), messages.end(), std::greater<>());
+        messages.erase(std::unique(messages.begin(), messages.end()), messages.end());
+
+        // Newest first, so the young messages are a prefix.
+        auto old = std::find_if(messages.begin(), messages.end(), [now](const Snowflake& message) { return !BulkDeletable(message, now); });
+
+        PurgePlan plan;
+        for (auto it = messages.begin(); it != old;) {
+            auto batch_end = it + std::min<std::ptrdiff_t>(bulk_delete_max, old - it);
+            plan.bulk_batches.emplace_back(it, batch_end);
+            it = batch_end;
+        }
+
+        // Bulk delete needs at least two messages, so a lone young message takes some of the batch before it.
+        if (plan.bulk_batches.size() == 1 && plan.bulk_batches.back().size() == 1) {
+            plan.singles.push_back(plan.bulk_batches.back().front());
+            plan.bulk_batches.pop_back();
+        } else if (plan.bulk_batches.size() > 1 && plan.bulk_batches.back().size() == 1) {
+            std::vector<Snowflake>& last = plan.bulk_batches.back();
+            std::vector<Snowflake>& previous = plan.bulk_batches[plan.bulk_batches.size() - 2];
+
+            std::size_t keep = (previous.size() + 2) / 2;
+            last.insert(last.begin(), previous.begin() + keep, previous.end());
+            previous.resize(keep);
+        }
+
+        plan.singles.insert(plan.singles.end(), old, messages.end());
+        return plan;
+    }
+
+    bool MessagePurger::BulkDeletable(const Snowflake& message, std::chrono::system_clock::time_point now) {
+        return TimeFromSnowflake(message) > std::chrono::system_clock::to_time_t(now - bulk_delete_max_age);
+    }
+
+    void MessagePurger::Add(const Snowflake& message) {
+        if (!BulkDeletable(message, std::chrono::system_clock::now())) {
+            SendSingle(message);
+            return;
+        }
+
+        // Hold back two messages past a full batch, so the last batch never ends up with a single message.
+        recent.push_back(message);
+        if (recent.size() == bulk_delete_max + 2) {
+            SendBulk(std::vector<Snowflake>(recent.begin(), recent.begin() + bulk_delete_max));
+            recent.erase(recent.begin(), recent.begin() + bulk_delete_max);
+        }
+    }
+
+    void MessagePurger::SendRecent() {
+        if (recent.size() == 1) {
+            SendSingle(recent.front());
+        } else if (recent.size() > bulk_delete_max) {
+            std::size_t half = (recent.size() + 1) / 2;
+            SendBulk(std::vector<Snowflake>(recent.begin(), recent.begin() + half));
+            SendBulk(std::vector<Snowflake>(recent.begin() + half, recent.end()));
+        } else if (!recent.empty()) {
+            SendBulk(std::move(recent));
+        }
+
+        recent.clear();
+    }
+
+    void MessagePurger::SendBulk(std::vector<Snowflake> batch) {
+        JsonWriter writer;
+        writer.StartObject();
+        writer.Key("messages");
+        writer.StartArray();
+        for (const Snowflake& message : batch) {
+            writer.Id(message);
+        }
+        writer.EndArray();
+        writer.EndObject();
+
+        RestEngine::Request request;
+        request.method = "POST";
+        request.url = Endpoint("/channels/" + std::to_string(channel_id) + "/messages/bulk-delete");
+        request.headers = DefaultHeaders({ { "Content-Type", "application/json" } });
+        request.body = writer.ToString();
+
+        Send(std::move(request), batch.size());
+    }
+
+    void MessagePurger::SendSingle(const Snowflake& message) {
+        RestEngine::Request request;
+        request.method = "DELETE";
+        request.url = Endpoint("/channels/" + std::to_string(channel_id) + "/messages/" + std::to_string(message));
+        request.headers = DefaultHeaders();
+
+        Send(std::move(request), 1);
+    }
+
+    void MessagePurger::Send(RestEngine::Request request, std::size_t count) {
+        // With stop_on_error, requests still waiting on the bucket when one fails are never sent.
+        if (options.stop_on_error) request.cancelled = stopped;
+
+        in_flight.emplace_back(SendRequestAsync<void>(std::move(request), channel_id, RateLimitBucketType::CHANNEL, [](rapidjson::Document&) {}), count);
+        Reap(options.max_in_flight);
+    }
+
+    void MessagePurger::Reap(std::size_t keep) {
+        while (in_flight.size() > keep) {
+            auto [response, count] = std::move(in_flight.front());
+            in_flight.pop_front();
+
+            try {
+                response.get();
+                progress.deleted += count;
+            } catch (...) {
+                if (options.stop_on_error) {
+                    *stopped = true;
+                    in_flight.clear();
+                    recent.clear();
+                    throw;
+                }
+
+                progress.failed += count;
+            }
+
+            if (options.on_progress) options.on_progress(progress);
+        }
+    }
+
+    PurgeProgress MessagePurger::Finish() {
+        SendRecent();
+        Reap(0);
+
+        PurgeProgress result = progress;
+        progress = {};
+        return result;
+    }
+}
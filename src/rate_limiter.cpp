@@ -0,0 +1,320 @@
+#include "rate_limiter.h"
+#include "ratelimit.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <cctype>
+#include <future>
+#include <iterator>
+
+namespace discpp {
+    namespace {
+        const std::string* FindHeader(const cpr::Header& header, const char* key) {
+            auto it = header.find(key);
+            return it != header.end() ? &it->second : nullptr;
+        }
+
+        bool IsId(const std::string& segment) {
+            return !segment.empty() && std::all_of(segment.begin(), segment.end(), [](unsigned char c) { return std::isdigit(c); });
+        }
+    }
+
+    RateLimiter::~RateLimiter() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+
+        timer_cv.notify_all();
+        if (timer.joinable()) timer.join();
+    }
+
+    void RateLimiter::Acquire(const std::string& method, const std::string& url, const Snowflake& major, Dispatch dispatch) {
+        std::vector<Dispatch> ready;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            std::shared_ptr<Bucket>& bucket = FindBucket(Route(method, url), major);
+            bucket->waiting.push_back(std::move(dispatch));
+            Drain(*bucket, Clock::now(), ready);
+        }
+
+        for (Dispatch& d : ready) d();
+    }
+
+    void RateLimiter::Acquire(const std::string& method, const std::string& url, const Snowflake& major) {
+        auto dispatched = std::make_shared<std::promise<void>>();
+        std::future<void> future = dispatched->get_future();
+
+        Acquire(method, url, major, [dispatched]() { dispatched->set_value(); });
+        future.wait();
+    }
+
+    bool RateLimiter::Complete(const std::string& method, const std::string& url, const Snowflake& major, const cpr::Response& response) {
+        std::vector<Dispatch> ready;
+        bool limited = response.status_code == 429;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            Clock::time_point now = Clock::now();
+            std::string route = Route(method, url);
+            RouteInfo& info = routes[route];
+
+            std::shared_ptr<Bucket> bucket = FindBucket(route, major);
+            bucket->in_flight = std::max(0, bucket->in_flight - 1);
+
+            // The first response naming the bucket hash moves the route over to the buckets shared by its hash.
+            const std::string* hash = FindHeader(response.header, "x-ratelimit-bucket");
+            if (hash != nullptr && *hash != info.hash) {
+                std::vector<std::string> old_keys;
+                if (info.hash.empty()) {
+                    // Requests for other major parameters may be queued or in flight under the route as well.
+                    std::string prefix = route + ":";
+                    for (const auto& entry : buckets) {
+                        if (entry.first.compare(0, prefix.size(), prefix) == 0 && IsId(entry.first.substr(prefix.size()))) {
+                            old_keys.push_back(entry.first);
+                        }
+                    }
+                } else {
+                    // Other routes may still share the old hash, so only this major parameter moves.
+                    old_keys.push_back(BucketKey(route, major));
+                }
+
+                info.hash = *hash;
+                for (const std::string& old_key : old_keys) {
+                    std::string new_key = *hash + old_key.substr(old_key.rfind(':'));
+                    Bucket& moved = MoveBucket(old_key, new_key);
+                    if (new_key != BucketKey(route, major)) Drain(moved, now, ready);
+                }
+                bucket = FindBucket(route, major);
+            }
+
+            const std::string* limit = FindHeader(response.header, "x-ratelimit-limit");
+            const std::string* remaining = FindHeader(response.header, "x-ratelimit-remaining");
+            const std::string* reset_after = FindHeader(response.header, "x-ratelimit-reset-after");
+            if (limit != nullptr) {
+                info.limit = bucket->limit = std::max(1, std::stoi(*limit));
+            }
+            if (remaining != nullptr && reset_after != nullptr) {
+                // Requests still in flight were sent after this response was counted.
+                bucket->remaining = std::max(0, std::stoi(*remaining) - bucket->in_flight);
+                bucket->reset_at = now + std::chrono::milliseconds(static_cast<int64_t>(std::stod(*reset_after) * 1000));
+            }
+
+            bool global_changed = false;
+            if (limited) {
+                rapidjson::Document json;
+                json.Parse(response.text.c_str());
+                Ratelimit ratelimit = json.IsObject() ? Ratelimit(json) : Ratelimit();
+                Clock::time_point retry_at = now + std::chrono::milliseconds(json.IsObject() ? ratelimit.retry_after : 1000);
+
+                if (FindHeader(response.header, "x-ratelimit-global") != nullptr || (json.IsObject() && ratelimit.global)) {
+                    global_until = std::max(global_until, retry_at);
+                    global_changed = true;
+                } else {
+                    bucket->remaining = 0;
+                    bucket->reset_at = std::max(bucket->reset_at, retry_at);
+                }
+            }
+
+            if (global_changed) {
+                ScheduleWake(global_until);
+            } else {
+                Drain(*bucket, now, ready);
+            }
+
+            if (++completions % 4096 == 0) PruneIdle(now);
+        }
+
+        for (Dispatch& d : ready) d();
+        return limited;
+    }
+
+    std::size_t RateLimiter::BucketCount() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return buckets.size();
+    }
+
+    std::size_t RateLimiter::Bytes() const {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        std::size_t bytes = 0;
+        for (const auto& bucket : buckets) {
+            bytes += bucket.first.capacity() + sizeof(bucket) + sizeof(Bucket) + bucket.second->waiting.size() * sizeof(Dispatch);
+        }
+        for (const auto& route : routes) {
+            bytes += route.first.capacity() + route.second.hash.capacity() + sizeof(route);
+        }
+
+        return bytes;
+    }
+
+    std::string RateLimiter::Route(const std::string& method, const std::string& url) {
+        // Skip the scheme, host and api version, and drop the query string.
+        std::size_t start = RouteStart(url);
+        std::size_t end = std::min(url.find('?'), url.size());
+
+        std::string route = method + " ";
+        std::string previous;
+        std::string before_previous;
+        while (start != std::string::npos && start < end) {
+            std::size_t next = std::min(url.find('/', start + 1), end);
+            std::string segment = url.substr(start + 1, next - start - 1);
+
+            if (IsId(segment)) {
+                route += "/:id";
+            } else if (before_previous == "webhooks") {
+                route += "/:token";
+            } else if (previous == "reactions") {
+                route += "/:emoji";
+            } else {
+                route += "/" + segment;
+            }
+
+            before_previous = std::move(previous);
+            previous = std::move(segment);
+            start = next;
+        }
+
+        return route;
+    }
+
+    std::size_t RateLimiter::RouteStart(const std::string& url) {
+        std::size_t end = std::min(url.find('?'), url.size());
+
+        const std::string& base = globals::api_base_url;
+        if (!base.empty() && url.compare(0, base.size(), base) == 0 && (base.size() == end || url[base.size()] == '/')) return base.size();
+
+        std::size_t api = url.find("/api/");
+        if (api < end) {
+            // The version is optional, Discord serves /api/channels as well.
+            std::size_t version_end = std::min(url.find('/', api + 5), end);
+            bool versioned = version_end > api + 6 && url[api + 5] == 'v'
+                && std::all_of(url.begin() + api + 6, url.begin() + version_end, [](char c) { return std::isdigit(static_cast<unsigned char>(c)) != 0; });
+
+            return versioned ? version_end : api + 4;
+        }
+
+        // Without an /api/ only the scheme and host come before the route, and a bare path starts with it.
+        std::size_t scheme = url.find("://");
+        if (scheme >= end) return 0;
+
+        return std::min(url.find('/', scheme + 3), end);
+    }
+
+    std::string RateLimiter::BucketKey(const std::string& route, const Snowflake& major) {
+        auto it = routes.find(route);
+        const std::string& bucket = (it != routes.end() && !it->second.hash.empty()) ? it->second.hash : route;
+
+        return bucket + ":" + std::to_string(major);
+    }
+
+    RateLimiter::Bucket& RateLimiter::MoveBucket(const std::string& from, const std::string& to) {
+        std::shared_ptr<Bucket> bucket = std::move(buckets.at(from));
+        buckets.erase(from);
+
+        std::shared_ptr<Bucket>& shared = buckets[to];
+        if (shared == nullptr) {
+            shared = bucket;
+        } else {
+            std::move(bucket->waiting.begin(), bucket->waiting.end(), std::back_inserter(shared->waiting));
+            shared->in_flight += bucket->in_flight;
+        }
+
+        return *shared;
+    }
+
+    std::shared_ptr<RateLimiter::Bucket>& RateLimiter::FindBucket(const std::string& route, const Snowflake& major) {
+        std::shared_ptr<Bucket>& bucket = buckets[BucketKey(route, major)];
+        if (bucket == nullptr) {
+            bucket = std::make_shared<Bucket>();
+
+            auto it = routes.find(route);
+            if (it != routes.end()) bucket->limit = bucket->remaining = it->second.limit;
+        }
+
+        return bucket;
+    }
+
+    void RateLimiter::Drain(Bucket& bucket, Clock::time_point now, std::vector<Dispatch>& ready) {
+        if (bucket.waiting.empty()) return;
+
+        if (now < global_until) {
+            ScheduleWake(global_until);
+            return;
+        }
+
+        if (bucket.reset_at != Clock::time_point() && now >= bucket.reset_at) {
+            bucket.remaining = bucket.limit;
+            bucket.reset_at = Clock::time_point();
+        }
+
+        // Without a known reset, only a response can free the budget. If none is coming, start over.
+        if (bucket.remaining <= 0 && bucket.reset_at == Clock::time_point() && bucket.in_flight == 0) {
+            bucket.remaining = bucket.limit;
+        }
+
+        while (!bucket.waiting.empty() && bucket.remaining > 0) {
+            bucket.remaining--;
+            bucket.in_flight++;
+            ready.push_back(std::move(bucket.waiting.front()));
+            bucket.waiting.pop_front();
+        }
+
+        if (!bucket.waiting.empty() && bucket.reset_at != Clock::time_point()) {
+            ScheduleWake(bucket.reset_at);
+        }
+    }
+
+    void RateLimiter::DrainAll(Clock::time_point now, std::vector<Dispatch>& ready) {
+        for (auto& bucket : buckets) {
+            Drain(*bucket.second, now, ready);
+        }
+    }
+
+    void RateLimiter::PruneIdle(Clock::time_point now) {
+        // An idle bucket past its reset is the same as a new one, the route remembers its limit.
+        for (auto it = buckets.begin(); it != buckets.end();) {
+            const Bucket& bucket = *it->second;
+            if (bucket.waiting.empty() && bucket.in_flight == 0 && bucket.reset_at <= now) {
+                it = buckets.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    void RateLimiter::ScheduleWake(Clock::time_point when) {
+        if (when >= next_wake) return;
+
+        next_wake = when;
+        if (!timer.joinable()) {
+            timer = std::thread(&RateLimiter::RunTimer, this);
+        }
+        timer_cv.notify_one();
+    }
+
+    void RateLimiter::RunTimer() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping) {
+            if (next_wake == Clock::time_point::max()) {
+                timer_cv.wait(lock);
+                continue;
+            }
+
+            if (timer_cv.wait_until(lock, next_wake) == std::cv_status::no_timeout && Clock::now() < next_wake) {
+                continue;
+            }
+
+            Clock::time_point now = Clock::now();
+            next_wake = Clock::time_point::max();
+
+            std::vector<Dispatch> ready;
+            DrainAll(now, ready);
+
+            lock.unlock();
+            for (Dispatch& d : ready) d();
+            lock.lock();
+        }
+    }
+}
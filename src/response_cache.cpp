@@ -0,0 +1,175 @@
+#include "response_cache.h"
+#include "rate_limiter.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace discpp {
+    void ResponseCache::SetTTL(const std::string& route, std::chrono::milliseconds ttl) {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (ttl.count() > 0) {
+            ttls[route] = ttl;
+        } else {
+            ttls.erase(route);
+        }
+    }
+
+    void ResponseCache::EnableDefaults() {
+        SetTTL("/guilds/:id/bans", std::chrono::seconds(60));
+        SetTTL("/guilds/:id/invites", std::chrono::seconds(60));
+        SetTTL("/guilds/:id/integrations", std::chrono::minutes(5));
+        SetTTL("/guilds/:id/emojis", std::chrono::minutes(5));
+        SetTTL("/guilds/:id/audit-logs", std::chrono::seconds(15));
+        SetTTL("/channels/:id/pins", std::chrono::seconds(60));
+        SetTTL("/users/@me/connections", std::chrono::minutes(5));
+    }
+
+    bool ResponseCache::Cacheable(const std::string& url) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return TTLFor(url).count() > 0;
+    }
+
+    std::unique_ptr<rapidjson::Document> ResponseCache::Get(const std::string& url) const {
+        std::shared_ptr<const rapidjson::Document> json;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            auto it = entries.find(url);
+            if (it == entries.end() || Clock::now() >= it->second.expires_at) return nullptr;
+            json = it->second.json;
+        }
+
+        return Copy(json);
+    }
+
+    std::string ResponseCache::GetETag(const std::string& url) const {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto it = entries.find(url);
+        return it != entries.end() ? it->second.etag : "";
+    }
+
+    std::unique_ptr<rapidjson::Document> ResponseCache::Revalidate(const std::string& url) {
+        std::shared_ptr<const rapidjson::Document> json;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            auto it = entries.find(url);
+            if (it == entries.end()) return nullptr;
+
+            it->second.expires_at = Clock::now() + it->second.ttl;
+            json = it->second.json;
+        }
+
+        return Copy(json);
+    }
+
+    uint64_t ResponseCache::Generation() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return current_generation;
+    }
+
+    void ResponseCache::Store(const std::string& url, const rapidjson::Document& json, const cpr::Header& header, uint64_t generation) {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        std::chrono::milliseconds ttl = TTLFor(url);
+        if (ttl.count() <= 0 || InvalidatedSince(url, generation)) return;
+
+        auto copy = std::make_shared<rapidjson::Document>();
+        copy->CopyFrom(json, copy->GetAllocator());
+
+        auto etag = header.find("etag");
+
+        Clock::time_point now = Clock::now();
+        if (entries.find(url) == entries.end()) MakeRoom(now);
+        entries[url] = { std::move(copy), etag != header.end() ? etag->second : "", now + ttl, ttl };
+    }
+
+    void ResponseCache::Invalidate(const std::string& url_prefix) {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // Forget old invalidations at once rather than growing forever, GETs from before then aren't stored.
+        if (invalidated.size() >= max_entries) {
+            invalidated.clear();
+            forgotten_generation = current_generation;
+        }
+        invalidated[url_prefix] = ++current_generation;
+
+        // Only whole path segments match, so /guilds/12 doesn't drop /guilds/123.
+        auto it = entries.lower_bound(url_prefix);
+        while (it != entries.end() && it->first.compare(0, url_prefix.size(), url_prefix) == 0) {
+            const std::string& url = it->first;
+            bool whole_segment = url.size() == url_prefix.size() || url[url_prefix.size()] == '/' || url[url_prefix.size()] == '?';
+
+            it = whole_segment ? entries.erase(it) : std::next(it);
+        }
+    }
+
+    void ResponseCache::InvalidateResource(const std::string& url) {
+        // The resource is the first two segments of the route, like /guilds/1234.
+        std::size_t start = RateLimiter::RouteStart(url);
+        if (start >= url.size() || url[start] != '/') return;
+
+        std::size_t end = url.find_first_of("/?", start + 1);
+        if (end != std::string::npos && url[end] == '/') end = url.find_first_of("/?", end + 1);
+
+        Invalidate(url.substr(0, end));
+    }
+
+    std::size_t ResponseCache::Size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return entries.size();
+    }
+
+    void ResponseCache::Clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        entries.clear();
+        invalidated.clear();
+        forgotten_generation = ++current_generation;
+    }
+
+    std::chrono::milliseconds ResponseCache::TTLFor(const std::string& url) const {
+        if (ttls.empty()) return std::chrono::milliseconds(0);
+
+        // Skip the method and the space RateLimiter::Route puts in front of the path.
+        auto it = ttls.find(RateLimiter::Route("GET", url).substr(4));
+        return it != ttls.end() ? it->second : std::chrono::milliseconds(0);
+    }
+
+    bool ResponseCache::InvalidatedSince(const std::string& url, uint64_t generation) const {
+        if (generation < forgotten_generation) return true;
+
+        // Invalidate matches whole path segments, so check every prefix that ends before a '/' or '?'.
+        for (std::size_t end = url.find_first_of("/?"); end != std::string::npos; end = url.find_first_of("/?", end + 1)) {
+            auto it = invalidated.find(url.substr(0, end));
+            if (it != invalidated.end() && it->second > generation) return true;
+        }
+
+        auto it = invalidated.find(url);
+        return it != invalidated.end() && it->second > generation;
+    }
+
+    void ResponseCache::MakeRoom(Clock::time_point now) {
+        if (entries.size() < max_entries) return;
+
+        for (auto it = entries.begin(); it != entries.end();) {
+            it = it->second.expires_at <= now ? entries.erase(it) : std::next(it);
+        }
+
+        while (!entries.empty() && entries.size() >= max_entries) {
+            auto oldest = std::min_element(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+                return a.second.expires_at < b.second.expires_at;
+            });
+            entries.erase(oldest);
+        }
+    }
+
+    std::unique_ptr<rapidjson::Document> ResponseCache::Copy(const std::shared_ptr<const rapidjson::Document>& json) {
+        auto copy = std::make_unique<rapidjson::Document>();
+        copy->CopyFrom(*json, copy->GetAllocator());
+
+        return copy;
+    }
+}
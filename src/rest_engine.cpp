@@ -0,0 +1,390 @@
+#include "rest_engine.h"
+#include "client.h"
+#include "log.h"
+#include "response_cache.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <vector>
+
+namespace discpp {
+    struct RestEngine::PartSource {
+        std::string_view data; /**< Buffer and span contents. */
+        std::istream* stream = nullptr;
+        int64_t stream_start = -1;
+        int64_t stream_size = -1;
+        std::size_t offset = 0;
+    };
+
+    struct RestEngine::Transfer {
+        Request request;
+        curl_slist* headers = nullptr;
+        curl_mime* mime = nullptr;
+        std::vector<std::unique_ptr<PartSource>> part_sources;
+        std::string response_text;
+        cpr::Header response_headers;
+        char error[CURL_ERROR_SIZE] = {};
+
+        ~Transfer() {
+            curl_slist_free_all(headers);
+            curl_mime_free(mime);
+        }
+    };
+
+    RestEngine::RestEngine() {
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+
+        multi = curl_multi_init();
+        curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+
+        // Only the loop thread uses the handles, so the share needs no lock callbacks.
+        share = curl_share_init();
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+
+        thread = std::thread(&RestEngine::Run, this);
+    }
+
+    RestEngine::~RestEngine() {
+        running = false;
+        curl_multi_wakeup(multi);
+        if (thread.joinable()) thread.join();
+
+        for (auto& transfer : transfers) {
+            curl_multi_remove_handle(multi, transfer.first);
+            curl_easy_cleanup(transfer.first);
+        }
+        transfers.clear();
+
+        curl_multi_cleanup(multi);
+        curl_share_cleanup(share);
+    }
+
+    RestEngine& RestEngine::Instance() {
+        static RestEngine engine;
+        return engine;
+    }
+
+    void RestEngine::Perform(Request request) {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+
+            std::chrono::steady_clock::time_point not_before = request.not_before;
+            queue.emplace(not_before, std::move(request));
+        }
+
+        pending++;
+        curl_multi_wakeup(multi);
+    }
+
+    void RestEngine::PerformRateLimited(Request request, const Snowflake& major, int retries) {
+        PerformRateLimited(std::move(request), major, rate_limiter, retries);
+    }
+
+    void RestEngine::PerformRateLimited(Request request, const Snowflake& major, RateLimiter& limiter, int retries) {
+        Callback callback = std::move(request.callback);
+        auto retry = std::make_shared<Request>(request);
+
+        request.callback = [this, retry, callback, major, &limiter, retries](cpr::Response& response) {
+            if (limiter.Complete(retry->method, retry->url, major, response) && retries > 0) {
+                Request again = *retry;
+                again.callback = callback;
+                PerformRateLimited(std::move(again), major, limiter, retries - 1);
+                return;
+            }
+
+            if (callback) callback(response);
+        };
+
+        std::string method = request.method;
+        std::string url = request.url;
+        limiter.Acquire(method, url, major, [this, request = std::move(request)]() mutable {
+            Perform(std::move(request));
+        });
+    }
+
+    std::size_t RestEngine::Pending() const {
+        return pending;
+    }
+
+    bool RestEngine::OnLoopThread() const {
+        return std::this_thread::get_id() == thread.get_id();
+    }
+
+    void RestEngine::Run() {
+        while (running) {
+            StartDueRequests();
+
+            int running_handles = 0;
+            curl_multi_perform(multi, &running_handles);
+
+            CURLMsg* message;
+            int messages_left = 0;
+            while ((message = curl_multi_info_read(multi, &messages_left)) != nullptr) {
+                if (message->msg == CURLMSG_DONE) {
+                    FinishTransfer(message->easy_handle, message->data.result);
+                }
+            }
+
+            // Sleep until there is socket activity, a new request, or the next delayed request is due.
+            int timeout_ms = 1000;
+            {
+                std::lock_guard<std::mutex> lock(queue_mutex);
+
+                if (!queue.empty()) {
+                    auto until_due = std::chrono::duration_cast<std::chrono::milliseconds>(queue.begin()->first - std::chrono::steady_clock::now());
+                    timeout_ms = static_cast<int>(std::max<int64_t>(0, std::min<int64_t>(until_due.count(), timeout_ms)));
+                }
+            }
+
+            curl_multi_poll(multi, nullptr, 0, timeout_ms, nullptr);
+        }
+    }
+
+    void RestEngine::StartDueRequests() {
+        std::vector<Request> due;
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+
+            auto now = std::chrono::steady_clock::now();
+            while (!queue.empty() && queue.begin()->first <= now) {
+                due.push_back(std::move(queue.begin()->second));
+                queue.erase(queue.begin());
+            }
+        }
+
+        for (Request& request : due) {
+            if (request.cancelled != nullptr && *request.cancelled) {
+                cpr::Response response;
+                response.url = cpr::Url{ request.url };
+
+                pending--;
+                if (request.callback) request.callback(response);
+                continue;
+            }
+
+            auto transfer = std::make_unique<Transfer>();
+            transfer->request = std::move(request);
+
+            bool multipart = !transfer->request.files.empty();
+            for (const auto& header : transfer->request.headers) {
+                // curl sets the multipart Content-Type itself, since it has to carry the boundary.
+                if (multipart && header.first == "Content-Type") continue;
+
+                transfer->headers = curl_slist_append(transfer->headers, (header.first + ": " + header.second).c_str());
+            }
+
+            CURL* handle = curl_easy_init();
+            curl_easy_setopt(handle, CURLOPT_URL, transfer->request.url.c_str());
+            curl_easy_setopt(handle, CURLOPT_HTTPHEADER, transfer->headers);
+            curl_easy_setopt(handle, CURLOPT_SHARE, share);
+            curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+            curl_easy_setopt(handle, CURLOPT_PIPEWAIT, 1L);
+            curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+            curl_easy_setopt(handle, CURLOPT_TIMEOUT_MS, static_cast<long>(transfer->request.timeout.count()));
+            curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT_MS, static_cast<long>(transfer->request.connect_timeout.count()));
+            curl_easy_setopt(handle, CURLOPT_ERRORBUFFER, transfer->error);
+            curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, &RestEngine::WriteCallback);
+            curl_easy_setopt(handle, CURLOPT_WRITEDATA, transfer.get());
+            curl_easy_setopt(handle, CURLOPT_HEADERFUNCTION, &RestEngine::HeaderCallback);
+            curl_easy_setopt(handle, CURLOPT_HEADERDATA, transfer.get());
+
+            const std::string& method = transfer->request.method;
+            if (multipart) {
+                if (method != "POST") curl_easy_setopt(handle, CURLOPT_CUSTOMREQUEST, method.c_str());
+                AttachMultipart(handle, *transfer);
+            } else if (method == "GET") {
+                curl_easy_setopt(handle, CURLOPT_HTTPGET, 1L);
+            } else {
+                // Discord wants a Content-Length even on empty PUT and DELETE requests, so always send the body.
+                if (method != "POST") curl_easy_setopt(handle, CURLOPT_CUSTOMREQUEST, method.c_str());
+                curl_easy_setopt(handle, CURLOPT_POSTFIELDSIZE, static_cast<long>(transfer->request.body.size()));
+                curl_easy_setopt(handle, CURLOPT_POSTFIELDS, transfer->request.body.c_str());
+            }
+
+            curl_multi_add_handle(multi, handle);
+            transfers.emplace(handle, std::move(transfer));
+        }
+    }
+
+    void RestEngine::FinishTransfer(CURL* handle, CURLcode result) {
+        auto it = transfers.find(handle);
+        std::unique_ptr<Transfer> transfer = std::move(it->second);
+        transfers.erase(it);
+
+        cpr::Response response;
+        response.url = cpr::Url{ transfer->request.url };
+        response.text = std::move(transfer->response_text);
+        response.header = std::move(transfer->response_headers);
+
+        long status_code = 0;
+        if (result == CURLE_OK) curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &status_code);
+        response.status_code = status_code;
+
+        double elapsed = 0;
+        curl_easy_getinfo(handle, CURLINFO_TOTAL_TIME, &elapsed);
+        response.elapsed = elapsed;
+
+        curl_multi_remove_handle(multi, handle);
+        curl_easy_cleanup(handle);
+
+        if (result != CURLE_OK && globals::client_instance != nullptr) {
+            globals::client_instance->logger->Debug("Async request to " + transfer->request.url + " failed: " + transfer->error);
+        }
+
+        // Anything but a GET may have changed what discpp::rest_cache holds for the resource, and the
+        // callback may read it again.
+        if (transfer->request.method != "GET") rest_cache.InvalidateResource(transfer->request.url);
+
+        pending--;
+        if (transfer->request.callback) transfer->request.callback(response);
+    }
+
+    void RestEngine::AttachMultipart(CURL* handle, Transfer& transfer) {
+        transfer.mime = curl_mime_init(handle);
+
+        const std::vector<File>& files = transfer.request.files;
+        for (std::size_t i = 0; i < files.size(); i++) {
+            const File& file = files[i];
+
+            curl_mimepart* part = curl_mime_addpart(transfer.mime);
+            curl_mime_name(part, ("file" + std::to_string(i)).c_str());
+
+            if (file.buffer != nullptr || !file.span.empty() || file.stream != nullptr) {
+                auto source = std::make_unique<PartSource>();
+                curl_off_t size;
+                if (file.stream != nullptr) {
+                    source->stream = file.stream.get();
+                    source->stream_start = file.stream_start;
+                    source->stream_size = file.stream_size;
+                    size = file.stream_size;
+                } else {
+                    source->data = file.buffer != nullptr ? std::string_view(*file.buffer) : file.span;
+                    size = static_cast<curl_off_t>(source->data.size());
+                }
+
+                curl_mime_data_cb(part, size, &RestEngine::ReadPartCallback, &RestEngine::SeekPartCallback, nullptr, source.get());
+                transfer.part_sources.push_back(std::move(source));
+            } else if (file.file_path.empty()) {
+                // An empty span has no contents to point at, and curl would try to open "" as a path.
+                curl_mime_data(part, "", 0);
+            } else {
+                curl_mime_filedata(part, file.file_path.c_str());
+            }
+
+            curl_mime_filename(part, file.file_name.c_str());
+            curl_mime_type(part, "application/octet-stream");
+        }
+
+        curl_mimepart* payload = curl_mime_addpart(transfer.mime);
+        curl_mime_name(payload, "payload_json");
+        curl_mime_data(payload, transfer.request.body.data(), transfer.request.body.size());
+        curl_mime_type(payload, "application/json");
+
+        curl_easy_setopt(handle, CURLOPT_MIMEPOST, transfer.mime);
+    }
+
+    size_t RestEngine::ReadPartCallback(char* buffer, size_t size, size_t count, void* user) {
+        PartSource* source = static_cast<PartSource*>(user);
+
+        if (source->stream != nullptr) {
+            // Only rewind once the upload starts, so a stream shared with a retry is read from its start again.
+            if (source->offset == 0 && source->stream_start >= 0) {
+                source->stream->clear();
+                source->stream->seekg(source->stream_start);
+            }
+
+            // curl announced the size, anything the stream has after it would corrupt the body.
+            std::size_t wanted = size * count;
+            if (source->stream_size >= 0) wanted = std::min(wanted, static_cast<std::size_t>(source->stream_size) - source->offset);
+
+            source->stream->read(buffer, static_cast<std::streamsize>(wanted));
+            std::size_t read = static_cast<std::size_t>(source->stream->gcount());
+            source->offset += read;
+
+            return (read == 0 && source->stream->bad()) ? CURL_READFUNC_ABORT : read;
+        }
+
+        std::size_t read = std::min(size * count, source->data.size() - source->offset);
+        std::memcpy(buffer, source->data.data() + source->offset, read);
+        source->offset += read;
+
+        return read;
+    }
+
+    int RestEngine::SeekPartCallback(void* user, curl_off_t offset, int origin) {
+        PartSource* source = static_cast<PartSource*>(user);
+        if (origin != SEEK_SET || offset < 0) return CURL_SEEKFUNC_CANTSEEK;
+
+        if (source->stream != nullptr) {
+            if (source->stream_start < 0) return CURL_SEEKFUNC_CANTSEEK;
+
+            source->stream->clear();
+            source->stream->seekg(source->stream_start + offset);
+            if (source->stream->fail()) return CURL_SEEKFUNC_FAIL;
+        } else if (static_cast<std::size_t>(offset) > source->data.size()) {
+            return CURL_SEEKFUNC_FAIL;
+        }
+
+        // Keep a non-zero offset for streams so the read callback doesn't rewind again.
+        source->offset = static_cast<std::size_t>(offset);
+        return CURL_SEEKFUNC_OK;
+    }
+
+    size_t RestEngine::WriteCallback(char* data, size_t size, size_t count, void* user) {
+        static_cast<Transfer*>(user)->response_text.append(data, size * count);
+        return size * count;
+    }
+
+    size_t RestEngine::HeaderCallback(char* data, size_t size, size_t count, void* user) {
+        Transfer* transfer = static_cast<Transfer*>(user);
+        std::string line(data, size * count);
+
+        // A new status line starts the headers of another response, like after a redirect.
+        if (line.compare(0, 5, "HTTP/") == 0) {
+            transfer->response_headers.clear();
+            return size * count;
+        }
+
+        std::size_t colon = line.find(':');
+        if (colon != std::string::npos) {
+            std::size_t value_start = line.find_first_not_of(" \t", colon + 1);
+            std::size_t value_end = line.find_last_not_of("\r\n");
+            std::string value = (value_start == std::string::npos || value_end < value_start) ? "" : line.substr(value_start, value_end - value_start + 1);
+
+            transfer->response_headers[line.substr(0, colon)] = value;
+        }
+
+        return size * count;
+    }
+
+    namespace {
+        std::unique_ptr<rapidjson::Document> MoveJson(rapidjson::Document& json) {
+            auto doc = std::make_unique<rapidjson::Document>();
+            doc->Swap(json);
+
+            return doc;
+        }
+    }
+
+    std::future<std::unique_ptr<rapidjson::Document>> SendGetRequestAsync(const std::string& url, const cpr::Header& headers, const Snowflake& object, const RateLimitBucketType& ratelimit_bucket, const cpr::Body& body) {
+        return SendRequestAsync<std::unique_ptr<rapidjson::Document>>("GET", url, headers, object, ratelimit_bucket, body, MoveJson);
+    }
+
+    std::future<std::unique_ptr<rapidjson::Document>> SendPostRequestAsync(const std::string& url, const cpr::Header& headers, const Snowflake& object, const RateLimitBucketType& ratelimit_bucket, const cpr::Body& body) {
+        return SendRequestAsync<std::unique_ptr<rapidjson::Document>>("POST", url, headers, object, ratelimit_bucket, body, MoveJson);
+    }
+
+    std::future<std::unique_ptr<rapidjson::Document>> SendPutRequestAsync(const std::string& url, const cpr::Header& headers, const Snowflake& object, const RateLimitBucketType& ratelimit_bucket, const cpr::Body& body) {
+        return SendRequestAsync<std::unique_ptr<rapidjson::Document>>("PUT", url, headers, object, ratelimit_bucket, body, MoveJson);
+    }
+
+    std::future<std::unique_ptr<rapidjson::Document>> SendPatchRequestAsync(const std::string& url, const cpr::Header& headers, const Snowflake& object, const RateLimitBucketType& ratelimit_bucket, const cpr::Body& body) {
+        return SendRequestAsync<std::unique_ptr<rapidjson::Document>>("PATCH", url, headers, object, ratelimit_bucket, body, MoveJson);
+    }
+
+    std::future<std::unique_ptr<rapidjson::Document>> SendDeleteRequestAsync(const std::string& url, const cpr::Header& headers, const Snowflake& object, const RateLimitBucketType& ratelimit_bucket) {
+        return SendRequestAsync<std::unique_ptr<rapidjson::Document>>("DELETE", url, headers, object, ratelimit_bucket, {}, MoveJson);
+    }
+}
@@ -0,0 +1,80 @@
+#include "rest_proxy.h"
+
+#include <algorithm>
+#include <cctype>
+#include <memory>
+
+namespace discpp {
+    namespace {
+        constexpr const char* forwarded_request_headers[] = { "Authorization", "User-Agent", "Content-Type", "X-Audit-Log-Reason" };
+
+        // Compares `name` to the lowercase `prefix`, ignoring the case of `name`.
+        bool StartsWithLower(const std::string& name, std::string_view prefix) {
+            return name.size() >= prefix.size() && std::equal(prefix.begin(), prefix.end(), name.begin(),
+                [](char lower, char c) { return std::tolower(static_cast<unsigned char>(c)) == lower; });
+        }
+
+        bool KeepResponseHeader(const std::string& name) {
+            return StartsWithLower(name, "x-ratelimit-") || (name.size() == 12 && StartsWithLower(name, "content-type"))
+                || (name.size() == 11 && StartsWithLower(name, "retry-after"));
+        }
+    }
+
+    std::future<cpr::Response> RestProxy::Forward(const std::string& method, const std::string& target, const cpr::Header& headers, std::string body) {
+        RestEngine::Request request;
+        request.method = method;
+        request.url = upstream + target;
+        request.body = std::move(body);
+
+        for (const char* name : forwarded_request_headers) {
+            auto it = headers.find(name);
+            if (it != headers.end()) request.headers[name] = it->second;
+        }
+
+        auto promise = std::make_shared<std::promise<cpr::Response>>();
+        std::future<cpr::Response> future = promise->get_future();
+
+        request.callback = [promise](cpr::Response& response) {
+            for (auto it = response.header.begin(); it != response.header.end();) {
+                it = KeepResponseHeader(it->first) ? std::next(it) : response.header.erase(it);
+            }
+
+            promise->set_value(std::move(response));
+        };
+
+        // The full url, so the route is found behind any base path of the upstream.
+        Snowflake major = MajorParameter(request.url);
+        auto authorization = request.headers.find("Authorization");
+        RateLimiter& limiter = LimiterFor(authorization != request.headers.end() ? authorization->second : "");
+
+        RestEngine::Instance().PerformRateLimited(std::move(request), major, limiter);
+        return future;
+    }
+
+    RateLimiter& RestProxy::LimiterFor(const std::string& authorization) {
+        std::lock_guard<std::mutex> lock(limiters_mutex);
+
+        std::unique_ptr<RateLimiter>& limiter = limiters[authorization];
+        if (limiter == nullptr) limiter = std::make_unique<RateLimiter>();
+
+        return *limiter;
+    }
+
+    Snowflake RestProxy::MajorParameter(const std::string& target) {
+        std::size_t start = RateLimiter::RouteStart(target);
+        std::size_t end = std::min(target.find('?'), target.size());
+        if (start >= end) return 0;
+
+        std::size_t resource_end = std::min(target.find('/', start + 1), end);
+        if (resource_end >= end) return 0;
+
+        std::string resource = target.substr(start + 1, resource_end - start - 1);
+        if (resource != "channels" && resource != "guilds" && resource != "webhooks") return 0;
+
+        std::size_t id_end = std::min(target.find('/', resource_end + 1), end);
+        std::string_view id(target.data() + resource_end + 1, id_end - resource_end - 1);
+        if (id.empty() || !std::all_of(id.begin(), id.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)) != 0; })) return 0;
+
+        return Snowflake(id);
+    }
+}
@@ -3,8 +3,8 @@
 
 namespace discpp {
 	Role::Role(const Snowflake& role_id, const discpp::Guild& guild) : DiscordObject(role_id) {
-		auto it = guild.roles.find(role_id);
-		if (it != guild.roles.end()) {
+		auto it = guild.roles->find(role_id);
+		if (it != guild.roles->end()) {
 			*this = *it->second;
 		}
 	}
@@ -17,7 +17,7 @@ namespace discpp {
             flags |= 0b1;
         }
 		position = json["position"].GetInt();
-        permissions = Permissions(PermissionType::ROLE, json["permissions"].GetInt());
+        permissions = Permissions(PermissionType::ROLE, PermissionsFromJson(json["permissions"]));
         if (GetDataSafely<bool>(json, "managed")) {
             flags |= 0b10;
         }
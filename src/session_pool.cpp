@@ -0,0 +1,65 @@
+#include "session_pool.h"
+
+namespace discpp {
+    SessionPool::Lease SessionPool::Acquire(const std::string& method) {
+        std::unique_ptr<cpr::Session> session;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            auto it = idle.find(method);
+            if (it != idle.end() && !it->second.empty()) {
+                session = std::move(it->second.back());
+                it->second.pop_back();
+                idle_count--;
+            }
+        }
+
+        if (session == nullptr) session = std::make_unique<cpr::Session>();
+        return Lease(*this, method, std::move(session));
+    }
+
+    void SessionPool::SetMaxIdle(std::size_t max_idle) {
+        std::vector<std::unique_ptr<cpr::Session>> dropped;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            this->max_idle = max_idle;
+            for (auto it = idle.begin(); it != idle.end() && idle_count > max_idle; it++) {
+                while (!it->second.empty() && idle_count > max_idle) {
+                    dropped.push_back(std::move(it->second.back()));
+                    it->second.pop_back();
+                    idle_count--;
+                }
+            }
+        }
+    }
+
+    std::size_t SessionPool::IdleCount() const {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        return idle_count;
+    }
+
+    void SessionPool::Clear() {
+        std::unordered_map<std::string, std::vector<std::unique_ptr<cpr::Session>>> dropped;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            dropped.swap(idle);
+            idle_count = 0;
+        }
+    }
+
+    void SessionPool::Release(const std::string& method, std::unique_ptr<cpr::Session> session) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (idle_count < max_idle) {
+                idle[method].push_back(std::move(session));
+                idle_count++;
+                return;
+            }
+        }
+
+        // Over the limit, the session and its connection are closed outside of the lock.
+    }
+}
@@ -0,0 +1,92 @@
+#include "slab.h"
+
+#include <algorithm>
+
+namespace discpp {
+    Slab* Slab::Create(std::size_t blocks_per_chunk) {
+        return new Slab(blocks_per_chunk == 0 ? 1 : blocks_per_chunk);
+    }
+
+    void Slab::Retain() noexcept {
+        references.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void Slab::Release() noexcept {
+        if (references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+
+    void* Slab::Allocate(std::size_t size, std::size_t alignment) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            // The first allocation decides the block size of this slab.
+            if (block_size == 0) {
+                block_alignment = std::max(alignment, alignof(FreeBlock));
+                block_size = std::max(size, sizeof(FreeBlock));
+                block_size = (block_size + block_alignment - 1) / block_alignment * block_alignment;
+            }
+
+            if (size <= block_size && alignment <= block_alignment) {
+                void* block;
+                if (free_list != nullptr) {
+                    block = free_list;
+                    free_list = free_list->next;
+                } else {
+                    if (chunk_cursor == chunk_end) {
+                        // new[] of unsigned char is aligned for any fundamental type, over-allocate for stricter ones.
+                        std::size_t chunk_bytes = block_size * blocks_per_chunk + block_alignment;
+                        chunks.emplace_back(new unsigned char[chunk_bytes]);
+
+                        void* start = chunks.back().get();
+                        std::align(block_alignment, block_size * blocks_per_chunk, start, chunk_bytes);
+                        chunk_cursor = static_cast<unsigned char*>(start);
+                        chunk_end = chunk_cursor + block_size * blocks_per_chunk;
+                    }
+
+                    block = chunk_cursor;
+                    chunk_cursor += block_size;
+                }
+
+                live_blocks++;
+                Retain();
+                return block;
+            }
+        }
+
+        void* ptr = ::operator new(size);
+        Retain();
+        return ptr;
+    }
+
+    void Slab::Deallocate(void* ptr, std::size_t size, std::size_t alignment) noexcept {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (size <= block_size && alignment <= block_alignment) {
+                FreeBlock* block = static_cast<FreeBlock*>(ptr);
+                block->next = free_list;
+                free_list = block;
+                live_blocks--;
+            } else {
+                ::operator delete(ptr);
+            }
+        }
+
+        // This may be the last reference, so it must happen after the lock is released.
+        Release();
+    }
+
+    std::size_t Slab::ReservedBytes() const {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        return chunks.size() * (block_size * blocks_per_chunk + block_alignment);
+    }
+
+    std::size_t Slab::LiveBlocks() const {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        return live_blocks;
+    }
+}
@@ -6,10 +6,18 @@
 #include <iomanip>
 
 namespace discpp {
+	namespace {
+		// Avatar hashes of animated avatars start with "a_".
+		void ParseAvatar(const std::string& icon_str, uint64_t out[2], bool& is_gif) {
+			is_gif = StartsWith(icon_str, "a_");
+			SplitAvatarHash(is_gif ? icon_str.substr(2) : icon_str, out);
+		}
+	}
+
 	User::User(const Snowflake& id) : discpp::DiscordObject(id) {
-		auto it = discpp::globals::client_instance->cache.members.find(id);
-		if (it != discpp::globals::client_instance->cache.members.end()) {
-			*this = it->second->user;
+		std::shared_ptr<discpp::User> user;
+		if (discpp::globals::client_instance->cache.users.Get(id, user)) {
+			*this = *user;
 		}
 	}
 
@@ -17,21 +25,57 @@ namespace discpp {
 		id = GetIDSafely(json, "id");
 		username = GetDataSafely<std::string>(json, "username");
 		discriminator = (unsigned short) strtoul(GetDataSafely<std::string>(json, "discriminator").c_str(), nullptr, 10);
-		if (ContainsNotNull(json, "avatar")) {
-			std::string icon_str = json["avatar"].GetString();
-
-			if (StartsWith(icon_str, "a_")) {
-				is_avatar_gif = true;
-				SplitAvatarHash(icon_str.substr(2), avatar_hex);
-			} else {
-				SplitAvatarHash(icon_str, avatar_hex);
-			}
-		}
+		if (ContainsNotNull(json, "avatar")) ParseAvatar(json["avatar"].GetString(), avatar_hex, is_avatar_gif);
 		if (GetDataSafely<bool>(json, "bot")) flags |= 0b1;
         if (GetDataSafely<bool>(json, "system")) flags |= 0b10;
 		//public_flags = GetDataSafely<int>(json, "public_flags");
 	}
 
+	bool User::Update(rapidjson::Document& json) {
+		const std::string old_username = username;
+		const unsigned char old_flags = flags;
+		const unsigned short old_discriminator = discriminator;
+		const uint64_t old_avatar_hex[2] = { avatar_hex[0], avatar_hex[1] };
+		const bool old_is_avatar_gif = is_avatar_gif;
+
+		if (ContainsNotNull(json, "username")) username = json["username"].GetString();
+		if (ContainsNotNull(json, "discriminator")) {
+			discriminator = (unsigned short) strtoul(json["discriminator"].GetString(), nullptr, 10);
+		}
+		if (json.HasMember("avatar")) {
+			is_avatar_gif = false;
+			avatar_hex[0] = avatar_hex[1] = 0;
+
+			if (!json["avatar"].IsNull()) ParseAvatar(json["avatar"].GetString(), avatar_hex, is_avatar_gif);
+		}
+		if (ContainsNotNull(json, "bot")) {
+			flags = json["bot"].GetBool() ? (flags | 0b1) : (flags & ~0b1);
+		}
+		if (ContainsNotNull(json, "system")) {
+			flags = json["system"].GetBool() ? (flags | 0b10) : (flags & ~0b10);
+		}
+
+		return username != old_username || flags != old_flags || discriminator != old_discriminator ||
+			avatar_hex[0] != old_avatar_hex[0] || avatar_hex[1] != old_avatar_hex[1] || is_avatar_gif != old_is_avatar_gif;
+	}
+
+	bool User::WouldChange(rapidjson::Document& json) const {
+		if (ContainsNotNull(json, "username") && username != json["username"].GetString()) return true;
+		if (ContainsNotNull(json, "discriminator") &&
+			discriminator != (unsigned short) strtoul(json["discriminator"].GetString(), nullptr, 10)) return true;
+		if (json.HasMember("avatar")) {
+			uint64_t new_avatar_hex[2] = { 0, 0 };
+			bool new_is_avatar_gif = false;
+			if (!json["avatar"].IsNull()) ParseAvatar(json["avatar"].GetString(), new_avatar_hex, new_is_avatar_gif);
+
+			if (avatar_hex[0] != new_avatar_hex[0] || avatar_hex[1] != new_avatar_hex[1] || is_avatar_gif != new_is_avatar_gif) return true;
+		}
+		if (ContainsNotNull(json, "bot") && json["bot"].GetBool() != ((flags & 0b1) != 0)) return true;
+		if (ContainsNotNull(json, "system") && json["system"].GetBool() != ((flags & 0b10) != 0)) return true;
+
+		return false;
+	}
+
 	User::Connection::Connection(rapidjson::Document& json) {
 
 		id = json["id"].GetString();
@@ -2,12 +2,16 @@
 #include "client.h"
 #include "client_config.h"
 #include "exceptions.h"
+#include "session_pool.h"
+#include "rate_limiter.h"
+#include "response_cache.h"
+#include "json_writer.h"
 
 #include <stdlib.h>
 #include <numeric>
 #include <iomanip>
-
-#include <rapidjson/writer.h>
+#include <future>
+#include <mutex>
 
 std::string discpp::GetOsName() {
 	#ifdef _WIN32
@@ -62,7 +66,7 @@ std::unique_ptr<rapidjson::Document> discpp::HandleResponse(cpr::Response& respo
             case 405:
                 response_msg = "METHOD NOT ALLOWED";
                 break;
-            case 249:
+            case 429:
                 response_msg = "TOO MANY REQUESTS";
                 break;
             case 502:
@@ -76,7 +80,6 @@ std::unique_ptr<rapidjson::Document> discpp::HandleResponse(cpr::Response& respo
         throw exceptions::http::HTTPResponseException(response.status_code, response_msg);
     }
 
-	HandleRateLimits(response.header, object, ratelimit_bucket);
 	tmp->Parse((!response.text.empty() ? response.text.c_str() : "{}"));
 
 	// Check if we were returned a json error and throw an exception if so.
@@ -88,6 +91,46 @@ std::unique_ptr<rapidjson::Document> discpp::HandleResponse(cpr::Response& respo
 	return tmp;
 }
 
+namespace {
+    // Point a pooled session at a new request. Every option a previous request set is overwritten here.
+    void PrepareSession(cpr::Session& session, const std::string& url, const cpr::Header& headers, const cpr::Body& body) {
+        session.SetUrl(cpr::Url{ url });
+        session.SetHeader(headers);
+        session.SetBody(body);
+    }
+
+    // A get request that is in flight. Callers asking for the same url wait for its result instead of sending their own.
+    struct InFlightGet {
+        std::promise<std::shared_ptr<const rapidjson::Document>> promise;
+        std::shared_future<std::shared_ptr<const rapidjson::Document>> result = promise.get_future().share();
+        int waiters = 0;
+    };
+
+    std::mutex in_flight_gets_mutex;
+    std::unordered_map<std::string, std::shared_ptr<InFlightGet>> in_flight_gets;
+
+    // Stop new callers from joining the request, and get how many already did.
+    int FinishInFlightGet(const std::string& url, const std::shared_ptr<InFlightGet>& flight) {
+        std::lock_guard<std::mutex> lock(in_flight_gets_mutex);
+        in_flight_gets.erase(url);
+
+        return flight->waiters;
+    }
+
+    // Send a request once its rate limit bucket allows it, and send it again if it still got a 429.
+    template <typename Perform>
+    cpr::Response PerformRateLimited(const std::string& method, const std::string& url, const discpp::Snowflake& object, Perform perform) {
+        for (int retries = discpp::RateLimiter::max_retries; ; retries--) {
+            discpp::rate_limiter.Acquire(method, url, object);
+            cpr::Response response = perform();
+
+            if (!discpp::rate_limiter.Complete(method, url, object, response) || retries == 0) {
+                return response;
+            }
+        }
+    }
+}
+
 std::string CprBodyToString(const cpr::Body& body) {
 	if (body.empty()) {
 		return "Empty";
@@ -100,10 +143,84 @@ std::unique_ptr<rapidjson::Document> discpp::SendGetRequest(const std::string& u
     if (globals::client_instance != nullptr) {
         globals::client_instance->logger->Debug("Sending get request, URL: " + url + ", body: " + CprBodyToString(body));
     }
-	WaitForRateLimits(object, ratelimit_bucket);
-	cpr::Response result = cpr::Get(cpr::Url{ url }, headers, body);
 
-    std::unique_ptr<rapidjson::Document> doc = HandleResponse(result, object, ratelimit_bucket);
+    bool cacheable = body.empty() && rest_cache.Cacheable(url);
+    if (cacheable) {
+        std::unique_ptr<rapidjson::Document> cached = rest_cache.Get(url);
+        if (cached != nullptr) return cached;
+    }
+
+    std::shared_ptr<InFlightGet> flight;
+    bool joined = false;
+    if (body.empty()) {
+        std::lock_guard<std::mutex> lock(in_flight_gets_mutex);
+
+        std::shared_ptr<InFlightGet>& in_flight = in_flight_gets[url];
+        if (in_flight == nullptr) {
+            in_flight = std::make_shared<InFlightGet>();
+        } else {
+            in_flight->waiters++;
+            joined = true;
+        }
+        flight = in_flight;
+    }
+
+    if (joined) {
+        std::shared_ptr<const rapidjson::Document> shared = flight->result.get();
+
+        auto doc = std::make_unique<rapidjson::Document>();
+        doc->CopyFrom(*shared, doc->GetAllocator());
+        return doc;
+    }
+
+    std::unique_ptr<rapidjson::Document> doc;
+    try {
+        // A stale cached response is revalidated instead of downloaded again if the server gave it an ETag.
+        cpr::Header request_headers = headers;
+        std::string etag = cacheable ? rest_cache.GetETag(url) : "";
+        if (!etag.empty()) request_headers["If-None-Match"] = etag;
+
+        auto send = [&]() {
+            return PerformRateLimited("GET", url, object, [&]() {
+                discpp::SessionPool::Lease session = rest_sessions.Acquire("GET");
+                PrepareSession(*session, url, request_headers, body);
+                return session->Get();
+            });
+        };
+
+        uint64_t generation = rest_cache.Generation();
+        cpr::Response result = send();
+
+        if (result.status_code == 304 && !etag.empty()) {
+            doc = rest_cache.Revalidate(url);
+
+            // The cached response was dropped while the request was in flight, so download it in full.
+            if (doc == nullptr) {
+                request_headers.erase("If-None-Match");
+                generation = rest_cache.Generation();
+                result = send();
+            }
+        }
+        if (doc == nullptr) {
+            doc = HandleResponse(result, object, ratelimit_bucket);
+            if (cacheable) rest_cache.Store(url, *doc, result.header, generation);
+        }
+    } catch (...) {
+        if (flight != nullptr) {
+            FinishInFlightGet(url, flight);
+            flight->promise.set_exception(std::current_exception());
+        }
+        throw;
+    }
+
+    if (flight != nullptr) {
+        std::shared_ptr<rapidjson::Document> shared;
+        if (FinishInFlightGet(url, flight) > 0) {
+            shared = std::make_shared<rapidjson::Document>();
+            shared->CopyFrom(*doc, shared->GetAllocator());
+        }
+        flight->promise.set_value(shared);
+    }
 
     // This shows an error in inteliisense for some reason but compiles fine.
 	return doc;
@@ -113,46 +230,73 @@ std::unique_ptr<rapidjson::Document> discpp::SendPostRequest(const std::string&
     if (globals::client_instance != nullptr) {
         globals::client_instance->logger->Debug("Sending post request, URL: " + url + ", body: " + CprBodyToString(body));
     }
-	WaitForRateLimits(object, ratelimit_bucket);
-	cpr::Response result = cpr::Post(cpr::Url{ url }, headers, body);
-	return HandleResponse(result, object, ratelimit_bucket);
+	cpr::Response result = PerformRateLimited("POST", url, object, [&]() {
+		discpp::SessionPool::Lease session = rest_sessions.Acquire("POST");
+		PrepareSession(*session, url, headers, body);
+		return session->Post();
+	});
+
+	std::unique_ptr<rapidjson::Document> doc = HandleResponse(result, object, ratelimit_bucket);
+	rest_cache.InvalidateResource(url);
+	return doc;
 }
 
 std::unique_ptr<rapidjson::Document> discpp::SendPutRequest(const std::string& url, const cpr::Header& headers, const Snowflake& object, const RateLimitBucketType& ratelimit_bucket, const cpr::Body& body) {
     if (globals::client_instance != nullptr) {
         globals::client_instance->logger->Debug("put patch request, URL: " + url + ", body: " + CprBodyToString(body));
     }
-	WaitForRateLimits(object, ratelimit_bucket);
-	cpr::Response result = cpr::Put(cpr::Url{ url }, headers, body);
-	return HandleResponse(result, object, ratelimit_bucket);
+	cpr::Response result = PerformRateLimited("PUT", url, object, [&]() {
+		discpp::SessionPool::Lease session = rest_sessions.Acquire("PUT");
+		PrepareSession(*session, url, headers, body);
+		return session->Put();
+	});
+
+	std::unique_ptr<rapidjson::Document> doc = HandleResponse(result, object, ratelimit_bucket);
+	rest_cache.InvalidateResource(url);
+	return doc;
 }
 
 std::unique_ptr<rapidjson::Document> discpp::SendPatchRequest(const std::string& url, const cpr::Header& headers, const Snowflake& object, const RateLimitBucketType& ratelimit_bucket, const cpr::Body& body) {
 	if (globals::client_instance != nullptr) {
         globals::client_instance->logger->Debug("Sending patch request, URL: " + url + ", body: " + CprBodyToString(body));
     }
-	WaitForRateLimits(object, ratelimit_bucket);
-	cpr::Response result = cpr::Patch(cpr::Url{ url }, headers, body);
-	return HandleResponse(result, object, ratelimit_bucket);
+	cpr::Response result = PerformRateLimited("PATCH", url, object, [&]() {
+		discpp::SessionPool::Lease session = rest_sessions.Acquire("PATCH");
+		PrepareSession(*session, url, headers, body);
+		return session->Patch();
+	});
+
+	std::unique_ptr<rapidjson::Document> doc = HandleResponse(result, object, ratelimit_bucket);
+	rest_cache.InvalidateResource(url);
+	return doc;
 }
 
 std::unique_ptr<rapidjson::Document> discpp::SendDeleteRequest(const std::string& url, const cpr::Header& headers, const Snowflake& object, const RateLimitBucketType& ratelimit_bucket) {
     if (globals::client_instance != nullptr) {
         globals::client_instance->logger->Debug("Sending delete request, URL: " + url);
     }
-	WaitForRateLimits(object, ratelimit_bucket);
-	cpr::Response result = cpr::Delete(cpr::Url{ url }, headers);
-	return HandleResponse(result, object, ratelimit_bucket);
+	cpr::Response result = PerformRateLimited("DELETE", url, object, [&]() {
+		discpp::SessionPool::Lease session = rest_sessions.Acquire("DELETE");
+		PrepareSession(*session, url, headers, {});
+		return session->Delete();
+	});
+
+	std::unique_ptr<rapidjson::Document> doc = HandleResponse(result, object, ratelimit_bucket);
+	rest_cache.InvalidateResource(url);
+	return doc;
 }
 
 cpr::Header discpp::DefaultHeaders(const cpr::Header& add) {
     cpr::Header headers = { { "User-Agent", "DiscordBot (https://github.com/seanomik/DisCPP, v0.0.0)" },
                             { "X-RateLimit-Precision", "millisecond"} };
-    // Add the correct authorization header depending on the token type.
-	if (globals::client_instance->config->type == TokenType::USER) {
-	    headers.insert({ "Authorization", discpp::globals::client_instance->token });
-	} else {
-        headers.insert({ "Authorization", "Bot " + discpp::globals::client_instance->token });
+    // Add the correct authorization header depending on the token type. Without a client there is no token,
+    // which webhooks don't need since theirs is in the url.
+	if (globals::client_instance != nullptr) {
+	    if (globals::client_instance->config->type == TokenType::USER) {
+	        headers.insert({ "Authorization", discpp::globals::client_instance->token });
+	    } else {
+	        headers.insert({ "Authorization", "Bot " + discpp::globals::client_instance->token });
+	    }
 	}
 
 	for (auto head : add) {
@@ -203,56 +347,6 @@ std::string discpp::ReadEntireFile(std::ifstream& file) {
 	return std::string((std::istreambuf_iterator<char>(file)), (std::istreambuf_iterator<char>()));
 }
 
-static const std::string base64_chars =
-        "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-        "abcdefghijklmnopqrstuvwxyz"
-        "0123456789+/";
-
-std::string discpp::Base64Encode(const std::string& text) {
-    unsigned char* buf = (unsigned char *) text.c_str();
-    size_t buf_len = text.size();
-    std::string ret;
-    int i = 0;
-    int j = 0;
-    unsigned char char_array_3[3];
-    unsigned char char_array_4[4];
-
-    while (buf_len--) {
-        char_array_3[i++] = *(buf++);
-        if (i == 3) {
-            char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-            char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-            char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-            char_array_4[3] = char_array_3[2] & 0x3f;
-
-            for (i = 0; (i < 4); i++)
-                ret += base64_chars[char_array_4[i]];
-            i = 0;
-        }
-    }
-
-    if (i) {
-        for (j = i; j < 3; j++) {
-            char_array_3[j] = '\0';
-        }
-
-        char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-        char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-        char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-        char_array_4[3] = char_array_3[2] & 0x3f;
-
-        for (j = 0; (j < i + 1); j++) {
-            ret += base64_chars[char_array_4[j]];
-        }
-
-        while ((i++ < 3)) {
-            ret += '=';
-        }
-    }
-
-    return ret;
-}
-
 std::string discpp::ReplaceAll(const std::string& data, const std::string& to_search, const std::string& replace_str) {
 	std::string tmp = data;
     // Get the first occurrence
@@ -270,58 +364,13 @@ std::string discpp::ReplaceAll(const std::string& data, const std::string& to_se
 }
 
 std::string discpp::EscapeString(const std::string& string) {
-    std::string tmp = string;
-	tmp = ReplaceAll(string, "\\", "\\\\");
-	tmp = ReplaceAll(string, "\"", "\\\"");
-	tmp = ReplaceAll(string, "\a", "\\a");
-	tmp = ReplaceAll(string, "\b", "\\b");
-	tmp = ReplaceAll(string, "\f", "\\f");
-	tmp = ReplaceAll(string, "\r", "\\r");
-	tmp = ReplaceAll(string, "\t", "\\t");
-	// \u + four-hex-digits
+    std::string tmp;
+    tmp.reserve(string.size() + 16);
+    AppendEscapedJson(tmp, string);
 
 	return tmp;
 }
 
-int discpp::WaitForRateLimits(const Snowflake& object, const RateLimitBucketType& ratelimit_bucket) {
-
-	RateLimit* rlmt = nullptr;
-
-	if (global_ratelimit.remaining_limit == 0) {
-		rlmt = &global_ratelimit;
-	}
-	else {
-		switch (ratelimit_bucket) {
-		case RateLimitBucketType::CHANNEL:
-			rlmt = &channel_ratelimit[object];
-			break;
-		case RateLimitBucketType::GUILD:
-			rlmt = &guild_ratelimit[object];
-			break;
-		case RateLimitBucketType::WEBHOOK:
-			rlmt = &webhook_ratelimit[object];
-			break;
-		case RateLimitBucketType::GLOBAL:
-			rlmt = &global_ratelimit;
-			break;
-		default:
-			globals::client_instance->logger->Error(LogTextColor::RED + "RateLimitBucketType is invalid!");
-			throw std::runtime_error("RateLimitBucketType is invalid!");
-			break;
-		}
-	}
-
-	if (rlmt->remaining_limit == 0) {
-		double milisecond_time = rlmt->ratelimit_reset * 1000 - time(NULL) * 1000;
-
-		if (milisecond_time > 0) {
-			globals::client_instance->logger->Debug("Rate limit wait time: " + std::to_string(milisecond_time) + " milliseconds");
-			std::this_thread::sleep_for(std::chrono::milliseconds((int)milisecond_time));
-		}
-	}
-	return 0;
-}
-
 bool HeaderContains(const cpr::Header& header, const std::string& key) {
 	/**
 	 * @brief Check if a cpr::Header contains a specific key.
@@ -342,72 +391,83 @@ bool HeaderContains(const cpr::Header& header, const std::string& key) {
 	return false;
 }
 
-void discpp::HandleRateLimits(cpr::Header& header, const Snowflake& object, const RateLimitBucketType& ratelimit_bucket) {
-	RateLimit* obj = nullptr;
-	if (HeaderContains(header, "x-ratelimit-global")) {
-		obj = &global_ratelimit;
-	} else if (HeaderContains(header, "x-ratelimit-limit")) {
-		switch (ratelimit_bucket) {
-		    case RateLimitBucketType::CHANNEL:
-		        obj = &channel_ratelimit[object];
-		        break;
-		    case RateLimitBucketType::GUILD:
-		        obj = &guild_ratelimit[object];
-		        break;
-		    case RateLimitBucketType::WEBHOOK:
-		        obj = &webhook_ratelimit[object];
-		        break;
-		    case RateLimitBucketType::GLOBAL:
-		        obj = &global_ratelimit;
-		        break;
-		    default:
-		        throw std::runtime_error("Invalid RateLimitBucketType!");
-		        break;
-		}
-	} else {
-		return;
-	}
+namespace {
+    // Parse exactly `count` decimal digits starting at `pos`, -1 if any of them isn't a digit.
+    inline int ParseDigits(std::string_view str, std::size_t pos, std::size_t count) {
+        int value = 0;
+        bool valid = true;
+        for (std::size_t i = 0; i < count; i++) {
+            unsigned int digit = static_cast<unsigned char>(str[pos + i]) - static_cast<unsigned int>('0');
+            valid &= digit <= 9;
+            value = value * 10 + static_cast<int>(digit);
+        }
 
-	obj->limit = std::stoi(header["x-ratelimit-limit"]);
-	obj->remaining_limit = std::stoi(header["x-ratelimit-remaining"]);
-	obj->ratelimit_reset = std::stod(header["x-ratelimit-reset"]);
-}
+        return valid ? value : -1;
+    }
 
-time_t discpp::TimeFromDiscord(const std::string &time) {
-    int year, month, day, hour, minute;
-    int timezone_hr = 0, timezone_min = 0;
-    float second;
-    if (6 < sscanf(time.c_str(), "%d-%d-%dT%d:%d:%f%d:%d", &year, &month, &day, &hour, &minute, &second, &timezone_hr, &timezone_min)) {
-        if (timezone_hr < 0) {
-            timezone_min = -timezone_min;
-        }
+    // Days between 1970-01-01 and a proleptic Gregorian date, from http://howardhinnant.github.io/date_algorithms.html
+    constexpr int64_t DaysFromCivil(int64_t year, unsigned int month, unsigned int day) {
+        year -= month <= 2;
+        const int64_t era = (year >= 0 ? year : year - 399) / 400;
+        const unsigned int year_of_era = static_cast<unsigned int>(year - era * 400);
+        const unsigned int day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+        const unsigned int day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
 
-        hour += timezone_hr;
-        minute += timezone_hr;
+        return era * 146097 + static_cast<int64_t>(day_of_era) - 719468;
+    }
+}
 
-        struct tm t{};
-        t.tm_year = year - 1900;
-        t.tm_mon = month - 1;
-        t.tm_mday = day;
-        t.tm_hour = hour;
-        t.tm_min = minute;
-        t.tm_sec = (int) second;
+std::chrono::system_clock::time_point discpp::TimePointFromDiscord(std::string_view time) {
+    // Every timestamp starts with "YYYY-MM-DDTHH:MM:SS", so the fixed part is read by position.
+    if (time.size() < 19 || time[4] != '-' || time[7] != '-' || (time[10] != 'T' && time[10] != ' ') || time[13] != ':' || time[16] != ':') {
+        throw std::runtime_error("Failed to parse time");
+    }
 
-        time_t utc_time = mktime(&t);
-        struct tm utc_buf;
+    int year = ParseDigits(time, 0, 4);
+    int month = ParseDigits(time, 5, 2);
+    int day = ParseDigits(time, 8, 2);
+    int hour = ParseDigits(time, 11, 2);
+    int minute = ParseDigits(time, 14, 2);
+    int second = ParseDigits(time, 17, 2);
 
-#ifndef __linux__
-        localtime_s(&utc_buf, &utc_time);
-#else
-        utc_buf = *localtime(&utc_time);
-#endif
+    if ((year | month | day | hour | minute | second) < 0 || month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60) {
+        throw std::runtime_error("Failed to parse time");
+    }
 
-        discpp::globals::client_instance->logger->Debug("Parsed time: " + FormatTime(utc_time));
+    std::size_t pos = 19;
+    int64_t milliseconds = 0;
+    if (pos < time.size() && time[pos] == '.') {
+        // Discord sends microseconds, only the first three digits are kept.
+        int digits = 0;
+        for (pos++; pos < time.size() && static_cast<unsigned int>(time[pos] - '0') <= 9; pos++, digits++) {
+            if (digits < 3) milliseconds = milliseconds * 10 + (time[pos] - '0');
+        }
+        for (; digits < 3; digits++) milliseconds *= 10;
+    }
+
+    int64_t offset_minutes = 0;
+    if (pos < time.size() && (time[pos] == '+' || time[pos] == '-')) {
+        int offset_hours = time.size() >= pos + 6 && time[pos + 3] == ':' ? ParseDigits(time, pos + 1, 2) : -1;
+        int offset_mins = offset_hours >= 0 ? ParseDigits(time, pos + 4, 2) : -1;
+        if (offset_mins < 0) throw std::runtime_error("Failed to parse time");
 
-        return utc_time;
+        offset_minutes = (time[pos] == '-' ? -1 : 1) * (offset_hours * 60 + offset_mins);
+        pos += 6;
+    } else if (pos < time.size() && (time[pos] == 'Z' || time[pos] == 'z')) {
+        pos++;
     }
 
-    throw std::runtime_error("Failed to parse time");
+    if (pos != time.size()) throw std::runtime_error("Failed to parse time");
+
+    int64_t seconds = DaysFromCivil(year, static_cast<unsigned int>(month), static_cast<unsigned int>(day)) * 86400 +
+        hour * 3600 + minute * 60 + second - offset_minutes * 60;
+
+    return std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+        std::chrono::milliseconds(seconds * 1000 + milliseconds)));
+}
+
+time_t discpp::TimeFromDiscord(std::string_view time) {
+    return std::chrono::system_clock::to_time_t(TimePointFromDiscord(time));
 }
 
 time_t discpp::TimeFromSnowflake(const Snowflake& snow) {
@@ -457,21 +517,14 @@ std::unique_ptr<rapidjson::Document> discpp::GetDocumentInsideJson(rapidjson::Do
 }
 
 std::string discpp::DumpJson(rapidjson::Document &json) {
-    rapidjson::StringBuffer buffer;
-    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-    json.Accept(writer);
-	std::string tmp = buffer.GetString();
-
-    return tmp;
+    return DumpJson(static_cast<rapidjson::Value&>(json));
 }
 
 std::string discpp::DumpJson(rapidjson::Value &json) {
-    rapidjson::StringBuffer buffer;
-    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    JsonWriter writer;
     json.Accept(writer);
-    std::string tmp = buffer.GetString();
 
-    return tmp;
+    return writer.ToString();
 }
 
 // Safe characters for URIEncode
@@ -3,15 +3,24 @@
 #include "message.h"
 #include "client.h"
 #include "guild.h"
-
-#include <fstream>
+#include "rest_engine.h"
+#include "json_writer.h"
+#include "exceptions.h"
 
 namespace discpp {
     Webhook::Webhook(rapidjson::Document& json) {
         id = discpp::Snowflake(json["id"].GetString());
         type = static_cast<WebhookType>(json["type"].GetInt());
-        guild = std::make_shared<discpp::Guild>(ConstructDiscppObjectFromID(json, "guild_id", discpp::Guild()));
-        channel = std::make_shared<discpp::Channel>(globals::client_instance->cache.GetChannel(discpp::Snowflake(json["guild_id"].GetString())));
+        discpp::Snowflake guild_id = GetIDSafely(json, "guild_id");
+        guild = globals::client_instance->cache.FindGuild(guild_id);
+        if (guild == nullptr) {
+            guild = std::make_shared<discpp::Guild>();
+            guild->id = guild_id;
+        }
+
+        discpp::Snowflake channel_id = GetIDSafely(json, "channel_id");
+        channel = std::make_shared<discpp::Channel>(globals::client_instance->cache.FindChannel(channel_id).value_or(discpp::Channel()));
+        channel->id = channel_id;
 		user = std::make_shared<discpp::User>(ConstructDiscppObjectFromJson(json, "user", discpp::User()));
         name = GetDataSafely<std::string>(json, "name");
         if (ContainsNotNull(json, "avatar")) {
@@ -26,71 +35,54 @@ namespace discpp {
 	};
 
 	discpp::Message Webhook::Send(const std::string& text, const bool tts, discpp::EmbedBuilder* embed, const std::vector<discpp::File>& files) {
-
-		std::string escaped_text = EscapeString(text);
-        rapidjson::Document message_json = rapidjson::Document(rapidjson::kObjectType);
-        message_json.Parse("{\"content\":\"" + escaped_text + (tts ? "\",\"tts\":\"true\"" : "\"") + "}");
-
-		if (escaped_text.size() >= 2000) {
-			// Write message to file
-			std::ofstream message("message.txt", std::ios::out | std::ios::binary);
-			message << message_json["content"].GetString();
-			message.close();
-
-			// Ensure the file will be deleted even if it runs into an exception sending the file.
-			discpp::Message sent_message;
-			try {
-				// Send the message
-				std::vector<discpp::File> files;
-				files.push_back({ "message.txt", "message.txt" });
-				sent_message = Send("Message was too large to fit in 2000 characters", tts, nullptr, files);
-
-				// Delete the temporary message file
-				remove("message.txt");
-			}
-			catch (std::exception e) {
-				// Delete the temporary message file
-				remove("message.txt");
-
-				throw std::exception(e);
-			}
-
-			return sent_message;
+		if (text.size() >= 2000) {
+			// Upload the message as a file, straight from memory.
+			return Send("Message was too large to fit in 2000 characters", tts, nullptr, { discpp::File::FromBuffer("message.txt", text) });
 		}
 
-		cpr::Body body;
+		JsonWriter writer;
+		writer.StartObject();
+		if (embed == nullptr || !text.empty()) {
+			writer.Key("content");
+			writer.String(text);
+			writer.Key("tts");
+			writer.Bool(tts);
+		}
 		if (embed != nullptr) {
-		    std::unique_ptr<rapidjson::Document> json = embed->ToJson();
-			body = cpr::Body("{\"embed\": " + DumpJson(*json) + ((!text.empty()) ? ", \"content\": \"" + escaped_text + (tts ? "\",\"tts\":\"true\"" : "\"") : "") + "}");
+			writer.Key("embed");
+			embed->ToJson(writer);
 		}
-		else if (!files.empty()) {
-			cpr::Multipart multipart_data{};
+		writer.EndObject();
 
-			for (int i = 0; i < files.size(); i++) {
-				multipart_data.parts.emplace_back("file" + std::to_string(i), cpr::File(files[i].file_path), "application/octet-stream");
+		if (embed == nullptr && !files.empty()) {
+			if (RestEngine::Instance().OnLoopThread()) {
+				throw exceptions::LoopThreadException("Webhook::Send can't wait for an upload on the REST engine's thread");
 			}
 
-			multipart_data.parts.emplace_back("payload_json", "{\"content\": \"" + escaped_text + (tts ? "\",\"tts\":\"true\"" : "\"") + "\"}");
-
-			WaitForRateLimits(id, RateLimitBucketType::WEBHOOK);
-			cpr::Response response = cpr::Post(cpr::Url{ Endpoint("/webhooks/" + std::to_string(id) + "/" + token) }, DefaultHeaders({ {"Content-Type", "multipart/form-data"} }), multipart_data);
-			HandleRateLimits(response.header, id, RateLimitBucketType::WEBHOOK);
+			RestEngine::Request request;
+			request.method = "POST";
+			request.url = Endpoint("/webhooks/" + std::to_string(id) + "/" + token);
+			request.headers = DefaultHeaders();
+			request.body = writer.ToString();
+			request.files = files;
 
-            rapidjson::Document result_json(rapidjson::kObjectType);
-            result_json.Parse(response.text);
-			return discpp::Message(result_json);
-		} else {
-			body = cpr::Body(DumpJson(message_json));
+			return SendRequestAsync<discpp::Message>(std::move(request), id, RateLimitBucketType::WEBHOOK,
+				[](rapidjson::Document& json) { return discpp::Message(json); }).get();
 		}
+
+		cpr::Body body(writer.ToString());
 		std::unique_ptr<rapidjson::Document> result = SendPostRequest(Endpoint("/webhooks/" + std::to_string(id) + "/" + token), DefaultHeaders({ { "Content-Type", "application/json" } }), id, RateLimitBucketType::WEBHOOK, body);
 
 		return discpp::Message(*result);
 	}
 
 	void Webhook::EditName(std::string& name) {
-        rapidjson::Document result_json(rapidjson::kObjectType);
-        result_json.Parse("{\"name\": \"" + name + "\"}");
-		discpp::SendPatchRequest(discpp::Endpoint("/webhooks/" + std::to_string(id)), DefaultHeaders({ { "Content-Type", "application/json" } }), id, discpp::RateLimitBucketType::WEBHOOK, cpr::Body(DumpJson(result_json)));
+        JsonWriter writer;
+        writer.StartObject();
+        writer.Key("name");
+        writer.String(name);
+        writer.EndObject();
+		discpp::SendPatchRequest(discpp::Endpoint("/webhooks/" + std::to_string(id)), DefaultHeaders({ { "Content-Type", "application/json" } }), id, discpp::RateLimitBucketType::WEBHOOK, cpr::Body(writer.ToString()));
 	}
 
 	void Webhook::Remove() {
@@ -0,0 +1,110 @@
+#include "webhook_fanout.h"
+#include "exceptions.h"
+#include "json_writer.h"
+#include "rest_engine.h"
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <mutex>
+
+namespace discpp {
+    struct WebhookFanout::State {
+        const std::string& body;
+        const std::vector<discpp::Webhook>& webhooks;
+        const WebhookFanoutOptions& options;
+        cpr::Header headers;
+
+        std::vector<WebhookSendResult> results;
+        std::vector<std::chrono::steady_clock::time_point> started;
+
+        std::mutex mutex;
+        std::size_t next = 0; /**< The next webhook to dispatch, guarded by `mutex`. */
+        std::atomic<std::size_t> remaining;
+        std::promise<void> done;
+
+        State(const std::string& body, const std::vector<discpp::Webhook>& webhooks, const WebhookFanoutOptions& options)
+            : body(body), webhooks(webhooks), options(options), results(webhooks.size()), started(webhooks.size()), remaining(webhooks.size()) {}
+    };
+
+    WebhookFanout::WebhookFanout(const std::string& text, const bool tts, const discpp::EmbedBuilder* embed) {
+        if (text.size() >= 2000) {
+            throw exceptions::RequestTooLargeException("discpp::WebhookFanout text must be shorter than 2000 characters!");
+        }
+
+        JsonWriter writer;
+        writer.StartObject();
+        if (embed == nullptr || !text.empty()) {
+            writer.Key("content");
+            writer.String(text);
+            writer.Key("tts");
+            writer.Bool(tts);
+        }
+        if (embed != nullptr) {
+            writer.Key("embed");
+            embed->ToJson(writer);
+        }
+        writer.EndObject();
+
+        body = writer.ToString();
+    }
+
+    std::vector<WebhookSendResult> WebhookFanout::Send(const std::vector<discpp::Webhook>& webhooks, const WebhookFanoutOptions& options) const {
+        if (webhooks.empty()) return {};
+        if (RestEngine::Instance().OnLoopThread()) {
+            throw exceptions::LoopThreadException("discpp::WebhookFanout::Send can't wait for its requests on the REST engine's thread");
+        }
+
+        auto state = std::make_shared<State>(body, webhooks, options);
+        state->headers = DefaultHeaders({ { "Content-Type", "application/json" } });
+        std::future<void> done = state->done.get_future();
+
+        // Later requests are started by the callbacks of the first ones.
+        std::size_t first = std::max<std::size_t>(1, std::min(options.max_in_flight, webhooks.size()));
+        state->next = first;
+        for (std::size_t i = 0; i < first; i++) {
+            Dispatch(state, i);
+        }
+
+        done.wait();
+        return std::move(state->results);
+    }
+
+    void WebhookFanout::Dispatch(const std::shared_ptr<State>& state, std::size_t index) {
+        const discpp::Webhook& webhook = state->webhooks[index];
+        state->results[index].webhook_id = webhook.id;
+        state->started[index] = std::chrono::steady_clock::now();
+
+        RestEngine::Request request;
+        request.method = "POST";
+        request.url = Endpoint("/webhooks/" + std::to_string(webhook.id) + "/" + webhook.token) + (state->options.wait ? "?wait=true" : "");
+        request.headers = state->headers;
+        request.body = state->body;
+        request.callback = [state, index](cpr::Response& response) {
+            WebhookSendResult& result = state->results[index];
+            result.status_code = response.status_code;
+            result.latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - state->started[index]);
+
+            try {
+                std::unique_ptr<rapidjson::Document> json = HandleResponse(response, result.webhook_id, RateLimitBucketType::WEBHOOK);
+                if (state->options.wait) result.message.emplace(*json);
+            } catch (...) {
+                result.error = std::current_exception();
+            }
+
+            if (state->options.on_result) state->options.on_result(result);
+
+            std::size_t next;
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                next = state->next < state->webhooks.size() ? state->next++ : state->webhooks.size();
+            }
+            if (next < state->webhooks.size()) Dispatch(state, next);
+
+            // Nothing may touch the caller's webhooks or options after this, Send returns once it's set.
+            if (--state->remaining == 0) state->done.set_value();
+        };
+
+        RestEngine::Instance().PerformRateLimited(std::move(request), webhook.id);
+    }
+}
@@ -0,0 +1,213 @@
+#ifndef DISCPP_TESTS_STUB_SERVER_H
+#define DISCPP_TESTS_STUB_SERVER_H
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace test {
+    /**
+     * @brief Local HTTP/1.1 server that stands in for Discord in tests.
+     *
+     * Every connection is served on its own thread, so requests that curl sends in parallel stay parallel.
+     * The handler gets each request and returns the response to send, and every request is recorded.
+     *
+     * ```cpp
+     *      test::StubServer server([](const test::StubServer::Request& request) {
+     *          return test::StubServer::Response{ 200, { { "Content-Type", "application/json" } }, "{}" };
+     *      });
+     *      std::string url = server.Url() + "/api/v6/gateway";
+     * ```
+     */
+    class StubServer {
+    public:
+        struct Request {
+            std::string method;
+            std::string target;
+            std::map<std::string, std::string> headers; /**< Names are lowercase. */
+            std::string body;
+
+            std::string Header(const std::string& name) const {
+                auto it = headers.find(name);
+                return it == headers.end() ? "" : it->second;
+            }
+        };
+
+        struct Response {
+            long status_code = 200;
+            std::map<std::string, std::string> headers;
+            std::string body;
+            bool drop = false; /**< Close the connection without responding, like a server that went away. */
+        };
+
+        using Handler = std::function<Response(const Request&)>;
+
+        explicit StubServer(Handler handler) : handler(std::move(handler)) {
+            listener = socket(AF_INET, SOCK_STREAM, 0);
+            int reuse = 1;
+            setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            address.sin_port = 0;
+            bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+            listen(listener, 64);
+
+            socklen_t length = sizeof(address);
+            getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length);
+            port = ntohs(address.sin_port);
+
+            acceptor = std::thread([this] { Accept(); });
+        }
+
+        StubServer(const StubServer&) = delete;
+        StubServer& operator=(const StubServer&) = delete;
+
+        ~StubServer() {
+            stopping = true;
+            shutdown(listener, SHUT_RDWR);
+            close(listener);
+            acceptor.join();
+
+            std::vector<std::thread> finished;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (int connection : connections) shutdown(connection, SHUT_RDWR);
+                finished.swap(workers);
+            }
+            for (std::thread& worker : finished) worker.join();
+        }
+
+        std::string Url() const {
+            return "http://127.0.0.1:" + std::to_string(port);
+        }
+
+        std::vector<Request> Requests() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            return requests;
+        }
+    private:
+        void Accept() {
+            while (!stopping) {
+                int connection = accept(listener, nullptr, nullptr);
+                if (connection < 0) continue;
+
+                std::lock_guard<std::mutex> lock(mutex);
+                connections.push_back(connection);
+                workers.emplace_back([this, connection] { Serve(connection); });
+            }
+        }
+
+        void Serve(int connection) {
+            std::string buffer;
+            Request request;
+            while (ReadRequest(connection, buffer, request)) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    requests.push_back(request);
+                }
+
+                Response response = handler(request);
+                if (response.drop) break;
+
+                std::string raw = "HTTP/1.1 " + std::to_string(response.status_code) + " Stub\r\n";
+                for (const auto& header : response.headers) {
+                    raw += header.first + ": " + header.second + "\r\n";
+                }
+                raw += "Content-Length: " + std::to_string(response.body.size()) + "\r\n\r\n" + response.body;
+
+                if (!SendAll(connection, raw)) break;
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            connections.erase(std::find(connections.begin(), connections.end(), connection));
+            close(connection);
+        }
+
+        bool ReadRequest(int connection, std::string& buffer, Request& request) {
+            std::size_t head_end;
+            while ((head_end = buffer.find("\r\n\r\n")) == std::string::npos) {
+                if (!Receive(connection, buffer)) return false;
+            }
+
+            request = Request();
+            std::size_t line_end = buffer.find("\r\n");
+            std::string request_line = buffer.substr(0, line_end);
+            std::size_t method_end = request_line.find(' ');
+            std::size_t target_end = request_line.find(' ', method_end + 1);
+            request.method = request_line.substr(0, method_end);
+            request.target = request_line.substr(method_end + 1, target_end - method_end - 1);
+
+            for (std::size_t start = line_end + 2; start < head_end;) {
+                std::size_t end = buffer.find("\r\n", start);
+                std::string line = buffer.substr(start, end - start);
+                std::size_t colon = line.find(':');
+
+                std::string name = line.substr(0, colon);
+                std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+                std::size_t value_start = line.find_first_not_of(' ', colon + 1);
+                request.headers[name] = value_start == std::string::npos ? "" : line.substr(value_start);
+
+                start = end + 2;
+            }
+            buffer.erase(0, head_end + 4);
+
+            if (request.Header("expect") == "100-continue" && !SendAll(connection, "HTTP/1.1 100 Continue\r\n\r\n")) return false;
+
+            std::size_t length = std::strtoull(request.Header("content-length").c_str(), nullptr, 10);
+            while (buffer.size() < length) {
+                if (!Receive(connection, buffer)) return false;
+            }
+            request.body = buffer.substr(0, length);
+            buffer.erase(0, length);
+
+            return true;
+        }
+
+        static bool Receive(int connection, std::string& buffer) {
+            char chunk[16384];
+            ssize_t received = recv(connection, chunk, sizeof(chunk), 0);
+            if (received <= 0) return false;
+
+            buffer.append(chunk, static_cast<std::size_t>(received));
+            return true;
+        }
+
+        static bool SendAll(int connection, const std::string& data) {
+            for (std::size_t sent = 0; sent < data.size();) {
+                ssize_t result = send(connection, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+                if (result <= 0) return false;
+
+                sent += static_cast<std::size_t>(result);
+            }
+
+            return true;
+        }
+
+        Handler handler;
+        int listener;
+        int port;
+        std::atomic<bool> stopping{ false };
+        std::thread acceptor;
+
+        mutable std::mutex mutex;
+        std::vector<int> connections;
+        std::vector<std::thread> workers;
+        std::vector<Request> requests;
+    };
+}
+
+#endif //DISCPP_TESTS_STUB_SERVER_H
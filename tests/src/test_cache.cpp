@@ -0,0 +1,220 @@
+#include <discpp/cache.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    constexpr uint64_t guild_id = 100;
+    constexpr uint64_t message_id = 500;
+
+    std::shared_ptr<discpp::Member> MakeMember(uint64_t id) {
+        auto member = std::make_shared<discpp::Member>();
+        member->guild_id = guild_id;
+        member->user = std::make_shared<discpp::User>();
+        member->user->id = id;
+
+        return member;
+    }
+
+    discpp::Channel MakeChannel(uint64_t id) {
+        discpp::Channel channel;
+        channel.id = id;
+        channel.guild_id = guild_id;
+
+        return channel;
+    }
+}
+
+// The dispatcher changes cached guilds and messages only through UpdateGuild, the shared member store
+// and MessageCache::Update, while listeners read them without any lock.
+TEST(Cache, UpdatesDontDisturbReaders) {
+    discpp::Cache cache;
+
+    auto guild = std::make_shared<discpp::Guild>();
+    guild->id = guild_id;
+    cache.guilds.Insert(guild_id, guild);
+
+    auto message = std::make_shared<discpp::Message>();
+    message->id = message_id;
+    message->channel.id = 400;
+    message->content = "a";
+    cache.messages.Insert(message);
+
+    std::atomic<bool> done{ false };
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; i++) {
+        readers.emplace_back([&] {
+            while (!done) {
+                std::shared_ptr<discpp::Guild> snapshot = cache.FindGuild(guild_id);
+                ASSERT_NE(nullptr, snapshot);
+
+                for (const auto& channel : *snapshot->channels) {
+                    ASSERT_EQ(channel.first, channel.second.id);
+                }
+                snapshot->members->ForEach([](const discpp::Snowflake& id, const std::shared_ptr<discpp::Member>& member) {
+                    ASSERT_EQ(id, member->user->id);
+                });
+
+                std::shared_ptr<discpp::Message> cached = cache.messages.Get(message_id);
+                ASSERT_NE(nullptr, cached);
+                ASSERT_FALSE(cached->content.empty());
+                ASSERT_EQ(std::string::npos, cached->content.find_first_not_of(cached->content[0]));
+            }
+        });
+    }
+
+    constexpr int writes = 2000;
+    std::vector<std::thread> writers;
+    for (uint64_t writer = 0; writer < 2; writer++) {
+        writers.emplace_back([&cache, writer] {
+            for (uint64_t i = 0; i < writes; i++) {
+                uint64_t id = 1000 + writer * writes + i;
+                cache.FindGuild(guild_id)->members->Insert(id, MakeMember(id));
+                cache.UpdateGuildChannels(guild_id, [id](discpp::GuildChannels& channels) {
+                    channels.insert({ id, MakeChannel(id) });
+                });
+
+                // Remove every other member and channel again, like a leave.
+                if (i % 2 == 1) {
+                    cache.FindGuild(guild_id)->members->Erase(id - 1);
+                    cache.UpdateGuildChannels(guild_id, [id](discpp::GuildChannels& channels) {
+                        channels.erase(id - 1);
+                    });
+                }
+
+                cache.messages.Update(message_id, [i](discpp::Message& copy) {
+                    copy.content = std::string(16 + i % 64, static_cast<char>('a' + i % 26));
+                });
+            }
+        });
+    }
+
+    for (std::thread& writer : writers) writer.join();
+    done = true;
+    for (std::thread& reader : readers) reader.join();
+
+    std::shared_ptr<discpp::Guild> updated = cache.FindGuild(guild_id);
+    EXPECT_EQ(static_cast<std::size_t>(writes), updated->members->Size());
+    EXPECT_EQ(static_cast<std::size_t>(writes), updated->channels->size());
+
+    // The guild and message that were replaced are untouched, apart from the member store every copy shares.
+    EXPECT_EQ(guild->members, updated->members);
+    EXPECT_TRUE(guild->channels->empty());
+    EXPECT_EQ("a", message->content);
+    EXPECT_EQ(cache.messages.Bytes(), discpp::MessageCache::EstimateSize(*cache.messages.Get(message_id)));
+}
+
+TEST(Cache, RemoveGuildDropsUsersOfNoOtherGuild) {
+    discpp::Cache cache;
+
+    std::shared_ptr<discpp::Member> shared_member = MakeMember(1);
+    std::shared_ptr<discpp::Member> only_member = MakeMember(2);
+    cache.users.Insert(1, shared_member->user);
+    cache.users.Insert(2, only_member->user);
+
+    auto removed = std::make_shared<discpp::Guild>();
+    removed->id = guild_id;
+    removed->members->Insert(1, shared_member);
+    removed->members->Insert(2, only_member);
+    auto channels = std::make_shared<discpp::GuildChannels>();
+    channels->insert({ 400, MakeChannel(400) });
+    removed->channels = channels;
+    cache.guilds.Insert(guild_id, removed);
+    cache.channel_guilds.Insert(400, guild_id);
+
+    auto other = std::make_shared<discpp::Guild>();
+    other->id = guild_id + 1;
+    other->members->Insert(1, MakeMember(1));
+    cache.guilds.Insert(other->id, other);
+
+    // The caller keeps the removed guild, like the GUILD_DELETE listeners do.
+    std::shared_ptr<discpp::Guild> guild = cache.RemoveGuild(guild_id);
+    ASSERT_EQ(removed, guild);
+
+    EXPECT_EQ(nullptr, cache.FindGuild(guild_id));
+    EXPECT_FALSE(cache.channel_guilds.Contains(400));
+    EXPECT_NE(nullptr, cache.FindUser(1));
+    EXPECT_EQ(nullptr, cache.FindUser(2));
+
+    EXPECT_EQ(nullptr, cache.RemoveGuild(guild_id));
+}
+
+TEST(Cache, MemberChangesKeepTheGuild) {
+    discpp::Cache cache;
+
+    auto guild = std::make_shared<discpp::Guild>();
+    guild->id = guild_id;
+    cache.guilds.Insert(guild_id, guild);
+
+    // Members join and leave without the guild, and its channels, being copied.
+    guild->members->Insert(1, MakeMember(1));
+    guild->members->Insert(2, MakeMember(2));
+    guild->members->Erase(1);
+    EXPECT_EQ(guild, cache.FindGuild(guild_id));
+
+    std::shared_ptr<discpp::Member> member = cache.FindMember(guild_id, 2);
+    ASSERT_NE(nullptr, member);
+    EXPECT_EQ(2u, static_cast<uint64_t>(member->user->id));
+    EXPECT_EQ(nullptr, cache.FindMember(guild_id, 1));
+
+    // A copy made for another change still sees later member changes.
+    std::shared_ptr<discpp::Guild> updated = cache.UpdateGuild(guild_id, [](discpp::Guild& copy) {
+        copy.name = "renamed";
+    });
+    guild->members->Insert(3, MakeMember(3));
+    EXPECT_NE(nullptr, updated->FindMember(3));
+    EXPECT_EQ("", guild->name);
+}
+
+TEST(Cache, ChangesCopyOnlyTheirMap) {
+    discpp::Cache cache;
+
+    auto guild = std::make_shared<discpp::Guild>();
+    guild->id = guild_id;
+    cache.guilds.Insert(guild_id, guild);
+
+    std::shared_ptr<discpp::Guild> updated = cache.UpdateGuildChannels(guild_id, [](discpp::GuildChannels& channels) {
+        channels.insert({ 400, MakeChannel(400) });
+    });
+    ASSERT_NE(nullptr, updated);
+    EXPECT_EQ(updated, cache.FindGuild(guild_id));
+
+    // The new guild has its own channels, and shares everything else with the one it replaced.
+    EXPECT_NE(guild->channels, updated->channels);
+    EXPECT_TRUE(guild->channels->empty());
+    EXPECT_TRUE(updated->FindChannel(400).has_value());
+    EXPECT_EQ(guild->roles, updated->roles);
+    EXPECT_EQ(guild->emojis, updated->emojis);
+    EXPECT_EQ(guild->members, updated->members);
+    EXPECT_EQ(guild->features, updated->features);
+    EXPECT_EQ(guild->voice_states, updated->voice_states);
+
+    EXPECT_EQ(nullptr, cache.UpdateGuildRoles(guild_id + 1, [](discpp::GuildRoles&) {}));
+}
+
+TEST(Cache, UnchangedUsersKeepTheirRecord) {
+    discpp::Cache cache;
+
+    rapidjson::Document json;
+    json.Parse(R"({"id": "300", "username": "a", "discriminator": "0001", "avatar": null})");
+    std::shared_ptr<discpp::User> user = cache.InternUser(json);
+
+    // A user object that repeats the record must not replace it.
+    rapidjson::Document same;
+    same.Parse(R"({"id": "300", "username": "a", "avatar": null})");
+    EXPECT_EQ(user, cache.InternUser(same));
+    EXPECT_EQ(user, cache.UpdateUser(same));
+
+    rapidjson::Document renamed;
+    renamed.Parse(R"({"id": "300", "username": "b"})");
+    std::shared_ptr<discpp::User> updated = cache.UpdateUser(renamed);
+    ASSERT_NE(nullptr, updated);
+    EXPECT_NE(user, updated);
+    EXPECT_EQ("a", user->username);
+    EXPECT_EQ("b", updated->username);
+    EXPECT_EQ(user->GetDiscriminator(), updated->GetDiscriminator());
+}
@@ -0,0 +1,107 @@
+#include <discpp/concurrent_map.h>
+#include <discpp/snowflake.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+struct CachedObject {
+    explicit CachedObject(uint64_t id) : id(id), version(0) {}
+
+    uint64_t id;
+    uint64_t version;
+};
+
+TEST(ConcurrentMap, InsertGetErase) {
+    discpp::ConcurrentMap<discpp::Snowflake, int> map;
+
+    EXPECT_TRUE(map.Insert(1, 10));
+    EXPECT_FALSE(map.Insert(1, 20));
+    EXPECT_EQ(10, map.GetOr(1));
+
+    EXPECT_FALSE(map.InsertOrAssign(1, 30));
+    EXPECT_EQ(30, map.GetOr(1));
+
+    int out = 0;
+    EXPECT_FALSE(map.Get(2, out));
+    EXPECT_TRUE(map.Update(1, [](int& value) { value++; }));
+    EXPECT_TRUE(map.Take(1, out));
+    EXPECT_EQ(31, out);
+    EXPECT_TRUE(map.Empty());
+}
+
+TEST(ConcurrentMap, StressInsertUpdateLookup) {
+    using ObjectPtr = std::shared_ptr<CachedObject>;
+    discpp::ConcurrentMap<discpp::Snowflake, ObjectPtr> map;
+
+    constexpr int writer_count = 4;
+    constexpr int reader_count = 8;
+    constexpr uint64_t keys_per_writer = 2000;
+    constexpr int update_rounds = 5;
+
+    std::atomic<bool> writers_done(false);
+    std::atomic<uint64_t> lookups(0);
+    std::vector<std::thread> threads;
+
+    for (int w = 0; w < writer_count; w++) {
+        threads.emplace_back([&map, w] {
+            // Use snowflake-shaped keys so the timestamp bits dominate like they do in practice.
+            const uint64_t base = (static_cast<uint64_t>(w + 1) << 40);
+
+            for (uint64_t i = 0; i < keys_per_writer; i++) {
+                map.Insert(base + (i << 22), std::make_shared<CachedObject>(base + (i << 22)));
+            }
+
+            for (int round = 0; round < update_rounds; round++) {
+                for (uint64_t i = 0; i < keys_per_writer; i++) {
+                    map.Update(base + (i << 22), [](ObjectPtr& object) {
+                        auto updated = std::make_shared<CachedObject>(*object);
+                        updated->version++;
+                        object = updated;
+                    });
+                }
+            }
+
+            // Erase every other key so erases race lookups too.
+            for (uint64_t i = 0; i < keys_per_writer; i += 2) {
+                map.Erase(base + (i << 22));
+            }
+        });
+    }
+
+    for (int r = 0; r < reader_count; r++) {
+        threads.emplace_back([&map, &writers_done, &lookups, r] {
+            uint64_t i = r;
+            while (!writers_done.load()) {
+                const uint64_t key = (static_cast<uint64_t>(i % writer_count + 1) << 40) + ((i % keys_per_writer) << 22);
+
+                ObjectPtr object;
+                if (map.Get(key, object)) {
+                    ASSERT_EQ(key, object->id);
+                    ASSERT_LE(object->version, static_cast<uint64_t>(update_rounds));
+                }
+
+                lookups++;
+                i += 7;
+            }
+        });
+    }
+
+    for (int w = 0; w < writer_count; w++) {
+        threads[w].join();
+    }
+    writers_done = true;
+    for (std::size_t t = writer_count; t < threads.size(); t++) {
+        threads[t].join();
+    }
+
+    EXPECT_GT(lookups.load(), 0u);
+    EXPECT_EQ(writer_count * keys_per_writer / 2, map.Size());
+
+    map.ForEach([](const discpp::Snowflake& key, const ObjectPtr& object) {
+        EXPECT_EQ(static_cast<uint64_t>(key), object->id);
+        EXPECT_EQ(static_cast<uint64_t>(update_rounds), object->version);
+    });
+}
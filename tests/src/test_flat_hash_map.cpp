@@ -0,0 +1,71 @@
+#include <discpp/flat_hash_map.h>
+#include <gtest/gtest.h>
+
+#include <map>
+#include <memory>
+#include <string>
+
+TEST(FlatHashMap, InsertFindErase) {
+    discpp::SnowflakeMap<std::string> map;
+
+    EXPECT_TRUE(map.insert({ 1, "one" }).second);
+    EXPECT_FALSE(map.insert({ 1, "uno" }).second);
+    EXPECT_EQ("one", map.at(1));
+
+    map.insert_or_assign(1, "uno");
+    map[2] = "two";
+    EXPECT_EQ("uno", map.find(1)->second);
+    EXPECT_EQ(2u, map.size());
+
+    EXPECT_EQ(1u, map.erase(1));
+    EXPECT_EQ(0u, map.erase(1));
+    EXPECT_EQ(map.end(), map.find(1));
+    EXPECT_EQ(1u, map.count(2));
+}
+
+TEST(FlatHashMap, EraseWhileIterating) {
+    discpp::SnowflakeMap<int> map;
+    for (int i = 0; i < 1000; i++) map.insert({ static_cast<uint64_t>(i) << 22, i });
+
+    for (auto it = map.begin(); it != map.end();) {
+        if (it->second % 2 == 0) {
+            it = map.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    EXPECT_EQ(500u, map.size());
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_EQ(i % 2, static_cast<int>(map.count(static_cast<uint64_t>(i) << 22)));
+    }
+}
+
+TEST(FlatHashMap, MatchesOrderedMapUnderChurn) {
+    discpp::SnowflakeMap<std::shared_ptr<int>> map;
+    std::map<uint64_t, int> expected;
+
+    // Keep erasing and reinserting a small key range so tombstones pile up and get rehashed away.
+    for (int i = 0; i < 20000; i++) {
+        uint64_t key = (static_cast<uint64_t>(i) * 2654435761u) % 300;
+        if (i % 3 == 0) {
+            map.erase(key);
+            expected.erase(key);
+        } else {
+            map.insert_or_assign(key, std::make_shared<int>(i));
+            expected[key] = i;
+        }
+    }
+
+    ASSERT_EQ(expected.size(), map.size());
+    for (const auto& entry : expected) {
+        auto it = map.find(entry.first);
+        ASSERT_NE(map.end(), it);
+        EXPECT_EQ(entry.second, *it->second);
+    }
+
+    discpp::SnowflakeMap<std::shared_ptr<int>> copy = map;
+    map.clear();
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ(expected.size(), copy.size());
+}
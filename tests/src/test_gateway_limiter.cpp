@@ -0,0 +1,54 @@
+#include <discpp/gateway_limiter.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstddef>
+
+namespace {
+    using Limiter = discpp::GatewaySendLimiter;
+    using Clock = Limiter::Clock;
+
+    constexpr std::size_t regular_sends = Limiter::limit - Limiter::reserved_for_heartbeats;
+}
+
+TEST(GatewaySendLimiter, HoldsSendsOverTheLimit) {
+    Limiter limiter;
+    Clock::time_point start = Clock::now();
+
+    for (std::size_t i = 0; i < regular_sends; i++) {
+        ASSERT_EQ(Clock::duration::zero(), limiter.TryAcquire(false, start + std::chrono::milliseconds(i)));
+    }
+
+    // The next send has to wait for the first one to leave the window.
+    Clock::time_point later = start + std::chrono::seconds(1);
+    EXPECT_EQ(start + Limiter::window - later, limiter.TryAcquire(false, later));
+    EXPECT_EQ(Clock::duration::zero(), limiter.TryAcquire(false, start + Limiter::window));
+}
+
+TEST(GatewaySendLimiter, KeepsRoomForHeartbeats) {
+    Limiter limiter;
+    Clock::time_point start = Clock::now();
+
+    for (std::size_t i = 0; i < regular_sends; i++) {
+        ASSERT_EQ(Clock::duration::zero(), limiter.TryAcquire(false, start));
+    }
+    EXPECT_NE(Clock::duration::zero(), limiter.TryAcquire(false, start));
+
+    for (std::size_t i = 0; i < Limiter::reserved_for_heartbeats; i++) {
+        EXPECT_EQ(Clock::duration::zero(), limiter.TryAcquire(true, start));
+    }
+    EXPECT_NE(Clock::duration::zero(), limiter.TryAcquire(true, start));
+}
+
+TEST(GatewaySendLimiter, NewConnectionsStartOver) {
+    Limiter limiter;
+    Clock::time_point start = Clock::now();
+
+    for (std::size_t i = 0; i < Limiter::limit; i++) {
+        ASSERT_EQ(Clock::duration::zero(), limiter.TryAcquire(true, start));
+    }
+    EXPECT_NE(Clock::duration::zero(), limiter.TryAcquire(true, start));
+
+    limiter.Reset();
+    EXPECT_EQ(Clock::duration::zero(), limiter.TryAcquire(false, start));
+}
@@ -0,0 +1,66 @@
+#include <discpp/json_writer.h>
+#include <gtest/gtest.h>
+
+#include <string>
+
+TEST(JsonWriter, NestedValues) {
+    discpp::JsonWriter writer;
+    writer.StartObject();
+    writer.Key("content");
+    writer.String("hello");
+    writer.Key("tts");
+    writer.Bool(false);
+    writer.Key("roles");
+    writer.StartArray();
+    writer.Id(discpp::Snowflake(150312037426135041));
+    writer.Int(-3);
+    writer.Null();
+    writer.StartObject();
+    writer.EndObject();
+    writer.EndArray();
+    writer.Key("flags");
+    writer.Uint64(64);
+    writer.EndObject();
+
+    EXPECT_EQ("{\"content\":\"hello\",\"tts\":false,\"roles\":[\"150312037426135041\",-3,null,{}],\"flags\":64}", writer.View());
+}
+
+TEST(JsonWriter, Escaping) {
+    std::string out;
+    discpp::AppendEscapedJson(out, "\"\\\n\t\x01 \xc3\xa9");
+    EXPECT_EQ("\\\"\\\\\\n\\t\\u0001 \xc3\xa9", out);
+
+    // Long enough to go through the vectorized search, with escapes at the edges of 16 byte blocks.
+    std::string text(15, 'a');
+    text += '"';
+    text += std::string(16, 'b');
+    text += '\x1f';
+    text += std::string(20, 'c');
+
+    out.clear();
+    discpp::AppendEscapedJson(out, text);
+    EXPECT_EQ(std::string(15, 'a') + "\\\"" + std::string(16, 'b') + "\\u001f" + std::string(20, 'c'), out);
+}
+
+TEST(JsonWriter, ValueAccept) {
+    rapidjson::Document json;
+    json.Parse("{\"name\":\"a\\\"b\",\"ids\":[1,2.5,true]}");
+
+    discpp::JsonWriter writer;
+    json.Accept(writer);
+
+    EXPECT_EQ("{\"name\":\"a\\\"b\",\"ids\":[1,2.5,true]}", writer.View());
+}
+
+TEST(JsonWriter, ShortestDoubles) {
+    discpp::JsonWriter writer;
+    writer.StartArray();
+    writer.Double(0.1);
+    writer.Double(2.5);
+    writer.Double(-100.0);
+    writer.Double(1.0 / 3.0);
+    writer.Double(1.7976931348623157e308);
+    writer.EndArray();
+
+    EXPECT_EQ("[0.1,2.5,-100,0.3333333333333333,1.7976931348623157e+308]", writer.View());
+}
@@ -0,0 +1,123 @@
+#include <discpp/message_cache.h>
+#include <discpp/message.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+    std::shared_ptr<discpp::Message> MakeMessage(uint64_t id, uint64_t channel_id, const std::string& content = "") {
+        auto message = std::make_shared<discpp::Message>();
+        message->id = id;
+        message->channel.id = channel_id;
+        message->content = content;
+
+        return message;
+    }
+
+    std::vector<uint64_t> Ids(const std::vector<std::shared_ptr<discpp::Message>>& messages) {
+        std::vector<uint64_t> ids;
+        for (const auto& message : messages) {
+            ids.push_back(message->id);
+        }
+
+        return ids;
+    }
+}
+
+TEST(MessageCache, EvictsLowestIdFirst) {
+    discpp::MessageCache cache;
+    cache.SetLimits(3);
+
+    // History fetched after newer messages arrived must still be evicted first.
+    cache.Insert(MakeMessage(50, 1));
+    cache.Insert(MakeMessage(60, 1));
+    cache.Insert(MakeMessage(10, 1));
+    cache.Insert(MakeMessage(20, 1));
+
+    EXPECT_EQ(3u, cache.Size());
+    EXPECT_FALSE(cache.Contains(10));
+    EXPECT_TRUE(cache.Contains(20));
+    EXPECT_TRUE(cache.Contains(50));
+    EXPECT_TRUE(cache.Contains(60));
+
+    cache.Insert(MakeMessage(70, 1));
+    EXPECT_FALSE(cache.Contains(20));
+    EXPECT_TRUE(cache.Contains(70));
+
+    cache.SetLimits(1);
+    EXPECT_EQ(std::vector<uint64_t>({ 70 }), Ids(cache.GetChannelMessages(1)));
+}
+
+TEST(MessageCache, EvictsByBytes) {
+    discpp::MessageCache cache;
+
+    std::shared_ptr<discpp::Message> message = MakeMessage(1, 1, std::string(1024, 'a'));
+    std::size_t message_bytes = discpp::MessageCache::EstimateSize(*message);
+    cache.SetLimits(100, 2 * message_bytes);
+
+    cache.Insert(MakeMessage(3, 1, std::string(1024, 'a')));
+    cache.Insert(MakeMessage(2, 1, std::string(1024, 'a')));
+    cache.Insert(message);
+
+    EXPECT_EQ(2u, cache.Size());
+    EXPECT_FALSE(cache.Contains(1));
+    EXPECT_EQ(2 * message_bytes, cache.Bytes());
+}
+
+TEST(MessageCache, ChannelsStayOrderedAndSeparate) {
+    discpp::MessageCache cache;
+    cache.SetLimits(4);
+
+    cache.Insert(MakeMessage(30, 1));
+    cache.Insert(MakeMessage(10, 1));
+    cache.Insert(MakeMessage(20, 2));
+    cache.Insert(MakeMessage(40, 1));
+    cache.Insert(MakeMessage(50, 2));
+
+    // 10 is the oldest overall, so channel 1 loses it although channel 2 has fewer messages.
+    EXPECT_EQ(std::vector<uint64_t>({ 30, 40 }), Ids(cache.GetChannelMessages(1)));
+    EXPECT_EQ(std::vector<uint64_t>({ 20, 50 }), Ids(cache.GetChannelMessages(2)));
+    EXPECT_EQ(std::vector<uint64_t>({ 40 }), Ids(cache.GetChannelMessages(1, 1)));
+    EXPECT_TRUE(cache.GetChannelMessages(3).empty());
+
+    EXPECT_EQ(2u, cache.EraseChannel(2));
+    EXPECT_EQ(2u, cache.Size());
+    EXPECT_TRUE(cache.GetChannelMessages(2).empty());
+}
+
+TEST(MessageCache, UpdatesKeepSizeAccounting) {
+    discpp::MessageCache cache;
+    cache.Insert(MakeMessage(1, 1, "short"));
+    cache.Insert(MakeMessage(2, 1, "short"));
+
+    std::shared_ptr<discpp::Message> original = cache.Get(1);
+    std::shared_ptr<discpp::Message> updated = cache.Update(1, [](discpp::Message& message) {
+        message.content = std::string(4096, 'b');
+    });
+    ASSERT_NE(nullptr, updated);
+    EXPECT_EQ("short", original->content);
+    EXPECT_EQ(updated, cache.Get(1));
+    EXPECT_EQ(discpp::MessageCache::EstimateSize(*updated) + discpp::MessageCache::EstimateSize(*cache.Get(2)), cache.Bytes());
+    EXPECT_EQ(nullptr, cache.Update(3, [](discpp::Message&) {}));
+
+    // Replacing through Insert accounts for the new size as well.
+    cache.Insert(MakeMessage(1, 1, "short"));
+    EXPECT_EQ(discpp::MessageCache::EstimateSize(*cache.Get(1)) + discpp::MessageCache::EstimateSize(*cache.Get(2)), cache.Bytes());
+
+    std::shared_ptr<discpp::Message> taken;
+    EXPECT_TRUE(cache.Take(1, taken));
+    EXPECT_EQ(1u, static_cast<uint64_t>(taken->id));
+    EXPECT_FALSE(cache.Erase(1));
+    EXPECT_TRUE(cache.Erase(2));
+    EXPECT_TRUE(cache.Empty());
+    EXPECT_EQ(0u, cache.Bytes());
+
+    // An erased id doesn't affect the eviction of messages inserted later.
+    cache.SetLimits(2);
+    cache.Insert(MakeMessage(5, 1));
+    cache.Insert(MakeMessage(6, 1));
+    cache.Insert(MakeMessage(7, 1));
+    EXPECT_EQ(std::vector<uint64_t>({ 6, 7 }), Ids(cache.GetChannelMessages(1)));
+}
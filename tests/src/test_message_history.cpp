@@ -0,0 +1,126 @@
+#include <discpp/message_history.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+    // Serves a channel with the message ids 1 to `size` like Discord does, every page newest first.
+    struct FakeChannel {
+        uint64_t size;
+        std::vector<std::string> urls;
+
+        static uint64_t Param(const std::string& url, const std::string& name) {
+            std::size_t start = url.find(name + "=");
+            return start == std::string::npos ? 0 : std::strtoull(url.c_str() + start + name.size() + 1, nullptr, 10);
+        }
+
+        discpp::MessageHistoryPager::Fetch Fetch() {
+            return [this](const std::string& url) {
+                urls.push_back(url);
+
+                uint64_t limit = Param(url, "limit");
+                std::vector<uint64_t> ids;
+                if (url.find("after=") != std::string::npos) {
+                    for (uint64_t id = Param(url, "after") + 1; id <= size && ids.size() < limit; id++) ids.push_back(id);
+                    std::reverse(ids.begin(), ids.end());
+                } else {
+                    uint64_t before = url.find("before=") != std::string::npos ? Param(url, "before") : size + 1;
+                    for (uint64_t id = before - 1; id >= 1 && ids.size() < limit; id--) ids.push_back(id);
+                }
+
+                auto page = std::make_unique<rapidjson::Document>();
+                page->SetArray();
+                for (uint64_t id : ids) {
+                    rapidjson::Value message(rapidjson::kObjectType);
+                    message.AddMember("id", rapidjson::Value(std::to_string(id).c_str(), page->GetAllocator()), page->GetAllocator());
+                    page->PushBack(message, page->GetAllocator());
+                }
+
+                std::promise<std::unique_ptr<rapidjson::Document>> promise;
+                promise.set_value(std::move(page));
+                return promise.get_future();
+            };
+        }
+    };
+
+    std::vector<uint64_t> Ids(const rapidjson::Document& page) {
+        std::vector<uint64_t> ids;
+        for (const auto& message : page.GetArray()) {
+            ids.push_back(std::strtoull(message["id"].GetString(), nullptr, 10));
+        }
+
+        return ids;
+    }
+
+    std::vector<uint64_t> Range(uint64_t first, uint64_t last) {
+        std::vector<uint64_t> ids;
+        for (uint64_t id = first; first <= last ? id <= last : id >= last; first <= last ? id++ : id--) ids.push_back(id);
+
+        return ids;
+    }
+}
+
+TEST(MessageHistoryPager, WalksOlderUpToTheLimit) {
+    FakeChannel channel{ 1000 };
+    discpp::MessageHistoryPager pager(7, discpp::HistoryDirection::OLDER, 0, 250, channel.Fetch());
+
+    EXPECT_EQ(Range(1000, 901), Ids(*pager.NextPage()));
+    EXPECT_EQ(Range(900, 801), Ids(*pager.NextPage()));
+    EXPECT_EQ(Range(800, 751), Ids(*pager.NextPage()));
+    EXPECT_TRUE(pager.NextPage()->Empty());
+
+    // The last page only asks for what is left of the limit, and nothing is requested after it.
+    ASSERT_EQ(3u, channel.urls.size());
+    EXPECT_NE(std::string::npos, channel.urls[0].find("/channels/7/messages?limit=100"));
+    EXPECT_EQ(std::string::npos, channel.urls[0].find("before="));
+    EXPECT_NE(std::string::npos, channel.urls[1].find("limit=100&before=901"));
+    EXPECT_NE(std::string::npos, channel.urls[2].find("limit=50&before=801"));
+}
+
+TEST(MessageHistoryPager, WalksNewerOldestFirst) {
+    FakeChannel channel{ 230 };
+    discpp::MessageHistoryPager pager(7, discpp::HistoryDirection::NEWER, 0, 0, channel.Fetch());
+
+    EXPECT_EQ(Range(1, 100), Ids(*pager.NextPage()));
+    EXPECT_EQ(Range(101, 200), Ids(*pager.NextPage()));
+    EXPECT_EQ(Range(201, 230), Ids(*pager.NextPage()));
+    EXPECT_TRUE(pager.NextPage()->Empty());
+
+    // The short page ended the walk.
+    ASSERT_EQ(3u, channel.urls.size());
+    EXPECT_NE(std::string::npos, channel.urls[0].find("limit=100&after=0"));
+    EXPECT_NE(std::string::npos, channel.urls[1].find("limit=100&after=100"));
+    EXPECT_NE(std::string::npos, channel.urls[2].find("limit=100&after=200"));
+}
+
+TEST(MessageHistoryPager, StopsAtAnEmptyPage) {
+    FakeChannel channel{ 200 };
+    discpp::MessageHistoryPager pager(7, discpp::HistoryDirection::OLDER, 201, 0, channel.Fetch());
+
+    EXPECT_EQ(Range(200, 101), Ids(*pager.NextPage()));
+    EXPECT_EQ(Range(100, 1), Ids(*pager.NextPage()));
+    EXPECT_TRUE(pager.NextPage()->Empty());
+    EXPECT_TRUE(pager.NextPage()->Empty());
+
+    // The history ended on a full page, so it takes one empty page to find out.
+    ASSERT_EQ(3u, channel.urls.size());
+    EXPECT_NE(std::string::npos, channel.urls[0].find("limit=100&before=201"));
+    EXPECT_NE(std::string::npos, channel.urls[2].find("limit=100&before=1"));
+}
+
+TEST(MessageHistoryPager, SplitsLimitsAcrossPages) {
+    FakeChannel channel{ 1000 };
+    discpp::MessageHistoryPager pager(7, discpp::HistoryDirection::NEWER, 500, 101, channel.Fetch());
+
+    EXPECT_EQ(Range(501, 600), Ids(*pager.NextPage()));
+    EXPECT_EQ(Range(601, 601), Ids(*pager.NextPage()));
+    EXPECT_TRUE(pager.NextPage()->Empty());
+
+    ASSERT_EQ(2u, channel.urls.size());
+    EXPECT_NE(std::string::npos, channel.urls[1].find("limit=1&after=600"));
+}
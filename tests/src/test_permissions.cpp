@@ -0,0 +1,153 @@
+#include <discpp/guild.h>
+#include <discpp/member.h>
+#include <discpp/role.h>
+#include <discpp/channel.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+
+namespace {
+    constexpr uint64_t guild_id = 100;
+    constexpr uint64_t moderator_role_id = 200;
+    constexpr uint64_t member_id = 300;
+
+    std::shared_ptr<discpp::Role> MakeRole(uint64_t id, int permissions) {
+        auto role = std::make_shared<discpp::Role>();
+        role->id = id;
+        role->permissions = discpp::Permissions(discpp::PermissionType::ROLE, permissions);
+
+        return role;
+    }
+
+    discpp::Permissions MakeOverwrite(uint64_t id, discpp::PermissionType type, int allow, int deny) {
+        discpp::Permissions overwrite(type, allow);
+        overwrite.role_user_id = id;
+        overwrite.deny_perms = discpp::PermissionOverwrite(deny);
+
+        return overwrite;
+    }
+
+    // Roles are immutable once a guild holds them, so swap in a copy with the role added.
+    void AddRole(discpp::Guild& guild, std::shared_ptr<discpp::Role> role) {
+        auto roles = std::make_shared<discpp::GuildRoles>(*guild.roles);
+        (*roles)[role->id] = std::move(role);
+        guild.roles = roles;
+    }
+
+    discpp::Guild MakeGuild() {
+        discpp::Guild guild;
+        guild.id = guild_id;
+        guild.owner_id = 1;
+        AddRole(guild, MakeRole(guild_id, discpp::Permission::READ_MESSAGES | discpp::Permission::SEND_MESSAGES));
+        AddRole(guild, MakeRole(moderator_role_id, discpp::Permission::KICK_MEMBERS));
+
+        return guild;
+    }
+
+    discpp::Member MakeMember(uint64_t id) {
+        discpp::Member member;
+        member.guild_id = guild_id;
+        member.user = std::make_shared<discpp::User>();
+        member.user->id = id;
+
+        return member;
+    }
+}
+
+TEST(Permissions, GuildLevelStacksRoles) {
+    discpp::Guild guild = MakeGuild();
+    discpp::Member member = MakeMember(member_id);
+
+    EXPECT_EQ(0u, guild.ComputePermissions(member) & discpp::Permission::KICK_MEMBERS);
+
+    member.roles.push_back(moderator_role_id);
+    EXPECT_NE(0u, guild.ComputePermissions(member) & discpp::Permission::KICK_MEMBERS);
+    EXPECT_NE(0u, guild.ComputePermissions(member) & discpp::Permission::SEND_MESSAGES);
+}
+
+TEST(Permissions, OwnerAndAdministratorGetEverything) {
+    discpp::Guild guild = MakeGuild();
+    AddRole(guild, MakeRole(201, discpp::Permission::ADMINISTRATOR));
+
+    discpp::Member owner = MakeMember(1);
+    EXPECT_EQ(~static_cast<uint64_t>(0), guild.ComputePermissions(owner));
+
+    discpp::Member admin = MakeMember(member_id);
+    admin.roles.push_back(201);
+    EXPECT_EQ(~static_cast<uint64_t>(0), guild.ComputePermissions(admin));
+}
+
+TEST(Permissions, ChannelOverwritesApplyInOrder) {
+    discpp::Guild guild = MakeGuild();
+    discpp::Member member = MakeMember(member_id);
+    member.roles.push_back(moderator_role_id);
+
+    discpp::Channel channel;
+    channel.id = 400;
+
+    // @everyone loses send messages, the moderator role gets it back, and the member loses it again.
+    channel.permissions.push_back(MakeOverwrite(guild_id, discpp::PermissionType::ROLE, 0, discpp::Permission::SEND_MESSAGES));
+    EXPECT_EQ(0u, guild.ComputePermissions(member, &channel) & discpp::Permission::SEND_MESSAGES);
+
+    channel.permissions.push_back(MakeOverwrite(moderator_role_id, discpp::PermissionType::ROLE, discpp::Permission::SEND_MESSAGES, 0));
+    EXPECT_NE(0u, guild.ComputePermissions(member, &channel) & discpp::Permission::SEND_MESSAGES);
+
+    channel.permissions.push_back(MakeOverwrite(member_id, discpp::PermissionType::MEMBER, 0, discpp::Permission::SEND_MESSAGES));
+    EXPECT_EQ(0u, guild.ComputePermissions(member, &channel) & discpp::Permission::SEND_MESSAGES);
+    EXPECT_NE(0u, guild.ComputePermissions(member, &channel) & discpp::Permission::READ_MESSAGES);
+}
+
+TEST(Permissions, MemoizedMasksFollowTheMembersRoles) {
+    discpp::Guild guild = MakeGuild();
+    discpp::Member member = MakeMember(member_id);
+    EXPECT_EQ(0u, guild.GetEffectivePermissions(member) & discpp::Permission::KICK_MEMBERS);
+
+    // Another object of the same member with other roles must not get the memoized mask.
+    discpp::Member moderator = member;
+    moderator.roles.push_back(moderator_role_id);
+    EXPECT_NE(0u, guild.GetEffectivePermissions(moderator) & discpp::Permission::KICK_MEMBERS);
+    EXPECT_EQ(0u, guild.GetEffectivePermissions(member) & discpp::Permission::KICK_MEMBERS);
+}
+
+TEST(Permissions, MemoizedMasksFollowRolesAndOverwrites) {
+    discpp::Guild guild = MakeGuild();
+    discpp::Member member = MakeMember(member_id);
+    member.roles.push_back(moderator_role_id);
+
+    auto channels = std::make_shared<discpp::GuildChannels>();
+    (*channels)[400].id = 400;
+    guild.channels = channels;
+    EXPECT_NE(0u, guild.GetEffectivePermissions(member, 400) & discpp::Permission::SEND_MESSAGES);
+
+    // A copy shares the memoized masks, but one with changed overwrites must not reuse them.
+    discpp::Guild overwritten = guild;
+    auto overwritten_channels = std::make_shared<discpp::GuildChannels>(*guild.channels);
+    (*overwritten_channels)[400].permissions.push_back(MakeOverwrite(member_id, discpp::PermissionType::MEMBER, 0, discpp::Permission::SEND_MESSAGES));
+    overwritten.channels = overwritten_channels;
+    EXPECT_EQ(0u, overwritten.GetEffectivePermissions(member, 400) & discpp::Permission::SEND_MESSAGES);
+
+    // Same for changed roles, while the older snapshot keeps computing with its own roles.
+    discpp::Guild demoted = guild;
+    AddRole(demoted, MakeRole(moderator_role_id, 0));
+    EXPECT_EQ(0u, demoted.GetEffectivePermissions(member) & discpp::Permission::KICK_MEMBERS);
+    EXPECT_NE(0u, guild.GetEffectivePermissions(member) & discpp::Permission::KICK_MEMBERS);
+    EXPECT_NE(0u, guild.GetEffectivePermissions(member, 400) & discpp::Permission::SEND_MESSAGES);
+}
+
+TEST(Permissions, OverwritesKeepHighBits) {
+    constexpr uint64_t high_bit = static_cast<uint64_t>(1) << 40;
+
+    rapidjson::Document json;
+    json.Parse(R"({"id": "400", "type": "member", "allow": "1099511627776", "deny": 2048})");
+    discpp::Permissions overwrite(json);
+    EXPECT_EQ(high_bit, overwrite.allow_perms.value);
+    EXPECT_EQ(static_cast<uint64_t>(discpp::Permission::SEND_MESSAGES), overwrite.deny_perms.value);
+
+    discpp::Guild guild = MakeGuild();
+    discpp::Member member = MakeMember(member_id);
+    discpp::Channel channel;
+    channel.id = 400;
+    channel.permissions.push_back(MakeOverwrite(member_id, discpp::PermissionType::MEMBER, 0, 0));
+    channel.permissions.back().allow_perms = discpp::PermissionOverwrite(high_bit);
+    EXPECT_EQ(high_bit, guild.ComputePermissions(member, &channel) & high_bit);
+}
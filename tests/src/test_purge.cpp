@@ -0,0 +1,75 @@
+#include <discpp/purge.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <vector>
+
+namespace {
+    const std::chrono::system_clock::time_point now = std::chrono::system_clock::from_time_t(1600000000);
+
+    discpp::Snowflake MessageAged(std::chrono::hours age, uint64_t increment = 0) {
+        constexpr uint64_t discord_epoch = 1420070400000;
+        uint64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>((now - age).time_since_epoch()).count();
+
+        return ((ms - discord_epoch) << 22) | increment;
+    }
+}
+
+TEST(MessagePurger, SplitsYoungMessagesIntoBatches) {
+    std::vector<discpp::Snowflake> messages;
+    for (uint64_t i = 0; i < 250; i++) {
+        messages.push_back(MessageAged(std::chrono::hours(1), i));
+    }
+
+    discpp::PurgePlan plan = discpp::MessagePurger::Plan(messages, now);
+    ASSERT_EQ(3u, plan.bulk_batches.size());
+    EXPECT_EQ(100u, plan.bulk_batches[0].size());
+    EXPECT_EQ(100u, plan.bulk_batches[1].size());
+    EXPECT_EQ(50u, plan.bulk_batches[2].size());
+    EXPECT_TRUE(plan.singles.empty());
+}
+
+TEST(MessagePurger, DeletesOldMessagesOneByOne) {
+    std::vector<discpp::Snowflake> messages = {
+        MessageAged(std::chrono::hours(24 * 20)),
+        MessageAged(std::chrono::hours(2)),
+        MessageAged(std::chrono::hours(1)),
+        MessageAged(std::chrono::hours(24 * 15)),
+        MessageAged(std::chrono::hours(1)) // Duplicate
+    };
+
+    discpp::PurgePlan plan = discpp::MessagePurger::Plan(messages, now);
+    ASSERT_EQ(1u, plan.bulk_batches.size());
+    EXPECT_EQ(2u, plan.bulk_batches[0].size());
+    ASSERT_EQ(2u, plan.singles.size());
+    EXPECT_EQ(MessageAged(std::chrono::hours(24 * 15)), plan.singles[0]);
+    EXPECT_EQ(MessageAged(std::chrono::hours(24 * 20)), plan.singles[1]);
+}
+
+TEST(MessagePurger, SingleYoungMessageIsNotBulkDeleted) {
+    std::vector<discpp::Snowflake> messages = { MessageAged(std::chrono::hours(1)), MessageAged(std::chrono::hours(24 * 20)) };
+
+    discpp::PurgePlan plan = discpp::MessagePurger::Plan(messages, now);
+    EXPECT_TRUE(plan.bulk_batches.empty());
+    EXPECT_EQ(std::vector<discpp::Snowflake>({ MessageAged(std::chrono::hours(1)), MessageAged(std::chrono::hours(24 * 20)) }), plan.singles);
+}
+
+TEST(MessagePurger, RebalancesALoneYoungMessage) {
+    std::vector<discpp::Snowflake> messages;
+    for (uint64_t i = 0; i < 201; i++) {
+        messages.push_back(MessageAged(std::chrono::hours(1), i));
+    }
+
+    // 201 messages take three requests either way, but 100 + 51 + 50 keeps them all in bulk deletes.
+    discpp::PurgePlan plan = discpp::MessagePurger::Plan(messages, now);
+    ASSERT_EQ(3u, plan.bulk_batches.size());
+    EXPECT_EQ(100u, plan.bulk_batches[0].size());
+    EXPECT_EQ(51u, plan.bulk_batches[1].size());
+    EXPECT_EQ(50u, plan.bulk_batches[2].size());
+    EXPECT_TRUE(plan.singles.empty());
+
+    // Still newest first across the batches.
+    EXPECT_EQ(MessageAged(std::chrono::hours(1), 50), plan.bulk_batches[1].back());
+    EXPECT_EQ(MessageAged(std::chrono::hours(1), 49), plan.bulk_batches[2].front());
+    EXPECT_EQ(MessageAged(std::chrono::hours(1), 0), plan.bulk_batches[2].back());
+}
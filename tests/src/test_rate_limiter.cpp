@@ -0,0 +1,106 @@
+#include <discpp/rate_limiter.h>
+#include <discpp/utils.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <future>
+#include <string>
+#include <vector>
+
+namespace {
+    const std::string messages_url = "https://discordapp.com/api/v6/channels/1234/messages";
+
+    cpr::Response MakeResponse(const std::string& remaining, const std::string& reset_after) {
+        cpr::Response response;
+        response.status_code = 200;
+        response.header["x-ratelimit-bucket"] = "abcd";
+        response.header["x-ratelimit-limit"] = "2";
+        response.header["x-ratelimit-remaining"] = remaining;
+        response.header["x-ratelimit-reset-after"] = reset_after;
+
+        return response;
+    }
+}
+
+TEST(RateLimiter, RouteTemplates) {
+    EXPECT_EQ("DELETE /channels/:id/messages/:id", discpp::RateLimiter::Route("DELETE", messages_url + "/5678"));
+    EXPECT_EQ("GET /channels/:id/messages", discpp::RateLimiter::Route("GET", messages_url + "?limit=50"));
+    EXPECT_EQ("POST /webhooks/:id/:token", discpp::RateLimiter::Route("POST", "https://discordapp.com/api/v6/webhooks/1234/s3cr3t"));
+    EXPECT_EQ("PUT /channels/:id/messages/:id/reactions/:emoji/@me",
+        discpp::RateLimiter::Route("PUT", messages_url + "/5678/reactions/%F0%9F%91%8D/@me"));
+}
+
+TEST(RateLimiter, RouteTemplatesBehindAnyBasePath) {
+    EXPECT_EQ("GET /channels/:id", discpp::RateLimiter::Route("GET", "https://discordapp.com/api/channels/1234"));
+    EXPECT_EQ("GET /channels/:id", discpp::RateLimiter::Route("GET", "/api/v6/channels/1234"));
+    EXPECT_EQ("GET /channels/:id", discpp::RateLimiter::Route("GET", "http://127.0.0.1:8080/channels/1234?limit=1"));
+    EXPECT_EQ("GET /gateway", discpp::RateLimiter::Route("GET", "https://discordapp.com/api/v6/gateway?v=6"));
+
+    // A rest proxy served from its own base path, which only the configured base url tells apart from the route.
+    std::string api_base_url = discpp::globals::api_base_url;
+    discpp::globals::api_base_url = "http://127.0.0.1:8080/discord/v6";
+    EXPECT_EQ("DELETE /channels/:id/messages/:id", discpp::RateLimiter::Route("DELETE", "http://127.0.0.1:8080/discord/v6/channels/1234/messages/5678"));
+    discpp::globals::api_base_url = api_base_url;
+}
+
+TEST(RateLimiter, DispatchesInOrderWithinBudget) {
+    discpp::RateLimiter limiter;
+    std::vector<int> dispatched;
+
+    // Until a response describes the bucket only one request is sent.
+    for (int i = 0; i < 3; i++) {
+        limiter.Acquire("POST", messages_url, 1234, [&dispatched, i]() { dispatched.push_back(i); });
+    }
+    EXPECT_EQ(std::vector<int>({ 0 }), dispatched);
+
+    limiter.Complete("POST", messages_url, 1234, MakeResponse("1", "60"));
+    EXPECT_EQ(std::vector<int>({ 0, 1 }), dispatched);
+
+    // Other channels have their own bucket.
+    limiter.Acquire("POST", "https://discordapp.com/api/v6/channels/99/messages", 99, [&dispatched]() { dispatched.push_back(99); });
+    EXPECT_EQ(std::vector<int>({ 0, 1, 99 }), dispatched);
+}
+
+TEST(RateLimiter, ReleasesHeldRequestsOnReset) {
+    discpp::RateLimiter limiter;
+    limiter.Acquire("POST", messages_url, 1234);
+
+    std::promise<void> dispatched;
+    limiter.Acquire("POST", messages_url, 1234, [&dispatched]() { dispatched.set_value(); });
+
+    auto completed = std::chrono::steady_clock::now();
+    limiter.Complete("POST", messages_url, 1234, MakeResponse("0", "0.05"));
+
+    std::future<void> future = dispatched.get_future();
+    ASSERT_EQ(std::future_status::ready, future.wait_for(std::chrono::seconds(2)));
+    EXPECT_GE(std::chrono::steady_clock::now() - completed, std::chrono::milliseconds(45));
+}
+
+TEST(RateLimiter, MovesEveryMajorParameterToTheLearnedBucket) {
+    discpp::RateLimiter limiter;
+    const std::string other_url = "https://discordapp.com/api/v6/channels/99/messages";
+    std::vector<std::string> dispatched;
+
+    // Both channels queue under the route, since no response named the bucket yet.
+    for (const char* name : { "a1", "a2" }) {
+        limiter.Acquire("POST", messages_url, 1234, [&dispatched, name]() { dispatched.push_back(name); });
+    }
+    for (const char* name : { "b1", "b2" }) {
+        limiter.Acquire("POST", other_url, 99, [&dispatched, name]() { dispatched.push_back(name); });
+    }
+    EXPECT_EQ(std::vector<std::string>({ "a1", "b1" }), dispatched);
+
+    limiter.Complete("POST", messages_url, 1234, MakeResponse("1", "60"));
+    EXPECT_EQ(std::vector<std::string>({ "a1", "b1", "a2" }), dispatched);
+    EXPECT_EQ(2u, limiter.BucketCount());
+
+    // The request of the other channel was sent under the route, but completes into the bucket of the hash.
+    limiter.Complete("POST", other_url, 99, MakeResponse("1", "60"));
+    EXPECT_EQ(std::vector<std::string>({ "a1", "b1", "a2", "b2" }), dispatched);
+    EXPECT_EQ(2u, limiter.BucketCount());
+
+    limiter.Complete("POST", messages_url, 1234, MakeResponse("0", "60"));
+    limiter.Complete("POST", other_url, 99, MakeResponse("0", "60"));
+    limiter.Acquire("POST", other_url, 99, [&dispatched]() { dispatched.push_back("b3"); });
+    EXPECT_EQ(4u, dispatched.size());
+}
@@ -0,0 +1,112 @@
+#include <discpp/response_cache.h>
+#include <discpp/utils.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace {
+    const std::string bans_url = "https://discordapp.com/api/v6/guilds/1234/bans";
+
+    rapidjson::Document MakeJson(int value) {
+        rapidjson::Document json;
+        json.SetInt(value);
+
+        return json;
+    }
+}
+
+TEST(ResponseCache, OnlyCachesRoutesWithTTL) {
+    discpp::ResponseCache cache;
+    cache.SetTTL("/guilds/:id/bans", std::chrono::seconds(60));
+
+    EXPECT_TRUE(cache.Cacheable(bans_url));
+    EXPECT_FALSE(cache.Cacheable("https://discordapp.com/api/v6/guilds/1234/members"));
+
+    cache.Store(bans_url, MakeJson(1), {}, cache.Generation());
+    cache.Store("https://discordapp.com/api/v6/guilds/1234/members", MakeJson(2), {}, cache.Generation());
+    EXPECT_EQ(1u, cache.Size());
+
+    std::unique_ptr<rapidjson::Document> cached = cache.Get(bans_url);
+    ASSERT_NE(nullptr, cached);
+    EXPECT_EQ(1, cached->GetInt());
+}
+
+TEST(ResponseCache, StaleResponsesRevalidate) {
+    discpp::ResponseCache cache;
+    cache.SetTTL("/guilds/:id/bans", std::chrono::milliseconds(1));
+
+    cpr::Header header;
+    header["etag"] = "\"v1\"";
+    cache.Store(bans_url, MakeJson(1), header, cache.Generation());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    EXPECT_EQ(nullptr, cache.Get(bans_url));
+    EXPECT_EQ("\"v1\"", cache.GetETag(bans_url));
+
+    std::unique_ptr<rapidjson::Document> revalidated = cache.Revalidate(bans_url);
+    ASSERT_NE(nullptr, revalidated);
+    EXPECT_EQ(1, revalidated->GetInt());
+}
+
+TEST(ResponseCache, InvalidatesWholeSegments) {
+    discpp::ResponseCache cache;
+    cache.SetTTL("/guilds/:id/bans", std::chrono::seconds(60));
+    cache.Store(bans_url, MakeJson(1), {}, cache.Generation());
+    cache.Store("https://discordapp.com/api/v6/guilds/12345/bans", MakeJson(2), {}, cache.Generation());
+
+    cache.InvalidateResource("https://discordapp.com/api/v6/guilds/1234/bans/5678");
+    EXPECT_EQ(nullptr, cache.Get(bans_url));
+    EXPECT_NE(nullptr, cache.Get("https://discordapp.com/api/v6/guilds/12345/bans"));
+}
+
+TEST(ResponseCache, InvalidatesBehindAnyBasePath) {
+    std::string api_base_url = discpp::globals::api_base_url;
+    discpp::globals::api_base_url = "http://127.0.0.1:8080/discord";
+    const std::string proxied_bans_url = "http://127.0.0.1:8080/discord/guilds/1234/bans";
+
+    discpp::ResponseCache cache;
+    cache.SetTTL("/guilds/:id/bans", std::chrono::seconds(60));
+    cache.Store(proxied_bans_url, MakeJson(1), {}, cache.Generation());
+    cache.Store("http://127.0.0.1:8080/discord/guilds/12345/bans", MakeJson(2), {}, cache.Generation());
+
+    cache.InvalidateResource("http://127.0.0.1:8080/discord/guilds/1234/bans/5678");
+    EXPECT_EQ(nullptr, cache.Get(proxied_bans_url));
+    EXPECT_NE(nullptr, cache.Get("http://127.0.0.1:8080/discord/guilds/12345/bans"));
+
+    discpp::globals::api_base_url = api_base_url;
+}
+
+TEST(ResponseCache, DropsResponsesInvalidatedWhileInFlight) {
+    discpp::ResponseCache cache;
+    cache.SetTTL("/guilds/:id/bans", std::chrono::seconds(60));
+    const std::string other_url = "https://discordapp.com/api/v6/guilds/12345/bans";
+
+    uint64_t generation = cache.Generation();
+    cache.InvalidateResource("https://discordapp.com/api/v6/guilds/1234/bans/5678");
+
+    // The response may predate the ban, but other guilds weren't touched.
+    cache.Store(bans_url, MakeJson(1), {}, generation);
+    cache.Store(other_url, MakeJson(2), {}, generation);
+    EXPECT_EQ(nullptr, cache.Get(bans_url));
+    EXPECT_NE(nullptr, cache.Get(other_url));
+
+    cache.Store(bans_url, MakeJson(3), {}, cache.Generation());
+    EXPECT_NE(nullptr, cache.Get(bans_url));
+
+    generation = cache.Generation();
+    cache.Clear();
+    cache.Store(other_url, MakeJson(4), {}, generation);
+    EXPECT_EQ(0u, cache.Size());
+
+    // Once old invalidations are forgotten, responses from before them aren't stored at all.
+    cache.max_entries = 2;
+    generation = cache.Generation();
+    for (int i = 0; i < 3; i++) {
+        cache.Invalidate("https://discordapp.com/api/v6/guilds/" + std::to_string(i));
+    }
+    cache.Store(other_url, MakeJson(5), {}, generation);
+    EXPECT_EQ(0u, cache.Size());
+}
@@ -0,0 +1,287 @@
+#include <discpp/rest_engine.h>
+#include <discpp/response_cache.h>
+#include <discpp/utils.h>
+#include <gtest/gtest.h>
+#include <stub_server.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+namespace {
+    struct Completed {
+        cpr::Response response;
+        std::thread::id thread;
+    };
+
+    std::future<Completed> Perform(discpp::RestEngine& engine, discpp::RestEngine::Request request) {
+        auto promise = std::make_shared<std::promise<Completed>>();
+        request.callback = [promise](cpr::Response& response) {
+            promise->set_value({ response, std::this_thread::get_id() });
+        };
+
+        engine.Perform(std::move(request));
+        return promise->get_future();
+    }
+}
+
+TEST(RestEngine, PerformsRequestsOnTheLoopThread) {
+    test::StubServer server([](const test::StubServer::Request&) {
+        return test::StubServer::Response{ 200, { { "X-RateLimit-Remaining", "4" } }, "{\"id\":\"1\"}" };
+    });
+    discpp::RestEngine engine;
+
+    discpp::RestEngine::Request request;
+    request.url = server.Url() + "/api/v6/channels/1";
+    request.headers = { { "Authorization", "Bot token" } };
+    Completed completed = Perform(engine, std::move(request)).get();
+
+    EXPECT_EQ(200, completed.response.status_code);
+    EXPECT_EQ("{\"id\":\"1\"}", completed.response.text);
+    EXPECT_EQ("4", completed.response.header["X-RateLimit-Remaining"]);
+    EXPECT_NE(std::this_thread::get_id(), completed.thread);
+
+    std::vector<test::StubServer::Request> received = server.Requests();
+    ASSERT_EQ(1u, received.size());
+    EXPECT_EQ("GET", received[0].method);
+    EXPECT_EQ("/api/v6/channels/1", received[0].target);
+    EXPECT_EQ("Bot token", received[0].Header("authorization"));
+    EXPECT_EQ(0u, engine.Pending());
+}
+
+TEST(RestEngine, KnowsItsLoopThread) {
+    test::StubServer server([](const test::StubServer::Request&) {
+        return test::StubServer::Response{ 200, {}, "{}" };
+    });
+    discpp::RestEngine engine;
+
+    std::promise<bool> on_loop_thread;
+    discpp::RestEngine::Request request;
+    request.url = server.Url() + "/api/v6/gateway";
+    request.callback = [&engine, &on_loop_thread](cpr::Response&) { on_loop_thread.set_value(engine.OnLoopThread()); };
+    engine.Perform(std::move(request));
+
+    // Channel::Send and Webhook::Send use this to throw instead of waiting for an upload forever.
+    EXPECT_TRUE(on_loop_thread.get_future().get());
+    EXPECT_FALSE(engine.OnLoopThread());
+}
+
+TEST(RestEngine, SendsBodiesWithEveryMethod) {
+    test::StubServer server([](const test::StubServer::Request&) {
+        return test::StubServer::Response{ 204, {}, "" };
+    });
+    discpp::RestEngine engine;
+
+    std::vector<std::future<Completed>> futures;
+    for (const char* method : { "POST", "PATCH", "PUT", "DELETE" }) {
+        discpp::RestEngine::Request request;
+        request.method = method;
+        request.url = server.Url() + "/api/v6/channels/1/" + method;
+        request.body = method == std::string("PATCH") ? "{\"name\":\"a\"}" : "";
+        futures.push_back(Perform(engine, std::move(request)));
+    }
+    for (std::future<Completed>& future : futures) {
+        EXPECT_EQ(204, future.get().response.status_code);
+    }
+
+    std::vector<test::StubServer::Request> received = server.Requests();
+    ASSERT_EQ(4u, received.size());
+    for (const test::StubServer::Request& request : received) {
+        EXPECT_EQ("/api/v6/channels/1/" + request.method, request.target);
+
+        // Discord wants a Content-Length even without a body.
+        EXPECT_EQ(std::to_string(request.body.size()), request.Header("content-length"));
+        EXPECT_EQ(request.method == "PATCH" ? "{\"name\":\"a\"}" : "", request.body);
+    }
+}
+
+TEST(RestEngine, WaitsForNotBefore) {
+    test::StubServer server([](const test::StubServer::Request&) {
+        return test::StubServer::Response{ 200, {}, "{}" };
+    });
+    discpp::RestEngine engine;
+
+    auto start = std::chrono::steady_clock::now();
+    discpp::RestEngine::Request request;
+    request.url = server.Url() + "/api/v6/gateway";
+    request.not_before = start + std::chrono::milliseconds(200);
+
+    std::future<Completed> completed = Perform(engine, std::move(request));
+    EXPECT_EQ(1u, engine.Pending());
+    EXPECT_EQ(200, completed.get().response.status_code);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(200));
+}
+
+TEST(RestEngine, TimesOutSlowRequests) {
+    test::StubServer server([](const test::StubServer::Request&) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+        return test::StubServer::Response{ 200, {}, "{}" };
+    });
+    discpp::RestEngine engine;
+
+    auto start = std::chrono::steady_clock::now();
+    discpp::RestEngine::Request request;
+    request.url = server.Url() + "/api/v6/gateway";
+    request.timeout = std::chrono::milliseconds(100);
+
+    // A failed transfer has no status code, which discpp::HandleResponse turns into an exception.
+    EXPECT_EQ(0, Perform(engine, std::move(request)).get().response.status_code);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(900));
+    EXPECT_EQ(0u, engine.Pending());
+}
+
+TEST(RestEngine, SkipsCancelledRequests) {
+    test::StubServer server([](const test::StubServer::Request&) {
+        return test::StubServer::Response{ 204, {}, "" };
+    });
+    discpp::RestEngine engine;
+    auto cancelled = std::make_shared<std::atomic<bool>>(false);
+
+    discpp::RestEngine::Request sent;
+    sent.method = "DELETE";
+    sent.url = server.Url() + "/api/v6/channels/1/messages/1";
+    sent.cancelled = cancelled;
+
+    discpp::RestEngine::Request skipped = sent;
+    skipped.url = server.Url() + "/api/v6/channels/1/messages/2";
+    skipped.not_before = std::chrono::steady_clock::now() + std::chrono::milliseconds(300);
+
+    std::future<Completed> first = Perform(engine, std::move(sent));
+    std::future<Completed> second = Perform(engine, std::move(skipped));
+    EXPECT_EQ(204, first.get().response.status_code);
+
+    // The flag is checked once the request is due, not when it is queued.
+    *cancelled = true;
+    EXPECT_EQ(0, second.get().response.status_code);
+    EXPECT_EQ(1u, server.Requests().size());
+    EXPECT_EQ(0u, engine.Pending());
+}
+
+namespace {
+    // Finds the contents of the multipart part with the file name `name`.
+    std::string PartContents(const std::string& body, const std::string& name) {
+        std::size_t part = body.find("filename=\"" + name + "\"");
+        if (part == std::string::npos) return "<missing>";
+
+        std::size_t start = body.find("\r\n\r\n", part) + 4;
+        return body.substr(start, body.find("\r\n--", start) - start);
+    }
+}
+
+TEST(RestEngine, UploadsFilesFromEverySource) {
+    test::StubServer server([](const test::StubServer::Request&) {
+        return test::StubServer::Response{ 200, {}, "{}" };
+    });
+    discpp::RestEngine engine;
+
+    std::string span = "from a span";
+    auto stream = std::make_shared<std::istringstream>("skipped, from a stream, not sent");
+    stream->seekg(9);
+
+    discpp::RestEngine::Request request;
+    request.method = "POST";
+    request.url = server.Url() + "/api/v6/channels/1/messages";
+    request.body = "{\"content\":\"files\"}";
+    request.files = {
+        discpp::File::FromBuffer("buffer.txt", "from a buffer"),
+        discpp::File::FromSpan("span.txt", span.data(), span.size()),
+        discpp::File::FromSpan("empty.txt", nullptr, 0),
+        discpp::File::FromStream("stream.txt", stream, 13),
+    };
+    EXPECT_EQ(200, Perform(engine, std::move(request)).get().response.status_code);
+
+    std::vector<test::StubServer::Request> received = server.Requests();
+    ASSERT_EQ(1u, received.size());
+    EXPECT_EQ(0u, received[0].Header("content-type").find("multipart/form-data; boundary="));
+    EXPECT_EQ("from a buffer", PartContents(received[0].body, "buffer.txt"));
+    EXPECT_EQ("from a span", PartContents(received[0].body, "span.txt"));
+    EXPECT_EQ("", PartContents(received[0].body, "empty.txt"));
+    EXPECT_EQ("from a stream", PartContents(received[0].body, "stream.txt"));
+    EXPECT_NE(std::string::npos, received[0].body.find("name=\"payload_json\"\r\nContent-Type: application/json\r\n\r\n{\"content\":\"files\"}"));
+}
+
+TEST(RestEngine, RewindsStreamsForAnotherUpload) {
+    test::StubServer server([](const test::StubServer::Request&) {
+        return test::StubServer::Response{ 200, {}, "{}" };
+    });
+    discpp::RestEngine engine;
+
+    discpp::RestEngine::Request request;
+    request.method = "POST";
+    request.url = server.Url() + "/api/v6/channels/1/messages";
+    request.files = { discpp::File::FromStream("stream.txt", std::make_shared<std::istringstream>("streamed twice"), 14) };
+
+    // A rate limited upload is sent again with the same stream, which was read to its end by then.
+    EXPECT_EQ(200, Perform(engine, request).get().response.status_code);
+    EXPECT_EQ(200, Perform(engine, request).get().response.status_code);
+
+    std::vector<test::StubServer::Request> received = server.Requests();
+    ASSERT_EQ(2u, received.size());
+    EXPECT_EQ("streamed twice", PartContents(received[0].body, "stream.txt"));
+    EXPECT_EQ("streamed twice", PartContents(received[1].body, "stream.txt"));
+}
+
+TEST(RestEngine, SeeksBackWhenCurlResendsAnUpload) {
+    std::atomic<int> uploads{ 0 };
+    test::StubServer server([&uploads](const test::StubServer::Request& request) {
+        // Dropping the first upload on a reused connection makes curl send it again on a new one.
+        test::StubServer::Response response{ 200, {}, "{}" };
+        response.drop = request.method == "POST" && uploads++ == 0;
+        return response;
+    });
+    discpp::RestEngine engine;
+
+    discpp::RestEngine::Request warm_up;
+    warm_up.url = server.Url() + "/api/v6/gateway";
+    EXPECT_EQ(200, Perform(engine, std::move(warm_up)).get().response.status_code);
+
+    std::string span = "from a span";
+    discpp::RestEngine::Request request;
+    request.method = "POST";
+    request.url = server.Url() + "/api/v6/channels/1/messages";
+    request.files = {
+        discpp::File::FromSpan("span.txt", span.data(), span.size()),
+        discpp::File::FromStream("stream.txt", std::make_shared<std::istringstream>("from a stream"), 13),
+    };
+    EXPECT_EQ(200, Perform(engine, std::move(request)).get().response.status_code);
+
+    std::vector<test::StubServer::Request> received = server.Requests();
+    ASSERT_EQ(3u, received.size());
+    for (std::size_t i = 1; i < received.size(); i++) {
+        EXPECT_EQ("from a span", PartContents(received[i].body, "span.txt"));
+        EXPECT_EQ("from a stream", PartContents(received[i].body, "stream.txt"));
+    }
+}
+
+TEST(RestEngine, ChangesInvalidateCachedResponses) {
+    test::StubServer server([](const test::StubServer::Request&) {
+        return test::StubServer::Response{ 204, {}, "" };
+    });
+    discpp::RestEngine engine;
+
+    std::string api_base_url = discpp::globals::api_base_url;
+    discpp::globals::api_base_url = server.Url() + "/api/v6";
+    const std::string bans_url = server.Url() + "/api/v6/guilds/1234/bans";
+
+    discpp::rest_cache.SetTTL("/guilds/:id/bans", std::chrono::seconds(60));
+    rapidjson::Document bans;
+    bans.SetArray();
+    discpp::rest_cache.Store(bans_url, bans, {}, discpp::rest_cache.Generation());
+
+    // Reading the resource keeps its cached responses, changing it drops them.
+    discpp::RestEngine::Request read;
+    read.url = bans_url + "/5678";
+    Perform(engine, std::move(read)).get();
+    EXPECT_NE(nullptr, discpp::rest_cache.Get(bans_url));
+
+    discpp::RestEngine::Request ban;
+    ban.method = "PUT";
+    ban.url = bans_url + "/5678";
+    Perform(engine, std::move(ban)).get();
+    EXPECT_EQ(nullptr, discpp::rest_cache.Get(bans_url));
+
+    discpp::globals::api_base_url = api_base_url;
+}
@@ -0,0 +1,99 @@
+#include <discpp/rest_proxy.h>
+#include <gtest/gtest.h>
+#include <stub_server.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <string>
+#include <vector>
+
+TEST(RestProxy, MajorParameter) {
+    EXPECT_EQ(1234, discpp::RestProxy::MajorParameter("/api/v6/channels/1234/messages/5678"));
+    EXPECT_EQ(1234, discpp::RestProxy::MajorParameter("/api/v6/guilds/1234?with_counts=true"));
+    EXPECT_EQ(1234, discpp::RestProxy::MajorParameter("/api/v6/webhooks/1234/token"));
+    EXPECT_EQ(0, discpp::RestProxy::MajorParameter("/api/v6/users/@me/guilds"));
+    EXPECT_EQ(0, discpp::RestProxy::MajorParameter("/api/v6/gateway/bot"));
+    EXPECT_EQ(0, discpp::RestProxy::MajorParameter("/api/v6/channels"));
+}
+
+TEST(RestProxy, MajorParameterWithoutApiVersion) {
+    EXPECT_EQ(1234, discpp::RestProxy::MajorParameter("/api/channels/1234/messages"));
+    EXPECT_EQ(1234, discpp::RestProxy::MajorParameter("/channels/1234/messages"));
+    EXPECT_EQ(1234, discpp::RestProxy::MajorParameter("https://discordapp.com/api/v6/guilds/1234/bans"));
+    EXPECT_EQ(1234, discpp::RestProxy::MajorParameter("http://127.0.0.1:8080/webhooks/1234/token"));
+}
+
+TEST(RestProxy, ForwardsOnlyTheNeededHeaders) {
+    test::StubServer server([](const test::StubServer::Request&) {
+        return test::StubServer::Response{ 200, {
+            { "Content-Type", "application/json" }, { "X-RateLimit-Remaining", "4" }, { "Set-Cookie", "__cfduid=1" }, { "Via", "stub" },
+        }, "{\"id\":\"1\"}" };
+    });
+    discpp::RestProxy proxy(server.Url());
+
+    cpr::Header headers = { { "Authorization", "Bot a" }, { "Content-Type", "application/json" }, { "Cookie", "session=1" }, { "X-Forwarded-For", "10.0.0.1" } };
+    cpr::Response response = proxy.Forward("POST", "/api/v6/channels/1/messages", headers, "{\"content\":\"hi\"}").get();
+
+    EXPECT_EQ(200, response.status_code);
+    EXPECT_EQ("{\"id\":\"1\"}", response.text);
+    EXPECT_EQ("application/json", response.header["Content-Type"]);
+    EXPECT_EQ("4", response.header["X-RateLimit-Remaining"]);
+    EXPECT_EQ(0u, response.header.count("Set-Cookie"));
+    EXPECT_EQ(0u, response.header.count("Via"));
+    EXPECT_EQ(0u, response.header.count("Content-Length"));
+
+    std::vector<test::StubServer::Request> received = server.Requests();
+    ASSERT_EQ(1u, received.size());
+    EXPECT_EQ("POST", received[0].method);
+    EXPECT_EQ("/api/v6/channels/1/messages", received[0].target);
+    EXPECT_EQ("{\"content\":\"hi\"}", received[0].body);
+    EXPECT_EQ("Bot a", received[0].Header("authorization"));
+    EXPECT_EQ("application/json", received[0].Header("content-type"));
+    EXPECT_EQ("", received[0].Header("cookie"));
+    EXPECT_EQ("", received[0].Header("x-forwarded-for"));
+}
+
+TEST(RestProxy, RetriesA429) {
+    std::atomic<int> requests{ 0 };
+    test::StubServer server([&requests](const test::StubServer::Request&) {
+        if (requests++ == 0) {
+            return test::StubServer::Response{ 429, {
+                { "Content-Type", "application/json" }, { "X-RateLimit-Limit", "1" }, { "X-RateLimit-Remaining", "0" }, { "X-RateLimit-Reset-After", "0.2" },
+            }, "{\"message\":\"You are being rate limited.\",\"retry_after\":200,\"global\":false}" };
+        }
+
+        return test::StubServer::Response{ 200, { { "Content-Type", "application/json" } }, "{}" };
+    });
+    discpp::RestProxy proxy(server.Url());
+
+    auto start = std::chrono::steady_clock::now();
+    cpr::Response response = proxy.Forward("GET", "/api/v6/channels/2/messages", { { "Authorization", "Bot a" } }, "").get();
+
+    // The process behind the proxy only sees the response of the retry.
+    EXPECT_EQ(200, response.status_code);
+    EXPECT_EQ(2, requests);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(200));
+}
+
+TEST(RestProxy, KeepsBucketsPerToken) {
+    test::StubServer server([](const test::StubServer::Request&) {
+        return test::StubServer::Response{ 200, {
+            { "X-RateLimit-Bucket", "abcd" }, { "X-RateLimit-Limit", "1" }, { "X-RateLimit-Remaining", "0" }, { "X-RateLimit-Reset-After", "1" },
+        }, "{}" };
+    });
+    discpp::RestProxy proxy(server.Url());
+    const std::string target = "/api/v6/channels/3/messages";
+
+    EXPECT_EQ(200, proxy.Forward("GET", target, { { "Authorization", "Bot a" } }, "").get().status_code);
+
+    // The first token used up its bucket, which doesn't hold back the other one.
+    auto start = std::chrono::steady_clock::now();
+    std::future<cpr::Response> held = proxy.Forward("GET", target, { { "Authorization", "Bot a" } }, "");
+    std::future<cpr::Response> other = proxy.Forward("GET", target, { { "Authorization", "Bot b" } }, "");
+
+    EXPECT_EQ(200, other.get().status_code);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+    EXPECT_EQ(200, held.get().status_code);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+}
@@ -0,0 +1,72 @@
+#include <discpp/session_pool.h>
+#include <gtest/gtest.h>
+
+#include <vector>
+
+TEST(SessionPool, ReusesReturnedSessions) {
+    discpp::SessionPool pool(2);
+    EXPECT_EQ(0u, pool.IdleCount());
+
+    cpr::Session* first;
+    {
+        discpp::SessionPool::Lease session = pool.Acquire("GET");
+        first = &*session;
+        EXPECT_EQ(0u, pool.IdleCount());
+    }
+    EXPECT_EQ(1u, pool.IdleCount());
+
+    discpp::SessionPool::Lease session = pool.Acquire("GET");
+    EXPECT_EQ(first, &*session);
+    EXPECT_EQ(0u, pool.IdleCount());
+}
+
+TEST(SessionPool, KeepsSessionsPerMethod) {
+    discpp::SessionPool pool;
+
+    cpr::Session* deleted;
+    {
+        discpp::SessionPool::Lease session = pool.Acquire("DELETE");
+        deleted = &*session;
+    }
+
+    // A session that sent a DELETE is never handed out for a GET.
+    {
+        discpp::SessionPool::Lease session = pool.Acquire("GET");
+        EXPECT_NE(deleted, &*session);
+        EXPECT_EQ(1u, pool.IdleCount());
+    }
+    EXPECT_EQ(2u, pool.IdleCount());
+
+    discpp::SessionPool::Lease session = pool.Acquire("DELETE");
+    EXPECT_EQ(deleted, &*session);
+}
+
+TEST(SessionPool, LimitsIdleSessions) {
+    discpp::SessionPool pool(2);
+    {
+        std::vector<discpp::SessionPool::Lease> leases;
+        for (int i = 0; i < 4; i++) {
+            leases.push_back(pool.Acquire(i % 2 == 0 ? "GET" : "POST"));
+        }
+    }
+    EXPECT_EQ(2u, pool.IdleCount());
+
+    pool.SetMaxIdle(1);
+    EXPECT_EQ(1u, pool.IdleCount());
+
+    pool.SetMaxIdle(4);
+    {
+        std::vector<discpp::SessionPool::Lease> leases;
+        for (int i = 0; i < 4; i++) {
+            leases.push_back(pool.Acquire("PATCH"));
+        }
+    }
+    EXPECT_EQ(4u, pool.IdleCount());
+
+    pool.Clear();
+    EXPECT_EQ(0u, pool.IdleCount());
+
+    pool.SetMaxIdle(0);
+    { discpp::SessionPool::Lease session = pool.Acquire("GET"); }
+    EXPECT_EQ(0u, pool.IdleCount());
+}
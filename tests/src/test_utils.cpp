@@ -23,12 +23,40 @@ TEST(Utils, CombineStringVector) {
 TEST(Utils, Base64Encode) {
 	EXPECT_EQ("dGVzdA==", discpp::Base64Encode("test"));
 }
+TEST(Utils, Base64EncodeVectorized) {
+	// Long enough for the AVX2 and SSSE3 loops, with every tail length.
+	const std::string text = "The quick brown fox jumps over the lazy dog. The quick brown fox jumps over the lazy dog.";
+	const std::string encoded = "VGhlIHF1aWNrIGJyb3duIGZveCBqdW1wcyBvdmVyIHRoZSBsYXp5IGRvZy4gVGhlIHF1aWNrIGJyb3duIGZveCBqdW1wcyBvdmVyIHRoZSBsYXp5IGRvZy4=";
+	EXPECT_EQ(encoded, discpp::Base64Encode(text));
+
+	for (std::size_t size = 0; size <= text.size(); size++) {
+		std::string prefix = discpp::Base64Encode(std::string_view(text).substr(0, size));
+		EXPECT_EQ(discpp::Base64EncodedSize(size), prefix.size());
+		EXPECT_EQ(encoded.substr(0, size / 3 * 4), prefix.substr(0, size / 3 * 4));
+	}
+
+	std::string binary;
+	for (int i = 0; i < 256; i++) binary += static_cast<char>(i);
+	EXPECT_EQ("/P3+/w==", discpp::Base64Encode(binary).substr(336));
+}
 TEST(Utils, EscapeString) {
-	EXPECT_EQ("\\\\ \\\" \\a \\b \\f \\r \\t", discpp::EscapeString("\\ \" \a \b \f \r \t"));
+	EXPECT_EQ("\\\\ \\\" \\u0007 \\b \\f \\r \\t", discpp::EscapeString("\\ \" \a \b \f \r \t"));
 }
 TEST(Utils, TimeFromSnowflake) {
 	EXPECT_EQ(1455907582, discpp::TimeFromSnowflake("150312037426135041"));
 }
+TEST(Utils, TimeFromDiscord) {
+	EXPECT_EQ(1455907582, discpp::TimeFromDiscord("2016-02-19T18:46:22.000000+00:00"));
+	EXPECT_EQ(1455907582, discpp::TimeFromDiscord("2016-02-19T20:46:22+02:00"));
+	EXPECT_EQ(1592915696789, std::chrono::duration_cast<std::chrono::milliseconds>(
+		discpp::TimePointFromDiscord("2020-06-23T12:34:56.789000+00:00").time_since_epoch()).count());
+	EXPECT_THROW(discpp::TimeFromDiscord("2016-02-19"), std::runtime_error);
+}
+TEST(Utils, ParseSnowflake) {
+	EXPECT_EQ(150312037426135041ULL, static_cast<uint64_t>(discpp::Snowflake("150312037426135041")));
+	EXPECT_EQ(18446744073709551615ULL, static_cast<uint64_t>(discpp::Snowflake(std::string("18446744073709551615"))));
+	EXPECT_EQ(0ULL, static_cast<uint64_t>(discpp::Snowflake("not a snowflake")));
+}
 TEST(Utils, FormatTimeFromSnowflake) {
 	EXPECT_EQ("2016-02-19 @ 18:46:22 GMT", discpp::FormatTimeFromSnowflake("150312037426135041"));
 }
\ No newline at end of file
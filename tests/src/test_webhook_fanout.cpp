@@ -0,0 +1,124 @@
+#include <discpp/webhook_fanout.h>
+#include <discpp/exceptions.h>
+#include <gtest/gtest.h>
+#include <stub_server.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    // Points the REST helpers at a stub server for the lifetime of a test.
+    struct StubApi {
+        test::StubServer server;
+        std::string api_base_url = discpp::globals::api_base_url;
+
+        explicit StubApi(test::StubServer::Handler handler) : server(std::move(handler)) {
+            discpp::globals::api_base_url = server.Url() + "/api/v6";
+        }
+
+        ~StubApi() {
+            discpp::globals::api_base_url = api_base_url;
+        }
+    };
+
+    // Reads the webhook id out of a target like /api/v6/webhooks/1234/token.
+    uint64_t WebhookId(const test::StubServer::Request& request) {
+        return std::strtoull(request.target.c_str() + request.target.find("/webhooks/") + 10, nullptr, 10);
+    }
+
+    std::vector<discpp::Webhook> Webhooks(uint64_t first, std::size_t count) {
+        std::vector<discpp::Webhook> webhooks;
+        for (uint64_t id = first; id < first + count; id++) webhooks.emplace_back(discpp::Snowflake(id), "token" + std::to_string(id));
+
+        return webhooks;
+    }
+}
+
+TEST(WebhookFanout, KeepsResultsInWebhookOrder) {
+    // Answer the first webhook right away and the others later the earlier they are, so they arrive in reverse.
+    StubApi api([](const test::StubServer::Request& request) {
+        uint64_t id = WebhookId(request);
+        std::this_thread::sleep_for(std::chrono::milliseconds(id == 1100 ? 0 : 50 * (1105 - id)));
+        return test::StubServer::Response{ 204, {}, "" };
+    });
+    std::vector<discpp::Webhook> webhooks = Webhooks(1100, 5);
+
+    std::mutex mutex;
+    std::vector<uint64_t> arrived;
+    discpp::WebhookFanoutOptions options;
+    options.on_result = [&mutex, &arrived](const discpp::WebhookSendResult& result) {
+        std::lock_guard<std::mutex> lock(mutex);
+        arrived.push_back(result.webhook_id);
+    };
+
+    std::vector<discpp::WebhookSendResult> results = discpp::WebhookFanout("Relayed").Send(webhooks, options);
+    ASSERT_EQ(webhooks.size(), results.size());
+    for (std::size_t i = 0; i < results.size(); i++) {
+        EXPECT_EQ(webhooks[i].id, results[i].webhook_id);
+        EXPECT_TRUE(results[i].Succeeded());
+        EXPECT_EQ(204, results[i].status_code);
+    }
+
+    // Every result was reported before Send returned, as it arrived.
+    EXPECT_EQ((std::vector<uint64_t>{ 1100, 1104, 1103, 1102, 1101 }), arrived);
+
+    std::vector<test::StubServer::Request> received = api.server.Requests();
+    ASSERT_EQ(5u, received.size());
+    for (const test::StubServer::Request& request : received) {
+        EXPECT_EQ("POST", request.method);
+        EXPECT_EQ("{\"content\":\"Relayed\",\"tts\":false}", request.body);
+        EXPECT_EQ("/api/v6/webhooks/" + std::to_string(WebhookId(request)) + "/token" + std::to_string(WebhookId(request)), request.target);
+    }
+}
+
+TEST(WebhookFanout, IsolatesFailedWebhooks) {
+    StubApi api([](const test::StubServer::Request& request) {
+        if (WebhookId(request) == 1201) {
+            return test::StubServer::Response{ 404, { { "Content-Type", "application/json" } }, "{\"message\":\"Unknown Webhook\",\"code\":10015}" };
+        }
+
+        return test::StubServer::Response{ 204, {}, "" };
+    });
+    std::vector<discpp::Webhook> webhooks = Webhooks(1200, 3);
+
+    std::vector<discpp::WebhookSendResult> results = discpp::WebhookFanout("Relayed").Send(webhooks);
+    ASSERT_EQ(3u, results.size());
+    EXPECT_TRUE(results[0].Succeeded());
+    EXPECT_TRUE(results[2].Succeeded());
+
+    ASSERT_FALSE(results[1].Succeeded());
+    EXPECT_EQ(404, results[1].status_code);
+    EXPECT_THROW(std::rethrow_exception(results[1].error), discpp::exceptions::http::HTTPResponseException);
+    EXPECT_EQ(3u, api.server.Requests().size());
+}
+
+TEST(WebhookFanout, LimitsRequestsInFlight) {
+    std::atomic<int> in_flight{ 0 };
+    std::atomic<int> most_in_flight{ 0 };
+    StubApi api([&in_flight, &most_in_flight](const test::StubServer::Request&) {
+        int now = ++in_flight;
+        int most = most_in_flight;
+        while (now > most && !most_in_flight.compare_exchange_weak(most, now)) {}
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        in_flight--;
+        return test::StubServer::Response{ 204, {}, "" };
+    });
+
+    discpp::WebhookFanoutOptions options;
+    options.max_in_flight = 2;
+    std::vector<discpp::WebhookSendResult> results = discpp::WebhookFanout("Relayed").Send(Webhooks(1300, 7), options);
+
+    // The callbacks of the first requests started the rest, and Send waited for all of them.
+    EXPECT_EQ(7u, results.size());
+    EXPECT_TRUE(std::all_of(results.begin(), results.end(), [](const discpp::WebhookSendResult& result) { return result.Succeeded(); }));
+    EXPECT_EQ(7u, api.server.Requests().size());
+    EXPECT_LE(most_in_flight, 2);
+    EXPECT_TRUE(discpp::WebhookFanout("Relayed").Send({}, options).empty());
+}
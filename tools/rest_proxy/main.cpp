@@ -0,0 +1,55 @@
+/*
+	Forwards the REST requests of several bot processes to Discord, behind one set of rate limit buckets.
+
+	Usage: rest_proxy [port] [host] [upstream]
+	Point the bots at it with `config->rest_proxy_url = "http://127.0.0.1:8080/api/v6";`
+*/
+
+#include <discpp/rest_proxy.h>
+
+#include <ixwebsocket/IXHttpServer.h>
+#include <ixwebsocket/IXNetSystem.h>
+
+#include <iostream>
+#include <string>
+
+int main(int argc, const char* argv[]) {
+	int port = argc > 1 ? std::stoi(argv[1]) : 8080;
+	std::string host = argc > 2 ? argv[2] : "127.0.0.1";
+	discpp::RestProxy proxy(argc > 3 ? argv[3] : "https://discordapp.com");
+
+	ix::initNetSystem();
+
+	// Every connection is served on its own thread, so waiting for the forwarded request here is fine.
+	ix::HttpServer server(port, host);
+	server.setOnConnectionCallback([&proxy](ix::HttpRequestPtr request, std::shared_ptr<ix::ConnectionState>) {
+		cpr::Header headers;
+		for (const auto& header : request->headers) {
+			headers[header.first] = header.second;
+		}
+
+		cpr::Response response = proxy.Forward(request->method, request->uri, headers, request->body).get();
+
+		ix::WebSocketHttpHeaders response_headers;
+		for (const auto& header : response.header) {
+			response_headers[header.first] = header.second;
+		}
+
+		if (response.status_code == 0) {
+			return std::make_shared<ix::HttpResponse>(502, "Bad Gateway", ix::HttpErrorCode::Ok, response_headers, "");
+		}
+		return std::make_shared<ix::HttpResponse>(response.status_code, "", ix::HttpErrorCode::Ok, response_headers, response.text);
+	});
+
+	auto listening = server.listen();
+	if (!listening.first) {
+		std::cerr << "Failed to listen on " << host << ":" << port << ": " << listening.second << std::endl;
+		return 1;
+	}
+
+	std::cout << "Forwarding REST requests on " << host << ":" << port << std::endl;
+	server.start();
+	server.wait();
+
+	return 0;
+}